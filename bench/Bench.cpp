@@ -0,0 +1,64 @@
+#include "Bench.hpp"
+
+#include <algorithm>
+#include <chrono>
+
+using namespace bench;
+using std::chrono::duration;
+using std::chrono::steady_clock;
+
+/// @brief Min duration of a samples batch (seconds)
+inline constexpr double MIN_BATCH_TIME = 0.001;
+
+static volatile const void* sink = nullptr;
+
+void bench::consume(const void* ptr) {
+    sink = ptr;
+}
+
+std::vector<BenchInfo>& bench::registry() {
+    static std::vector<BenchInfo> benchmarks;
+    return benchmarks;
+}
+
+static double measure_batch(const std::function<void()>& func, size_t count) {
+    auto start = steady_clock::now();
+    for (size_t i = 0; i < count; i++) {
+        func();
+    }
+    return duration<double>(steady_clock::now() - start).count();
+}
+
+void Context::measure(const std::function<void()>& func) {
+    // warm up caches and lazy initializations
+    func();
+
+    // grow batch until it is long enough for the clock resolution
+    size_t batch = 1;
+    while (measure_batch(func, batch) < MIN_BATCH_TIME) {
+        batch *= 2;
+    }
+
+    std::vector<double> samples;
+    double total = 0.0;
+    while (samples.size() < config.maxSamples &&
+           (total < config.minTime || samples.size() < config.minSamples)) {
+        double time = measure_batch(func, batch);
+        total += time;
+        samples.push_back(time * 1e9 / batch);
+    }
+    std::sort(samples.begin(), samples.end());
+
+    double sum = 0.0;
+    for (double sample : samples) {
+        sum += sample;
+    }
+    size_t count = samples.size();
+    result.iterations = count * batch;
+    result.samples = count;
+    result.mean = sum / count;
+    result.median = count % 2 ? samples[count / 2]
+                              : (samples[count / 2 - 1] + samples[count / 2]) / 2;
+    result.min = samples.front();
+    result.max = samples.back();
+}
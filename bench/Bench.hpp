@@ -0,0 +1,89 @@
+#pragma once
+
+#include <functional>
+#include <string>
+#include <vector>
+
+/// @brief Defines a benchmark named GROUP.NAME
+/// @example:
+///     BENCH(gzip, compress) {
+///         auto data = ...;
+///         ctx.setBytes(data.size());
+///         ctx.measure([&]() {
+///             bench::consume(gzip::compress(data.data(), data.size()));
+///         });
+///     }
+#define BENCH(GROUP, NAME)                                               \
+    static void bench_##GROUP##_##NAME(bench::Context& ctx);             \
+    static bench::Registrar bench_##GROUP##_##NAME##_registrar(          \
+        #GROUP "." #NAME, bench_##GROUP##_##NAME                         \
+    );                                                                   \
+    static void bench_##GROUP##_##NAME([[maybe_unused]] bench::Context& ctx)
+
+namespace bench {
+    struct Config {
+        /// @brief Min measurement time of a benchmark (seconds)
+        double minTime = 0.5;
+        /// @brief Min number of samples of a benchmark
+        size_t minSamples = 10;
+        /// @brief Max number of samples of a benchmark
+        size_t maxSamples = 1000;
+    };
+
+    struct Result {
+        std::string name;
+        /// @brief Total number of measured iterations
+        size_t iterations = 0;
+        /// @brief Number of samples (batches of iterations)
+        size_t samples = 0;
+        /// @brief Iteration time statistics over samples (nanoseconds)
+        double mean = 0.0;
+        double median = 0.0;
+        double min = 0.0;
+        double max = 0.0;
+        /// @brief Bytes processed per iteration (0 if not set)
+        size_t bytes = 0;
+    };
+
+    class Context {
+        const Config& config;
+        Result& result;
+    public:
+        Context(const Config& config, Result& result)
+            : config(config), result(result) {
+        }
+
+        /// @brief Set number of bytes processed per iteration
+        void setBytes(size_t bytes) {
+            result.bytes = bytes;
+        }
+
+        /// @brief Measure time of func calls. Benchmark setup must be
+        /// done before, so it is not measured
+        void measure(const std::function<void()>& func);
+    };
+
+    using BenchFunc = void (*)(Context&);
+
+    struct BenchInfo {
+        std::string name;
+        BenchFunc func;
+    };
+
+    /// @brief Registered benchmarks
+    std::vector<BenchInfo>& registry();
+
+    struct Registrar {
+        Registrar(const char* name, BenchFunc func) {
+            registry().push_back(BenchInfo {name, func});
+        }
+    };
+
+    /// @brief Prevent the value computation from being optimized out
+    void consume(const void* ptr);
+
+    template <typename T>
+    inline void consume(const T& value) {
+        consume(static_cast<const void*>(&value));
+    }
+}
@@ -0,0 +1,156 @@
+#include "Bench.hpp"
+#include "fixtures.hpp"
+
+#include <random>
+
+#include "coders/binary_json.hpp"
+#include "coders/gzip.hpp"
+#include "coders/lz.hpp"
+#include "coders/rle.hpp"
+#include "voxels/Chunk.hpp"
+
+using namespace bench;
+
+/// @brief Synthetic world-like document: entities with components data
+static dv::value create_document() {
+    std::mt19937 random(42);
+    auto root = dv::object();
+    root["name"] = "benchmark";
+    root["seed"] = 42;
+    auto& entities = root.list("entities");
+    for (int i = 0; i < 1000; i++) {
+        auto& entity = entities.object();
+        entity["uid"] = i;
+        entity["def"] = "base:drop";
+        auto& position = entity.list("position");
+        for (int j = 0; j < 3; j++) {
+            position.add(static_cast<double>(random() % 10000) / 100.0);
+        }
+        auto& inventory = entity.list("inventory");
+        for (int j = 0; j < 8; j++) {
+            auto& slot = inventory.object();
+            slot["id"] = static_cast<int>(random() % 256);
+            slot["count"] = static_cast<int>(random() % 64);
+        }
+        entity["sleeping"] = random() % 2 == 0;
+    }
+    return root;
+}
+
+BENCH(extrle, encode16) {
+    auto data = fixtures::create_chunk(0, 0)->encode();
+    std::vector<ubyte> buffer(CHUNK_DATA_LEN * 2);
+    ctx.setBytes(CHUNK_DATA_LEN);
+    ctx.measure([&]() {
+        consume(extrle::encode16(data.get(), CHUNK_DATA_LEN, buffer.data()));
+    });
+}
+
+BENCH(extrle, decode16) {
+    auto data = fixtures::create_chunk(0, 0)->encode();
+    std::vector<ubyte> encoded(CHUNK_DATA_LEN * 2);
+    size_t size = extrle::encode16(data.get(), CHUNK_DATA_LEN, encoded.data());
+    std::vector<ubyte> buffer(CHUNK_DATA_LEN);
+    ctx.setBytes(CHUNK_DATA_LEN);
+    ctx.measure([&]() {
+        consume(extrle::decode16(encoded.data(), size, buffer.data()));
+    });
+}
+
+BENCH(gzip, compress) {
+    auto data = fixtures::create_chunk(0, 0)->encode();
+    std::vector<ubyte> encoded(CHUNK_DATA_LEN * 2);
+    size_t size = extrle::encode16(data.get(), CHUNK_DATA_LEN, encoded.data());
+    ctx.setBytes(size);
+    ctx.measure([&]() {
+        consume(gzip::compress(encoded.data(), size));
+    });
+}
+
+BENCH(gzip, decompress) {
+    auto data = fixtures::create_chunk(0, 0)->encode();
+    std::vector<ubyte> encoded(CHUNK_DATA_LEN * 2);
+    size_t size = extrle::encode16(data.get(), CHUNK_DATA_LEN, encoded.data());
+    auto compressed = gzip::compress(encoded.data(), size);
+    ctx.setBytes(size);
+    ctx.measure([&]() {
+        consume(gzip::decompress(compressed.data(), compressed.size()));
+    });
+}
+
+BENCH(lz, encode) {
+    auto data = fixtures::create_chunk(0, 0)->encode();
+    std::vector<ubyte> buffer(lz::compress_bound(CHUNK_DATA_LEN));
+    ctx.setBytes(CHUNK_DATA_LEN);
+    ctx.measure([&]() {
+        consume(lz::encode(data.get(), CHUNK_DATA_LEN, buffer.data()));
+    });
+}
+
+BENCH(lz, decode) {
+    auto data = fixtures::create_chunk(0, 0)->encode();
+    std::vector<ubyte> encoded(lz::compress_bound(CHUNK_DATA_LEN));
+    size_t size = lz::encode(data.get(), CHUNK_DATA_LEN, encoded.data());
+    std::vector<ubyte> buffer(CHUNK_DATA_LEN);
+    ctx.setBytes(CHUNK_DATA_LEN);
+    ctx.measure([&]() {
+        consume(lz::decode(
+            encoded.data(), size, buffer.data(), CHUNK_DATA_LEN
+        ));
+    });
+}
+
+static lz::Dictionary create_dictionary() {
+    std::vector<std::unique_ptr<ubyte[]>> chunks;
+    std::vector<util::span<const ubyte>> samples;
+    for (int i = 1; i <= 16; i++) {
+        chunks.push_back(fixtures::create_chunk(i, -i)->encode());
+        samples.emplace_back(chunks.back().get(), CHUNK_DATA_LEN);
+    }
+    return lz::Dictionary(lz::train_dictionary(samples, 32 * 1024));
+}
+
+BENCH(lz, encode_dictionary) {
+    auto dict = create_dictionary();
+    auto data = fixtures::create_chunk(0, 0)->encode();
+    std::vector<ubyte> buffer(lz::compress_bound(CHUNK_DATA_LEN));
+    ctx.setBytes(CHUNK_DATA_LEN);
+    ctx.measure([&]() {
+        consume(lz::encode(data.get(), CHUNK_DATA_LEN, buffer.data(), &dict));
+    });
+}
+
+BENCH(lz, decode_dictionary) {
+    auto dict = create_dictionary();
+    auto data = fixtures::create_chunk(0, 0)->encode();
+    std::vector<ubyte> encoded(lz::compress_bound(CHUNK_DATA_LEN));
+    size_t size =
+        lz::encode(data.get(), CHUNK_DATA_LEN, encoded.data(), &dict);
+    std::vector<ubyte> buffer(CHUNK_DATA_LEN);
+    ctx.setBytes(CHUNK_DATA_LEN);
+    ctx.measure([&]() {
+        consume(lz::decode(
+            encoded.data(),
+            size,
+            buffer.data(),
+            CHUNK_DATA_LEN,
+            dict.getData()
+        ));
+    });
+}
+
+BENCH(json, to_binary) {
+    auto document = create_document();
+    ctx.setBytes(json::to_binary(document).size());
+    ctx.measure([&]() {
+        consume(json::to_binary(document));
+    });
+}
+
+BENCH(json, from_binary) {
+    auto bytes = json::to_binary(create_document());
+    ctx.setBytes(bytes.size());
+    ctx.measure([&]() {
+        consume(json::from_binary(bytes.data(), bytes.size()));
+    });
+}
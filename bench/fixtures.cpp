@@ -0,0 +1,124 @@
+#include "fixtures.hpp"
+
+#include <cmath>
+#include <random>
+
+#include "content/Content.hpp"
+#include "content/ContentControl.hpp"
+#include "engine/Engine.hpp"
+#include "lighting/Lighting.hpp"
+#include "voxels/Block.hpp"
+#include "voxels/Chunk.hpp"
+#include "voxels/Chunks.hpp"
+
+using namespace bench;
+
+enum PaletteIndex { AIR, STONE, DIRT, GRASS, ORE, LAMP };
+
+static std::filesystem::path resFolder = "res";
+static bool engineInitialized = false;
+
+void fixtures::fill_terrain(
+    Chunk& chunk, const std::vector<blockid_t>& palette, uint seed
+) {
+    std::mt19937 random(seed ^ (chunk.x * 73856093) ^ (chunk.z * 19349663));
+
+    struct Cave {
+        glm::ivec3 center;
+        int radius;
+    };
+    std::vector<Cave> caves;
+    for (int i = 0; i < 3; i++) {
+        caves.push_back(Cave {
+            glm::ivec3(random() % CHUNK_W, 8 + random() % 32, random() % CHUNK_D),
+            3 + static_cast<int>(random() % 4)});
+    }
+    for (int z = 0; z < CHUNK_D; z++) {
+        for (int x = 0; x < CHUNK_W; x++) {
+            int gx = chunk.x * CHUNK_W + x;
+            int gz = chunk.z * CHUNK_D + z;
+            int height = 48 + static_cast<int>(
+                8.0 * std::sin(gx * 0.1) * std::cos(gz * 0.13)
+            ) + random() % 2;
+            for (int y = 0; y < CHUNK_H; y++) {
+                int index = PaletteIndex::AIR;
+                if (y < height - 4) {
+                    index = random() % 100 ? PaletteIndex::STONE
+                                           : PaletteIndex::ORE;
+                    for (const auto& cave : caves) {
+                        glm::ivec3 d = glm::ivec3(x, y, z) - cave.center;
+                        if (d.x * d.x + d.y * d.y + d.z * d.z <
+                            cave.radius * cave.radius) {
+                            index = PaletteIndex::AIR;
+                        }
+                    }
+                } else if (y < height - 1) {
+                    index = PaletteIndex::DIRT;
+                } else if (y == height - 1) {
+                    index = PaletteIndex::GRASS;
+                } else if (y == height && random() % 256 == 0) {
+                    index = PaletteIndex::LAMP;
+                }
+                chunk.voxels.ref(vox_index(x, y, z)).id = palette[index];
+            }
+        }
+    }
+    chunk.voxels.compact();
+}
+
+std::unique_ptr<Chunk> fixtures::create_chunk(int x, int z, uint seed) {
+    auto chunk = std::make_unique<Chunk>(x, z);
+    fill_terrain(*chunk, {0, 1, 2, 3, 4, 5}, seed);
+    return chunk;
+}
+
+void fixtures::set_res_folder(const std::filesystem::path& folder) {
+    resFolder = folder;
+}
+
+const Content& fixtures::content() {
+    auto& engine = Engine::getInstance();
+    if (!engineInitialized) {
+        CoreParameters params;
+        params.headless = true;
+        params.resFolder = resFolder;
+        engine.initialize(std::move(params));
+        engine.getContentControl().loadContent({"base"});
+        engineInitialized = true;
+    }
+    return *engine.getContentControl().get();
+}
+
+void fixtures::cleanup() {
+    if (engineInitialized) {
+        Engine::terminate();
+        engineInitialized = false;
+    }
+}
+
+std::vector<blockid_t> fixtures::content_palette() {
+    const auto& blocks = content().blocks;
+    return {
+        BLOCK_AIR,
+        blocks.require("base:stone").rt.id,
+        blocks.require("base:dirt").rt.id,
+        blocks.require("base:grass_block").rt.id,
+        blocks.require("base:coal_ore").rt.id,
+        blocks.require("base:lamp").rt.id,
+    };
+}
+
+std::unique_ptr<Chunks> fixtures::create_area(uint seed) {
+    const auto& indices = *content().getIndices();
+    auto palette = content_palette();
+    auto chunks = std::make_unique<Chunks>(3, 3, -1, -1, nullptr, indices);
+    for (int z = -1; z <= 1; z++) {
+        for (int x = -1; x <= 1; x++) {
+            auto chunk = std::make_shared<Chunk>(x, z);
+            fill_terrain(*chunk, palette, seed);
+            Lighting::prebuildSkyLight(*chunk, indices);
+            chunks->putChunk(chunk);
+        }
+    }
+    return chunks;
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <filesystem>
+#include <memory>
+#include <vector>
+
+#include "typedefs.hpp"
+
+class Chunk;
+class Chunks;
+class Content;
+class ContentIndices;
+
+/// @brief Reproducible benchmark fixtures
+namespace bench::fixtures {
+    /// @brief Fill chunk with seeded synthetic terrain: stone with caves and
+    /// scattered ores, dirt and grass layers and sparse light sources
+    /// @param palette {air, stone, dirt, grass, ore, lamp} block ids
+    void fill_terrain(
+        Chunk& chunk, const std::vector<blockid_t>& palette, uint seed
+    );
+
+    /// @brief Create chunk filled with synthetic terrain of ids 0-5
+    std::unique_ptr<Chunk> create_chunk(int x, int z, uint seed = 42);
+
+    /// @brief Set resources folder used for the headless content load
+    void set_res_folder(const std::filesystem::path& folder);
+
+    /// @brief Get base content loaded in a headless engine.
+    /// Engine is initialized on the first call
+    const Content& content();
+
+    /// @brief Terminate the engine if initialized
+    void cleanup();
+
+    /// @brief Get {air, stone, dirt, grass, ore, lamp} base content palette
+    std::vector<blockid_t> content_palette();
+
+    /// @brief Create 3x3 chunks area centered at (0, 0) filled with
+    /// synthetic terrain of the base content with sky light prebuilt
+    std::unique_ptr<Chunks> create_area(uint seed = 42);
+}
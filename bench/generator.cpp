@@ -0,0 +1,27 @@
+#include "Bench.hpp"
+#include "fixtures.hpp"
+
+#include "content/Content.hpp"
+#include "voxels/voxel.hpp"
+#include "world/generator/WorldGenerator.hpp"
+
+using namespace bench;
+
+inline constexpr uint64_t SEED = 42;
+inline constexpr int LOAD_DISTANCE = 4;
+
+BENCH(world_generator, generate) {
+    const auto& content = fixtures::content();
+    const auto& def = content.generators.require("base:demo");
+    WorldGenerator generator(def, content, SEED);
+    auto voxels = std::make_unique<voxel[]>(CHUNK_VOL);
+
+    // walk along X generating new chunks as a moving player does,
+    // so prototypes building is included
+    int x = 0;
+    ctx.measure([&]() {
+        generator.update(x, 0, LOAD_DISTANCE);
+        generator.generate(voxels.get(), x, 0);
+        x++;
+    });
+}
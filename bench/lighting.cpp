@@ -0,0 +1,41 @@
+#include "Bench.hpp"
+#include "fixtures.hpp"
+
+#include "content/Content.hpp"
+#include "lighting/LightSolver.hpp"
+#include "voxels/Block.hpp"
+#include "voxels/Chunk.hpp"
+#include "voxels/Chunks.hpp"
+
+using namespace bench;
+
+BENCH(light_solver, solve) {
+    const auto& indices = *fixtures::content().getIndices();
+    auto chunks = fixtures::create_area();
+    auto getter = [&chunks](int x, int z) { return chunks->getChunk(x, z); };
+    auto center = chunks->getChunk(0, 0);
+
+    ctx.measure([&]() {
+        for (const auto& chunk : chunks->getChunks()) {
+            chunk->lightmap.clear();
+        }
+        LightSolver solverR(indices, getter, 0);
+        LightSolver solverG(indices, getter, 1);
+        LightSolver solverB(indices, getter, 2);
+        for (uint i = 0; i < CHUNK_VOL; i++) {
+            const auto& def = indices.blocks.require(center->voxels.get(i).id);
+            if (!def.rt.emissive) {
+                continue;
+            }
+            int x = i % CHUNK_W;
+            int y = i / (CHUNK_D * CHUNK_W);
+            int z = (i / CHUNK_W) % CHUNK_D;
+            solverR.add(x, y, z, def.emission[0]);
+            solverG.add(x, y, z, def.emission[1]);
+            solverB.add(x, y, z, def.emission[2]);
+        }
+        solverR.solve();
+        solverG.solve();
+        solverB.solve();
+    });
+}
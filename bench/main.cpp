@@ -0,0 +1,140 @@
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+
+#include "Bench.hpp"
+#include "fixtures.hpp"
+#include "coders/json.hpp"
+#include "constants.hpp"
+#include "util/ArgsReader.hpp"
+
+struct Options {
+    bench::Config config;
+    std::string filter;
+    std::filesystem::path output {"bench.json"};
+    std::filesystem::path resFolder {"res"};
+    bool list = false;
+};
+
+static bool perform_keyword(
+    util::ArgsReader& reader, const std::string& keyword, Options& options
+) {
+    if (keyword == "--help" || keyword == "-h") {
+        std::cout << "Options\n\n";
+        std::cout << "  --help, -h                      = show help\n";
+        std::cout << "  --list                          = list benchmarks\n";
+        std::cout << "  --filter <text>, -f <text>      = run benchmarks with names containing text\n";
+        std::cout << "  --output <path>, -o <path>      = results JSON file path (bench.json)\n";
+        std::cout << "  --res <path>, -r <path>         = 'res' directory path\n";
+        std::cout << "  --min-time <seconds>            = min measurement time of a benchmark\n";
+        std::cout << std::endl;
+        return false;
+    } else if (keyword == "--list") {
+        options.list = true;
+    } else if (keyword == "--filter" || keyword == "-f") {
+        options.filter = reader.next();
+    } else if (keyword == "--output" || keyword == "-o") {
+        options.output = reader.next();
+    } else if (keyword == "--res" || keyword == "-r") {
+        options.resFolder = reader.next();
+    } else if (keyword == "--min-time") {
+        options.config.minTime = std::stod(reader.next());
+    } else {
+        std::cerr << "unknown argument " << keyword << std::endl;
+        return false;
+    }
+    return true;
+}
+
+static bool parse_cmdline(int argc, char** argv, Options& options) {
+    util::ArgsReader reader(argc, argv);
+    reader.skip();
+    while (reader.hasNext()) {
+        std::string token = reader.next();
+        if (reader.isKeywordArg()) {
+            if (!perform_keyword(reader, token, options)) {
+                return false;
+            }
+        } else {
+            std::cerr << "unexpected token " << token << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+static dv::value to_json(const bench::Result& result) {
+    auto object = dv::object();
+    object["name"] = result.name;
+    object["iterations"] = static_cast<int64_t>(result.iterations);
+    object["samples"] = static_cast<int64_t>(result.samples);
+    object["mean_ns"] = result.mean;
+    object["median_ns"] = result.median;
+    object["min_ns"] = result.min;
+    object["max_ns"] = result.max;
+    if (result.bytes) {
+        object["bytes"] = static_cast<int64_t>(result.bytes);
+        object["bytes_per_second"] = result.bytes * 1e9 / result.median;
+    }
+    return object;
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    try {
+        if (!parse_cmdline(argc, argv, options)) {
+            return 0;
+        }
+    } catch (const std::exception& err) {
+        std::cerr << err.what() << std::endl;
+        return 1;
+    }
+    bench::fixtures::set_res_folder(options.resFolder);
+
+    auto benchmarks = bench::registry();
+    std::sort(benchmarks.begin(), benchmarks.end(), [](auto& a, auto& b) {
+        return a.name < b.name;
+    });
+    if (options.list) {
+        for (const auto& info : benchmarks) {
+            std::cout << info.name << std::endl;
+        }
+        return 0;
+    }
+
+    auto root = dv::object();
+    root["engine_version"] = ENGINE_VERSION_STRING;
+    root["debug_build"] = ENGINE_DEBUG_BUILD;
+    auto& results = root.list("benchmarks");
+
+    int status = 0;
+    for (const auto& info : benchmarks) {
+        if (info.name.find(options.filter) == std::string::npos) {
+            continue;
+        }
+        bench::Result result;
+        result.name = info.name;
+        bench::Context ctx(options.config, result);
+        try {
+            info.func(ctx);
+        } catch (const std::exception& err) {
+            std::cerr << info.name << ": " << err.what() << std::endl;
+            status = 1;
+            continue;
+        }
+        std::cout << info.name << ": " << result.median / 1000.0
+                  << " us (median of " << result.samples << " samples, "
+                  << result.iterations << " iterations)" << std::endl;
+        results.add(to_json(result));
+    }
+    bench::fixtures::cleanup();
+
+    std::ofstream file(options.output);
+    file << json::stringify(root, true, "  ");
+    if (!file) {
+        std::cerr << "could not write " << options.output.u8string()
+                  << std::endl;
+        return 1;
+    }
+    return status;
+}
@@ -0,0 +1,38 @@
+#include "Bench.hpp"
+#include "fixtures.hpp"
+
+#include "assets/Assets.hpp"
+#include "frontend/ContentGfxCache.hpp"
+#include "graphics/core/Atlas.hpp"
+#include "graphics/core/ImageData.hpp"
+#include "graphics/core/Mesh.hpp"
+#include "graphics/render/BlocksRenderer.hpp"
+#include "settings.hpp"
+#include "voxels/Chunks.hpp"
+
+using namespace bench;
+
+BENCH(blocks_renderer, build) {
+    const auto& content = fixtures::content();
+    auto chunks = fixtures::create_area();
+
+    // no textures in headless mode, all blocks use the default region
+    Assets assets;
+    assets.store(
+        std::make_unique<Atlas>(
+            std::make_unique<ImageData>(ImageFormat::rgba8888, 1, 1),
+            std::unordered_map<std::string, UVRegion> {},
+            false
+        ),
+        "blocks"
+    );
+    EngineSettings settings;
+    ContentGfxCache cache(content, assets, settings.graphics);
+    BlocksRenderer renderer(
+        settings.graphics.chunkMaxVertices.get(), content, cache, settings
+    );
+    auto center = chunks->getChunk(0, 0);
+    ctx.measure([&]() {
+        renderer.build(center, chunks.get());
+    });
+}
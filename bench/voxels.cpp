@@ -0,0 +1,35 @@
+#include "Bench.hpp"
+#include "fixtures.hpp"
+
+#include "voxels/Chunk.hpp"
+
+using namespace bench;
+
+BENCH(chunk, encode) {
+    auto chunk = fixtures::create_chunk(0, 0);
+    ctx.setBytes(CHUNK_DATA_LEN);
+    ctx.measure([&]() {
+        consume(chunk->encode());
+    });
+}
+
+BENCH(chunk, decode) {
+    auto data = fixtures::create_chunk(0, 0)->encode();
+    Chunk chunk(0, 0);
+    ctx.setBytes(CHUNK_DATA_LEN);
+    ctx.measure([&]() {
+        consume(chunk.decode(data.get()));
+    });
+}
+
+BENCH(chunk, get) {
+    auto chunk = fixtures::create_chunk(0, 0);
+    ctx.setBytes(CHUNK_VOL * sizeof(voxel));
+    ctx.measure([&]() {
+        uint sum = 0;
+        for (uint i = 0; i < CHUNK_VOL; i++) {
+            sum += chunk->voxels.get(i).id;
+        }
+        consume(sum);
+    });
+}
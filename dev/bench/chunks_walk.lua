@@ -0,0 +1,42 @@
+-- Random teleport walk of several players loading and generating chunks
+-- @threshold tick_p99_ms <= 250
+-- @threshold chunks_generated_per_second >= 20
+-- @threshold rss_peak_mb <= 4096
+local util = require "core:tests_util"
+util.create_demo_world("base:demo")
+
+app.set_setting("chunks.load-distance", 12)
+app.set_setting("chunks.load-speed", 15)
+
+local PLAYERS = 4
+local TICKS = 200
+
+math.randomseed(42)
+
+local pids = {}
+for i = 1, PLAYERS do
+    pids[i] = player.create("Walker"..i)
+end
+
+for tick = 1, TICKS do
+    if tick % 20 == 1 then
+        for i, pid in ipairs(pids) do
+            local radius = 100 * i
+            player.set_pos(
+                pid,
+                math.random() * radius * 2 - radius,
+                100,
+                math.random() * radius * 2 - radius
+            )
+        end
+    end
+    app.tick()
+end
+print("chunks loaded", world.count_chunks())
+
+for _, pid in ipairs(pids) do
+    player.delete(pid)
+end
+
+app.close_world(false)
+app.delete_world("demo")
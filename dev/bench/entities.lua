@@ -0,0 +1,36 @@
+-- Many falling and resting drops simulated around a single player
+-- @threshold tick_p99_ms <= 100
+-- @threshold rss_peak_mb <= 4096
+local util = require "core:tests_util"
+util.create_demo_world("core:default")
+
+app.set_setting("chunks.load-distance", 4)
+app.set_setting("chunks.load-speed", 4)
+
+local base_util = require "base:util"
+
+local DROPS = 1000
+local TICKS = 200
+
+local pid = player.create("Xerxes")
+player.set_spawnpoint(pid, 0, 100, 0)
+player.set_pos(pid, 0, 100, 0)
+
+app.sleep_until(function () return block.get(0, 0, 0) ~= -1 end)
+
+local itemid = item.index("base:bazalt_breaker")
+for i = 0, DROPS - 1 do
+    local x = i % 32 - 16
+    local z = math.floor(i / 32) % 32 - 16
+    local y = 20 + math.floor(i / 1024) * 2 + (i % 7)
+    base_util.drop({x + 0.5, y, z + 0.5}, itemid, 1)
+end
+
+for _ = 1, TICKS do
+    app.tick()
+end
+
+player.delete(pid)
+
+app.close_world(false)
+app.delete_world("demo")
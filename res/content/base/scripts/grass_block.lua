@@ -1,9 +1,13 @@
-function on_random_update(x, y, z)
+local function update_grass(x, y, z)
+    local grassblockid = block.index('base:grass_block')
+    -- block may be replaced by previous updates of the batch
+    if block.get(x, y, z) ~= grassblockid then
+        return
+    end
     local dirtid = block.index('base:dirt');
     if block.is_solid_at(x, y+1, z) then
         block.set(x, y, z, dirtid, 0)
     else
-        local grassblockid = block.index('base:grass_block')
         for lx=-1,1 do
             for ly=-1,1 do
                 for lz=-1,1 do
@@ -18,3 +22,11 @@ function on_random_update(x, y, z)
         end
     end
 end
+
+on_random_update = update_grass
+
+function on_random_update_batch(positions)
+    for i=1,#positions,3 do
+        update_grass(positions[i], positions[i + 1], positions[i + 2])
+    end
+end
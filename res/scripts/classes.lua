@@ -41,6 +41,9 @@ local Socket = {__index={
     recv=function(self, ...) return network.__recv(self.id, ...) end,
     close=function(self) return network.__close(self.id) end,
     available=function(self) return network.__available(self.id) or 0 end,
+    set_high_water_mark=function(self, bytes)
+        return network.__set_high_water_mark(self.id, bytes)
+    end,
     is_alive=function(self) return network.__is_alive(self.id) end,
     is_connected=function(self) return network.__is_connected(self.id) end,
     get_address=function(self) return network.__get_address(self.id) end,
@@ -65,3 +68,17 @@ network.tcp_open = function(port, handler)
         handler(setmetatable({id=id}, Socket))
     end)}, ServerSocket)
 end
+
+local UdpSocket = {__index={
+    send_to=function(self, ...) return network.__udp_send_to(self.id, ...) end,
+    recv_from=function(self, ...)
+        return network.__udp_recv_from(self.id, ...)
+    end,
+    close=function(self) return network.__udp_close(self.id) end,
+    is_open=function(self) return network.__udp_is_open(self.id) end,
+    get_port=function(self) return network.__udp_get_port(self.id) end,
+}}
+
+network.udp_bind = function(port)
+    return setmetatable({id=network.__udp_bind(port)}, UdpSocket)
+end
@@ -142,12 +142,24 @@ function events.on(event, func)
     table.insert(events.handlers[event], func)
 end
 
+-- handlers lists are cleared instead of being removed as the engine
+-- refers to them by handles
+local function clear_handlers(handlers)
+    for i=#handlers,1,-1 do
+        handlers[i] = nil
+    end
+end
+
 function events.reset(event, func)
-    if func == nil then
-        events.handlers[event] = nil
-    else
-        events.handlers[event] = {func}
+    local handlers = events.handlers[event]
+    if handlers == nil then
+        if func ~= nil then
+            events.handlers[event] = {func}
+        end
+        return
     end
+    clear_handlers(handlers)
+    handlers[1] = func
 end
 
 function events.remove_by_prefix(prefix)
@@ -157,7 +169,10 @@ function events.remove_by_prefix(prefix)
             actualname = name[1]
         end
         if actualname:sub(1, #prefix+1) == prefix..':' then
-            events.handlers[actualname] = nil
+            local list = events.handlers[actualname]
+            if list then
+                clear_handlers(list)
+            end
         end
     end
 end
@@ -68,6 +68,14 @@ void ByteBuilder::putFloat64(double val, bool bigEndian) {
     putInt64(i64_val, bigEndian);
 }
 
+void ByteBuilder::putVarUInt32(uint32_t val) {
+    while (val >= 0x80) {
+        buffer.push_back(static_cast<ubyte>(val | 0x80));
+        val >>= 7;
+    }
+    buffer.push_back(static_cast<ubyte>(val));
+}
+
 void ByteBuilder::set(size_t position, ubyte val) {
     buffer[position] = val;
 }
@@ -187,6 +195,18 @@ double ByteReader::getFloat64(bool bigEndian) {
     return val;
 }
 
+uint32_t ByteReader::getVarUInt32() {
+    uint32_t value = 0;
+    for (int shift = 0; shift < 35; shift += 7) {
+        ubyte b = get();
+        value |= static_cast<uint32_t>(b & 0x7F) << shift;
+        if ((b & 0x80) == 0) {
+            return value;
+        }
+    }
+    throw std::runtime_error("invalid varint");
+}
+
 const char* ByteReader::getCString() {
     const char* cstr = reinterpret_cast<const char*>(data + pos);
     pos += std::strlen(cstr) + 1;
@@ -25,6 +25,8 @@ public:
     void putFloat32(float val, bool bigEndian = false);
     /// @brief Write 64 bit floating-point number
     void putFloat64(double val, bool bigEndian = false);
+    /// @brief Write unsigned 32 bit integer as LEB128 (1-5 bytes)
+    void putVarUInt32(uint32_t val);
 
     /// @brief Write string (uint32 length + bytes)
     void put(const std::string& s);
@@ -72,6 +74,8 @@ public:
     float getFloat32(bool bigEndian = false);
     /// @brief Read 64 bit floating-point number
     double getFloat64(bool bigEndian = false);
+    /// @brief Read unsigned 32 bit LEB128 integer
+    uint32_t getVarUInt32();
     /// @brief Read C-String
     const char* getCString();
     /// @brief Read string with unsigned 32 bit number before (length)
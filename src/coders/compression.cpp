@@ -6,6 +6,7 @@
 
 #include "rle.hpp"
 #include "gzip.hpp"
+#include "lz.hpp"
 #include "util/BufferPool.hpp"
 
 using namespace compression;
@@ -16,6 +17,8 @@ static util::BufferPool<ubyte> buffer_pools[] {
     {255},
     {UINT16_MAX},
     {UINT16_MAX * 8},
+    // fits EXTRLE16_LZ intermediate buffer of chunk voxels
+    {UINT16_MAX * 16},
 };
 
 static std::shared_ptr<ubyte[]> get_buffer(size_t minSize) {
@@ -55,8 +58,124 @@ static auto compress_rle(
     return data;
 }
 
+static std::unique_ptr<ubyte[]> compress_lz(
+    const ubyte* src,
+    size_t srclen,
+    size_t& len,
+    const lz::Dictionary* dictionary
+) {
+    size_t bufferSize = lz::compress_bound(srclen);
+    auto buffer = get_buffer(bufferSize);
+    std::unique_ptr<ubyte[]> uptr;
+    ubyte* bytes = buffer.get();
+    if (bytes == nullptr) {
+        uptr = std::make_unique<ubyte[]>(bufferSize);
+        bytes = uptr.get();
+    }
+    len = lz::encode(src, srclen, bytes, dictionary);
+    auto data = std::make_unique<ubyte[]>(len);
+    std::memcpy(data.get(), bytes, len);
+    return data;
+}
+
+static void check_dictionary(
+    Method method, const lz::Dictionary*& dictionary
+) {
+    if (!is_using_dictionary(method)) {
+        dictionary = nullptr;
+    } else if (dictionary == nullptr || dictionary->empty()) {
+        throw std::invalid_argument("compression method requires a dictionary");
+    }
+}
+
+static util::span<const ubyte> get_data(const lz::Dictionary* dictionary) {
+    return dictionary ? dictionary->getData() : util::span<const ubyte> {};
+}
+
+static std::unique_ptr<ubyte[]> compress_extrle16_lz(
+    const ubyte* src,
+    size_t srclen,
+    size_t& len,
+    const lz::Dictionary* dictionary
+) {
+    size_t bufferSize = srclen * 2;
+    auto buffer = get_buffer(bufferSize);
+    std::unique_ptr<ubyte[]> uptr;
+    ubyte* bytes = buffer.get();
+    if (bytes == nullptr) {
+        uptr.reset(new ubyte[bufferSize]);
+        bytes = uptr.get();
+    }
+    size_t rleLength = extrle::encode16(src, srclen, bytes);
+    return compress_lz(bytes, rleLength, len, dictionary);
+}
+
+static std::unique_ptr<ubyte[]> decompress_extrle16_lz(
+    const ubyte* src,
+    size_t srclen,
+    size_t dstlen,
+    const lz::Dictionary* dictionary
+) {
+    // extrle16 data is never longer than twice the source
+    size_t bufferSize = dstlen * 2;
+    auto buffer = get_buffer(bufferSize);
+    std::unique_ptr<ubyte[]> uptr;
+    ubyte* bytes = buffer.get();
+    if (bytes == nullptr) {
+        uptr.reset(new ubyte[bufferSize]);
+        bytes = uptr.get();
+    }
+    size_t rleLength =
+        lz::decode(src, srclen, bytes, bufferSize, get_data(dictionary));
+    auto decompressed = std::make_unique<ubyte[]>(dstlen);
+    size_t decoded = extrle::decode16(bytes, rleLength, decompressed.get());
+    if (decoded != dstlen) {
+        throw std::runtime_error(
+            "expected decompressed size " + std::to_string(dstlen) +
+            " got " + std::to_string(decoded));
+    }
+    return decompressed;
+}
+
+bool compression::is_using_dictionary(Method method) {
+    return method == Method::LZ_DICT || method == Method::EXTRLE16_LZ_DICT;
+}
+
+Method compression::get_dictionary_method(Method method) {
+    switch (method) {
+        case Method::LZ:
+            return Method::LZ_DICT;
+        case Method::EXTRLE16_LZ:
+            return Method::EXTRLE16_LZ_DICT;
+        default:
+            return method;
+    }
+}
+
+std::vector<ubyte> compression::to_dictionary_sample(
+    const ubyte* src, size_t srclen, Method method
+) {
+    switch (method) {
+        case Method::LZ:
+        case Method::LZ_DICT:
+            return std::vector<ubyte>(src, src + srclen);
+        case Method::EXTRLE16_LZ:
+        case Method::EXTRLE16_LZ_DICT: {
+            std::vector<ubyte> sample(srclen * 2);
+            sample.resize(extrle::encode16(src, srclen, sample.data()));
+            return sample;
+        }
+        default:
+            throw std::invalid_argument("method is not LZ-based");
+    }
+}
+
 std::unique_ptr<ubyte[]> compression::compress(
-    const ubyte* src, size_t srclen, size_t& len, Method method
+    const ubyte* src,
+    size_t srclen,
+    size_t& len,
+    Method method,
+    const lz::Dictionary* dictionary
 ) {
     switch (method) {
         case Method::NONE:
@@ -72,13 +191,25 @@ std::unique_ptr<ubyte[]> compression::compress(
             len = buffer.size();
             return data;
         }
+        case Method::LZ:
+        case Method::LZ_DICT:
+            check_dictionary(method, dictionary);
+            return compress_lz(src, srclen, len, dictionary);
+        case Method::EXTRLE16_LZ:
+        case Method::EXTRLE16_LZ_DICT:
+            check_dictionary(method, dictionary);
+            return compress_extrle16_lz(src, srclen, len, dictionary);
         default:
             throw std::runtime_error("not implemented");
     }
 }
 
 std::unique_ptr<ubyte[]> compression::decompress(
-    const ubyte* src, size_t srclen, size_t dstlen, Method method
+    const ubyte* src,
+    size_t srclen,
+    size_t dstlen,
+    Method method,
+    const lz::Dictionary* dictionary
 ) {
     switch (method) {
         case Method::NONE:
@@ -109,6 +240,24 @@ std::unique_ptr<ubyte[]> compression::decompress(
             std::memcpy(decompressed.get(), buffer.data(), buffer.size());
             return decompressed;
         }
+        case Method::LZ:
+        case Method::LZ_DICT: {
+            check_dictionary(method, dictionary);
+            auto decompressed = std::make_unique<ubyte[]>(dstlen);
+            size_t decoded = lz::decode(
+                src, srclen, decompressed.get(), dstlen, get_data(dictionary)
+            );
+            if (decoded != dstlen) {
+                throw std::runtime_error(
+                    "expected decompressed size " + std::to_string(dstlen) +
+                    " got " + std::to_string(decoded));
+            }
+            return decompressed;
+        }
+        case Method::EXTRLE16_LZ:
+        case Method::EXTRLE16_LZ_DICT:
+            check_dictionary(method, dictionary);
+            return decompress_extrle16_lz(src, srclen, dstlen, dictionary);
         default:
             throw std::runtime_error("not implemented");
     }
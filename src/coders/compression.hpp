@@ -1,30 +1,72 @@
 #pragma once
 
 #include <memory>
+#include <vector>
 
 #include "typedefs.hpp"
+#include "util/span.hpp"
+
+namespace lz {
+    class Dictionary;
+}
 
 namespace compression {
+    /// @brief Compression method. Values are stored in region files
     enum class Method {
-        NONE, EXTRLE8, EXTRLE16, GZIP
+        NONE, EXTRLE8, EXTRLE16, GZIP,
+        /// @brief LZ without dictionary
+        LZ,
+        /// @brief LZ with dictionary required to decompress data
+        LZ_DICT,
+        /// @brief EXTRLE16 followed by LZ
+        EXTRLE16_LZ,
+        /// @brief EXTRLE16 followed by LZ with dictionary
+        EXTRLE16_LZ_DICT
     };
 
+    /// @return true if method requires a dictionary
+    bool is_using_dictionary(Method method);
+
+    /// @brief Get variant of the method using dictionary
+    /// @return method itself if it has no such variant
+    Method get_dictionary_method(Method method);
+
+    /// @brief Convert source data to the form LZ stage of the method
+    /// is applied to. Used to get dictionary training samples
+    /// @param src source buffer
+    /// @param srclen length of the source buffer
+    /// @param method LZ-based compression method
+    std::vector<ubyte> to_dictionary_sample(
+        const ubyte* src, size_t srclen, Method method
+    );
+
     /// @brief Compress buffer
     /// @param src source buffer
     /// @param srclen length of the source buffer
     /// @param len (out argument) length of result buffer
     /// @param method compression method
+    /// @param dictionary dictionary used by *_LZ_DICT methods
     /// @return compressed bytes array
     /// @throws std::invalid_argument if compression method is NONE
     std::unique_ptr<ubyte[]> compress(
-        const ubyte* src, size_t srclen, size_t& len, Method method
+        const ubyte* src,
+        size_t srclen,
+        size_t& len,
+        Method method,
+        const lz::Dictionary* dictionary = nullptr
     );
 
     /// @brief Decompress buffer
     /// @param src compressed buffer
     /// @param srclen length of compressed buffer
     /// @param dstlen max expected length of source buffer
+    /// @param dictionary dictionary used by *_LZ_DICT methods
     /// @return decompressed bytes array
     std::unique_ptr<ubyte[]> decompress(
-        const ubyte* src, size_t srclen, size_t dstlen, Method method);
+        const ubyte* src,
+        size_t srclen,
+        size_t dstlen,
+        Method method,
+        const lz::Dictionary* dictionary = nullptr
+    );
 }
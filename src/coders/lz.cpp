@@ -0,0 +1,496 @@
+#include "lz.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <queue>
+#include <stdexcept>
+
+#include "util/BufferPool.hpp"
+
+/// @brief Sequence format:
+///     token: (literals length: 4 bits) (match length - MIN_MATCH: 4 bits)
+///     [literals length extension: 255-bytes until < 255]
+///     literals
+///     match offset: LEB128 varint (absent in the last sequence)
+///     [match length extension: 255-bytes until < 255]
+/// Data always ends with a literals-only sequence
+
+inline constexpr int HASH_BITS = 15;
+inline constexpr size_t HASH_SIZE = 1 << HASH_BITS;
+/// @brief Higher values make the encoder skip incompressible data slower
+inline constexpr int SKIP_STRENGTH = 6;
+/// @brief Max number of match candidates checked at position
+inline constexpr int MAX_CHAIN_DEPTH = 16;
+/// @brief Max source length using pooled hash chains (chunk data length)
+inline constexpr size_t CHAINS_POOL_SIZE = 1 << 18;
+inline constexpr uint NIBBLE_MAX = 15;
+
+/// @brief Dictionary training k-mer length
+inline constexpr size_t KMER_LENGTH = 8;
+inline constexpr size_t SEGMENT_SIZE = 128;
+inline constexpr int FREQUENCIES_BITS = 20;
+
+static inline uint32_t read32(const ubyte* src) {
+    uint32_t value;
+    std::memcpy(&value, src, sizeof(value));
+    return value;
+}
+
+static inline uint64_t read64(const ubyte* src) {
+    uint64_t value;
+    std::memcpy(&value, src, sizeof(value));
+    return value;
+}
+
+static inline uint32_t hash4(uint32_t sequence) {
+    return (sequence * 2654435761U) >> (32 - HASH_BITS);
+}
+
+static inline size_t hash8(const ubyte* src) {
+    return (read64(src) * 0x9E3779B97F4A7C15ULL) >> (64 - FREQUENCIES_BITS);
+}
+
+static size_t count_common(const ubyte* a, const ubyte* b, const ubyte* aend) {
+    const ubyte* start = a;
+    while (a + sizeof(uint64_t) <= aend && read64(a) == read64(b)) {
+        a += sizeof(uint64_t);
+        b += sizeof(uint64_t);
+    }
+    while (a < aend && *a == *b) {
+        a++;
+        b++;
+    }
+    return a - start;
+}
+
+static ubyte* write_length(ubyte* dst, size_t length) {
+    while (length >= 255) {
+        *(dst++) = 255;
+        length -= 255;
+    }
+    *(dst++) = length;
+    return dst;
+}
+
+/// @brief Count of length extension bytes written after a 4-bit nibble
+static inline size_t length_ext_bytes(size_t length) {
+    return length >= NIBBLE_MAX ? (length - NIBBLE_MAX) / 255 + 1 : 0;
+}
+
+static inline size_t varint_bytes(size_t value) {
+    size_t count = 1;
+    while (value >= 0x80) {
+        value >>= 7;
+        count++;
+    }
+    return count;
+}
+
+/// @brief Count of sequence bytes besides literals. The encoder only emits
+/// sequences with the overhead less than the match length, so any sequence
+/// is shorter than its source bytes
+static inline size_t sequence_overhead(
+    size_t litlen, size_t offset, size_t matchlen
+) {
+    return 1 + length_ext_bytes(litlen) + varint_bytes(offset) +
+           length_ext_bytes(matchlen - lz::MIN_MATCH);
+}
+
+static ubyte* write_sequence(
+    ubyte* dst,
+    const ubyte* literals,
+    size_t litlen,
+    size_t offset,
+    size_t matchlen
+) {
+    ubyte* token = dst++;
+    *token = std::min<size_t>(litlen, NIBBLE_MAX) << 4;
+    if (litlen >= NIBBLE_MAX) {
+        dst = write_length(dst, litlen - NIBBLE_MAX);
+    }
+    if (litlen) {
+        std::memcpy(dst, literals, litlen);
+        dst += litlen;
+    }
+    if (offset == 0) {
+        return dst;
+    }
+    while (offset >= 0x80) {
+        *(dst++) = (offset & 0x7F) | 0x80;
+        offset >>= 7;
+    }
+    *(dst++) = offset;
+
+    matchlen -= lz::MIN_MATCH;
+    *token |= std::min<size_t>(matchlen, NIBBLE_MAX);
+    if (matchlen >= NIBBLE_MAX) {
+        dst = write_length(dst, matchlen - NIBBLE_MAX);
+    }
+    return dst;
+}
+
+size_t lz::compress_bound(size_t length) {
+    // match sequences never exceed their source bytes, so the worst case is
+    // the final literals-only sequence: token + length extension + literals
+    return length + length / 255 + 16;
+}
+
+/// @brief Per-call hash heads, reused between calls
+static util::BufferPool<uint32_t> heads_pool(HASH_SIZE);
+/// @brief Per-call hash chains fitting chunk data, reused between calls
+static util::BufferPool<uint32_t> chains_pool(CHAINS_POOL_SIZE);
+
+lz::Dictionary::Dictionary(std::vector<ubyte> data)
+    : data(std::move(data)),
+      heads(std::make_unique<uint32_t[]>(HASH_SIZE)),
+      chains(std::make_unique<uint32_t[]>(this->data.size())) {
+    for (size_t index = 0; index + MIN_MATCH <= this->data.size(); index++) {
+        uint32_t& head = heads[hash4(read32(this->data.data() + index))];
+        chains[index] = head;
+        head = index + 1;
+    }
+}
+
+/// @brief Count common bytes of source at pos and dictionary at candidate.
+/// Match may continue from the dictionary end to the source start
+static size_t count_common_dict(
+    const ubyte* pos,
+    const ubyte* candidate,
+    const ubyte* dictend,
+    const ubyte* src,
+    const ubyte* srcend
+) {
+    size_t left = dictend - candidate;
+    size_t count = count_common(
+        pos, candidate, pos + std::min<size_t>(left, srcend - pos)
+    );
+    if (count == left && pos + count < srcend) {
+        count += count_common(pos + count, src, srcend);
+    }
+    return count;
+}
+
+size_t lz::encode(
+    const ubyte* src,
+    size_t length,
+    ubyte* dst,
+    const Dictionary* dictionary
+) {
+    // positions are indices in dictionary followed by source
+    const ubyte* dict = nullptr;
+    size_t start = 0;
+    if (dictionary && !dictionary->empty()) {
+        dict = dictionary->data.data();
+        start = dictionary->data.size();
+    } else {
+        dictionary = nullptr;
+    }
+    const size_t end = start + length;
+    const ubyte* srcend = src + length;
+    auto at = [=](size_t index) {
+        return index < start ? dict + index : src + (index - start);
+    };
+
+    // hash chains of positions + 1, zero is the chain end. Source chains
+    // continue with prebuilt dictionary chains
+    auto headsBuffer = heads_pool.get();
+    uint32_t* heads = headsBuffer.get();
+    const uint32_t* dictChains = nullptr;
+    if (dictionary) {
+        std::memcpy(
+            heads, dictionary->heads.get(), HASH_SIZE * sizeof(uint32_t)
+        );
+        dictChains = dictionary->chains.get();
+    } else {
+        std::memset(heads, 0, HASH_SIZE * sizeof(uint32_t));
+    }
+    std::shared_ptr<uint32_t[]> chainsBuffer;
+    if (length <= CHAINS_POOL_SIZE) {
+        chainsBuffer = chains_pool.get();
+    } else {
+        chainsBuffer.reset(new uint32_t[length]);
+    }
+    uint32_t* chains = chainsBuffer.get();
+    auto insert = [&](size_t index) {
+        uint32_t& head = heads[hash4(read32(at(index)))];
+        chains[index - start] = head;
+        head = index + 1;
+    };
+    size_t inserted = start;
+
+    ubyte* dstptr = dst;
+    size_t anchor = start;
+    size_t pos = start;
+    size_t misses = 0;
+    while (pos + MIN_MATCH <= end) {
+        while (inserted < pos) {
+            insert(inserted++);
+        }
+        const ubyte* posptr = at(pos);
+        uint32_t sequence = read32(posptr);
+        size_t candidate = 0;
+        size_t matchlen = 0;
+        uint32_t next = heads[hash4(sequence)];
+        for (int depth = 0; next && depth < MAX_CHAIN_DEPTH; depth++) {
+            size_t index = next - 1;
+            next = index < start ? dictChains[index] : chains[index - start];
+            if (read32(at(index)) != sequence) {
+                continue;
+            }
+            size_t length = MIN_MATCH;
+            if (index < start) {
+                length += count_common_dict(
+                    posptr + MIN_MATCH,
+                    dict + index + MIN_MATCH,
+                    dict + start,
+                    src,
+                    srcend
+                );
+            } else {
+                length += count_common(
+                    posptr + MIN_MATCH, at(index) + MIN_MATCH, srcend
+                );
+            }
+            if (length > matchlen) {
+                matchlen = length;
+                candidate = index;
+                if (pos + length == end) {
+                    break;
+                }
+            }
+        }
+        insert(pos);
+        inserted = pos + 1;
+        if (matchlen == 0) {
+            pos += 1 + (misses++ >> SKIP_STRENGTH);
+            continue;
+        }
+        size_t matchpos = pos;
+        while (matchpos > anchor && candidate > 0 &&
+               *at(matchpos - 1) == *at(candidate - 1)) {
+            matchpos--;
+            candidate--;
+            matchlen++;
+        }
+        size_t overhead = sequence_overhead(
+            matchpos - anchor, matchpos - candidate, matchlen
+        );
+        if (overhead >= matchlen) {
+            // short distant match costs more than literals
+            pos += 1 + (misses++ >> SKIP_STRENGTH);
+            continue;
+        }
+        misses = 0;
+        pos = matchpos;
+        dstptr = write_sequence(
+            dstptr, at(anchor), pos - anchor, pos - candidate, matchlen
+        );
+        pos += matchlen;
+        anchor = pos;
+    }
+    dstptr = write_sequence(dstptr, at(anchor), end - anchor, 0, 0);
+    return dstptr - dst;
+}
+
+[[noreturn]] static void throw_malformed() {
+    throw std::runtime_error("malformed lz data");
+}
+
+static size_t read_length(const ubyte*& src, const ubyte* end) {
+    size_t length = 0;
+    ubyte byte;
+    do {
+        if (src >= end) {
+            throw_malformed();
+        }
+        byte = *(src++);
+        length += byte;
+    } while (byte == 255);
+    return length;
+}
+
+static size_t read_offset(const ubyte*& src, const ubyte* end) {
+    size_t offset = 0;
+    for (int shift = 0; shift < 35; shift += 7) {
+        if (src >= end) {
+            throw_malformed();
+        }
+        ubyte byte = *(src++);
+        offset |= static_cast<size_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            return offset;
+        }
+    }
+    throw_malformed();
+}
+
+size_t lz::decode(
+    const ubyte* src,
+    size_t length,
+    ubyte* dst,
+    size_t dstlen,
+    util::span<const ubyte> dictionary
+) {
+    const ubyte* end = src + length;
+    ubyte* dstptr = dst;
+    ubyte* dstend = dst + dstlen;
+    while (true) {
+        if (src >= end) {
+            throw_malformed();
+        }
+        ubyte token = *(src++);
+        size_t litlen = token >> 4;
+        if (litlen == NIBBLE_MAX) {
+            litlen += read_length(src, end);
+        }
+        if (litlen > static_cast<size_t>(end - src) ||
+            litlen > static_cast<size_t>(dstend - dstptr)) {
+            throw_malformed();
+        }
+        if (litlen) {
+            std::memcpy(dstptr, src, litlen);
+            dstptr += litlen;
+            src += litlen;
+        }
+        if (src == end) {
+            break;
+        }
+        size_t offset = read_offset(src, end);
+        size_t matchlen = (token & NIBBLE_MAX) + MIN_MATCH;
+        if ((token & NIBBLE_MAX) == NIBBLE_MAX) {
+            matchlen += read_length(src, end);
+        }
+        size_t produced = dstptr - dst;
+        if (offset == 0 || offset > produced + dictionary.size() ||
+            matchlen > static_cast<size_t>(dstend - dstptr)) {
+            throw_malformed();
+        }
+        if (offset > produced) {
+            // match starts in the dictionary
+            size_t inDictionary = offset - produced;
+            size_t count = std::min(matchlen, inDictionary);
+            std::memcpy(
+                dstptr,
+                dictionary.data() + dictionary.size() - inDictionary,
+                count
+            );
+            dstptr += count;
+            matchlen -= count;
+        }
+        // overlapping match repeats a period of offset bytes
+        const ubyte* match = dstptr - offset;
+        while (matchlen) {
+            size_t count = std::min<size_t>(matchlen, dstptr - match);
+            std::memcpy(dstptr, match, count);
+            dstptr += count;
+            matchlen -= count;
+        }
+    }
+    return dstptr - dst;
+}
+
+namespace {
+    struct Segment {
+        size_t score;
+        size_t sample;
+        size_t offset;
+
+        bool operator<(const Segment& other) const {
+            return score < other.score;
+        }
+    };
+
+    class SegmentScorer {
+        const std::vector<util::span<const ubyte>>& samples;
+        std::vector<uint32_t> frequencies;
+        /// @brief Last segment id the k-mer was counted in
+        std::vector<uint32_t> marks;
+        uint32_t mark = 0;
+    public:
+        SegmentScorer(const std::vector<util::span<const ubyte>>& samples)
+            : samples(samples),
+              frequencies(1 << FREQUENCIES_BITS),
+              marks(1 << FREQUENCIES_BITS) {
+            // k-mers are counted once per sample
+            for (const auto& sample : samples) {
+                mark++;
+                for (size_t i = 0; i + KMER_LENGTH <= sample.size(); i++) {
+                    size_t hash = hash8(sample.data() + i);
+                    if (marks[hash] != mark) {
+                        marks[hash] = mark;
+                        frequencies[hash]++;
+                    }
+                }
+            }
+        }
+
+        /// @brief Sum of frequencies of segment distinct k-mers
+        size_t score(const Segment& segment) {
+            const ubyte* data = samples[segment.sample].data() + segment.offset;
+            size_t score = 0;
+            mark++;
+            for (size_t i = 0; i + KMER_LENGTH <= SEGMENT_SIZE; i++) {
+                size_t hash = hash8(data + i);
+                if (marks[hash] != mark) {
+                    marks[hash] = mark;
+                    score += frequencies[hash];
+                }
+            }
+            return score;
+        }
+
+        /// @brief Make segment k-mers worthless for further segments
+        void cover(const Segment& segment) {
+            const ubyte* data = samples[segment.sample].data() + segment.offset;
+            for (size_t i = 0; i + KMER_LENGTH <= SEGMENT_SIZE; i++) {
+                frequencies[hash8(data + i)] = 0;
+            }
+        }
+    };
+}
+
+std::vector<ubyte> lz::train_dictionary(
+    const std::vector<util::span<const ubyte>>& samples, size_t capacity
+) {
+    SegmentScorer scorer(samples);
+    std::priority_queue<Segment> queue;
+    for (size_t i = 0; i < samples.size(); i++) {
+        for (size_t offset = 0; offset + SEGMENT_SIZE <= samples[i].size();
+             offset += SEGMENT_SIZE) {
+            Segment segment {0, i, offset};
+            segment.score = scorer.score(segment);
+            if (segment.score) {
+                queue.push(segment);
+            }
+        }
+    }
+    // lazy greedy selection: segment score may only decrease when other
+    // segments get selected
+    std::vector<Segment> selected;
+    while (!queue.empty() && (selected.size() + 1) * SEGMENT_SIZE <= capacity) {
+        Segment segment = queue.top();
+        queue.pop();
+        segment.score = scorer.score(segment);
+        if (segment.score == 0) {
+            continue;
+        }
+        if (!queue.empty() && segment.score < queue.top().score) {
+            queue.push(segment);
+            continue;
+        }
+        scorer.cover(segment);
+        selected.push_back(segment);
+    }
+    // the most valuable segments are placed at the end to get shorter offsets
+    std::vector<ubyte> dictionary(selected.size() * SEGMENT_SIZE);
+    for (size_t i = 0; i < selected.size(); i++) {
+        const auto& segment = selected[selected.size() - i - 1];
+        std::memcpy(
+            dictionary.data() + i * SEGMENT_SIZE,
+            samples[segment.sample].data() + segment.offset,
+            SEGMENT_SIZE
+        );
+    }
+    return dictionary;
+}
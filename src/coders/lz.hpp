@@ -0,0 +1,83 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "typedefs.hpp"
+#include "util/span.hpp"
+
+/// @brief Fast LZ77-family byte-oriented codec (LZ4-like sequences with
+/// variable-length offsets). Supports an optional dictionary: data
+/// logically preceding the source, available for matches on both sides
+namespace lz {
+    /// @brief Min match length encoded as a back-reference
+    inline constexpr size_t MIN_MATCH = 4;
+
+    class Dictionary;
+
+    /// @brief Max compressed data length of source of the given length
+    size_t compress_bound(size_t length);
+
+    /// @brief Compress bytes array
+    /// @param src source bytes array
+    /// @param length length of source bytes array
+    /// @param dst destination buffer of at least compress_bound(length) bytes
+    /// @param dictionary dictionary used to compress data (may be nullptr)
+    /// @return compressed data length
+    size_t encode(
+        const ubyte* src,
+        size_t length,
+        ubyte* dst,
+        const Dictionary* dictionary = nullptr
+    );
+
+    /// @brief Dictionary with matches search state built once and reused
+    /// by encode calls. Immutable, so may be used by multiple threads
+    class Dictionary {
+        std::vector<ubyte> data;
+        /// @brief Hash chains heads of dictionary positions + 1
+        std::unique_ptr<uint32_t[]> heads;
+        /// @brief Previous position + 1 in the hash chain of each position
+        std::unique_ptr<uint32_t[]> chains;
+
+        friend size_t encode(
+            const ubyte*, size_t, ubyte*, const Dictionary*
+        );
+    public:
+        Dictionary() = default;
+        explicit Dictionary(std::vector<ubyte> data);
+
+        util::span<const ubyte> getData() const {
+            return {data.data(), data.size()};
+        }
+
+        bool empty() const {
+            return data.empty();
+        }
+    };
+
+    /// @brief Decompress bytes array
+    /// @param src compressed data
+    /// @param length compressed data length
+    /// @param dst destination buffer
+    /// @param dstlen destination buffer capacity
+    /// @param dictionary the same dictionary used to compress data
+    /// @return decompressed data length
+    /// @throws std::runtime_error if data is malformed or does not fit dst
+    size_t decode(
+        const ubyte* src,
+        size_t length,
+        ubyte* dst,
+        size_t dstlen,
+        util::span<const ubyte> dictionary = {}
+    );
+
+    /// @brief Build dictionary of the most common segments of samples.
+    /// Most valuable segments are placed closer to the end
+    /// @param samples training data, typically uncompressed chunks data
+    /// @param capacity max dictionary length
+    /// @return dictionary (empty if samples are empty)
+    std::vector<ubyte> train_dictionary(
+        const std::vector<util::span<const ubyte>>& samples, size_t capacity
+    );
+}
@@ -97,17 +97,18 @@ struct ContentPackStats {
     }
 };
 
+/// @brief World script events handles (0 if the function is not defined)
 struct WorldFuncsSet {
-    bool onblockplaced;
-    bool onblockreplaced;
-    bool onblockbreaking;
-    bool onblockbroken;
-    bool onblockinteract;
-    bool onplayertick;
-    bool onchunkpresent;
-    bool onchunkremove;
-    bool oninventoryopen;
-    bool oninventoryclosed;
+    eventhandle_t onblockplaced;
+    eventhandle_t onblockreplaced;
+    eventhandle_t onblockbreaking;
+    eventhandle_t onblockbroken;
+    eventhandle_t onblockinteract;
+    eventhandle_t onplayertick;
+    eventhandle_t onchunkpresent;
+    eventhandle_t onchunkremove;
+    eventhandle_t oninventoryopen;
+    eventhandle_t oninventoryclosed;
 };
 
 class ContentPackRuntime {
@@ -0,0 +1,162 @@
+#include "Profiler.hpp"
+
+#include <algorithm>
+#include <sstream>
+
+#include "Logger.hpp"
+
+using namespace debug::profiler;
+using std::chrono::duration_cast;
+using std::chrono::microseconds;
+
+static debug::Logger logger("profiler");
+
+static const char* SECTION_NAMES[SECTIONS_COUNT] {
+    "tick",
+    "chunks",
+    "lighting",
+    "random-ticks",
+    "blocks-tick",
+    "world-tick",
+    "physics",
+    "entities-update",
+    "player-tick",
+    "saving",
+};
+
+struct TraceEvent {
+    Section section;
+    /// @brief Start time since the trace start (microseconds)
+    int64_t start;
+    int64_t duration;
+};
+
+static int64_t current[SECTIONS_COUNT] {};
+static int64_t histories[SECTIONS_COUNT][HISTORY_SIZE] {};
+/// @brief Index of the next frame in histories
+static size_t cursor = 0;
+/// @brief Number of frames stored in histories
+static size_t frames = 0;
+
+static int64_t counters[COUNTERS_COUNT] {};
+
+static bool tracing = false;
+static clock::time_point traceStart;
+static std::vector<TraceEvent> traceEvents;
+static size_t traceMaxEvents = 0;
+static size_t traceDropped = 0;
+
+void debug::profiler::add(
+    Section section, clock::time_point start, clock::time_point end
+) {
+    int64_t duration = duration_cast<microseconds>(end - start).count();
+    current[static_cast<size_t>(section)] += duration;
+    if (!tracing) {
+        return;
+    }
+    if (traceEvents.size() >= traceMaxEvents) {
+        traceDropped++;
+        return;
+    }
+    traceEvents.push_back(TraceEvent {
+        section,
+        duration_cast<microseconds>(start - traceStart).count(),
+        duration});
+}
+
+void debug::profiler::next_frame() {
+    for (size_t i = 0; i < SECTIONS_COUNT; i++) {
+        histories[i][cursor] = current[i];
+        current[i] = 0;
+    }
+    cursor = (cursor + 1) % HISTORY_SIZE;
+    frames = std::min(frames + 1, HISTORY_SIZE);
+}
+
+void debug::profiler::increment(Counter counter, int64_t value) {
+    counters[static_cast<size_t>(counter)] += value;
+}
+
+int64_t debug::profiler::get_counter(Counter counter) {
+    return counters[static_cast<size_t>(counter)];
+}
+
+std::string_view debug::profiler::get_name(Section section) {
+    return SECTION_NAMES[static_cast<size_t>(section)];
+}
+
+bool debug::profiler::get_section(std::string_view name, Section& dst) {
+    for (size_t i = 0; i < SECTIONS_COUNT; i++) {
+        if (name == SECTION_NAMES[i]) {
+            dst = static_cast<Section>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+std::vector<int64_t> debug::profiler::get_history(Section section) {
+    const auto& history = histories[static_cast<size_t>(section)];
+    std::vector<int64_t> values;
+    values.reserve(frames);
+    size_t first = (cursor + HISTORY_SIZE - frames) % HISTORY_SIZE;
+    for (size_t i = 0; i < frames; i++) {
+        values.push_back(history[(first + i) % HISTORY_SIZE]);
+    }
+    return values;
+}
+
+Stats debug::profiler::get_stats(Section section) {
+    if (frames == 0) {
+        return Stats {0, 0, 0};
+    }
+    const auto& history = histories[static_cast<size_t>(section)];
+    int64_t sum = 0;
+    int64_t max = 0;
+    for (size_t i = 0; i < frames; i++) {
+        sum += history[i];
+        max = std::max(max, history[i]);
+    }
+    int64_t last = history[(cursor + HISTORY_SIZE - 1) % HISTORY_SIZE];
+    return Stats {last, sum / static_cast<int64_t>(frames), max};
+}
+
+void debug::profiler::start_trace(size_t maxEvents) {
+    traceEvents.clear();
+    traceEvents.reserve(std::min<size_t>(maxEvents, 1024));
+    traceMaxEvents = maxEvents;
+    traceDropped = 0;
+    traceStart = clock::now();
+    tracing = true;
+    logger.info() << "trace started";
+}
+
+bool debug::profiler::is_tracing() {
+    return tracing;
+}
+
+std::string debug::profiler::stop_trace() {
+    if (tracing) {
+        logger.info() << "trace stopped (" << traceEvents.size()
+                      << " events, " << traceDropped << " dropped)";
+    }
+    tracing = false;
+
+    std::stringstream ss;
+    ss << "{\"traceEvents\":[";
+    for (size_t i = 0; i < traceEvents.size(); i++) {
+        const auto& event = traceEvents[i];
+        if (i) {
+            ss << ",";
+        }
+        ss << "\n{\"name\":\"" << get_name(event.section)
+           << "\",\"cat\":\"tick\",\"ph\":\"X\",\"ts\":" << event.start
+           << ",\"dur\":" << event.duration << ",\"pid\":1,\"tid\":1}";
+    }
+    ss << "\n],\"displayTimeUnit\":\"ms\",\"otherData\":{\"dropped\":"
+       << traceDropped << "}}";
+
+    traceEvents.clear();
+    traceEvents.shrink_to_fit();
+    return ss.str();
+}
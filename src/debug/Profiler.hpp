@@ -0,0 +1,109 @@
+#pragma once
+
+#include <chrono>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "typedefs.hpp"
+
+/// @brief Lightweight profiler of level tick phases.
+/// Sections time is accumulated per frame (LevelController::update call)
+/// and kept in fixed-size histories. Nested sections time is inclusive.
+/// Must be used from the main thread only
+namespace debug::profiler {
+    enum class Section {
+        TICK,
+        CHUNKS,
+        LIGHTING,
+        RANDOM_TICKS,
+        BLOCKS_TICK,
+        WORLD_TICK,
+        PHYSICS,
+        ENTITIES_UPDATE,
+        PLAYER_TICK,
+        SAVING,
+        COUNT
+    };
+
+    inline constexpr size_t SECTIONS_COUNT =
+        static_cast<size_t>(Section::COUNT);
+
+    /// @brief Cumulative events counters
+    enum class Counter {
+        CHUNKS_LOADED,
+        CHUNKS_GENERATED,
+        COUNT
+    };
+
+    inline constexpr size_t COUNTERS_COUNT =
+        static_cast<size_t>(Counter::COUNT);
+
+    /// @brief Number of frames stored in a section history
+    inline constexpr size_t HISTORY_SIZE = 128;
+    inline constexpr size_t DEFAULT_MAX_TRACE_EVENTS = 100'000;
+
+    using clock = std::chrono::steady_clock;
+
+    struct Stats {
+        /// @brief Last finished frame time (microseconds)
+        int64_t last;
+        /// @brief Average time over the history (microseconds)
+        int64_t average;
+        /// @brief Max time over the history (microseconds)
+        int64_t max;
+    };
+
+    /// @brief Add section time to the current frame
+    void add(Section section, clock::time_point start, clock::time_point end);
+
+    /// @brief Finish the current frame and push sections time to histories
+    void next_frame();
+
+    void increment(Counter counter, int64_t value = 1);
+
+    /// @brief Get counter value accumulated since the engine start
+    int64_t get_counter(Counter counter);
+
+    std::string_view get_name(Section section);
+
+    /// @return false if no section found
+    bool get_section(std::string_view name, Section& dst);
+
+    /// @brief Get section history, oldest frames first (microseconds)
+    std::vector<int64_t> get_history(Section section);
+
+    Stats get_stats(Section section);
+
+    /// @brief Start recording sections to a trace.
+    /// Events exceeding maxEvents are dropped
+    void start_trace(size_t maxEvents = DEFAULT_MAX_TRACE_EVENTS);
+
+    bool is_tracing();
+
+    /// @brief Stop recording trace
+    /// @return trace in Chrome Trace Event JSON format
+    /// (chrome://tracing, Perfetto)
+    std::string stop_trace();
+
+    /// @brief Measures scope time
+    /// @example:
+    ///     {
+    ///         debug::profiler::ScopedTimer timer(Section::PHYSICS);
+    ///         ...
+    ///     }
+    class ScopedTimer {
+        Section section;
+        clock::time_point start;
+    public:
+        ScopedTimer(Section section)
+            : section(section), start(clock::now()) {
+        }
+
+        ScopedTimer(const ScopedTimer&) = delete;
+
+        ~ScopedTimer() {
+            add(section, start, clock::now());
+        }
+    };
+}
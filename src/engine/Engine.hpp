@@ -50,6 +50,10 @@ struct CoreParameters {
     std::filesystem::path userFolder = ".";
     std::filesystem::path scriptFile;
     std::filesystem::path projectFolder;
+    /// @brief Chrome trace output file of headless run ticks
+    std::filesystem::path traceFile;
+    /// @brief Ticks statistics report output file of headless run
+    std::filesystem::path reportFile;
 };
 
 using OnWorldOpen = std::function<void(std::unique_ptr<Level>, int64_t)>;
@@ -1,15 +1,20 @@
 #include "ServerMainloop.hpp"
 
 #include "Engine.hpp"
+#include "TickStats.hpp"
+#include "coders/json.hpp"
 #include "logic/scripting/scripting.hpp"
 #include "logic/LevelController.hpp"
 #include "interfaces/Process.hpp"
+#include "objects/Entities.hpp"
 #include "debug/Logger.hpp"
+#include "debug/Profiler.hpp"
 #include "world/Level.hpp"
 #include "world/World.hpp"
 #include "util/platform.hpp"
 
 #include <chrono>
+#include <fstream>
 
 using namespace std::chrono;
 
@@ -44,6 +49,11 @@ void ServerMainloop::run() {
     auto begin = system_clock::now();
     auto startupTime = begin;
 
+    if (!coreParams.traceFile.empty()) {
+        debug::profiler::start_trace();
+    }
+    TickStats stats;
+
     while (process->isActive()) {
         if (engine.isQuitSignal()) {
             process->terminate();
@@ -60,8 +70,15 @@ void ServerMainloop::run() {
         }
         process->update();
         if (controller) {
-            controller->getLevel()->getWorld()->updateTimers(delta);
+            auto tickStart = steady_clock::now();
+            auto level = controller->getLevel();
+            level->getWorld()->updateTimers(delta);
             controller->update(glm::min(delta, 0.2), false);
+            stats.addTick(
+                duration_cast<microseconds>(steady_clock::now() - tickStart)
+                    .count(),
+                level->entities->size()
+            );
         }
         engine.postUpdate();
 
@@ -76,6 +93,19 @@ void ServerMainloop::run() {
         }
     }
     logger.info() << "script finished";
+
+    if (!coreParams.traceFile.empty()) {
+        std::ofstream file(coreParams.traceFile);
+        file << debug::profiler::stop_trace();
+        logger.info() << "trace written to " << coreParams.traceFile.u8string();
+    }
+    if (!coreParams.reportFile.empty()) {
+        std::ofstream file(coreParams.reportFile);
+        file << json::stringify(stats.createReport(), true);
+        logger.info() << "report of " << stats.getTicksCount()
+                      << " ticks written to "
+                      << coreParams.reportFile.u8string();
+    }
 }
 
 void ServerMainloop::setLevel(std::unique_ptr<Level> level) {
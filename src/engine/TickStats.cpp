@@ -0,0 +1,72 @@
+#include "TickStats.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "debug/Profiler.hpp"
+#include "util/platform.hpp"
+
+using debug::profiler::Counter;
+
+static int64_t percentile_of(
+    const std::vector<int64_t>& sorted, double percentile
+) {
+    if (sorted.empty()) {
+        return 0;
+    }
+    auto rank = static_cast<size_t>(
+        std::ceil(percentile / 100.0 * sorted.size())
+    );
+    return sorted[std::clamp<size_t>(rank, 1, sorted.size()) - 1];
+}
+
+TickStats::TickStats()
+    : startTime(clock::now()),
+      chunksLoaded(debug::profiler::get_counter(Counter::CHUNKS_LOADED)),
+      chunksGenerated(debug::profiler::get_counter(Counter::CHUNKS_GENERATED)) {
+}
+
+void TickStats::addTick(int64_t time, size_t entities) {
+    tickTimes.push_back(time);
+    maxEntities = std::max(maxEntities, entities);
+}
+
+int64_t TickStats::getPercentile(double percentile) const {
+    auto sorted = tickTimes;
+    std::sort(sorted.begin(), sorted.end());
+    return percentile_of(sorted, percentile);
+}
+
+dv::value TickStats::createReport() const {
+    double duration =
+        std::chrono::duration<double>(clock::now() - startTime).count();
+    auto sorted = tickTimes;
+    std::sort(sorted.begin(), sorted.end());
+    int64_t total = 0;
+    for (int64_t time : sorted) {
+        total += time;
+    }
+    int64_t loaded =
+        debug::profiler::get_counter(Counter::CHUNKS_LOADED) - chunksLoaded;
+    int64_t generated =
+        debug::profiler::get_counter(Counter::CHUNKS_GENERATED) -
+        chunksGenerated;
+
+    auto report = dv::object();
+    report["ticks"] = static_cast<int64_t>(sorted.size());
+    report["duration_s"] = duration;
+    report["tick_mean_ms"] =
+        sorted.empty() ? 0.0 : total / 1000.0 / sorted.size();
+    report["tick_p50_ms"] = percentile_of(sorted, 50) / 1000.0;
+    report["tick_p99_ms"] = percentile_of(sorted, 99) / 1000.0;
+    report["tick_max_ms"] = sorted.empty() ? 0.0 : sorted.back() / 1000.0;
+    report["chunks_loaded"] = loaded;
+    report["chunks_loaded_per_second"] = duration > 0 ? loaded / duration : 0.0;
+    report["chunks_generated"] = generated;
+    report["chunks_generated_per_second"] =
+        duration > 0 ? generated / duration : 0.0;
+    report["entities_max"] = static_cast<int64_t>(maxEntities);
+    report["rss_peak_mb"] =
+        platform::get_peak_memory_usage() / (1024.0 * 1024.0);
+    return report;
+}
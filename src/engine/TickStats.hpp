@@ -0,0 +1,39 @@
+#pragma once
+
+#include <chrono>
+#include <vector>
+
+#include "data/dv.hpp"
+
+/// @brief Level ticks statistics of a headless run used as a load test
+/// report
+class TickStats {
+    using clock = std::chrono::steady_clock;
+
+    clock::time_point startTime;
+    /// @brief Ticks wall time (microseconds)
+    std::vector<int64_t> tickTimes;
+    size_t maxEntities = 0;
+    /// @brief Counters values at the start
+    int64_t chunksLoaded;
+    int64_t chunksGenerated;
+public:
+    TickStats();
+
+    /// @param time tick wall time (microseconds)
+    /// @param entities number of entities after the tick
+    void addTick(int64_t time, size_t entities);
+
+    size_t getTicksCount() const {
+        return tickTimes.size();
+    }
+
+    /// @brief Get tick time percentile using nearest-rank method
+    /// @param percentile percentile in range [0, 100]
+    int64_t getPercentile(double percentile) const;
+
+    /// @brief Build flat report object: tick time percentiles (ms),
+    /// chunks load and generation rates, max entities count and peak
+    /// resident memory
+    dv::value createReport() const;
+};
@@ -22,6 +22,21 @@ ContentGfxCache::ContentGfxCache(
     refresh();
 }
 
+/// @param regions block sides uv regions
+static bool is_greedy(const Block& def, const UVRegion* regions) {
+    if (def.model.type != BlockModelType::BLOCK || def.translucent ||
+        def.rotatable) {
+        return false;
+    }
+    for (int side = 0; side < 6; side++) {
+        const auto& region = regions[side];
+        if (region.u2 <= region.u1 || region.v2 <= region.v1) {
+            return false;
+        }
+    }
+    return true;
+}
+
 void ContentGfxCache::refresh(const Block& def, const Atlas& atlas) {
     for (uint side = 0; side < 6; side++) {
         std::string tex = def.textureFaces[side];
@@ -35,6 +50,7 @@ void ContentGfxCache::refresh(const Block& def, const Atlas& atlas) {
             sideregions[def.rt.id * 6 + side] = atlas.get(TEXTURE_NOTFOUND);
         }
     }
+    greedyBlocks[def.rt.id] = is_greedy(def, &sideregions[def.rt.id * 6]);
     if (def.model.type == BlockModelType::CUSTOM) {
         auto model = assets.require<model::Model>(def.model.name);
         // temporary dirty fix tbh
@@ -58,6 +74,7 @@ void ContentGfxCache::refresh(const Block& def, const Atlas& atlas) {
 void ContentGfxCache::refresh() {
     auto indices = content.getIndices();
     sideregions = std::make_unique<UVRegion[]>(indices->blocks.count() * 6);
+    greedyBlocks = std::make_unique<bool[]>(indices->blocks.count());
     const auto& atlas = assets.require<Atlas>("blocks");
 
     const auto& blocks = indices->blocks.getIterable();
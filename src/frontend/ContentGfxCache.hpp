@@ -23,6 +23,8 @@ class ContentGfxCache {
 
     // array of block sides uv regions (6 per block)
     std::unique_ptr<UVRegion[]> sideregions;
+    /// @brief Greedy meshing flags of blocks
+    std::unique_ptr<bool[]> greedyBlocks;
     std::unordered_map<blockid_t, model::Model> models;
 public:
     ContentGfxCache(
@@ -36,6 +38,11 @@ public:
         return sideregions[id * 6 + side];
     }
 
+    /// @brief Check if block faces may be merged by greedy meshing
+    inline bool isGreedy(blockid_t id) const {
+        return greedyBlocks[id];
+    }
+
     const model::Model& getModel(blockid_t id) const;
 
     void refresh(const Block& block, const Atlas& atlas);
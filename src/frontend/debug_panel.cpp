@@ -4,6 +4,7 @@
 #include "settings.hpp"
 #include "hud.hpp"
 #include "content/Content.hpp"
+#include "debug/Profiler.hpp"
 #include "graphics/core/Mesh.hpp"
 #include "graphics/ui/elements/CheckBox.hpp"
 #include "graphics/ui/elements/TextBox.hpp"
@@ -108,6 +109,16 @@ std::shared_ptr<UINode> create_debug_panel(
         return L"lua-stack: " + std::to_wstring(scripting::get_values_on_stack());
     }));
     panel->add(create_label(gui, []() { return netSpeedString; }));
+    // tick sections time: average / max over the profiler history
+    for (size_t i = 0; i < debug::profiler::SECTIONS_COUNT; i++) {
+        auto section = static_cast<debug::profiler::Section>(i);
+        auto name = util::str2wstr_utf8(debug::profiler::get_name(section));
+        panel->add(create_label(gui, [=]() {
+            auto stats = debug::profiler::get_stats(section);
+            return name + L": " + util::to_wstring(stats.average / 1000.0, 2) +
+                   L" / " + util::to_wstring(stats.max / 1000.0, 2) + L" ms";
+        }));
+    }
     panel->add(create_label(gui, [&engine]() {
         auto& settings = engine.getSettings();
         bool culling = settings.graphics.frustumCulling.get();
@@ -268,9 +268,9 @@ void Hud::updateHotbarControl() {
 void Hud::updateWorldGenDebug() {
     auto& level = frontend.getLevel();
     const auto& chunks = *player.chunks;
-    auto generator =
-        frontend.getController()->getChunksController()->getGenerator();
-    auto debugInfo = generator->createDebugInfo();
+    auto debugInfo = frontend.getController()
+                         ->getChunksController()
+                         ->createGeneratorDebugInfo();
     
     int width = debugImgWorldGen->getWidth();
     int height = debugImgWorldGen->getHeight();
@@ -334,7 +334,7 @@ void Hud::update(bool visible) {
     }
 
     if (blockUI) {
-        voxel* vox = chunks.get(blockPos.x, blockPos.y, blockPos.z);
+        const voxel* vox = chunks.get(blockPos.x, blockPos.y, blockPos.z);
         if (vox == nullptr || vox->id != currentblockid) {
             closeInventory();
         }
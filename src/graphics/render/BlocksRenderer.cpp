@@ -27,29 +27,37 @@ BlocksRenderer::BlocksRenderer(
     cache(cache),
     settings(settings)
 {
-    voxelsBuffer = std::make_unique<VoxelsVolume>(
-        CHUNK_W + voxelBufferPadding*2,
-        CHUNK_H,
-        CHUNK_D + voxelBufferPadding*2);
     blockDefsCache = content.getIndices()->blocks.getDefs();
 }
 
 BlocksRenderer::~BlocksRenderer() {
 }
 
+/// @brief Move voxel index to the last voxel of the section if all
+/// section blocks are air
+/// @return true if the section is skipped
+static inline bool skip_empty_section(const ChunkSnapshot& snapshot, int& i) {
+    int section = i / CHUNK_SECTION_VOL;
+    if (snapshot.isSectionOccupied(section)) {
+        return false;
+    }
+    i = (section + 1) * CHUNK_SECTION_VOL - 1;
+    return true;
+}
+
+static inline ChunkVertex::Light to_color(const glm::vec4& light) {
+    return ChunkVertex::packLight(light);
+}
+
 /// Basic vertex add method
 void BlocksRenderer::vertex(
     const glm::vec3& coord, float u, float v, const glm::vec4& light
 ) {
-
-    vertexBuffer[vertexCount].position = coord;
-
-    vertexBuffer[vertexCount].uv = {u,v};
-
-    vertexBuffer[vertexCount].color[0] = static_cast<uint8_t>(light.r * 255);
-    vertexBuffer[vertexCount].color[1] = static_cast<uint8_t>(light.g * 255);
-    vertexBuffer[vertexCount].color[2] = static_cast<uint8_t>(light.b * 255);
-    vertexBuffer[vertexCount].color[3] = static_cast<uint8_t>(light.a * 255);
+    auto& vertex = vertexBuffer[vertexCount];
+    vertex.setPosition(coord);
+    vertex.uv = {ChunkVertex::packUV(u), ChunkVertex::packUV(v)};
+    vertex.light = to_color(light);
+    vertex.tiling = {};
     vertexCount++;
 }
 
@@ -170,6 +178,98 @@ void BlocksRenderer::face(
     index(0, 1, 2, 0, 2, 3);
 }
 
+void BlocksRenderer::faceGreedy(
+    const glm::vec3& coord,
+    const glm::vec3& X,
+    const glm::vec3& Y,
+    const glm::vec3& Z,
+    int w, int h,
+    const UVRegion& region,
+    const Color(&colors)[4]
+) {
+    if (vertexCount + 4 >= capacity) {
+        overflow = true;
+        return;
+    }
+    // single face is written the same way as by face and faceAO
+    float u1 = region.u1, v1 = region.v1;
+    float u2 = region.u2, v2 = region.v2;
+    std::array<uint16_t, 2> tiling {};
+    if (w > 1 || h > 1) {
+        // shader repeats region starting from uv along face axes
+        u2 = u1;
+        v2 = v1;
+        tiling = {
+            ChunkVertex::packUV(region.getWidth()),
+            ChunkVertex::packUV(region.getHeight())};
+    }
+    const glm::vec3 sizeX = X * static_cast<float>(w);
+    const glm::vec3 sizeY = Y * static_cast<float>(h);
+    const glm::vec3 positions[4] {
+        coord + (-sizeX - sizeY + Z) * 0.5f,
+        coord + ( sizeX - sizeY + Z) * 0.5f,
+        coord + ( sizeX + sizeY + Z) * 0.5f,
+        coord + (-sizeX + sizeY + Z) * 0.5f,
+    };
+    const glm::vec2 uvs[4] {{u1, v1}, {u2, v1}, {u2, v2}, {u1, v2}};
+    for (int i = 0; i < 4; i++) {
+        auto& vertex = vertexBuffer[vertexCount++];
+        vertex.setPosition(positions[i]);
+        vertex.uv = {
+            ChunkVertex::packUV(uvs[i].x), ChunkVertex::packUV(uvs[i].y)};
+        vertex.light = colors[i];
+        vertex.tiling = tiling;
+    }
+    index(0, 1, 2, 0, 2, 3);
+}
+
+void BlocksRenderer::faceColors(
+    const glm::ivec3& icoord,
+    const glm::ivec3& iX,
+    const glm::ivec3& iY,
+    const glm::ivec3& iZ,
+    bool lights,
+    bool ao,
+    Color(&colors)[4]
+) const {
+    glm::vec3 coord(icoord);
+    glm::vec3 X(iX);
+    glm::vec3 Y(iY);
+    glm::vec3 Z(iZ);
+
+    float d = glm::dot(glm::normalize(Z), SUN_VECTOR);
+    d = (1.0f - DIRECTIONAL_LIGHT_FACTOR) + d * DIRECTIONAL_LIGHT_FACTOR;
+    if (!ao) {
+        auto tint = pickLight(icoord + iZ);
+        if (lights) {
+            tint *= d;
+        }
+        colors[0] = colors[1] = colors[2] = colors[3] = to_color(tint);
+        return;
+    }
+    if (!lights) {
+        colors[0] = colors[1] = colors[2] = colors[3] = to_color(glm::vec4(1.0f));
+        return;
+    }
+    glm::vec4 tint(d);
+    float s = 0.5f;
+    const glm::vec3 corners[4] {
+        coord + (-X - Y + Z) * s,
+        coord + ( X - Y + Z) * s,
+        coord + ( X + Y + Z) * s,
+        coord + (-X + Y + Z) * s,
+    };
+    for (int i = 0; i < 4; i++) {
+        auto pos = corners[i] + Z * 0.5f + (X + Y) * 0.5f;
+        auto light = pickSoftLight(
+            glm::ivec3(std::round(pos.x), std::round(pos.y), std::round(pos.z)),
+            iX,
+            iY
+        );
+        colors[i] = to_color(light * tint);
+    }
+}
+
 void BlocksRenderer::blockXSprite(
     int x, int y, int z,
     const glm::vec3& size,
@@ -408,9 +508,9 @@ void BlocksRenderer::blockCube(
 }
 
 bool BlocksRenderer::isOpenForLight(int x, int y, int z) const {
-    blockid_t id = voxelsBuffer->pickBlockId(chunk->x * CHUNK_W + x,
+    blockid_t id = voxelsBuffer->pickBlockId(snapshot->x * CHUNK_W + x,
                                              y,
-                                             chunk->z * CHUNK_D + z);
+                                             snapshot->z * CHUNK_D + z);
     if (id == BLOCK_VOID) {
         return false;
     }
@@ -423,8 +523,8 @@ bool BlocksRenderer::isOpenForLight(int x, int y, int z) const {
 
 glm::vec4 BlocksRenderer::pickLight(int x, int y, int z) const {
     if (isOpenForLight(x, y, z)) {
-        light_t light = voxelsBuffer->pickLight(chunk->x * CHUNK_W + x, y,
-                                                chunk->z * CHUNK_D + z);
+        light_t light = voxelsBuffer->pickLight(snapshot->x * CHUNK_W + x, y,
+                                                snapshot->z * CHUNK_D + z);
         return glm::vec4(Lightmap::extract(light, 0),
                          Lightmap::extract(light, 1),
                          Lightmap::extract(light, 2),
@@ -457,9 +557,7 @@ glm::vec4 BlocksRenderer::pickSoftLight(
         right, up);
 }
 
-void BlocksRenderer::render(
-    const voxel* voxels, int beginEnds[256][2]
-) {
+void BlocksRenderer::render(int beginEnds[256][2]) {
     for (const auto drawGroup : *content.drawGroups) {
         int begin = beginEnds[drawGroup][0];
         if (begin == 0) {
@@ -467,14 +565,20 @@ void BlocksRenderer::render(
         }
         int end = beginEnds[drawGroup][1];
         for (int i = begin-1; i <= end; i++) {
-            const voxel& vox = voxels[i];
+            if (skip_empty_section(*snapshot, i)) {
+                continue;
+            }
+            int x = i % CHUNK_W;
+            int y = i / (CHUNK_D * CHUNK_W);
+            int z = (i / CHUNK_D) % CHUNK_W;
+            const voxel& vox = snapshot->getVoxel(x, y, z);
             blockid_t id = vox.id;
             blockstate state = vox.state;
             const auto& def = *blockDefsCache[id];
             if (id == 0 || def.drawGroup != drawGroup || state.segment) {
                 continue;
             }
-            if (def.translucent) {
+            if (def.translucent || (greedy && cache.isGreedy(id))) {
                 continue;
             }
             const UVRegion texfaces[6] {
@@ -482,9 +586,6 @@ void BlocksRenderer::render(
                 cache.getRegion(id, 2), cache.getRegion(id, 3),
                 cache.getRegion(id, 4), cache.getRegion(id, 5)
             };
-            int x = i % CHUNK_W;
-            int y = i / (CHUNK_D * CHUNK_W);
-            int z = (i / CHUNK_D) % CHUNK_W;
             switch (def.model.type) {
                 case BlockModelType::BLOCK:
                     blockCube({x, y, z}, texfaces, def, vox.state, !def.shadeless,
@@ -515,9 +616,143 @@ void BlocksRenderer::render(
     }
 }
 
-SortingMeshData BlocksRenderer::renderTranslucent(
-    const voxel* voxels, int beginEnds[256][2]
-) {
+namespace {
+    /// @brief Cube face axes as used by blockCube with no rotation
+    struct GreedyFace {
+        glm::ivec3 X;
+        glm::ivec3 Y;
+        glm::ivec3 Z;
+        int texface;
+    };
+}
+
+static const GreedyFace GREEDY_FACES[6] {
+    {{1, 0, 0}, {0, 1, 0}, {0, 0, 1}, 5},
+    {{-1, 0, 0}, {0, 1, 0}, {0, 0, -1}, 4},
+    {{1, 0, 0}, {0, 0, -1}, {0, 1, 0}, 3},
+    {{1, 0, 0}, {0, 0, 1}, {0, -1, 0}, 2},
+    {{0, 0, -1}, {0, 1, 0}, {1, 0, 0}, 1},
+    {{0, 0, 1}, {0, 1, 0}, {-1, 0, 0}, 0},
+};
+
+static int axis_index(const glm::ivec3& v) {
+    return v.x ? 0 : (v.y ? 1 : 2);
+}
+
+void BlocksRenderer::renderGreedy() {
+    const int mins[3] {0, snapshot->bottom, 0};
+    const int maxs[3] {CHUNK_W, snapshot->top, CHUNK_D};
+
+    for (const auto& dir : GREEDY_FACES) {
+        int ax = axis_index(dir.Z);
+        int au = axis_index(dir.X);
+        int av = axis_index(dir.Y);
+        int nu = maxs[au] - mins[au];
+        int nv = maxs[av] - mins[av];
+        if (nu <= 0 || nv <= 0) {
+            continue;
+        }
+        greedyMask.resize(nu * nv);
+
+        for (int layer = mins[ax]; layer < maxs[ax]; layer++) {
+            // horizontal layers of empty sections have no faces
+            if (ax == 1 &&
+                !snapshot->isSectionOccupied(layer / CHUNK_SECTION_H)) {
+                continue;
+            }
+            // collect visible faces of the layer
+            for (int v = 0; v < nv; v++) {
+                for (int u = 0; u < nu; u++) {
+                    auto& cell = greedyMask[v * nu + u];
+                    cell.id = 0;
+
+                    glm::ivec3 coord;
+                    coord[ax] = layer;
+                    coord[au] = mins[au] + u;
+                    coord[av] = mins[av] + v;
+                    const auto& vox = snapshot->getVoxel(coord.x, coord.y, coord.z);
+                    if (vox.id == 0 || vox.state.segment) {
+                        continue;
+                    }
+                    if (!cache.isGreedy(vox.id)) {
+                        continue;
+                    }
+                    const auto& def = *blockDefsCache[vox.id];
+                    if (!isOpen(coord + dir.Z, def)) {
+                        continue;
+                    }
+                    Color colors[4];
+                    faceColors(
+                        coord, dir.X, dir.Y, dir.Z,
+                        !def.shadeless, def.ambientOcclusion, colors
+                    );
+                    if (colors[0] == colors[1] && colors[0] == colors[2] &&
+                        colors[0] == colors[3]) {
+                        cell = {vox.id, colors[0]};
+                        continue;
+                    }
+                    // faces with smooth lighting gradient can't be merged
+                    faceGreedy(
+                        coord, dir.X, dir.Y, dir.Z, 1, 1,
+                        cache.getRegion(vox.id, dir.texface), colors
+                    );
+                    if (overflow) {
+                        return;
+                    }
+                }
+            }
+            // merge equal faces into rectangles
+            for (int v = 0; v < nv; v++) {
+                for (int u = 0; u < nu;) {
+                    const auto cell = greedyMask[v * nu + u];
+                    if (cell.id == 0) {
+                        u++;
+                        continue;
+                    }
+                    int w = 1;
+                    while (u + w < nu && greedyMask[v * nu + u + w] == cell) {
+                        w++;
+                    }
+                    int h = 1;
+                    for (; v + h < nv; h++) {
+                        bool equal = true;
+                        for (int i = 0; i < w; i++) {
+                            if (!(greedyMask[(v + h) * nu + u + i] == cell)) {
+                                equal = false;
+                                break;
+                            }
+                        }
+                        if (!equal) {
+                            break;
+                        }
+                    }
+                    for (int j = 0; j < h; j++) {
+                        for (int i = 0; i < w; i++) {
+                            greedyMask[(v + j) * nu + u + i].id = 0;
+                        }
+                    }
+                    glm::vec3 center;
+                    center[ax] = layer;
+                    center[au] = mins[au] + u + (w - 1) * 0.5f;
+                    center[av] = mins[av] + v + (h - 1) * 0.5f;
+                    const Color colors[4] {
+                        cell.color, cell.color, cell.color, cell.color
+                    };
+                    faceGreedy(
+                        center, dir.X, dir.Y, dir.Z, w, h,
+                        cache.getRegion(cell.id, dir.texface), colors
+                    );
+                    if (overflow) {
+                        return;
+                    }
+                    u += w;
+                }
+            }
+        }
+    }
+}
+
+SortingMeshData BlocksRenderer::renderTranslucent(int beginEnds[256][2]) {
     SortingMeshData sortingMesh {{}};
 
     AABB aabb {};
@@ -530,7 +765,13 @@ SortingMeshData BlocksRenderer::renderTranslucent(
         }
         int end = beginEnds[drawGroup][1];
         for (int i = begin-1; i <= end; i++) {
-            const voxel& vox = voxels[i];
+            if (skip_empty_section(*snapshot, i)) {
+                continue;
+            }
+            int x = i % CHUNK_W;
+            int y = i / (CHUNK_D * CHUNK_W);
+            int z = (i / CHUNK_D) % CHUNK_W;
+            const voxel& vox = snapshot->getVoxel(x, y, z);
             blockid_t id = vox.id;
             blockstate state = vox.state;
             const auto& def = *blockDefsCache[id];
@@ -545,9 +786,6 @@ SortingMeshData BlocksRenderer::renderTranslucent(
                 cache.getRegion(id, 2), cache.getRegion(id, 3),
                 cache.getRegion(id, 4), cache.getRegion(id, 5)
             };
-            int x = i % CHUNK_W;
-            int y = i / (CHUNK_D * CHUNK_W);
-            int z = (i / CHUNK_D) % CHUNK_W;
             switch (def.model.type) {
                 case BlockModelType::BLOCK:
                     blockCube({x, y, z}, texfaces, def, vox.state, !def.shadeless,
@@ -576,9 +814,9 @@ SortingMeshData BlocksRenderer::renderTranslucent(
             }
             SortingMeshEntry entry {
                 glm::vec3(
-                    x + chunk->x * CHUNK_W + 0.5f,
+                    x + snapshot->x * CHUNK_W + 0.5f,
                     y + 0.5f,
-                    z + chunk->z * CHUNK_D + 0.5f
+                    z + snapshot->z * CHUNK_D + 0.5f
                 ),
                 util::Buffer<ChunkVertex>(indexCount), 0};
 
@@ -590,18 +828,14 @@ SortingMeshData BlocksRenderer::renderTranslucent(
                     vertexBuffer.get() + indexBuffer[j],
                     sizeof(ChunkVertex)
                 );
-                ChunkVertex& vertex = entry.vertexData[j];
-
+                // vertices are kept chunk-local to fit the packed format
+                auto position = entry.vertexData[j].getPosition();
                 if (!aabbInit) {
                     aabbInit = true;
-                    aabb.a = aabb.b = vertex.position;
+                    aabb.a = aabb.b = position;
                 } else {
-                    aabb.addPoint(vertex.position);
+                    aabb.addPoint(position);
                 }
-
-                vertex.position.x += chunk->x * CHUNK_W + 0.5f;
-                vertex.position.y += 0.5f;
-                vertex.position.z += chunk->z * CHUNK_D + 0.5f;
             }
             sortingMesh.entries.push_back(std::move(entry));
             vertexCount = 0;
@@ -632,27 +866,40 @@ SortingMeshData BlocksRenderer::renderTranslucent(
     return sortingMesh;
 }
 
+std::shared_ptr<ChunkSnapshot> BlocksRenderer::createSnapshot(
+    const Chunk& chunk, const Chunks& chunks
+) const {
+    return chunks.createSnapshot(
+        chunk, voxelBufferPadding, settings.graphics.backlight.get()
+    );
+}
+
 void BlocksRenderer::build(const Chunk* chunk, const Chunks* chunks) {
-    this->chunk = chunk;
-    voxelsBuffer->setPosition(
-        chunk->x * CHUNK_W - voxelBufferPadding, 0,
-        chunk->z * CHUNK_D - voxelBufferPadding);
-    chunks->getVoxels(*voxelsBuffer, settings.graphics.backlight.get());
+    auto snapshot = createSnapshot(*chunk, *chunks);
+    build(*snapshot);
+}
+
+void BlocksRenderer::build(const ChunkSnapshot& snapshot) {
+    this->snapshot = &snapshot;
+    voxelsBuffer = &snapshot.volume;
 
     if (voxelsBuffer->pickBlockId(
-        chunk->x * CHUNK_W, 0, chunk->z * CHUNK_D
+        snapshot.x * CHUNK_W, voxelsBuffer->getY(), snapshot.z * CHUNK_D
     ) == BLOCK_VOID) {
         cancelled = true;
         return;
     }
-    const voxel* voxels = chunk->voxels;
-
-    int totalBegin = chunk->bottom * (CHUNK_W * CHUNK_D);
-    int totalEnd = chunk->top * (CHUNK_W * CHUNK_D);
+    int totalBegin = snapshot.bottom * (CHUNK_W * CHUNK_D);
+    int totalEnd = snapshot.top * (CHUNK_W * CHUNK_D);
 
     int beginEnds[256][2] {};
     for (int i = totalBegin; i < totalEnd; i++) {
-        const voxel& vox = voxels[i];
+        if (skip_empty_section(snapshot, i)) {
+            continue;
+        }
+        const voxel& vox = snapshot.getVoxel(
+            i % CHUNK_W, i / (CHUNK_D * CHUNK_W), (i / CHUNK_D) % CHUNK_W
+        );
         blockid_t id = vox.id;
         const auto& def = *blockDefsCache[id];
 
@@ -662,19 +909,23 @@ void BlocksRenderer::build(const Chunk* chunk, const Chunks* chunks) {
         beginEnds[def.drawGroup][1] = i;
     }
     cancelled = false;
+    greedy = settings.graphics.greedyMeshing.get();
 
     overflow = false;
     vertexCount = 0;
     vertexOffset = indexCount = 0;
 
-    sortingMesh = renderTranslucent(voxels, beginEnds);
+    sortingMesh = renderTranslucent(beginEnds);
 
     overflow = false;
     vertexCount = 0;
     vertexOffset = 0;
     indexCount = 0;
 
-    render(voxels, beginEnds);
+    render(beginEnds);
+    if (greedy && !overflow) {
+        renderGreedy();
+    }
 }
 
 ChunkMeshData BlocksRenderer::createMesh() {
@@ -698,6 +949,3 @@ ChunkMesh BlocksRenderer::render(const Chunk *chunk, const Chunks *chunks) {
     ), std::move(sortingMesh)};
 }
 
-VoxelsVolume* BlocksRenderer::getVoxelsBuffer() const {
-    return voxelsBuffer.get();
-}
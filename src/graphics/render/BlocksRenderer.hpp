@@ -1,6 +1,7 @@
 #pragma once
 
 #include <memory>
+#include <vector>
 #include <glm/glm.hpp>
 #include "voxels/voxel.hpp"
 #include "typedefs.hpp"
@@ -8,6 +9,7 @@
 #include "voxels/Block.hpp"
 #include "voxels/Chunk.hpp"
 #include "voxels/VoxelsVolume.hpp"
+#include "voxels/ChunkSnapshot.hpp"
 #include "maths/util.hpp"
 #include "commons.hpp"
 #include "settings.hpp"
@@ -22,6 +24,19 @@ class ContentGfxCache;
 struct UVRegion;
 
 class BlocksRenderer {
+    /// @brief Packed vertex light (see ChunkVertex::light)
+    using Color = ChunkVertex::Light;
+
+    /// @brief Greedy meshing mask cell. Zero id means no face
+    struct GreedyCell {
+        blockid_t id;
+        Color color;
+
+        bool operator==(const GreedyCell& other) const {
+            return id == other.id && color == other.color;
+        }
+    };
+
     static const glm::vec3 SUN_VECTOR;
     const Content& content;
     std::unique_ptr<ChunkVertex[]> vertexBuffer;
@@ -33,8 +48,10 @@ class BlocksRenderer {
     int voxelBufferPadding = 2;
     bool overflow = false;
     bool cancelled = false;
-    const Chunk* chunk = nullptr;
-    std::unique_ptr<VoxelsVolume> voxelsBuffer;
+    bool greedy = false;
+    /// @brief Snapshot of the chunk being built
+    const ChunkSnapshot* snapshot = nullptr;
+    const VoxelsVolume* voxelsBuffer = nullptr;
 
     const Block* const* blockDefsCache;
     const ContentGfxCache& cache;
@@ -44,6 +61,9 @@ class BlocksRenderer {
 
     SortingMeshData sortingMesh;
 
+    /// @brief Faces of a single layer used by greedy meshing
+    std::vector<GreedyCell> greedyMask;
+
     void vertex(const glm::vec3& coord, float u, float v, const glm::vec4& light);
     void index(uint32_t a, uint32_t b, uint32_t c, uint32_t d, uint32_t e, uint32_t f);
 
@@ -81,6 +101,27 @@ class BlocksRenderer {
         const UVRegion& region,
         bool lights
     );
+    /// @brief Add face of w*h blocks with precalculated corner colors.
+    /// Texture region is repeated over blocks
+    void faceGreedy(
+        const glm::vec3& coord,
+        const glm::vec3& X,
+        const glm::vec3& Y,
+        const glm::vec3& Z,
+        int w, int h,
+        const UVRegion& region,
+        const Color(&colors)[4]
+    );
+    /// @brief Calculate face corner colors the same way faceAO and face do
+    void faceColors(
+        const glm::ivec3& coord,
+        const glm::ivec3& X,
+        const glm::ivec3& Y,
+        const glm::ivec3& Z,
+        bool lights,
+        bool ao,
+        Color(&colors)[4]
+    ) const;
     void blockCube(
         const glm::ivec3& coord,
         const UVRegion(&faces)[6], 
@@ -117,7 +158,7 @@ class BlocksRenderer {
     // Does block allow to see other blocks sides (is it transparent)
     inline bool isOpen(const glm::ivec3& pos, const Block& def) const {
         auto id = voxelsBuffer->pickBlockId(
-            chunk->x * CHUNK_W + pos.x, pos.y, chunk->z * CHUNK_D + pos.z
+            snapshot->x * CHUNK_W + pos.x, pos.y, snapshot->z * CHUNK_D + pos.z
         );
         if (id == BLOCK_VOID) {
             return false;
@@ -140,8 +181,11 @@ class BlocksRenderer {
     glm::vec4 pickSoftLight(const glm::ivec3& coord, const glm::ivec3& right, const glm::ivec3& up) const;
     glm::vec4 pickSoftLight(float x, float y, float z, const glm::ivec3& right, const glm::ivec3& up) const;
     
-    void render(const voxel* voxels, int beginEnds[256][2]);
-    SortingMeshData renderTranslucent(const voxel* voxels, int beginEnds[256][2]);
+    /// @brief Render faces of greedy blocks merging adjacent faces having
+    /// the same block and colors
+    void renderGreedy();
+    void render(int beginEnds[256][2]);
+    SortingMeshData renderTranslucent(int beginEnds[256][2]);
 public:
     BlocksRenderer(
         size_t capacity,
@@ -151,10 +195,18 @@ public:
     );
     virtual ~BlocksRenderer();
 
+    /// @brief Capture chunk data required to build its mesh.
+    /// Must be called in the thread owning chunks
+    std::shared_ptr<ChunkSnapshot> createSnapshot(
+        const Chunk& chunk, const Chunks& chunks
+    ) const;
+
     void build(const Chunk* chunk, const Chunks* chunks);
+    /// @brief Build mesh using immutable chunk snapshot only.
+    /// May be called from any thread
+    void build(const ChunkSnapshot& snapshot);
     ChunkMesh render(const Chunk* chunk, const Chunks* chunks);
     ChunkMeshData createMesh();
-    VoxelsVolume* getVoxelsBuffer() const;
 
     bool isCancelled() const {
         return cancelled;
@@ -18,18 +18,16 @@ static debug::Logger logger("chunks-render");
 
 size_t ChunksRenderer::visibleChunks = 0;
 
-class RendererWorker : public util::Worker<std::shared_ptr<Chunk>, RendererResult> {
-    const Chunks& chunks;
+class RendererWorker
+    : public util::Worker<std::shared_ptr<ChunkSnapshot>, RendererResult> {
     BlocksRenderer renderer;
 public:
     RendererWorker(
         const Level& level,
-        const Chunks& chunks,
         const ContentGfxCache& cache,
         const EngineSettings& settings
     )
-        : chunks(chunks),
-          renderer(
+        : renderer(
               settings.graphics.denseRender.get()
                   ? settings.graphics.chunkMaxVerticesDense.get()
                   : settings.graphics.chunkMaxVertices.get(),
@@ -39,15 +37,18 @@ public:
           ) {
     }
 
-    RendererResult operator()(const std::shared_ptr<Chunk>& chunk) override {
-        renderer.build(chunk.get(), &chunks);
+    RendererResult operator()(
+        const std::shared_ptr<ChunkSnapshot>& snapshot
+    ) override {
+        glm::ivec2 key(snapshot->x, snapshot->z);
+        renderer.build(*snapshot);
         if (renderer.isCancelled()) {
             return RendererResult {
-                glm::ivec2(chunk->x, chunk->z), true, ChunkMeshData {}};
+                key, snapshot->version, true, ChunkMeshData {}};
         }
         auto meshData = renderer.createMesh();
         return RendererResult {
-            glm::ivec2(chunk->x, chunk->z), false, std::move(meshData)};
+            key, snapshot->version, false, std::move(meshData)};
     }
 };
 
@@ -67,17 +68,22 @@ ChunksRenderer::ChunksRenderer(
           "chunks-render-pool",
           [&]() {
               return std::make_shared<RendererWorker>(
-                  *level, chunks, cache, settings
+                  *level, cache, settings
               );
           },
           [&](RendererResult& result) {
+              const auto& found = inwork.find(result.key);
+              if (found == inwork.end() || found->second != result.version) {
+                  // chunk was unloaded, cleared or rebuilt since snapshot
+                  return;
+              }
+              inwork.erase(found);
               if (!result.cancelled) {
                   auto meshData = std::move(result.meshData);
                   meshes[result.key] = ChunkMesh {
                       std::make_unique<Mesh<ChunkVertex>>(meshData.mesh),
                       std::move(meshData.sortingMesh)};
               }
-              inwork.erase(result.key);
           },
           settings.graphics.chunkMaxRenderers.get()
       ) {
@@ -95,28 +101,36 @@ ChunksRenderer::~ChunksRenderer() {
 const Mesh<ChunkVertex>* ChunksRenderer::render(
     const std::shared_ptr<Chunk>& chunk, bool important
 ) {
-    chunk->flags.modified = false;
+    glm::ivec2 key(chunk->x, chunk->z);
     if (important) {
+        chunk->flags.modified = false;
         auto mesh = renderer->render(chunk.get(), &chunks);
-        meshes[glm::ivec2(chunk->x, chunk->z)] = ChunkMesh {
+        meshes[key] = ChunkMesh {
             std::move(mesh.mesh), std::move(mesh.sortingMeshData)
         };
-        return meshes[glm::ivec2(chunk->x, chunk->z)].mesh.get();
+        // mesh being built by worker is outdated now
+        inwork.erase(key);
+        return meshes[key].mesh.get();
     }
-    glm::ivec2 key(chunk->x, chunk->z);
     if (inwork.find(key) != inwork.end()) {
+        // modified flag is kept to rebuild the mesh when the job is done
         return nullptr;
     }
-    inwork[key] = true;
-    threadPool.enqueueJob(chunk);
+    chunk->flags.modified = false;
+    auto snapshot = renderer->createSnapshot(*chunk, chunks);
+    snapshot->version = nextVersion++;
+    inwork[key] = snapshot->version;
+    threadPool.enqueueJob(std::move(snapshot));
     return nullptr;
 }
 
 void ChunksRenderer::unload(const Chunk* chunk) {
-    auto found = meshes.find(glm::ivec2(chunk->x, chunk->z));
+    glm::ivec2 key(chunk->x, chunk->z);
+    auto found = meshes.find(key);
     if (found != meshes.end()) {
         meshes.erase(found);
     }
+    inwork.erase(key);
 }
 
 void ChunksRenderer::clear() {
@@ -259,7 +273,6 @@ void ChunksRenderer::drawSortedMeshes(const Camera& camera, Shader& shader) {
 
     shader.use();
     atlas.getTexture()->bind();
-    shader.uniformMatrix("u_model", glm::mat4(1.0f));
     shader.uniform1i("u_alphaClip", false);
     
     for (const auto& index : indices) {
@@ -285,6 +298,11 @@ void ChunksRenderer::drawSortedMeshes(const Camera& camera, Shader& shader) {
 
         auto& chunkEntries = found->second.sortingMeshData.entries;
 
+        glm::vec3 coord(
+            chunk->x * CHUNK_W + 0.5f, 0.5f, chunk->z * CHUNK_D + 0.5f
+        );
+        shader.uniformMatrix("u_model", glm::translate(glm::mat4(1.0f), coord));
+
         if (chunkEntries.size() == 1) {
             auto& entry = chunkEntries.at(0);
             if (found->second.sortedMesh == nullptr) {
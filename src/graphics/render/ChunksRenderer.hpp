@@ -22,6 +22,7 @@ class Frustum;
 class BlocksRenderer;
 class ContentGfxCache;
 struct EngineSettings;
+struct ChunkSnapshot;
 
 struct ChunksSortEntry {
     int index;
@@ -34,6 +35,8 @@ struct ChunksSortEntry {
 
 struct RendererResult {
     glm::ivec2 key;
+    /// @brief Version of the chunk snapshot used to build the mesh
+    uint64_t version;
     bool cancelled;
     ChunkMeshData meshData;
 };
@@ -46,9 +49,12 @@ class ChunksRenderer {
 
     std::unique_ptr<BlocksRenderer> renderer;
     std::unordered_map<glm::ivec2, ChunkMesh> meshes;
-    std::unordered_map<glm::ivec2, bool> inwork;
+    /// @brief Snapshot versions of chunks being built by workers.
+    /// Results of other versions are outdated and dropped
+    std::unordered_map<glm::ivec2, uint64_t> inwork;
+    uint64_t nextVersion = 1;
     std::vector<ChunksSortEntry> indices;
-    util::ThreadPool<std::shared_ptr<Chunk>, RendererResult> threadPool;
+    util::ThreadPool<std::shared_ptr<ChunkSnapshot>, RendererResult> threadPool;
     const Mesh<ChunkVertex>* retrieveChunk(
         size_t index, const Camera& camera, Shader& shader, bool culling
     );
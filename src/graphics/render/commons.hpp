@@ -3,23 +3,80 @@
 #include <vector>
 #include <array>
 #include <memory>
+#include <cmath>
+#include <algorithm>
 #include <glm/vec2.hpp>
 #include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
 
 #include "graphics/core/MeshData.hpp"
 #include "util/Buffer.hpp"
 
-/// @brief Chunk mesh vertex format
+/// @brief Packed chunk mesh vertex format (18 bytes).
+/// Decoded by main shader
 struct ChunkVertex {
-    glm::vec3 position;
-    glm::vec2 uv;
-    std::array<uint8_t, 4> color;
+    /// @brief Normalized light color and sky light (R, G, B, S).
+    /// 8 bits per channel keep smooth AO and directional shading
+    using Light = std::array<uint8_t, 4>;
+
+    /// @brief Chunk-local position in 1/POSITION_SCALE units
+    /// shifted by POSITION_OFFSET
+    std::array<uint16_t, 3> position;
+    Light light;
+    /// @brief Normalized atlas texture coordinates
+    std::array<uint16_t, 2> uv;
+    /// @brief Normalized size of the atlas region repeated over merged faces
+    /// starting from uv. Zero means uv is not repeated
+    std::array<uint16_t, 2> tiling;
+
+    static constexpr float POSITION_SCALE = 128.0f;
+    static constexpr float POSITION_OFFSET = 64.0f;
 
     static constexpr VertexAttribute ATTRIBUTES[] = {
-        {VertexAttribute::Type::FLOAT, false, 3},
-        {VertexAttribute::Type::FLOAT, false, 2},
+        {VertexAttribute::Type::UNSIGNED_SHORT, false, 3},
         {VertexAttribute::Type::UNSIGNED_BYTE, true, 4},
+        {VertexAttribute::Type::UNSIGNED_SHORT, true, 2},
+        {VertexAttribute::Type::UNSIGNED_SHORT, true, 2},
         {{}, 0}};
+
+    static inline uint16_t packPosition(float x) {
+        return static_cast<uint16_t>(
+            std::round((x + POSITION_OFFSET) * POSITION_SCALE)
+        );
+    }
+
+    static inline float unpackPosition(uint16_t x) {
+        return x / POSITION_SCALE - POSITION_OFFSET;
+    }
+
+    /// @param light light color and sky light in range [0.0, 1.0]
+    static inline Light packLight(const glm::vec4& light) {
+        Light packed;
+        for (int i = 0; i < 4; i++) {
+            packed[i] = static_cast<uint8_t>(
+                std::round(std::clamp(light[i], 0.0f, 1.0f) * 0xFF)
+            );
+        }
+        return packed;
+    }
+
+    static inline uint16_t packUV(float u) {
+        return static_cast<uint16_t>(
+            std::round(std::clamp(u, 0.0f, 1.0f) * 0xFFFF)
+        );
+    }
+
+    inline void setPosition(const glm::vec3& pos) {
+        position = {packPosition(pos.x), packPosition(pos.y), packPosition(pos.z)};
+    }
+
+    inline glm::vec3 getPosition() const {
+        return glm::vec3(
+            unpackPosition(position[0]),
+            unpackPosition(position[1]),
+            unpackPosition(position[2])
+        );
+    }
 };
 
 template<typename VertexStructure>
@@ -0,0 +1,111 @@
+#include "mapped_file.hpp"
+
+#include <stdexcept>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace io;
+
+#ifdef _WIN32
+
+mapped_file::mapped_file(const std::filesystem::path& filename) {
+    fileHandle = CreateFileW(
+        filename.wstring().c_str(),
+        GENERIC_READ,
+        FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+        nullptr,
+        OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL,
+        nullptr
+    );
+    if (fileHandle == INVALID_HANDLE_VALUE) {
+        fileHandle = nullptr;
+        throw std::runtime_error("could not to open file " + filename.u8string());
+    }
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(fileHandle, &fileSize)) {
+        close();
+        throw std::runtime_error("could not to get size of " + filename.u8string());
+    }
+    length = static_cast<size_t>(fileSize.QuadPart);
+    if (length == 0) {
+        return;
+    }
+    mappingHandle = CreateFileMappingW(
+        fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr
+    );
+    if (mappingHandle == nullptr) {
+        close();
+        throw std::runtime_error("could not to map file " + filename.u8string());
+    }
+    ptr = static_cast<const ubyte*>(
+        MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0)
+    );
+    if (ptr == nullptr) {
+        close();
+        throw std::runtime_error("could not to map file " + filename.u8string());
+    }
+}
+
+void mapped_file::close() {
+    if (ptr) {
+        UnmapViewOfFile(ptr);
+        ptr = nullptr;
+    }
+    if (mappingHandle) {
+        CloseHandle(mappingHandle);
+        mappingHandle = nullptr;
+    }
+    if (fileHandle) {
+        CloseHandle(fileHandle);
+        fileHandle = nullptr;
+    }
+}
+
+#else
+
+mapped_file::mapped_file(const std::filesystem::path& filename) {
+    descriptor = ::open(filename.c_str(), O_RDONLY);
+    if (descriptor == -1) {
+        throw std::runtime_error("could not to open file " + filename.u8string());
+    }
+    struct stat info;
+    if (fstat(descriptor, &info) == -1) {
+        close();
+        throw std::runtime_error("could not to get size of " + filename.u8string());
+    }
+    length = static_cast<size_t>(info.st_size);
+    if (length == 0) {
+        return;
+    }
+    void* mapping = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, descriptor, 0);
+    if (mapping == MAP_FAILED) {
+        close();
+        throw std::runtime_error("could not to map file " + filename.u8string());
+    }
+    ptr = static_cast<const ubyte*>(mapping);
+}
+
+void mapped_file::close() {
+    if (ptr) {
+        munmap(const_cast<ubyte*>(ptr), length);
+        ptr = nullptr;
+    }
+    if (descriptor != -1) {
+        ::close(descriptor);
+        descriptor = -1;
+    }
+}
+
+#endif
+
+mapped_file::~mapped_file() {
+    close();
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <filesystem>
+
+#include "typedefs.hpp"
+
+namespace io {
+    /// @brief Read-only memory-mapped file. Can be used from multiple
+    /// threads simultaneously
+    class mapped_file {
+        const ubyte* ptr = nullptr;
+        size_t length = 0;
+#ifdef _WIN32
+        void* fileHandle = nullptr;
+        void* mappingHandle = nullptr;
+#else
+        int descriptor = -1;
+#endif
+        void close();
+    public:
+        /// @param filename native file path
+        /// @throws std::runtime_error if file could not be mapped
+        mapped_file(const std::filesystem::path& filename);
+        mapped_file(const mapped_file&) = delete;
+        ~mapped_file();
+
+        const ubyte* data() const {
+            return ptr;
+        }
+
+        size_t size() const {
+            return length;
+        }
+    };
+}
@@ -63,11 +63,22 @@ SettingsHandler::SettingsHandler(EngineSettings& settings) {
     builder.add("load-distance", &settings.chunks.loadDistance);
     builder.add("load-speed", &settings.chunks.loadSpeed);
     builder.add("padding", &settings.chunks.padding);
+    builder.add("load-threads", &settings.chunks.loadThreads);
+    builder.add("generator-threads", &settings.chunks.generatorThreads);
+    builder.add("light-threads", &settings.chunks.lightThreads);
+    builder.add("lighting-thread", &settings.chunks.lightingThread);
+    builder.add("server-lighting", &settings.chunks.serverLighting);
+    builder.add("regions-cache-size", &settings.chunks.regionsCacheSize);
+
+    builder.section("physics");
+    builder.add("threads", &settings.physics.threads);
+    builder.add("lod-distance", &settings.physics.lodDistance);
 
     builder.section("graphics");
     builder.add("fog-curve", &settings.graphics.fogCurve);
     builder.add("backlight", &settings.graphics.backlight);
     builder.add("dense-render", &settings.graphics.denseRender);
+    builder.add("greedy-meshing", &settings.graphics.greedyMeshing);
     builder.add("gamma", &settings.graphics.gamma);
     builder.add("frustum-culling", &settings.graphics.frustumCulling);
     builder.add("skybox-resolution", &settings.graphics.skyboxResolution);
@@ -0,0 +1,388 @@
+#include "LightEngine.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#include "Lightmap.hpp"
+#include "constants.hpp"
+#include "content/Content.hpp"
+#include "voxels/Block.hpp"
+#include "voxels/Chunk.hpp"
+#include "voxels/voxel.hpp"
+
+/// Area is the chunk with all its neighbours. Light of level 15 spreads for
+/// 14 blocks at most, so it never leaves the area and flat index never
+/// wraps horizontally.
+static_assert(CHUNK_W > 15 && CHUNK_D > 15);
+
+inline constexpr int AREA_W = CHUNK_W * 3;
+inline constexpr int AREA_D = CHUNK_D * 3;
+inline constexpr int AREA_H = CHUNK_H;
+inline constexpr int AREA_VOL = AREA_W * AREA_D * AREA_H;
+
+static constexpr uint area_index(int x, int y, int z) {
+    return (y * AREA_D + z) * AREA_W + x;
+}
+
+static constexpr int NEIGHBOURS[] {
+    1, -1, AREA_W, -AREA_W, AREA_W * AREA_D, -AREA_W * AREA_D
+};
+
+// All four channels are processed at once with light_t spread to 8-bit
+// lanes (0x0S0B0G0R), so lanes do not interfere on arithmetic operations.
+
+static inline uint32_t spread(light_t light) {
+    uint32_t x = light;
+    x = (x | (x << 8)) & 0x00FF00FF;
+    x = (x | (x << 4)) & 0x0F0F0F0F;
+    return x;
+}
+
+static inline light_t pack(uint32_t x) {
+    x = (x | (x >> 4)) & 0x00FF00FF;
+    x = (x | (x >> 8)) & 0x0000FFFF;
+    return static_cast<light_t>(x);
+}
+
+/// @brief Decrement every non-zero lane
+static inline uint32_t decrement(uint32_t x) {
+    return x - (((x + 0x0F0F0F0F) >> 4) & 0x01010101);
+}
+
+/// @return 0xF in every lane where a is greater than b
+static inline uint32_t greater_mask(uint32_t a, uint32_t b) {
+    return ((((a | 0x10101010) - b - 0x01010101) >> 4) & 0x01010101) * 0xF;
+}
+
+struct lightnode {
+    uint32_t index;
+    /// @brief Spread light
+    uint32_t light;
+};
+
+class LightArea {
+public:
+    light_t lights[AREA_VOL];
+    bool passing[AREA_VOL];
+    /// @brief Chunks of the area at the moment of preparing
+    Chunk* chunks[9];
+    /// @brief Chunks blocks versions at the moment of preparing
+    uint32_t blocksVersions[9];
+    /// @brief Chunks lightmap versions at the moment of preparing
+    uint32_t lightsVersions[9];
+    int x;
+    int z;
+    std::vector<lightnode> queue;
+
+    /// @brief Enqueue existing light of the cell
+    /// @param mask channels to spread
+    void add(uint index, light_t mask) {
+        light_t light = lights[index] & mask;
+        // at least one channel is greater than 1
+        if (light & 0xEEEE) {
+            queue.push_back(lightnode {index, spread(light)});
+        }
+    }
+
+    void emit(uint index, light_t emission) {
+        uint32_t current = spread(lights[index]);
+        uint32_t light = spread(emission);
+        uint32_t mask = greater_mask(light, current);
+        lights[index] = pack((current & ~mask) | (light & mask));
+        queue.push_back(lightnode {index, light});
+    }
+
+    void solve() {
+        for (size_t i = 0; i < queue.size(); i++) {
+            const auto node = queue[i];
+            uint32_t light = decrement(node.light);
+            if (light == 0) {
+                continue;
+            }
+            for (int offset : NEIGHBOURS) {
+                uint index = node.index + offset;
+                if (index >= AREA_VOL || !passing[index]) {
+                    continue;
+                }
+                uint32_t current = spread(lights[index]);
+                uint32_t mask = greater_mask(light, current);
+                if (mask == 0) {
+                    continue;
+                }
+                lights[index] = pack((current & ~mask) | (light & mask));
+                queue.push_back(lightnode {index, light & mask});
+            }
+        }
+        queue.clear();
+    }
+};
+
+/// @brief Max number of areas enqueued to the dedicated thread
+inline constexpr size_t MAX_ENQUEUED_AREAS = 4;
+
+class LightWorker : public util::Worker<
+                        std::shared_ptr<LightArea>,
+                        std::shared_ptr<LightArea>> {
+public:
+    std::shared_ptr<LightArea> operator()(
+        const std::shared_ptr<LightArea>& area
+    ) override {
+        area->solve();
+        return area;
+    }
+};
+
+class LightEngine::BuildWorker : public util::Worker<LightTask, LightTask> {
+    LightEngine& engine;
+    LightArea area;
+public:
+    BuildWorker(LightEngine& engine) : engine(engine) {
+    }
+
+    LightTask operator()(const LightTask& task) override {
+        engine.build(area, task);
+        return task;
+    }
+};
+
+LightEngine::LightEngine(
+    const ContentIndices& indices,
+    ChunkGetter getChunk,
+    uint threads,
+    bool dedicatedThread
+)
+    : blockDefs(indices.blocks.getDefs()),
+      getChunk(std::move(getChunk)),
+      area(std::make_unique<LightArea>()) {
+    if (threads > 1) {
+        buildWorkers =
+            std::make_unique<util::ThreadPool<LightTask, LightTask>>(
+                "lights-workers",
+                [this]() { return std::make_shared<BuildWorker>(*this); },
+                [](LightTask&) {},
+                threads
+            );
+    }
+    if (!dedicatedThread) {
+        return;
+    }
+    lightsThread = std::make_unique<util::ThreadPool<LightAreaPtr, LightAreaPtr>>(
+        "lights-thread",
+        []() { return std::make_shared<LightWorker>(); },
+        [this](LightAreaPtr& area) { onSolved(area); },
+        1
+    );
+    lightsThread->setStopOnFail(false);
+}
+
+LightEngine::~LightEngine() = default;
+
+void LightEngine::build(const std::vector<LightTask>& tasks) {
+    if (buildWorkers == nullptr || tasks.size() == 1) {
+        for (const auto& task : tasks) {
+            build(*area, task);
+        }
+        return;
+    }
+    for (const auto& task : tasks) {
+        buildWorkers->enqueueJob(task);
+    }
+    buildWorkers->waitForJobs();
+}
+
+void LightEngine::build(LightArea& area, const LightTask& task) {
+    prepare(area, task);
+    area.solve();
+    apply(area);
+}
+
+bool LightEngine::enqueue(const LightTask& task) {
+    if (isQueueFull()) {
+        return false;
+    }
+    for (const auto& area : inwork) {
+        if (std::abs(area->x - task.chunk->x) < 3 &&
+            std::abs(area->z - task.chunk->z) < 3) {
+            return false;
+        }
+    }
+    LightAreaPtr area;
+    if (freeAreas.empty()) {
+        area = std::make_shared<LightArea>();
+    } else {
+        area = std::move(freeAreas.back());
+        freeAreas.pop_back();
+    }
+    prepare(*area, task);
+    inwork.push_back(area);
+    lightsThread->enqueueJob(area);
+    return true;
+}
+
+void LightEngine::update() {
+    if (lightsThread) {
+        lightsThread->update();
+    }
+}
+
+void LightEngine::onSolved(const LightAreaPtr& area) {
+    inwork.erase(std::find(inwork.begin(), inwork.end(), area));
+    freeAreas.push_back(area);
+    // chunk will be enqueued again if still needs lights
+    if (!isActual(*area)) {
+        return;
+    }
+    apply(*area);
+    area->chunks[4]->flags.lighted = true;
+}
+
+bool LightEngine::isQueueFull() const {
+    return inwork.size() >= MAX_ENQUEUED_AREAS;
+}
+
+void LightEngine::prepare(LightArea& area, const LightTask& task) const {
+    area.x = task.chunk->x;
+    area.z = task.chunk->z;
+
+    for (int oz = 0; oz < 3; oz++) {
+        for (int ox = 0; ox < 3; ox++) {
+            Chunk* chunk = getChunk(area.x + ox - 1, area.z + oz - 1);
+            area.chunks[oz * 3 + ox] = chunk;
+            if (chunk) {
+                area.blocksVersions[oz * 3 + ox] = chunk->blocksVersion;
+                area.lightsVersions[oz * 3 + ox] = chunk->lightmap.version;
+            }
+            for (int y = 0; y < CHUNK_H; y++) {
+                for (int z = 0; z < CHUNK_D; z++) {
+                    uint index =
+                        area_index(ox * CHUNK_W, y, oz * CHUNK_D + z);
+                    if (chunk == nullptr) {
+                        std::memset(area.lights + index, 0, CHUNK_W * sizeof(light_t));
+                        std::memset(area.passing + index, 0, CHUNK_W);
+                        continue;
+                    }
+                    const light_t* src =
+                        chunk->lightmap.getLights() + vox_index(0, y, z);
+                    std::memcpy(area.lights + index, src, CHUNK_W * sizeof(light_t));
+                    uint offset = vox_index(0, y, z);
+                    for (int x = 0; x < CHUNK_W; x++) {
+                        const voxel& vox = chunk->voxels.get(offset + x);
+                        area.passing[index + x] =
+                            blockDefs[vox.id]->lightPassing;
+                    }
+                }
+            }
+        }
+    }
+
+    const Chunk& chunk = *task.chunk;
+    if (task.expand) {
+        // sky light
+        for (int z = CHUNK_D; z < CHUNK_D * 2; z++) {
+            for (int x = CHUNK_W; x < CHUNK_W * 2; x++) {
+                for (int y = chunk.lightmap.highestPoint; y >= 0; y--) {
+                    while (y > 0 && !area.passing[area_index(x, y, z)]) {
+                        y--;
+                    }
+                    uint index = area_index(x, y, z);
+                    if (Lightmap::extract(area.lights[index], 3) == 15) {
+                        continue;
+                    }
+                    if (y + 1 < AREA_H) {
+                        area.add(area_index(x, y + 1, z), 0xF000);
+                    }
+                    for (; y >= 0; y--) {
+                        index = area_index(x, y, z);
+                        area.add(index + 1, 0xF000);
+                        area.add(index - 1, 0xF000);
+                        area.add(index + AREA_W, 0xF000);
+                        area.add(index - AREA_W, 0xF000);
+                    }
+                }
+            }
+        }
+        // chunk border lights
+        for (int y = 0; y < CHUNK_H; y++) {
+            for (int i = 0; i < CHUNK_W; i++) {
+                area.add(area_index(CHUNK_W + i, y, CHUNK_D), 0xFFFF);
+                area.add(area_index(CHUNK_W + i, y, CHUNK_D * 2 - 1), 0xFFFF);
+            }
+            for (int i = 1; i < CHUNK_D - 1; i++) {
+                area.add(area_index(CHUNK_W, y, CHUNK_D + i), 0xFFFF);
+                area.add(area_index(CHUNK_W * 2 - 1, y, CHUNK_D + i), 0xFFFF);
+            }
+        }
+    }
+    // emissive blocks
+    for (int y = 0; y < CHUNK_H; y++) {
+        for (int z = 0; z < CHUNK_D; z++) {
+            for (int x = 0; x < CHUNK_W; x++) {
+                const voxel& vox = chunk.voxels.get(vox_index(x, y, z));
+                const Block* block = blockDefs[vox.id];
+                if (block->rt.emissive) {
+                    area.emit(
+                        area_index(x + CHUNK_W, y, z + CHUNK_D),
+                        Lightmap::combine(
+                            block->emission[0],
+                            block->emission[1],
+                            block->emission[2],
+                            0
+                        )
+                    );
+                }
+            }
+        }
+    }
+}
+
+bool LightEngine::isActual(const LightArea& area) const {
+    for (int i = 0; i < 9; i++) {
+        Chunk* chunk = getChunk(area.x + i % 3 - 1, area.z + i / 3 - 1);
+        if (chunk != area.chunks[i]) {
+            return false;
+        }
+        if (chunk && (chunk->blocksVersion != area.blocksVersions[i] ||
+                      chunk->lightmap.version != area.lightsVersions[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void LightEngine::apply(LightArea& area) const {
+    for (int oz = 0; oz < 3; oz++) {
+        for (int ox = 0; ox < 3; ox++) {
+            Chunk* chunk = area.chunks[oz * 3 + ox];
+            if (chunk == nullptr) {
+                continue;
+            }
+            // lightmap version is changed only if lights are changed
+            light_t* dst = nullptr;
+            for (int y = 0; y < CHUNK_H; y++) {
+                for (int z = 0; z < CHUNK_D; z++) {
+                    const light_t* src = area.lights +
+                        area_index(ox * CHUNK_W, y, oz * CHUNK_D + z);
+                    uint offset = vox_index(0, y, z);
+                    if (std::memcmp(
+                            chunk->lightmap.getLights() + offset,
+                            src,
+                            CHUNK_W * sizeof(light_t)
+                        ) == 0) {
+                        continue;
+                    }
+                    if (dst == nullptr) {
+                        dst = chunk->lightmap.getLightsWriteable();
+                    }
+                    std::memcpy(dst + offset, src, CHUNK_W * sizeof(light_t));
+                }
+            }
+            if (dst) {
+                chunk->flags.modified = true;
+            }
+        }
+    }
+}
+
+uint LightEngine::getThreadsCount() const {
+    return buildWorkers ? buildWorkers->getWorkersCount() : 1;
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "typedefs.hpp"
+#include "LightSolver.hpp"
+#include "util/ThreadPool.hpp"
+
+class Block;
+class Chunk;
+class ContentIndices;
+class LightArea;
+
+struct LightTask {
+    Chunk* chunk;
+    /// @brief Build sky light and spread chunk border lights to neighbours.
+    /// Used if chunk lights were not loaded
+    bool expand;
+};
+
+/// @brief Lights propagation engine processing all channels in one pass
+/// over a copy of chunk neighbourhood. Chunks with non-overlapping
+/// neighbourhoods are processed in parallel
+class LightEngine {
+    using LightAreaPtr = std::shared_ptr<LightArea>;
+
+    class BuildWorker;
+
+    const Block* const* blockDefs;
+    ChunkGetter getChunk;
+    /// @brief Neighbourhood buffer used on the calling thread
+    std::unique_ptr<LightArea> area;
+    /// @brief Parallel build workers having own neighbourhood buffers
+    /// (nullptr if single-threaded)
+    std::unique_ptr<util::ThreadPool<LightTask, LightTask>> buildWorkers;
+
+    /// @brief Dedicated lights thread (nullptr if not used)
+    std::unique_ptr<util::ThreadPool<LightAreaPtr, LightAreaPtr>> lightsThread;
+    /// @brief Areas enqueued to the dedicated thread
+    std::vector<LightAreaPtr> inwork;
+    /// @brief Areas ready for reuse
+    std::vector<LightAreaPtr> freeAreas;
+
+    /// @brief Copy chunk neighbourhood to the area and enqueue light sources
+    void prepare(LightArea& area, const LightTask& task) const;
+    /// @brief Check if area neighbourhood was not modified since prepare
+    /// comparing chunks blocks and lightmap versions
+    bool isActual(const LightArea& area) const;
+    /// @brief Write area lights back to chunks
+    void apply(LightArea& area) const;
+    void build(LightArea& area, const LightTask& task);
+    void onSolved(const LightAreaPtr& area);
+public:
+    /// @param threads number of threads used to build lights
+    /// @param dedicatedThread create thread for enqueued tasks
+    LightEngine(
+        const ContentIndices& indices,
+        ChunkGetter getChunk,
+        uint threads,
+        bool dedicatedThread = false
+    );
+    ~LightEngine();
+
+    /// @brief Build lights of chunks having all neighbours present.
+    /// Chunks must be at least 3 chunks apart from each other.
+    void build(const std::vector<LightTask>& tasks);
+
+    /// @brief Enqueue chunk lights building to the dedicated thread.
+    /// Chunk gets flags.lighted set on success in update
+    /// @return false if queue is full or the chunk neighbourhood overlaps
+    /// with one of enqueued
+    bool enqueue(const LightTask& task);
+
+    /// @brief Apply lights built on the dedicated thread.
+    /// Results are dropped if chunks were modified while building
+    void update();
+
+    bool isQueueFull() const;
+
+    bool hasDedicatedThread() const {
+        return lightsThread != nullptr;
+    }
+
+    uint getThreadsCount() const;
+};
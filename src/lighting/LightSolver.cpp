@@ -4,21 +4,30 @@
 #include "LightSolver.hpp"
 #include "Lightmap.hpp"
 #include "content/Content.hpp"
-#include "voxels/Chunks.hpp"
+#include "maths/voxmaths.hpp"
 #include "voxels/Chunk.hpp"
 #include "voxels/voxel.hpp"
 #include "voxels/Block.hpp"
 
-LightSolver::LightSolver(const ContentIndices& contentIds, Chunks& chunks, int channel) 
+LightSolver::LightSolver(
+    const ContentIndices& contentIds, ChunkGetter getChunk, int channel
+)
     : blockDefs(contentIds.blocks.getDefs()),
-      chunks(chunks), 
+      getChunk(std::move(getChunk)),
       channel(channel) {
 }
 
+Chunk* LightSolver::getChunkByVoxel(int x, int y, int z) const {
+    if (y < 0 || y >= CHUNK_H) {
+        return nullptr;
+    }
+    return getChunk(floordiv<CHUNK_W>(x), floordiv<CHUNK_D>(z));
+}
+
 void LightSolver::add(int x, int y, int z, int emission) {
     if (emission <= 1)
         return;
-    Chunk* chunk = chunks.getChunkByVoxel(x, y, z);
+    Chunk* chunk = getChunkByVoxel(x, y, z);
     if (chunk == nullptr)
         return;
     ubyte light = chunk->lightmap.get(x-chunk->x*CHUNK_W, y, z-chunk->z*CHUNK_D, channel);
@@ -31,11 +40,14 @@ void LightSolver::add(int x, int y, int z, int emission) {
 }
 
 void LightSolver::add(int x, int y, int z) {
-    add(x,y,z, chunks.getLight(x,y,z, channel));
+    Chunk* chunk = getChunkByVoxel(x, y, z);
+    if (chunk == nullptr)
+        return;
+    add(x,y,z, chunk->lightmap.get(x-chunk->x*CHUNK_W, y, z-chunk->z*CHUNK_D, channel));
 }
 
 void LightSolver::remove(int x, int y, int z) {
-    Chunk* chunk = chunks.getChunkByVoxel(x, y, z);
+    Chunk* chunk = getChunkByVoxel(x, y, z);
     if (chunk == nullptr)
         return;
 
@@ -67,7 +79,7 @@ void LightSolver::solve(){
             int y = entry.y+coords[imul3+1];
             int z = entry.z+coords[imul3+2];
             
-            Chunk* chunk = chunks.getChunkByVoxel(x,y,z);
+            Chunk* chunk = getChunkByVoxel(x,y,z);
             if (chunk) {
                 int lx = x - chunk->x * CHUNK_W;
                 int lz = z - chunk->z * CHUNK_D;
@@ -75,8 +87,8 @@ void LightSolver::solve(){
 
                 ubyte light = chunk->lightmap.get(lx,y,lz, channel);
                 if (light != 0 && light == entry.light-1){
-                    voxel* vox = chunks.get(x, y, z);
-                    if (vox && vox->id != 0) {
+                    const voxel* vox = &chunk->voxels.get(vox_index(lx, y, lz));
+                    if (vox->id != 0) {
                         const Block* block = blockDefs[vox->id];
                         if (uint8_t emission = block->emission[channel]) {
                             addqueue.push(lightentry {x, y, z, emission});
@@ -104,14 +116,14 @@ void LightSolver::solve(){
             int y = entry.y+coords[imul3+1];
             int z = entry.z+coords[imul3+2];
 
-            Chunk* chunk = chunks.getChunkByVoxel(x,y,z);
+            Chunk* chunk = getChunkByVoxel(x,y,z);
             if (chunk) {
                 int lx = x - chunk->x * CHUNK_W;
                 int lz = z - chunk->z * CHUNK_D;
                 chunk->flags.modified = true;
 
                 ubyte light = chunk->lightmap.get(lx, y, lz, channel);
-                voxel& v = chunk->voxels[vox_index(lx, y, lz)];
+                const voxel& v = chunk->voxels.get(vox_index(lx, y, lz));
                 const Block* block = blockDefs[v.id];
                 if (block->lightPassing && light+2 <= entry.light){
                     chunk->lightmap.set(
@@ -1,11 +1,15 @@
 #pragma once
 
+#include <functional>
 #include <queue>
 
-class Chunks;
+class Chunk;
 class ContentIndices;
 class Block;
 
+/// @brief Get chunk by chunk coordinates. Returns nullptr if chunk is missing
+using ChunkGetter = std::function<Chunk*(int cx, int cz)>;
+
 struct lightentry {
     int x;
     int y;
@@ -17,10 +21,14 @@ class LightSolver {
     std::queue<lightentry> addqueue;
     std::queue<lightentry> remqueue;
     const Block* const* blockDefs;
-    Chunks& chunks;
+    ChunkGetter getChunk;
     int channel;
+
+    Chunk* getChunkByVoxel(int x, int y, int z) const;
 public:
-    LightSolver(const ContentIndices& contentIds, Chunks& chunks, int channel);
+    LightSolver(
+        const ContentIndices& contentIds, ChunkGetter getChunk, int channel
+    );
 
     void add(int x, int y, int z);
     void add(int x, int y, int z, int emission);
@@ -2,8 +2,10 @@
 #include "LightSolver.hpp"
 #include "Lightmap.hpp"
 #include "content/Content.hpp"
-#include "voxels/Chunks.hpp"
 #include "voxels/Chunk.hpp"
+#include "voxels/GlobalChunks.hpp"
+#include "maths/voxmaths.hpp"
+#include "voxels/blocks_agent.hpp"
 #include "voxels/voxel.hpp"
 #include "voxels/Block.hpp"
 #include "constants.hpp"
@@ -14,39 +16,78 @@
 
 static debug::Logger logger("lighting");
 
-Lighting::Lighting(const Content& content, Chunks& chunks) 
-  : content(content), chunks(chunks) {
+static ubyte get_light(
+    const GlobalChunks& chunks, int x, int y, int z, int channel
+) {
+    if (y < 0 || y >= CHUNK_H) {
+        return 0;
+    }
+    int cx = floordiv<CHUNK_W>(x);
+    int cz = floordiv<CHUNK_D>(z);
+    auto chunk = chunks.getChunk(cx, cz);
+    if (chunk == nullptr) {
+        return 0;
+    }
+    return chunk->lightmap.get(x - cx * CHUNK_W, y, z - cz * CHUNK_D, channel);
+}
+
+Lighting::Lighting(
+    const Content& content,
+    GlobalChunks& chunks,
+    uint threads,
+    bool dedicatedThread
+)
+  : content(content),
+    chunks(chunks),
+    engine(
+        *content.getIndices(),
+        [&chunks](int cx, int cz) { return chunks.getChunk(cx, cz); },
+        threads,
+        dedicatedThread
+    ) {
     auto& indices = *content.getIndices();
-    solverR = std::make_unique<LightSolver>(indices, chunks, 0);
-    solverG = std::make_unique<LightSolver>(indices, chunks, 1);
-    solverB = std::make_unique<LightSolver>(indices, chunks, 2);
-    solverS = std::make_unique<LightSolver>(indices, chunks, 3);
+    ChunkGetter getChunk = [&chunks](int cx, int cz) {
+        return chunks.getChunk(cx, cz);
+    };
+    solverR = std::make_unique<LightSolver>(indices, getChunk, 0);
+    solverG = std::make_unique<LightSolver>(indices, getChunk, 1);
+    solverB = std::make_unique<LightSolver>(indices, getChunk, 2);
+    solverS = std::make_unique<LightSolver>(indices, getChunk, 3);
 }
 
 Lighting::~Lighting() = default;
 
-void Lighting::clear(){
-    const auto& chunks = this->chunks.getChunks();
-    for (size_t index = 0; index < chunks.size(); index++){
-        auto chunk = chunks[index];
-        if (chunk == nullptr)
-            continue;
-        Lightmap& lightmap = chunk->lightmap;
-        for (int i = 0; i < CHUNK_VOL; i++){
-            lightmap.map[i] = 0;
-        }
-    }
-}
-
 void Lighting::prebuildSkyLight(Chunk& chunk, const ContentIndices& indices){
     const auto* blockDefs = indices.blocks.getDefs();
 
+    // sections passing sky light through entirely: empty or uniform
+    bool passingSections[CHUNK_SECTIONS];
+    for (uint y = 0; y < CHUNK_SECTIONS; y++) {
+        blockid_t id = BLOCK_AIR;
+        if (chunk.isSectionOccupied(y)) {
+            if (!chunk.voxels.isUniform(y)) {
+                passingSections[y] = false;
+                continue;
+            }
+            id = chunk.voxels.get(y * CHUNK_SECTION_VOL).id;
+        }
+        passingSections[y] = blockDefs[id]->skyLightPassing;
+    }
+
     int highestPoint = 0;
     for (int z = 0; z < CHUNK_D; z++){
         for (int x = 0; x < CHUNK_W; x++){
             for (int y = CHUNK_H-1; y >= 0; y--){
+                if (y % CHUNK_SECTION_H == CHUNK_SECTION_H - 1 &&
+                    passingSections[y / CHUNK_SECTION_H]) {
+                    for (int i = 0; i < CHUNK_SECTION_H; i++) {
+                        chunk.lightmap.setS(x, y - i, z, 15);
+                    }
+                    y -= CHUNK_SECTION_H - 1;
+                    continue;
+                }
                 int index = (y * CHUNK_D + z) * CHUNK_W + x;
-                voxel& vox = chunk.voxels[index];
+                const voxel& vox = chunk.voxels.get(index);
                 const Block* block = blockDefs[vox.id];
                 if (!block->skyLightPassing) {
                     if (highestPoint < y)
@@ -62,102 +103,37 @@ void Lighting::prebuildSkyLight(Chunk& chunk, const ContentIndices& indices){
     chunk.lightmap.highestPoint = highestPoint;
 }
 
-void Lighting::buildSkyLight(int cx, int cz){
-    const auto blockDefs = content.getIndices()->blocks.getDefs();
-
-    Chunk* chunk = chunks.getChunk(cx, cz);
+void Lighting::onChunkLoaded(int cx, int cz, bool expand) {
+    auto chunk = chunks.getChunk(cx, cz);
     if (chunk == nullptr) {
-        logger.error() << "attempted to build sky lights to chunk missing in local matrix";
+        logger.error() << "attempted to build lights to missing chunk";
         return;
     }
-    for (int z = 0; z < CHUNK_D; z++){
-        for (int x = 0; x < CHUNK_W; x++){
-            int gx = x + cx * CHUNK_W;
-            int gz = z + cz * CHUNK_D;
-            for (int y = chunk->lightmap.highestPoint; y >= 0; y--){
-                while (y > 0 && !blockDefs[chunk->voxels[vox_index(x, y, z)].id]->lightPassing) {
-                    y--;
-                }
-                if (chunk->lightmap.getS(x, y, z) != 15) {
-                    solverS->add(gx,y+1,gz);
-                    for (; y >= 0; y--){
-                        solverS->add(gx+1,y,gz);
-                        solverS->add(gx-1,y,gz);
-                        solverS->add(gx,y,gz+1);
-                        solverS->add(gx,y,gz-1);
-                    }
-                }
-            }
-        }
-    }
-    solverS->solve();
+    engine.build({LightTask {chunk, expand}});
 }
 
+void Lighting::onChunksLoaded(const std::vector<LightTask>& tasks) {
+    engine.build(tasks);
+}
 
-void Lighting::onChunkLoaded(int cx, int cz, bool expand) {
-    auto& solverR = *this->solverR;
-    auto& solverG = *this->solverG;
-    auto& solverB = *this->solverB;
-    auto& solverS = *this->solverS;
+bool Lighting::enqueueChunk(Chunk& chunk, bool expand) {
+    return engine.enqueue(LightTask {&chunk, expand});
+}
 
-    auto blockDefs = content.getIndices()->blocks.getDefs();
-    auto chunk = chunks.getChunk(cx, cz);
-    if (chunk == nullptr) {
-        logger.error() << "attempted to build lights to chunk missing in local matrix";
-        return;
-    }
-    for (uint y = 0; y < CHUNK_H; y++){
-        for (uint z = 0; z < CHUNK_D; z++){
-            for (uint x = 0; x < CHUNK_W; x++){
-                const voxel& vox = chunk->voxels[(y * CHUNK_D + z) * CHUNK_W + x];
-                const Block* block = blockDefs[vox.id];
-                int gx = x + cx * CHUNK_W;
-                int gz = z + cz * CHUNK_D;
-                if (block->rt.emissive){
-                    solverR.add(gx,y,gz,block->emission[0]);
-                    solverG.add(gx,y,gz,block->emission[1]);
-                    solverB.add(gx,y,gz,block->emission[2]);
-                }
-            }
-        }
-    }
+void Lighting::update() {
+    engine.update();
+}
 
-    if (expand) {
-        for (int x = 0; x < CHUNK_W; x += CHUNK_W-1) {
-            for (int y = 0; y < CHUNK_H; y++) {
-                for (int z = 0; z < CHUNK_D; z++) {
-                    int gx = x + cx * CHUNK_W;
-                    int gz = z + cz * CHUNK_D;
-                    int rgbs = chunk->lightmap.get(x, y, z);
-                    if (rgbs){
-                        solverR.add(gx,y,gz, Lightmap::extract(rgbs, 0));
-                        solverG.add(gx,y,gz, Lightmap::extract(rgbs, 1));
-                        solverB.add(gx,y,gz, Lightmap::extract(rgbs, 2));
-                        solverS.add(gx,y,gz, Lightmap::extract(rgbs, 3));
-                    }
-                }
-            }
-        }
-        for (int z = 0; z < CHUNK_D; z += CHUNK_D-1) {
-            for (int y = 0; y < CHUNK_H; y++) {
-                for (int x = 0; x < CHUNK_W; x++) {
-                    int gx = x + cx * CHUNK_W;
-                    int gz = z + cz * CHUNK_D;
-                    int rgbs = chunk->lightmap.get(x, y, z);
-                    if (rgbs){
-                        solverR.add(gx,y,gz, Lightmap::extract(rgbs, 0));
-                        solverG.add(gx,y,gz, Lightmap::extract(rgbs, 1));
-                        solverB.add(gx,y,gz, Lightmap::extract(rgbs, 2));
-                        solverS.add(gx,y,gz, Lightmap::extract(rgbs, 3));
-                    }
-                }
-            }
-        }
-    }
-    solverR.solve();
-    solverG.solve();
-    solverB.solve();
-    solverS.solve();
+bool Lighting::isQueueFull() const {
+    return engine.isQueueFull();
+}
+
+bool Lighting::hasDedicatedThread() const {
+    return engine.hasDedicatedThread();
+}
+
+uint Lighting::getThreadsCount() const {
+    return engine.getThreadsCount();
 }
 
 void Lighting::onBlockSet(int x, int y, int z, blockid_t id){
@@ -170,9 +146,9 @@ void Lighting::onBlockSet(int x, int y, int z, blockid_t id){
         solverR->solve();
         solverG->solve();
         solverB->solve();
-        if (chunks.getLight(x,y+1,z, 3) == 0xF){
+        if (get_light(chunks, x,y+1,z, 3) == 0xF){
             for (int i = y; i >= 0; i--){
-                voxel* vox = chunks.get(x,i,z);
+                const voxel* vox = blocks_agent::get(chunks, x,i,z);
                 if ((vox == nullptr || vox->id != 0) && block.skyLightPassing)
                     break;
                 solverS->add(x,i,z, 0xF);
@@ -193,7 +169,7 @@ void Lighting::onBlockSet(int x, int y, int z, blockid_t id){
             solverS->remove(x,y,z);
             for (int i = y-1; i >= 0; i--){
                 solverS->remove(x,i,z);
-                if (i == 0 || chunks.get(x,i-1,z)->id != 0){
+                if (i == 0 || blocks_agent::get(chunks, x,i-1,z)->id != 0){
                     break;
                 }
             }
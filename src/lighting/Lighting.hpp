@@ -1,27 +1,54 @@
 #pragma once
 
+#include <memory>
+#include <vector>
+
 #include "typedefs.hpp"
+#include "LightEngine.hpp"
 
 class Content;
 class ContentIndices;
 class Chunk;
-class Chunks;
+class GlobalChunks;
 class LightSolver;
 
+/// @brief Maintains lightmaps of level chunks
 class Lighting {
     const Content& content;
-    Chunks& chunks;
+    GlobalChunks& chunks;
     std::unique_ptr<LightSolver> solverR;
     std::unique_ptr<LightSolver> solverG;
     std::unique_ptr<LightSolver> solverB;
     std::unique_ptr<LightSolver> solverS;
+    LightEngine engine;
 public:
-    Lighting(const Content& content, Chunks& chunks);
+    /// @param threads number of threads used to light chunks
+    /// @param dedicatedThread build lights of enqueued chunks on a
+    /// dedicated thread
+    Lighting(
+        const Content& content,
+        GlobalChunks& chunks,
+        uint threads = 1,
+        bool dedicatedThread = false
+    );
     ~Lighting();
 
-    void clear();
-    void buildSkyLight(int cx, int cz);
+    /// @brief Build lights of the chunk having all neighbours present
+    /// @param expand build sky light and spread chunk border lights to
+    /// neighbours (chunk lights were not loaded)
     void onChunkLoaded(int cx, int cz, bool expand);
+    /// @brief Build lights of multiple chunks in parallel.
+    /// Chunks must be at least 3 chunks apart from each other
+    void onChunksLoaded(const std::vector<LightTask>& tasks);
+    /// @brief Enqueue chunk to the dedicated lights thread
+    /// @see LightEngine::enqueue
+    bool enqueueChunk(Chunk& chunk, bool expand);
+    /// @brief Apply lights built on the dedicated thread
+    void update();
+    bool isQueueFull() const;
+    bool hasDedicatedThread() const;
+    /// @brief Max number of chunks lighted in parallel
+    uint getThreadsCount() const;
     void onBlockSet(int x, int y, int z, blockid_t id);
 
     static void prebuildSkyLight(Chunk& chunk, const ContentIndices& indices);
@@ -11,6 +11,7 @@ void Lightmap::set(const Lightmap* lightmap) {
 
 void Lightmap::set(const light_t* map) {
     std::memcpy(this->map, map, sizeof(light_t) * CHUNK_VOL);
+    version++;
 }
 
 static_assert(sizeof(light_t) == 2, "replace dataio calls to new light_t");
@@ -13,6 +13,8 @@ class Lightmap {
 public:
     light_t map[CHUNK_VOL] {};
     int highestPoint = 0;
+    /// @brief Incremented on every lights modification
+    uint32_t version = 0;
 
     void set(const Lightmap* lightmap);
 
@@ -20,6 +22,7 @@ public:
 
     void clear() {
         std::memset(map, 0, sizeof(map));
+        version++;
     }
 
     inline unsigned short get(int x, int y, int z) const {
@@ -49,33 +52,40 @@ public:
     inline void setR(int x, int y, int z, int value){
         const int index = y*CHUNK_D*CHUNK_W+z*CHUNK_W+x;
         map[index] = (map[index] & 0xFFF0) | value;
+        version++;
     }
 
     inline void setG(int x, int y, int z, int value){
         const int index = y*CHUNK_D*CHUNK_W+z*CHUNK_W+x;
         map[index] = (map[index] & 0xFF0F) | (value << 4);
+        version++;
     }
 
     inline void setB(int x, int y, int z, int value){
         const int index = y*CHUNK_D*CHUNK_W+z*CHUNK_W+x;
         map[index] = (map[index] & 0xF0FF) | (value << 8);
+        version++;
     }
 
     inline void setS(int x, int y, int z, int value){
         const int index = y*CHUNK_D*CHUNK_W+z*CHUNK_W+x;
         map[index] = (map[index] & 0x0FFF) | (value << 12);
+        version++;
     }
 
     inline void set(int x, int y, int z, int channel, int value){
         const int index = y*CHUNK_D*CHUNK_W+z*CHUNK_W+x;
         map[index] = (map[index] & (0xFFFF & (~(0xF << (channel*4))))) | (value << (channel << 2));
+        version++;
     }
 
     inline const light_t* getLights() const {
         return map;
     }
 
+    /// @brief Get lights for writing. Counts as a modification
     inline light_t* getLightsWriteable() {
+        version++;
         return map;
     }
 
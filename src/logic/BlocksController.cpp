@@ -1,8 +1,7 @@
 #include "BlocksController.hpp"
 
-#include <set>
-
 #include "content/Content.hpp"
+#include "debug/Profiler.hpp"
 #include "items/Inventories.hpp"
 #include "items/Inventory.hpp"
 #include "lighting/Lighting.hpp"
@@ -19,6 +18,8 @@
 #include "objects/Player.hpp"
 #include "objects/Players.hpp"
 
+namespace profiler = debug::profiler;
+
 BlocksController::BlocksController(const Level& level, Lighting* lighting)
     : level(level),
       chunks(*level.chunks),
@@ -38,7 +39,7 @@ void BlocksController::updateSides(int x, int y, int z) {
 }
 
 void BlocksController::updateSides(int x, int y, int z, int w, int h, int d) {
-    voxel* vox = blocks_agent::get(chunks, x, y, z);
+    const voxel* vox = blocks_agent::get(chunks, x, y, z);
     const auto& def = level.content.getIndices()->blocks.require(vox->id);
     const auto& rot = def.rotations.variants[vox->state.rotation];
     const auto& xaxis = rot.axes[0];
@@ -104,7 +105,7 @@ void BlocksController::placeBlock(
 }
 
 void BlocksController::updateBlock(int x, int y, int z) {
-    voxel* vox = blocks_agent::get(chunks, x, y, z);
+    const voxel* vox = blocks_agent::get(chunks, x, y, z);
     if (vox == nullptr) return;
     const auto& def = level.content.getIndices()->blocks.require(vox->id);
     if (def.grounded) {
@@ -121,12 +122,15 @@ void BlocksController::updateBlock(int x, int y, int z) {
 
 void BlocksController::update(float delta, uint padding) {
     if (randTickClock.update(delta)) {
+        profiler::ScopedTimer timer(profiler::Section::RANDOM_TICKS);
         randomTick(randTickClock.getPart(), randTickClock.getParts(), padding);
     }
     if (blocksTickClock.update(delta)) {
+        profiler::ScopedTimer timer(profiler::Section::BLOCKS_TICK);
         onBlocksTick(blocksTickClock.getPart(), blocksTickClock.getParts());
     }
     if (worldTickClock.update(delta)) {
+        profiler::ScopedTimer timer(profiler::Section::WORLD_TICK);
         scripting::on_world_tick();
     }
 }
@@ -154,15 +158,20 @@ void BlocksController::randomTick(
             int bx = random.rand() % CHUNK_W;
             int by = random.rand() % segheight + s * segheight;
             int bz = random.rand() % CHUNK_D;
-            const voxel& vox = chunk.voxels[vox_index(bx, by, bz)];
+            const voxel& vox = chunk.voxels.get(vox_index(bx, by, bz));
             auto& block = indices->blocks.require(vox.id);
-            if (block.rt.funcsset.randupdate) {
-                scripting::random_update_block(
-                    block,
-                    glm::ivec3(
-                        chunk.x * CHUNK_W + bx, by, chunk.z * CHUNK_D + bz
-                    )
-                );
+            glm::ivec3 pos(chunk.x * CHUNK_W + bx, by, chunk.z * CHUNK_D + bz);
+            if (block.rt.funcsset.randupdatebatch) {
+                if (randomBatches.size() <= vox.id) {
+                    randomBatches.resize(indices->blocks.count());
+                }
+                auto& batch = randomBatches[vox.id];
+                if (batch.empty()) {
+                    randomBatchedBlocks.push_back(vox.id);
+                }
+                batch.push_back(pos);
+            } else if (block.rt.funcsset.randupdate) {
+                scripting::random_update_block(block, pos);
             }
         }
     }
@@ -170,16 +179,13 @@ void BlocksController::randomTick(
 
 void BlocksController::randomTick(int tickid, int parts, uint padding) {
     auto indices = level.content.getIndices();
+    int segments = 4;
 
-    std::set<uint64_t> chunksIterated;
-
+    randomTicks++;
     for (const auto& [pid, player] : *level.players) {
         const auto& chunks = *player->chunks;
-        int offsetX = chunks.getOffsetX();
-        int offsetY = chunks.getOffsetY();
         int width = chunks.getWidth();
         int height = chunks.getHeight();
-        int segments = 4;
 
         for (uint z = padding; z < height - padding; z++) {
             for (uint x = padding; x < width - padding; x++) {
@@ -191,20 +197,21 @@ void BlocksController::randomTick(int tickid, int parts, uint padding) {
                 if (chunk == nullptr || !chunk->flags.lighted) {
                     continue;
                 }
-                union {
-                    int32_t pos[2];
-                    uint64_t key;
-                } posU;
-                posU.pos[0] = x + offsetX;
-                posU.pos[1] = z + offsetY;
-                if (chunksIterated.find(posU.key) != chunksIterated.end()) {
+                // skip chunks ticked in areas of previous players
+                if (chunk->randomTickStamp == randomTicks) {
                     continue;
                 }
-                chunksIterated.insert(posU.key);
+                chunk->randomTickStamp = randomTicks;
                 randomTick(*chunk, segments, indices);
             }
         }
     }
+    for (auto id : randomBatchedBlocks) {
+        auto& batch = randomBatches[id];
+        scripting::random_update_blocks(indices->blocks.require(id), batch);
+        batch.clear();
+    }
+    randomBatchedBlocks.clear();
 }
 
 int64_t BlocksController::createBlockInventory(int x, int y, int z) {
@@ -219,7 +226,7 @@ int64_t BlocksController::createBlockInventory(int x, int y, int z) {
     auto inv = chunk->getBlockInventory(lx, y, lz);
     if (inv == nullptr) {
         const auto& indices = level.content.getIndices()->blocks;
-        auto& def = indices.require(chunk->voxels[vox_index(lx, y, lz)].id);
+        auto& def = indices.require(chunk->voxels.get(vox_index(lx, y, lz)).id);
         int invsize = def.inventorySize;
         if (invsize == 0) {
             return 0;
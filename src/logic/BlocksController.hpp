@@ -1,6 +1,7 @@
 #pragma once
 
 #include <functional>
+#include <vector>
 #include <glm/glm.hpp>
 
 #include "maths/fastmaths.hpp"
@@ -33,6 +34,15 @@ class BlocksController {
     util::Clock worldTickClock;
     FastRandom random {};
     std::vector<on_block_interaction> blockInteractionCallbacks;
+
+    /// @brief Number of random ticks done. Used to stamp chunks to not
+    /// tick chunks shared by multiple players twice
+    uint64_t randomTicks = 0;
+    /// @brief Random updates positions by block id collected for
+    /// on_random_update_batch
+    std::vector<std::vector<glm::ivec3>> randomBatches;
+    /// @brief Ids of blocks having random updates batched in the current tick
+    std::vector<blockid_t> randomBatchedBlocks;
 public:
     BlocksController(const Level& level, Lighting* lighting);
 
@@ -1,52 +1,197 @@
 #include "ChunksController.hpp"
 
 #include <limits.h>
+#include <algorithm>
 #include <memory>
 
 #include "content/Content.hpp"
+#include "debug/Logger.hpp"
+#include "debug/Profiler.hpp"
 #include "world/files/WorldFiles.hpp"
 #include "graphics/core/Mesh.hpp"
 #include "lighting/Lighting.hpp"
 #include "maths/voxmaths.hpp"
 #include "util/timeutil.hpp"
 #include "objects/Player.hpp"
+#include "objects/Players.hpp"
 #include "voxels/Block.hpp"
 #include "voxels/Chunk.hpp"
 #include "voxels/Chunks.hpp"
 #include "voxels/GlobalChunks.hpp"
 #include "world/Level.hpp"
+#include "world/LevelEvents.hpp"
 #include "world/World.hpp"
 #include "world/generator/WorldGenerator.hpp"
+#include "settings.hpp"
+
+static debug::Logger logger("chunks-control");
+
+namespace profiler = debug::profiler;
 
 const uint MAX_WORK_PER_FRAME = 128;
 const uint MIN_SURROUNDING = 9;
+/// @brief Max number of chunks enqueued to the loader pool
+const uint MAX_LOADING_CHUNKS = 64;
+
+/// @brief Set generated voxels to the chunk and prebuild sky light
+static void fill_generated(
+    Chunk& chunk, const voxel* voxels, const ContentIndices& indices
+) {
+    chunk.voxels.setAll(voxels);
+    chunk.flags.unsaved = true;
+    chunk.updateHeights();
+
+    if (!chunk.flags.loadedLights) {
+        Lighting::prebuildSkyLight(chunk, indices);
+    }
+}
+
+class ChunksLoaderWorker : public util::Worker<glm::ivec2, ChunkLoadResult> {
+    WorldRegions& regions;
+    const ContentIndices& indices;
+    WorldGenerator& generator;
+    std::mutex& generatorMutex;
+    std::unique_ptr<voxel[]> buffer;
+public:
+    ChunksLoaderWorker(
+        WorldRegions& regions,
+        const ContentIndices& indices,
+        WorldGenerator& generator,
+        std::mutex& generatorMutex
+    )
+        : regions(regions),
+          indices(indices),
+          generator(generator),
+          generatorMutex(generatorMutex),
+          buffer(std::make_unique<voxel[]>(CHUNK_VOL)) {
+    }
 
-ChunksController::ChunksController(Level& level)
+    ChunkLoadResult operator()(const glm::ivec2& key) override {
+        try {
+            auto loaded = GlobalChunks::load(regions, indices, key.x, key.y);
+            auto& chunk = *loaded.chunk;
+            bool generated = !chunk.flags.loaded;
+            if (generated) {
+                {
+                    std::lock_guard lock(generatorMutex);
+                    // throws if generator area has moved away since enqueued
+                    generator.generate(buffer.get(), chunk.x, chunk.z);
+                }
+                fill_generated(chunk, buffer.get(), indices);
+                chunk.flags.loaded = true;
+            }
+            return ChunkLoadResult {key, false, generated, std::move(loaded)};
+        } catch (const std::exception& err) {
+            logger.error() << "could not load chunk " << key.x << "x" << key.y
+                           << ": " << err.what();
+            return ChunkLoadResult {key, true, false, {}};
+        }
+    }
+};
+
+ChunksController::ChunksController(
+    Level& level, const ChunksSettings& settings
+)
     : level(level),
       generator(std::make_unique<WorldGenerator>(
           level.content.generators.require(level.getWorld()->getGenerator()),
           level.content,
-          level.getWorld()->getSeed()
-      )) {}
+          level.getWorld()->getSeed(),
+          settings.generatorThreads.get()
+      )),
+      voxelsBuffer(std::make_unique<voxel[]>(CHUNK_VOL)) {
+    int loadThreads = settings.loadThreads.get();
+    if (loadThreads == 0) {
+        return;
+    }
+    loaderPool = std::make_unique<util::ThreadPool<glm::ivec2, ChunkLoadResult>>(
+        "chunks-loader-pool",
+        [this]() {
+            return std::make_shared<ChunksLoaderWorker>(
+                level.getWorld()->wfile->getRegions(),
+                *level.content.getIndices(),
+                *generator,
+                generatorMutex
+            );
+        },
+        [this](ChunkLoadResult& result) {
+            inwork.erase(result.key);
+            if (stale.erase(result.key)) {
+                return;
+            }
+            if (result.failed) {
+                failed.insert(result.key);
+            } else {
+                if (result.generated) {
+                    profiler::increment(profiler::Counter::CHUNKS_GENERATED);
+                }
+                loaded[result.key] = std::move(result.loaded);
+            }
+        },
+        loadThreads
+    );
+    loaderPool->setStopOnFail(false);
+
+    unloadHandler = level.events->observe(
+        LevelEventType::CHUNK_UNLOAD,
+        [this](auto, Chunk* chunk) {
+            glm::ivec2 key(chunk->x, chunk->z);
+            loaded.erase(key);
+            if (inwork.find(key) != inwork.end()) {
+                stale.insert(key);
+            }
+        }
+    );
+    logger.info() << "created " << loaderPool->getWorkersCount()
+                  << " chunks loading workers";
+}
 
 ChunksController::~ChunksController() = default;
 
+WorldGenDebugInfo ChunksController::createGeneratorDebugInfo() const {
+    std::lock_guard lock(generatorMutex);
+    return generator->createDebugInfo();
+}
+
 void ChunksController::update(
     int64_t maxDuration, int loadDistance, uint padding, Player& player
-) const {
+) {
+    profiler::ScopedTimer chunksTimer(profiler::Section::CHUNKS);
+    if (lighting) {
+        profiler::ScopedTimer lightingTimer(profiler::Section::LIGHTING);
+        lighting->update();
+    }
+    if (loaderPool) {
+        loaderPool->update();
+        if (loaded.size() > MAX_LOADING_CHUNKS * 2) {
+            dropLoaded();
+        }
+    }
     const auto& position = player.getPosition();
     int centerX = floordiv<CHUNK_W>(glm::floor(position.x));
     int centerY = floordiv<CHUNK_D>(glm::floor(position.z));
     
-    if (player.isLoadingChunks()) {
+    if (!player.isLoadingChunks()) {
+        return;
+    }
+    // skip the update instead of waiting for a chunk being generated
+    // in background, the area will be moved next frame
+    if (std::unique_lock lock(generatorMutex, std::try_to_lock);
+        lock.owns_lock()) {
         /// FIXME: one generator for multiple players
         generator->update(centerX, centerY, loadDistance);
-    } else {
-        return;
     }
 
     int64_t mcstotal = 0;
 
+    if (lighting && lighting->hasDedicatedThread()) {
+        enqueueLights(player, padding);
+    } else if (lighting && lighting->getThreadsCount() > 1) {
+        timeutil::Timer timer;
+        buildLightsParallel(player, padding);
+        mcstotal += timer.stop();
+    }
+
     for (uint i = 0; i < MAX_WORK_PER_FRAME; i++) {
         timeutil::Timer timer;
         if (loadVisible(player, padding)) {
@@ -60,10 +205,12 @@ void ChunksController::update(
     }
 }
 
-bool ChunksController::loadVisible(const Player& player, uint padding) const {
+bool ChunksController::loadVisible(const Player& player, uint padding) {
     const auto& chunks = *player.chunks;
     int sizeX = chunks.getWidth();
     int sizeY = chunks.getHeight();
+    int offsetX = chunks.getOffsetX();
+    int offsetY = chunks.getOffsetY();
 
     int nearX = 0;
     int nearZ = 0;
@@ -74,13 +221,27 @@ bool ChunksController::loadVisible(const Player& player, uint padding) const {
             int index = z * sizeX + x;
             auto& chunk = chunks.getChunks()[index];
             if (chunk != nullptr) {
-                if (chunk->flags.loaded && !chunk->flags.lighted) {
+                if (chunk->flags.loaded && !chunk->flags.lighted &&
+                    !(lighting && lighting->hasDedicatedThread())) {
                     if (buildLights(player, chunk)) {
                         return true;
                     }
                 }
                 continue;
             }
+            glm::ivec2 key(x + offsetX, z + offsetY);
+            if (loaderPool) {
+                const auto& found = loaded.find(key);
+                if (found != loaded.end()) {
+                    auto loadedChunk = std::move(found->second);
+                    loaded.erase(found);
+                    integrateChunk(player, std::move(loadedChunk));
+                    return true;
+                }
+                if (inwork.find(key) != inwork.end()) {
+                    continue;
+                }
+            }
             int lx = x - sizeX / 2;
             int lz = z - sizeY / 2;
             int distance = (lx * lx + lz * lz);
@@ -97,29 +258,78 @@ bool ChunksController::loadVisible(const Player& player, uint padding) const {
     if (chunk != nullptr || !assigned || !player.isLoadingChunks()) {
         return false;
     }
-    int offsetX = chunks.getOffsetX();
-    int offsetY = chunks.getOffsetY();
-    createChunk(player, nearX + offsetX, nearZ + offsetY);
+    int chunkX = nearX + offsetX;
+    int chunkZ = nearZ + offsetY;
+    if (loaderPool && failed.find({chunkX, chunkZ}) == failed.end()) {
+        // chunk held by another player's matrix needs no region reading
+        if (auto chunk = level.chunks->fetch(chunkX, chunkZ)) {
+            player.chunks->putChunk(chunk);
+            completeChunk(*chunk);
+            return true;
+        }
+        return enqueueChunk(chunkX, chunkZ);
+    }
+    failed.erase({chunkX, chunkZ});
+    createChunk(player, chunkX, chunkZ);
     return true;
 }
 
-bool ChunksController::buildLights(
-    const Player& player, const std::shared_ptr<Chunk>& chunk
-) const {
-    int surrounding = 0;
+bool ChunksController::enqueueChunk(int x, int z) {
+    if (inwork.size() >= MAX_LOADING_CHUNKS) {
+        return false;
+    }
+    glm::ivec2 key(x, z);
+    inwork.insert(key);
+    loaderPool->enqueueJob(key);
+    return true;
+}
+
+void ChunksController::dropLoaded() {
+    for (auto it = loaded.begin(); it != loaded.end();) {
+        const auto& key = it->first;
+        bool visible = false;
+        for (const auto& [_, player] : *level.players) {
+            if (player->isSuspended() || !player->isLoadingChunks()) {
+                continue;
+            }
+            const auto& chunks = *player->chunks;
+            int minX = chunks.getOffsetX();
+            int minZ = chunks.getOffsetY();
+            if (key.x >= minX && key.y >= minZ &&
+                key.x < minX + chunks.getWidth() &&
+                key.y < minZ + chunks.getHeight()) {
+                visible = true;
+                break;
+            }
+        }
+        if (visible) {
+            ++it;
+        } else {
+            it = loaded.erase(it);
+        }
+    }
+}
+
+static bool is_surrounded(const Chunks& chunks, const Chunk& chunk) {
+    uint surrounding = 0;
     for (int oz = -1; oz <= 1; oz++) {
         for (int ox = -1; ox <= 1; ox++) {
-            if (player.chunks->getChunk(chunk->x + ox, chunk->z + oz))
+            if (chunks.getChunk(chunk.x + ox, chunk.z + oz))
                 surrounding++;
         }
     }
-    if (surrounding == MIN_SURROUNDING) {
+    return surrounding == MIN_SURROUNDING;
+}
+
+bool ChunksController::buildLights(
+    const Player& player, const std::shared_ptr<Chunk>& chunk
+) const {
+    if (is_surrounded(*player.chunks, *chunk)) {
         if (lighting) {
-            bool lightsCache = chunk->flags.loadedLights;
-            if (!lightsCache) {
-                lighting->buildSkyLight(chunk->x, chunk->z);
-            }
-            lighting->onChunkLoaded(chunk->x, chunk->z, !lightsCache);
+            profiler::ScopedTimer timer(profiler::Section::LIGHTING);
+            lighting->onChunkLoaded(
+                chunk->x, chunk->z, !chunk->flags.loadedLights
+            );
         }
         chunk->flags.lighted = true;
         return true;
@@ -127,6 +337,69 @@ bool ChunksController::buildLights(
     return false;
 }
 
+void ChunksController::buildLightsParallel(
+    const Player& player, uint padding
+) const {
+    const auto& chunks = *player.chunks;
+    int sizeX = chunks.getWidth();
+    int sizeY = chunks.getHeight();
+    size_t maxTasks = lighting->getThreadsCount();
+
+    std::vector<LightTask> tasks;
+    for (uint z = padding; z < sizeY - padding && tasks.size() < maxTasks; z++) {
+        for (uint x = padding; x < sizeX - padding && tasks.size() < maxTasks; x++) {
+            const auto& chunk = chunks.getChunks()[z * sizeX + x];
+            if (chunk == nullptr || !chunk->flags.loaded ||
+                chunk->flags.lighted || !is_surrounded(chunks, *chunk)) {
+                continue;
+            }
+            // lighting modifies neighbour chunks too,
+            // so neighbourhoods must not overlap
+            bool independent = std::all_of(
+                tasks.begin(), tasks.end(), [&chunk](const LightTask& task) {
+                    return std::abs(task.chunk->x - chunk->x) >= 3 ||
+                           std::abs(task.chunk->z - chunk->z) >= 3;
+                }
+            );
+            if (independent) {
+                tasks.push_back(
+                    LightTask {chunk.get(), !chunk->flags.loadedLights}
+                );
+            }
+        }
+    }
+    if (tasks.size() < 2) {
+        return;
+    }
+    profiler::ScopedTimer timer(profiler::Section::LIGHTING);
+    lighting->onChunksLoaded(tasks);
+    for (const auto& task : tasks) {
+        task.chunk->flags.lighted = true;
+    }
+}
+
+void ChunksController::enqueueLights(
+    const Player& player, uint padding
+) const {
+    const auto& chunks = *player.chunks;
+    int sizeX = chunks.getWidth();
+    int sizeY = chunks.getHeight();
+
+    for (uint z = padding; z < sizeY - padding; z++) {
+        for (uint x = padding; x < sizeX - padding; x++) {
+            if (lighting->isQueueFull()) {
+                return;
+            }
+            const auto& chunk = chunks.getChunks()[z * sizeX + x];
+            if (chunk == nullptr || !chunk->flags.loaded ||
+                chunk->flags.lighted || !is_surrounded(chunks, *chunk)) {
+                continue;
+            }
+            lighting->enqueueChunk(*chunk, !chunk->flags.loadedLights);
+        }
+    }
+}
+
 void ChunksController::createChunk(const Player& player, int x, int z) const {
     if (!player.isLoadingChunks()) {
         if (auto chunk = level.chunks->fetch(x, z)) {
@@ -136,16 +409,29 @@ void ChunksController::createChunk(const Player& player, int x, int z) const {
     }
     auto chunk = level.chunks->create(x, z);
     player.chunks->putChunk(chunk);
-    auto& chunkFlags = chunk->flags;
+    completeChunk(*chunk);
+}
 
-    if (!chunkFlags.loaded) {
-        generator->generate(chunk->voxels, x, z);
-        chunkFlags.unsaved = true;
-    }
-    chunk->updateHeights();
+void ChunksController::integrateChunk(
+    const Player& player, LoadedChunk loadedChunk
+) const {
+    auto chunk = level.chunks->integrate(std::move(loadedChunk));
+    player.chunks->putChunk(chunk);
+    completeChunk(*chunk);
+}
 
-    if (!chunkFlags.loadedLights) {
-        Lighting::prebuildSkyLight(*chunk, *level.content.getIndices());
+void ChunksController::completeChunk(Chunk& chunk) const {
+    auto& chunkFlags = chunk.flags;
+
+    profiler::increment(profiler::Counter::CHUNKS_LOADED);
+    if (!chunkFlags.loaded) {
+        // chunks loaded by loaderPool workers are already generated
+        profiler::increment(profiler::Counter::CHUNKS_GENERATED);
+        {
+            std::lock_guard lock(generatorMutex);
+            generator->generate(voxelsBuffer.get(), chunk.x, chunk.z);
+        }
+        fill_generated(chunk, voxelsBuffer.get(), *level.content.getIndices());
     }
     chunkFlags.loaded = true;
     chunkFlags.ready = true;
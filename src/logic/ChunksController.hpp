@@ -1,8 +1,18 @@
 #pragma once
 
 #include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+
+#include <glm/glm.hpp>
+#define GLM_ENABLE_EXPERIMENTAL
+#include <glm/gtx/hash.hpp>
 
 #include "typedefs.hpp"
+#include "util/ThreadPool.hpp"
+#include "util/observer_handler.hpp"
+#include "voxels/GlobalChunks.hpp"
 
 class Level;
 class Chunk;
@@ -10,29 +20,69 @@ class Chunks;
 class Player;
 class Lighting;
 class WorldGenerator;
+struct ChunksSettings;
+struct WorldGenDebugInfo;
+struct voxel;
+
+struct ChunkLoadResult {
+    glm::ivec2 key;
+    bool failed;
+    /// @brief Chunk was not found in regions and has been generated
+    bool generated;
+    LoadedChunk loaded;
+};
 
 /// @brief ChunksController manages chunks dynamic loading/unloading
 class ChunksController {
 private:
     Level& level;
     std::unique_ptr<WorldGenerator> generator;
+    /// @brief Guards generator used by loaderPool workers
+    mutable std::mutex generatorMutex;
+    /// @brief Voxels buffer for chunks generated on the main thread
+    std::unique_ptr<voxel[]> voxelsBuffer;
+
+    /// @brief Region files reading and decoding workers.
+    /// nullptr if chunks are loaded on the main thread
+    std::unique_ptr<util::ThreadPool<glm::ivec2, ChunkLoadResult>> loaderPool;
+    /// @brief Chunks enqueued to loaderPool
+    std::unordered_set<glm::ivec2> inwork;
+    /// @brief Decoded chunks waiting to be integrated into the level
+    std::unordered_map<glm::ivec2, LoadedChunk> loaded;
+    /// @brief Chunks failed to load in background (loaded on main thread)
+    std::unordered_set<glm::ivec2> failed;
+    /// @brief Chunks in work which were unloaded and saved since enqueued,
+    /// so their results are outdated
+    std::unordered_set<glm::ivec2> stale;
+    ObserverHandler unloadHandler;
 
     /// @brief Process one chunk: load it or calculate lights for it
-    bool loadVisible(const Player& player, uint padding) const;
+    bool loadVisible(const Player& player, uint padding);
     bool buildLights(const Player& player, const std::shared_ptr<Chunk>& chunk) const;
+    /// @brief Build lights of independent chunks in parallel
+    void buildLightsParallel(const Player& player, uint padding) const;
+    /// @brief Enqueue chunks to the dedicated lights thread
+    void enqueueLights(const Player& player, uint padding) const;
     void createChunk(const Player& player, int x, int y) const;
+    void integrateChunk(const Player& player, LoadedChunk loadedChunk) const;
+    /// @brief Generate chunk if not loaded and mark it ready
+    void completeChunk(Chunk& chunk) const;
+    bool enqueueChunk(int x, int z);
+    /// @brief Drop decoded chunks which are out of all loading players
+    /// chunks matrices
+    void dropLoaded();
 public:
     std::unique_ptr<Lighting> lighting;
 
-    ChunksController(Level& level);
+    ChunksController(Level& level, const ChunksSettings& settings);
     ~ChunksController();
 
     /// @param maxDuration milliseconds reserved for chunks loading
     void update(
         int64_t maxDuration, int loadDistance, uint padding, Player& player
-    ) const;
+    );
 
-    const WorldGenerator* getGenerator() const {
-        return generator.get();
-    }
+    /// @brief Create generator debug info (waits for chunk generating
+    /// in background)
+    WorldGenDebugInfo createGeneratorDebugInfo() const;
 };
@@ -3,6 +3,7 @@
 #include <algorithm>
 
 #include "debug/Logger.hpp"
+#include "debug/Profiler.hpp"
 #include "engine/Engine.hpp"
 #include "world/files/WorldFiles.hpp"
 #include "maths/voxmaths.hpp"
@@ -11,6 +12,7 @@
 #include "objects/Player.hpp"
 #include "physics/Hitbox.hpp"
 #include "voxels/Chunks.hpp"
+#include "voxels/GlobalChunks.hpp"
 #include "scripting/scripting.hpp"
 #include "lighting/Lighting.hpp"
 #include "settings.hpp"
@@ -20,14 +22,26 @@
 
 static debug::Logger logger("level-control");
 
+/// @brief Ticks without blocks modifications before chunk voxels get packed
+inline constexpr uint VOXELS_IDLE_TICKS = 600;
+/// @brief Max number of chunks with voxels packed per tick
+inline constexpr size_t VOXELS_COMPACT_BUDGET = 4;
+
+namespace profiler = debug::profiler;
+
 LevelController::LevelController(
     Engine* engine, std::unique_ptr<Level> levelPtr, Player* clientPlayer
 )
     : settings(engine->getSettings()),
       level(std::move(levelPtr)),
-      chunks(std::make_unique<ChunksController>(*level)),
+      chunks(std::make_unique<ChunksController>(
+          *level, settings.chunks
+      )),
       playerTickClock(20, 3) {
-    
+    level->getWorld()->wfile->getRegions().setCacheBudget(
+        static_cast<size_t>(settings.chunks.regionsCacheSize.get()) * 1024 * 1024
+    );
+
     level->events->listen(LevelEventType::CHUNK_PRESENT, [](auto, Chunk* chunk) {
         scripting::on_chunk_present(*chunk, chunk->flags.loaded);
     });
@@ -35,9 +49,12 @@ LevelController::LevelController(
         scripting::on_chunk_remove(*chunk);
     });
 
-    if (clientPlayer) {
+    if (clientPlayer || settings.chunks.serverLighting.get()) {
         chunks->lighting = std::make_unique<Lighting>(
-            level->content, *clientPlayer->chunks
+            level->content,
+            *level->chunks,
+            settings.chunks.lightThreads.get(),
+            settings.chunks.lightingThread.get()
         );
     }
     blocks = std::make_unique<BlocksController>(
@@ -69,6 +86,14 @@ LevelController::LevelController(
 }
 
 void LevelController::update(float delta, bool pause) {
+    // frame is finished here, so time spent between updates (e.g. saving)
+    // is accounted to the previous one
+    profiler::next_frame();
+    profiler::ScopedTimer tickTimer(profiler::Section::TICK);
+
+    // no voxel references are held between ticks
+    level->chunks->compactIdle(VOXELS_IDLE_TICKS, VOXELS_COMPACT_BUDGET);
+
     for (const auto& [_, player] : *level->players) {
         if (player->isSuspended()) {
             continue;
@@ -91,8 +116,14 @@ void LevelController::update(float delta, bool pause) {
     if (!pause) {
         // update all objects that needed
         blocks->update(delta, settings.chunks.padding.get());
-        level->entities->updatePhysics(delta);
-        level->entities->update(delta);
+        {
+            profiler::ScopedTimer timer(profiler::Section::PHYSICS);
+            level->entities->updatePhysics(delta);
+        }
+        {
+            profiler::ScopedTimer timer(profiler::Section::ENTITIES_UPDATE);
+            level->entities->update(delta);
+        }
         for (const auto& [_, player] : *level->players) {
             if (player->isSuspended()) {
                 continue;
@@ -107,6 +138,9 @@ void LevelController::update(float delta, bool pause) {
                         std::floor(position.y),
                         std::floor(position.z)
                     )){
+                        profiler::ScopedTimer timer(
+                            profiler::Section::PLAYER_TICK
+                        );
                         scripting::on_player_tick(
                             player.get(), playerTickClock.getTickRate()
                         );
@@ -124,6 +158,7 @@ void LevelController::saveWorld() {
         logger.info() << "nameless world will not be saved";
         return;
     }
+    profiler::ScopedTimer timer(profiler::Section::SAVING);
     logger.info() << "writing world '" << world->getName() << "'";
     world->wfile->createDirectories();
     scripting::on_world_save();
@@ -12,7 +12,9 @@ static int l_get_vel(lua::State* L) {
 
 static int l_set_vel(lua::State* L) {
     if (auto entity = get_entity(L, 1)) {
-        entity->getRigidbody().hitbox.velocity = lua::tovec3(L, 2);
+        auto& hitbox = entity->getRigidbody().hitbox;
+        hitbox.velocity = lua::tovec3(L, 2);
+        hitbox.wakeUp();
     }
     return 0;
 }
@@ -26,7 +28,9 @@ static int l_is_enabled(lua::State* L) {
 
 static int l_set_enabled(lua::State* L) {
     if (auto entity = get_entity(L, 1)) {
-        entity->getRigidbody().enabled = lua::toboolean(L, 2);
+        auto& body = entity->getRigidbody();
+        body.enabled = lua::toboolean(L, 2);
+        body.hitbox.wakeUp();
     }
     return 0;
 }
@@ -40,7 +44,7 @@ static int l_get_size(lua::State* L) {
 
 static int l_set_size(lua::State* L) {
     if (auto entity = get_entity(L, 1)) {
-        entity->getRigidbody().hitbox.halfsize = lua::tovec3(L, 2) * 0.5f;
+        entity->setHitboxSize(lua::tovec3(L, 2));
     }
     return 0;
 }
@@ -54,7 +58,9 @@ static int l_get_gravity_scale(lua::State* L) {
 
 static int l_set_gravity_scale(lua::State* L) {
     if (auto entity = get_entity(L, 1)) {
-        entity->getRigidbody().hitbox.gravityScale = lua::tonumber(L, 2);
+        auto& hitbox = entity->getRigidbody().hitbox;
+        hitbox.gravityScale = lua::tonumber(L, 2);
+        hitbox.wakeUp();
     }
     return 0;
 }
@@ -82,6 +88,13 @@ static int l_is_grounded(lua::State* L) {
     return 0;
 }
 
+static int l_is_sleeping(lua::State* L) {
+    if (auto entity = get_entity(L, 1)) {
+        return lua::pushboolean(L, entity->getRigidbody().hitbox.sleeping);
+    }
+    return 0;
+}
+
 static int l_is_crouching(lua::State* L) {
     if (auto entity = get_entity(L, 1)) {
         return lua::pushboolean(L, entity->getRigidbody().hitbox.crouching);
@@ -114,6 +127,7 @@ static int l_set_body_type(lua::State* L) {
                 "unknown body type " + util::quote(lua::tostring(L, 2))
             );
         }
+        entity->getRigidbody().hitbox.wakeUp();
     }
     return 0;
 }
@@ -146,6 +160,7 @@ const luaL_Reg rigidbodylib[] = {
     {"is_vdamping", lua::wrap<l_is_vdamping>},
     {"set_vdamping", lua::wrap<l_set_vdamping>},
     {"is_grounded", lua::wrap<l_is_grounded>},
+    {"is_sleeping", lua::wrap<l_is_sleeping>},
     {"is_crouching", lua::wrap<l_is_crouching>},
     {"set_crouching", lua::wrap<l_set_crouching>},
     {"get_body_type", lua::wrap<l_get_body_type>},
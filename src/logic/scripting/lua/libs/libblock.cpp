@@ -217,8 +217,10 @@ static int l_set_states(lua::State* L) {
     }
     int lx = x - cx * CHUNK_W;
     int lz = z - cz * CHUNK_D;
-    chunk->voxels[vox_index(lx, y, lz)].state = int2blockstate(states);
+    size_t index = vox_index(lx, y, lz);
+    chunk->voxels.ref(index).state = int2blockstate(states);
     chunk->setModifiedAndUnsaved();
+    chunk->recordDelta(index);
     return 0;
 }
 
@@ -260,25 +262,23 @@ static int l_set_user_bits(lua::State* L) {
     size_t mask = ((1 << bits) - 1) << offset;
     auto value = (lua::tointeger(L, 6) << offset) & mask;
 
-    int cx = floordiv<CHUNK_W>(x);
-    int cz = floordiv<CHUNK_D>(z);
-    auto chunk = blocks_agent::get_chunk(chunks, cx, cz);
-    if (chunk == nullptr || y < 0 || y >= CHUNK_H) {
+    glm::ivec3 pos(x, y, z);
+    auto vox = blocks_agent::get(chunks, x, y, z);
+    if (vox == nullptr) {
         return 0;
     }
-    int lx = x - cx * CHUNK_W;
-    int lz = z - cz * CHUNK_D;
-    auto vox = &chunk->voxels[vox_index(lx, y, lz)];
     const auto& def = content->getIndices()->blocks.require(vox->id);
     if (def.rt.extended) {
-        auto origin = blocks_agent::seek_origin(chunks, {x, y, z}, def, vox->state);
-        vox = blocks_agent::get(chunks, origin.x, origin.y, origin.z);
+        // origin may be located in a neighbour chunk
+        pos = blocks_agent::seek_origin(chunks, pos, def, vox->state);
+        vox = blocks_agent::get(chunks, pos.x, pos.y, pos.z);
         if (vox == nullptr) {
             return 0;
         }
     }
-    vox->state.userbits = (vox->state.userbits & (~mask)) | value;
-    chunk->setModifiedAndUnsaved();
+    auto state = vox->state;
+    state.userbits = (state.userbits & (~mask)) | value;
+    blocks_agent::set_state(chunks, pos.x, pos.y, pos.z, state);
     return 0;
 }
 
@@ -529,7 +529,7 @@ static int l_get_field(lua::State* L) {
     auto lz = z - cz * CHUNK_W;
     size_t voxelIndex = vox_index(lx, y, lz);
 
-    const auto& vox = chunk->voxels[voxelIndex];
+    const auto& vox = chunk->voxels.get(voxelIndex);
     const auto& def = content->getIndices()->blocks.require(vox.id);
     if (def.dataStruct == nullptr) {
         return 0;
@@ -598,7 +598,7 @@ static int l_set_field(lua::State* L) {
         return 0;
     }
     size_t voxelIndex = vox_index(lx, y, lz);
-    const auto& vox = chunk->voxels[voxelIndex];
+    const auto& vox = chunk->voxels.get(voxelIndex);
 
     const auto& def = content->getIndices()->blocks.require(vox.id);
     if (def.dataStruct == nullptr) {
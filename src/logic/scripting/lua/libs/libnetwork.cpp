@@ -119,16 +119,12 @@ static int l_closeserver(lua::State* L, network::Network& network) {
     return 0;
 }
 
-static int l_send(lua::State* L, network::Network& network) {
-    u64id_t id = lua::tointeger(L, 1);
-    auto connection = network.getConnection(id);
-    if (connection == nullptr ||
-        connection->getState() == network::ConnectionState::CLOSED) {
-        return 0;
-    }
-    if (lua::istable(L, 2)) {
-        lua::pushvalue(L, 2);
-        size_t size = lua::objlen(L, 2);
+/// @brief Call func with bytes of a table, string or Bytearray argument
+template <typename Func>
+static void with_bytes(lua::State* L, int idx, const Func& func) {
+    if (lua::istable(L, idx)) {
+        lua::pushvalue(L, idx);
+        size_t size = lua::objlen(L, idx);
         util::Buffer<char> buffer(size);
         for (size_t i = 0; i < size; i++) {
             lua::rawgeti(L, i + 1);
@@ -136,15 +132,27 @@ static int l_send(lua::State* L, network::Network& network) {
             lua::pop(L);
         }
         lua::pop(L);
-        connection->send(buffer.data(), size);
-    } else if (lua::isstring(L, 2)) {
-        auto string = lua::tolstring(L, 2);
-        connection->send(string.data(), string.length());
+        func(buffer.data(), size);
+    } else if (lua::isstring(L, idx)) {
+        auto string = lua::tolstring(L, idx);
+        func(string.data(), string.length());
     } else {
-        auto string = lua::bytearray_as_string(L, 2);
-        connection->send(string.data(), string.length());
+        auto string = lua::bytearray_as_string(L, idx);
+        func(string.data(), string.length());
         lua::pop(L);
     }
+}
+
+static int l_send(lua::State* L, network::Network& network) {
+    u64id_t id = lua::tointeger(L, 1);
+    auto connection = network.getConnection(id);
+    if (connection == nullptr ||
+        connection->getState() == network::ConnectionState::CLOSED) {
+        return 0;
+    }
+    with_bytes(L, 2, [connection](const char* data, size_t size) {
+        connection->send(data, size);
+    });
     return 0;
 }
 
@@ -155,23 +163,40 @@ static int l_recv(lua::State* L, network::Network& network) {
     if (connection == nullptr) {
         return 0;
     }
-    length = glm::min(length, connection->available());
-    util::Buffer<char> buffer(length);
-    
-    int size = connection->recv(buffer.data(), length);
-    if (size == -1) {
-        return 0;
-    }
+    length = glm::max(0, glm::min(length, connection->available()));
     if (lua::toboolean(L, 3)) {
+        util::Buffer<char> buffer(length);
+        int size = connection->recv(buffer.data(), length);
+        if (size == -1) {
+            return 0;
+        }
         lua::createtable(L, size, 0);
         for (size_t i = 0; i < size; i++) {
             lua::pushinteger(L, buffer[i] & 0xFF);
             lua::rawseti(L, i+1);
         }
         return 1;
-    } else {
-        return lua::create_bytearray(L, buffer.data(), size);
     }
+    // receive directly to the bytearray memory
+    auto& bytearray = lua::new_bytearray(L, length);
+    int size = connection->recv(
+        reinterpret_cast<char*>(bytearray.bytes), length
+    );
+    if (size == -1) {
+        lua::pop(L);
+        return 0;
+    }
+    bytearray.size = size;
+    return 1;
+}
+
+static int l_set_high_water_mark(lua::State* L, network::Network& network) {
+    u64id_t id = lua::tointeger(L, 1);
+    auto bytes = lua::tointeger(L, 2);
+    if (auto connection = network.getConnection(id)) {
+        connection->setHighWaterMark(glm::max<lua::Integer>(0, bytes));
+    }
+    return 0;
 }
 
 static int l_available(lua::State* L, network::Network& network) {
@@ -182,6 +207,88 @@ static int l_available(lua::State* L, network::Network& network) {
     return 0;
 }
 
+static int l_udp_bind(lua::State* L, network::Network& network) {
+    int port = lua::isnoneornil(L, 1) ? 0 : lua::tointeger(L, 1);
+    return lua::pushinteger(L, network.bind(port));
+}
+
+static int l_udp_send_to(lua::State* L, network::Network& network) {
+    u64id_t id = lua::tointeger(L, 1);
+    auto socket = network.getUdpSocket(id);
+    if (socket == nullptr || !socket->isOpen()) {
+        return 0;
+    }
+    auto address = lua::require_string(L, 2);
+    int port = lua::tointeger(L, 3);
+    int sent = 0;
+    with_bytes(L, 4, [&](const char* data, size_t size) {
+        sent = socket->sendTo(address, port, data, size);
+    });
+    return lua::pushinteger(L, sent);
+}
+
+static int l_udp_recv_from(lua::State* L, network::Network& network) {
+    u64id_t id = lua::tointeger(L, 1);
+    auto socket = network.getUdpSocket(id);
+    if (socket == nullptr || !socket->isOpen()) {
+        return 0;
+    }
+    size_t maxCount = lua::isnoneornil(L, 2) ? 64 : lua::tointeger(L, 2);
+    bool usetable = lua::toboolean(L, 3);
+    std::vector<network::Datagram> datagrams;
+    size_t count = socket->recvFrom(datagrams, maxCount);
+
+    lua::createtable(L, count, 0);
+    for (size_t i = 0; i < count; i++) {
+        const auto& datagram = datagrams[i];
+        lua::createtable(L, 0, 3);
+
+        lua::pushstring(L, datagram.address);
+        lua::setfield(L, "address");
+        lua::pushinteger(L, datagram.port);
+        lua::setfield(L, "port");
+
+        if (usetable) {
+            lua::createtable(L, datagram.data.size(), 0);
+            for (size_t j = 0; j < datagram.data.size(); j++) {
+                lua::pushinteger(L, datagram.data[j] & 0xFF);
+                lua::rawseti(L, j + 1);
+            }
+        } else {
+            lua::create_bytearray(
+                L, datagram.data.data(), datagram.data.size()
+            );
+        }
+        lua::setfield(L, "data");
+        lua::rawseti(L, i + 1);
+    }
+    return 1;
+}
+
+static int l_udp_close(lua::State* L, network::Network& network) {
+    u64id_t id = lua::tointeger(L, 1);
+    if (auto socket = network.getUdpSocket(id)) {
+        socket->close();
+    }
+    return 0;
+}
+
+static int l_udp_is_open(lua::State* L, network::Network& network) {
+    u64id_t id = lua::tointeger(L, 1);
+    if (auto socket = network.getUdpSocket(id)) {
+        return lua::pushboolean(L, socket->isOpen());
+    }
+    return lua::pushboolean(L, false);
+}
+
+static int l_udp_get_port(lua::State* L, network::Network& network) {
+    u64id_t id = lua::tointeger(L, 1);
+    if (auto socket = network.getUdpSocket(id)) {
+        return lua::pushinteger(L, socket->getPort());
+    }
+    return 0;
+}
+
 static int l_open(lua::State* L, network::Network& network) {
     int port = lua::tointeger(L, 1);
     lua::pushvalue(L, 2);
@@ -281,6 +388,13 @@ const luaL_Reg networklib[] = {
     {"__send", wrap<l_send>},
     {"__recv", wrap<l_recv>},
     {"__available", wrap<l_available>},
+    {"__set_high_water_mark", wrap<l_set_high_water_mark>},
+    {"__udp_bind", wrap<l_udp_bind>},
+    {"__udp_send_to", wrap<l_udp_send_to>},
+    {"__udp_recv_from", wrap<l_udp_recv_from>},
+    {"__udp_close", wrap<l_udp_close>},
+    {"__udp_is_open", wrap<l_udp_is_open>},
+    {"__udp_get_port", wrap<l_udp_get_port>},
     {"__is_alive", wrap<l_is_alive>},
     {"__is_connected", wrap<l_is_connected>},
     {"__get_address", wrap<l_get_address>},
@@ -0,0 +1,73 @@
+#include "debug/Profiler.hpp"
+#include "api_lua.hpp"
+
+using namespace debug::profiler;
+
+static Section require_section(lua::State* L, int idx) {
+    auto name = lua::require_lstring(L, idx);
+    Section section;
+    if (!get_section(name, section)) {
+        throw std::runtime_error(
+            "unknown profiler section '" + std::string(name) + "'"
+        );
+    }
+    return section;
+}
+
+static int l_sections(lua::State* L) {
+    lua::createtable(L, SECTIONS_COUNT, 0);
+    for (size_t i = 0; i < SECTIONS_COUNT; i++) {
+        lua::pushlstring(L, get_name(static_cast<Section>(i)));
+        lua::rawseti(L, i + 1);
+    }
+    return 1;
+}
+
+static int l_get(lua::State* L) {
+    auto stats = get_stats(require_section(L, 1));
+    lua::createtable(L, 0, 3);
+    lua::pushnumber(L, stats.last / 1e6);
+    lua::setfield(L, "last");
+    lua::pushnumber(L, stats.average / 1e6);
+    lua::setfield(L, "average");
+    lua::pushnumber(L, stats.max / 1e6);
+    lua::setfield(L, "max");
+    return 1;
+}
+
+static int l_history(lua::State* L) {
+    auto history = get_history(require_section(L, 1));
+    lua::createtable(L, history.size(), 0);
+    for (size_t i = 0; i < history.size(); i++) {
+        lua::pushnumber(L, history[i] / 1e6);
+        lua::rawseti(L, i + 1);
+    }
+    return 1;
+}
+
+static int l_start_trace(lua::State* L) {
+    if (lua::isnoneornil(L, 1)) {
+        start_trace();
+    } else {
+        start_trace(lua::touinteger(L, 1));
+    }
+    return 0;
+}
+
+static int l_is_tracing(lua::State* L) {
+    return lua::pushboolean(L, is_tracing());
+}
+
+static int l_stop_trace(lua::State* L) {
+    return lua::pushstring(L, stop_trace());
+}
+
+const luaL_Reg profilerlib[] = {
+    {"sections", lua::wrap<l_sections>},
+    {"get", lua::wrap<l_get>},
+    {"history", lua::wrap<l_history>},
+    {"start_trace", lua::wrap<l_start_trace>},
+    {"is_tracing", lua::wrap<l_is_tracing>},
+    {"stop_trace", lua::wrap<l_stop_trace>},
+    {NULL, NULL}
+};
@@ -16,6 +16,7 @@
 #include "voxels/Chunk.hpp"
 #include "voxels/Chunks.hpp"
 #include "voxels/GlobalChunks.hpp"
+#include "voxels/blocks_agent.hpp"
 #include "voxels/compressed_chunks.hpp"
 #include "world/Level.hpp"
 #include "world/World.hpp"
@@ -215,6 +216,67 @@ static int l_save_chunk_data(lua::State* L) {
     return 0;
 }
 
+static int l_pull_chunk_deltas(lua::State* L) {
+    if (level == nullptr) {
+        throw std::runtime_error("no open world");
+    }
+    int x = static_cast<int>(lua::tointeger(L, 1));
+    int z = static_cast<int>(lua::tointeger(L, 2));
+
+    auto chunk = level->chunks->getChunk(x, z);
+    if (chunk == nullptr) {
+        return 0;
+    }
+    if (chunk->deltas == nullptr) {
+        chunk->deltas = std::make_unique<ChunkDeltas>();
+    }
+    ByteBuilder builder;
+    if (!chunk->deltas->pull(builder)) {
+        return 0;
+    }
+    return lua::create_bytearray(L, builder.data(), builder.size());
+}
+
+static int l_apply_chunk_deltas(lua::State* L) {
+    if (level == nullptr) {
+        throw std::runtime_error("no open world");
+    }
+    int x = static_cast<int>(lua::tointeger(L, 1));
+    int z = static_cast<int>(lua::tointeger(L, 2));
+    auto buffer = lua::bytearray_as_string(L, 3);
+
+    auto chunk = level->chunks->getChunk(x, z);
+    if (chunk == nullptr) {
+        return lua::pushboolean(L, false);
+    }
+    Lighting* lighting = nullptr;
+    if (auto chunksController = controller->getChunksController()) {
+        lighting = chunksController->lighting.get();
+    }
+    // whole data is validated before the chunk gets modified
+    auto changes = ChunkDeltas::decode(
+        reinterpret_cast<const ubyte*>(buffer.data()), buffer.size()
+    );
+    size_t blocksCount = indices->blocks.count();
+    for (const auto& change : changes) {
+        if (change.vox.id >= blocksCount) {
+            throw std::runtime_error(
+                "unknown block id " + std::to_string(change.vox.id)
+            );
+        }
+    }
+    for (const auto& [index, vox] : changes) {
+        int gx = x * CHUNK_W + index % CHUNK_W;
+        int gy = index / (CHUNK_W * CHUNK_D);
+        int gz = z * CHUNK_D + index / CHUNK_W % CHUNK_D;
+        blocks_agent::set(*level->chunks, gx, gy, gz, vox.id, vox.state);
+        if (lighting) {
+            lighting->onBlockSet(gx, gy, gz, vox.id);
+        }
+    }
+    return lua::pushboolean(L, true);
+}
+
 static int l_count_chunks(lua::State* L) {
     if (level == nullptr) {
         return 0;
@@ -222,6 +284,39 @@ static int l_count_chunks(lua::State* L) {
     return lua::pushinteger(L, level->chunks->size());
 }
 
+static int l_get_regions_cache_stats(lua::State* L) {
+    if (level == nullptr) {
+        throw std::runtime_error("no open world");
+    }
+    static const char* layerNames[REGION_LAYERS_COUNT] {
+        "voxels", "lights", "inventories", "entities", "blocks_data"
+    };
+    auto& regions = level->getWorld()->wfile->getRegions();
+    lua::createtable(L, 0, REGION_LAYERS_COUNT);
+    for (uint i = 0; i < REGION_LAYERS_COUNT; i++) {
+        auto stats = regions.getCacheStats(static_cast<RegionLayerIndex>(i));
+        lua::createtable(L, 0, 5);
+
+        lua::pushinteger(L, stats.hits);
+        lua::setfield(L, "hits");
+
+        lua::pushinteger(L, stats.misses);
+        lua::setfield(L, "misses");
+
+        lua::pushinteger(L, stats.evictions);
+        lua::setfield(L, "evictions");
+
+        lua::pushinteger(L, stats.memoryUsage);
+        lua::setfield(L, "memory");
+
+        lua::pushinteger(L, stats.regions);
+        lua::setfield(L, "regions");
+
+        lua::setfield(L, layerNames[i]);
+    }
+    return 1;
+}
+
 static int l_reload_script(lua::State* L) {
     auto packid = lua::require_string(L, 1);
     if (content == nullptr) {
@@ -249,7 +344,10 @@ const luaL_Reg worldlib[] = {
     {"get_chunk_data", lua::wrap<l_get_chunk_data>},
     {"set_chunk_data", lua::wrap<l_set_chunk_data>},
     {"save_chunk_data", lua::wrap<l_save_chunk_data>},
+    {"pull_chunk_deltas", lua::wrap<l_pull_chunk_deltas>},
+    {"apply_chunk_deltas", lua::wrap<l_apply_chunk_deltas>},
     {"count_chunks", lua::wrap<l_count_chunks>},
+    {"get_regions_cache_stats", lua::wrap<l_get_regions_cache_stats>},
     {"reload_script", lua::wrap<l_reload_script>},
     {NULL, NULL}
 };
@@ -72,6 +72,7 @@ static void create_libs(State* L, StateType stateType) {
         openlib(L, "inventory", inventorylib);
         openlib(L, "network", networklib);
         openlib(L, "player", playerlib);
+        openlib(L, "profiler", profilerlib);
         openlib(L, "time", timelib);
         openlib(L, "world", worldlib);
 
@@ -115,6 +116,9 @@ void lua::init_state(State* L, StateType stateType) {
     createtable(L, 0, 0);
     setglobal(L, CHUNKS_TABLE);
 
+    createtable(L, 0, 0);
+    setglobal(L, EVENTS_TABLE);
+
     initialize_libs_extends(L);
 
     newusertype<LuaHeightmap>(L);
@@ -152,6 +156,30 @@ bool lua::emit_event(
     return false;
 }
 
+eventhandle_t lua::get_event_handle(State* L, const std::string& name) {
+    requireglobal(L, EVENTS_TABLE);
+    if (getfield(L, name)) {
+        auto handle = static_cast<eventhandle_t>(tointeger(L, -1));
+        pop(L, 2);
+        return handle;
+    }
+    requireglobal(L, "events");
+    requirefield(L, "handlers");
+    // handlers lists are never replaced by the events library
+    if (!getfield(L, name)) {
+        createtable(L, 0, 0);
+        pushvalue(L, -1);
+        setfield(L, name, -3);
+    }
+    auto handle = static_cast<eventhandle_t>(objlen(L, -4) + 1);
+    rawseti(L, handle, -4);
+    pop(L, 2);
+    pushinteger(L, handle);
+    setfield(L, name);
+    pop(L);
+    return handle;
+}
+
 State* lua::get_main_state() {
     return main_thread;
 }
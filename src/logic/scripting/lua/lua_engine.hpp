@@ -25,6 +25,37 @@ namespace lua {
         const std::string& name,
         std::function<int(State*)> args = [](auto*) { return 0; }
     );
+    /// @brief Resolve event name to a handle referring to the event
+    /// handlers list. Same name always gets the same handle
+    eventhandle_t get_event_handle(State* L, const std::string& name);
+
+    /// @brief Call event handlers by handle (same as events.emit)
+    /// @param args function pushing handlers arguments, returns their number
+    /// @return true if any handler returned true
+    template <typename ArgsFunc>
+    bool emit_event(State* L, eventhandle_t handle, const ArgsFunc& args) {
+        if (handle == 0) {
+            return false;
+        }
+        requireglobal(L, EVENTS_TABLE);
+        rawgeti(L, handle);
+        bool result = false;
+        for (int i = 1;; i++) {
+            int top = gettop(L);
+            rawgeti(L, i);
+            if (isnil(L, -1)) {
+                pop(L);
+                break;
+            }
+            if (call_nothrow(L, args(L)) && toboolean(L, top + 1)) {
+                result = true;
+            }
+            pop(L, gettop(L) - top);
+        }
+        pop(L, 2);
+        return result;
+    }
+
     State* get_main_state();
     State* create_state(const EnginePaths& paths, StateType stateType);
     [[nodiscard]] scriptenv create_environment(State* L);
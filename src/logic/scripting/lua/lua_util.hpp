@@ -15,6 +15,7 @@
 namespace lua {
     inline std::string LAMBDAS_TABLE = "$L";  // lambdas storage
     inline std::string CHUNKS_TABLE = "$C";   // precompiled lua chunks
+    inline std::string EVENTS_TABLE = "$E";   // event handlers by handle
     extern std::unordered_map<std::type_index, std::string> usertypeNames;
     int userdata_destructor(lua::State* L);
 
@@ -758,6 +759,25 @@ namespace lua {
         return create_bytearray(L, bytes.data(), bytes.size());
     }
 
+    /// @brief Memory layout of FFI Bytearray (core:internal/bytearray)
+    struct bytearray_t {
+        unsigned char* bytes;
+        int size;
+        int capacity;
+    };
+
+    /// @brief Push a new Bytearray of the given size to fill it in-place
+    /// @return reference to the bytearray valid while it's on the stack
+    inline bytearray_t& new_bytearray(lua::State* L, size_t size) {
+        lua::requireglobal(L, "Bytearray_construct");
+        lua::pushinteger(L, size);
+        lua::call(L, 1, 1);
+        // LuaJIT returns address of the cdata payload
+        return *static_cast<bytearray_t*>(
+            const_cast<void*>(lua::topointer(L, -1))
+        );
+    }
+
     inline std::string_view bytearray_as_string(lua::State* L, int idx) {
         lua::requireglobal(L, "Bytearray_as_string");
         lua::pushvalue(L, idx);
@@ -345,45 +345,64 @@ void scripting::cleanup() {
 }
 
 void scripting::on_blocks_tick(const Block& block, int tps) {
-    std::string name = block.name + ".blockstick";
-    lua::emit_event(lua::get_main_state(), name, [tps](auto L) {
-        return lua::pushinteger(L, tps);
-    });
+    lua::emit_event(
+        lua::get_main_state(),
+        block.rt.funcsset.onblockstick,
+        [tps](auto L) { return lua::pushinteger(L, tps); }
+    );
 }
 
 void scripting::update_block(const Block& block, const glm::ivec3& pos) {
-    std::string name = block.name + ".update";
-    lua::emit_event(lua::get_main_state(), name, [pos](auto L) {
-        return lua::pushivec_stack(L, pos);
-    });
+    lua::emit_event(
+        lua::get_main_state(),
+        block.rt.funcsset.update,
+        [&pos](auto L) { return lua::pushivec_stack(L, pos); }
+    );
 }
 
 void scripting::random_update_block(const Block& block, const glm::ivec3& pos) {
-    std::string name = block.name + ".randupdate";
-    lua::emit_event(lua::get_main_state(), name, [pos](auto L) {
-        return lua::pushivec_stack(L, pos);
-    });
+    lua::emit_event(
+        lua::get_main_state(),
+        block.rt.funcsset.randupdate,
+        [&pos](auto L) { return lua::pushivec_stack(L, pos); }
+    );
 }
 
-/// TODO: replace template with index
-template<bool WorldFuncsSet::*worldfunc>
+void scripting::random_update_blocks(
+    const Block& block, const std::vector<glm::ivec3>& positions
+) {
+    lua::emit_event(
+        lua::get_main_state(),
+        block.rt.funcsset.randupdatebatch,
+        [&positions](auto L) {
+            lua::createtable(L, positions.size() * 3, 0);
+            for (size_t i = 0; i < positions.size(); i++) {
+                const auto& pos = positions[i];
+                lua::pushinteger(L, pos.x);
+                lua::rawseti(L, i * 3 + 1);
+                lua::pushinteger(L, pos.y);
+                lua::rawseti(L, i * 3 + 2);
+                lua::pushinteger(L, pos.z);
+                lua::rawseti(L, i * 3 + 3);
+            }
+            return 1;
+        }
+    );
+}
+
+template <eventhandle_t WorldFuncsSet::*worldfunc>
 static bool on_block_common(
-    const std::string& suffix,
-    bool blockfunc,
+    eventhandle_t blockfunc,
     Player* player,
     const Block& block,
     const glm::ivec3& pos
 ) {
-    bool result = false;
-    if (blockfunc) {
-        std::string name = block.name + "." + suffix;
-        result =
-            lua::emit_event(lua::get_main_state(), name, [pos, player](auto L) {
-                lua::pushivec_stack(L, pos);
-                lua::pushinteger(L, player ? player->getId() : -1);
-                return 4;
-            });
-    }
+    auto L = lua::get_main_state();
+    bool result = lua::emit_event(L, blockfunc, [&pos, player](auto L) {
+        lua::pushivec_stack(L, pos);
+        lua::pushinteger(L, player ? player->getId() : -1);
+        return 4;
+    });
     auto args = [&](lua::State* L) {
         lua::pushinteger(L, block.rt.id);
         lua::pushivec_stack(L, pos);
@@ -391,11 +410,7 @@ static bool on_block_common(
         return 5;
     };
     for (auto& [packid, pack] : content->getPacks()) {
-        if (pack->worldfuncsset.*worldfunc) {
-            lua::emit_event(
-                lua::get_main_state(), packid + ":.block" + suffix, args
-            );
-        }
+        lua::emit_event(L, pack->worldfuncsset.*worldfunc, args);
     }
     return result;
 }
@@ -404,7 +419,7 @@ void scripting::on_block_placed(
     Player* player, const Block& block, const glm::ivec3& pos
 ) {
     on_block_common<&WorldFuncsSet::onblockplaced>(
-        "placed", block.rt.funcsset.onplaced, player, block, pos
+        block.rt.funcsset.onplaced, player, block, pos
     );
 }
 
@@ -412,7 +427,7 @@ void scripting::on_block_replaced(
     Player* player, const Block& block, const glm::ivec3& pos
 ) {
     on_block_common<&WorldFuncsSet::onblockreplaced>(
-        "replaced", block.rt.funcsset.onreplaced, player, block, pos
+        block.rt.funcsset.onreplaced, player, block, pos
     );
 }
 
@@ -420,7 +435,7 @@ void scripting::on_block_breaking(
     Player* player, const Block& block, const glm::ivec3& pos
 ) {
     on_block_common<&WorldFuncsSet::onblockbreaking>(
-        "breaking", block.rt.funcsset.onbreaking, player, block, pos
+        block.rt.funcsset.onbreaking, player, block, pos
     );
 }
 
@@ -428,7 +443,7 @@ void scripting::on_block_broken(
     Player* player, const Block& block, const glm::ivec3& pos
 ) {
     on_block_common<&WorldFuncsSet::onblockbroken>(
-        "broken", block.rt.funcsset.onbroken, player, block, pos
+        block.rt.funcsset.onbroken, player, block, pos
     );
 }
 
@@ -436,82 +451,56 @@ bool scripting::on_block_interact(
     Player* player, const Block& block, const glm::ivec3& pos
 ) {
     return on_block_common<&WorldFuncsSet::onblockinteract>(
-        "interact", block.rt.funcsset.oninteract, player, block, pos
+        block.rt.funcsset.oninteract, player, block, pos
     );
 }
 
+/// @brief Emit world script event of every content pack
+template <eventhandle_t WorldFuncsSet::*worldfunc, typename ArgsFunc>
+static void on_world_event(const ArgsFunc& args) {
+    auto L = lua::get_main_state();
+    for (auto& [packid, pack] : content->getPacks()) {
+        lua::emit_event(L, pack->worldfuncsset.*worldfunc, args);
+    }
+}
+
 void scripting::on_chunk_present(const Chunk& chunk, bool loaded) {
-    auto args = [&chunk, loaded](lua::State* L) {
+    on_world_event<&WorldFuncsSet::onchunkpresent>([&chunk, loaded](auto L) {
         lua::pushvec_stack<2>(L, {chunk.x, chunk.z});
         lua::pushboolean(L, loaded);
         return 3;
-    };
-    for (auto& [packid, pack] : content->getPacks()) {
-        if (pack->worldfuncsset.onchunkpresent) {
-            lua::emit_event(
-                lua::get_main_state(), packid + ":.chunkpresent", args
-            );
-        }
-    }
+    });
 }
 
 void scripting::on_chunk_remove(const Chunk& chunk) {
-    auto args = [&chunk](lua::State* L) {
+    on_world_event<&WorldFuncsSet::onchunkremove>([&chunk](auto L) {
         lua::pushvec_stack<2>(L, {chunk.x, chunk.z});
         return 2;
-    };
-    for (auto& [packid, pack] : content->getPacks()) {
-        if (pack->worldfuncsset.onchunkremove) {
-            lua::emit_event(
-                lua::get_main_state(), packid + ":.chunkremove", args
-            );
-        }
-    }
+    });
 }
 
 void scripting::on_inventory_open(const Player* player, const Inventory& inventory) {
-    auto args = [player, &inventory](lua::State* L) {
+    on_world_event<&WorldFuncsSet::oninventoryopen>([player, &inventory](auto L) {
         lua::pushinteger(L, inventory.getId());
         lua::pushinteger(L, player ? player->getId() : -1);
         return 2;
-    };
-    for (auto& [packid, pack] : content->getPacks()) {
-        if (pack->worldfuncsset.oninventoryopen) {
-            lua::emit_event(
-                lua::get_main_state(), packid + ":.inventoryopen", args
-            );
-        }
-    }
+    });
 }
 
 void scripting::on_inventory_closed(const Player* player, const Inventory& inventory) {
-    auto args = [player, &inventory](lua::State* L) {
+    on_world_event<&WorldFuncsSet::oninventoryclosed>([player, &inventory](auto L) {
         lua::pushinteger(L, inventory.getId());
         lua::pushinteger(L, player ? player->getId() : -1);
         return 2;
-    };
-    for (auto& [packid, pack] : content->getPacks()) {
-        if (pack->worldfuncsset.oninventoryclosed) {
-            lua::emit_event(
-                lua::get_main_state(), packid + ":.inventoryclosed", args
-            );
-        }
-    }
+    });
 }
 
 void scripting::on_player_tick(Player* player, int tps) {
-    auto args = [=](lua::State* L) {
+    on_world_event<&WorldFuncsSet::onplayertick>([=](auto L) {
         lua::pushinteger(L, player ? player->getId() : -1);
         lua::pushinteger(L, tps);
         return 2;
-    };
-    for (auto& [packid, pack] : content->getPacks()) {
-        if (pack->worldfuncsset.onplayertick) {
-            lua::emit_event(
-                lua::get_main_state(), packid + ":.playertick", args
-            );
-        }
-    }
+    });
 }
 
 bool scripting::on_item_use(Player* player, const ItemDef& item) {
@@ -848,6 +837,17 @@ bool scripting::register_event(
     return success;
 }
 
+/// @brief Register event and resolve its handle
+/// @return event handle or 0 if the function is not defined
+static eventhandle_t register_event_handle(
+    int env, const std::string& name, const std::string& id
+) {
+    if (!scripting::register_event(env, name, id)) {
+        return 0;
+    }
+    return lua::get_event_handle(lua::get_main_state(), id);
+}
+
 int scripting::get_values_on_stack() {
     return lua::gettop(lua::get_main_state());
 }
@@ -863,20 +863,27 @@ void scripting::load_content_script(
     lua::pop(lua::get_main_state(), load_script(env, "block", file, fileName));
 
     funcsset = {};
-    funcsset.init = register_event(env, "init", prefix + ".init");
-    funcsset.update = register_event(env, "on_update", prefix + ".update");
-    funcsset.randupdate =
-        register_event(env, "on_random_update", prefix + ".randupdate");
+    funcsset.init = register_event_handle(env, "init", prefix + ".init");
+    funcsset.update =
+        register_event_handle(env, "on_update", prefix + ".update");
+    funcsset.randupdate = register_event_handle(
+        env, "on_random_update", prefix + ".randupdate"
+    );
+    funcsset.randupdatebatch = register_event_handle(
+        env, "on_random_update_batch", prefix + ".randupdatebatch"
+    );
     funcsset.onbreaking =
-        register_event(env, "on_breaking", prefix + ".breaking");
-    funcsset.onbroken = register_event(env, "on_broken", prefix + ".broken");
-    funcsset.onplaced = register_event(env, "on_placed", prefix + ".placed");
+        register_event_handle(env, "on_breaking", prefix + ".breaking");
+    funcsset.onbroken =
+        register_event_handle(env, "on_broken", prefix + ".broken");
+    funcsset.onplaced =
+        register_event_handle(env, "on_placed", prefix + ".placed");
     funcsset.onreplaced =
-        register_event(env, "on_replaced", prefix + ".replaced");
+        register_event_handle(env, "on_replaced", prefix + ".replaced");
     funcsset.oninteract =
-        register_event(env, "on_interact", prefix + ".interact");
+        register_event_handle(env, "on_interact", prefix + ".interact");
     funcsset.onblockstick =
-        register_event(env, "on_blocks_tick", prefix + ".blockstick");
+        register_event_handle(env, "on_blocks_tick", prefix + ".blockstick");
 }
 
 void scripting::load_content_script(
@@ -924,26 +931,36 @@ void scripting::load_world_script(
     register_event(env, "on_world_tick", prefix + ":.worldtick");
     register_event(env, "on_world_save", prefix + ":.worldsave");
     register_event(env, "on_world_quit", prefix + ":.worldquit");
-    funcsset.onblockplaced =
-        register_event(env, "on_block_placed", prefix + ":.blockplaced");
-    funcsset.onblockbreaking =
-        register_event(env, "on_block_breaking", prefix + ":.blockbreaking");
-    funcsset.onblockbroken =
-        register_event(env, "on_block_broken", prefix + ":.blockbroken");
-    funcsset.onblockreplaced =
-        register_event(env, "on_block_replaced", prefix + ":.blockreplaced");
-    funcsset.onblockinteract =
-        register_event(env, "on_block_interact", prefix + ":.blockinteract");
-    funcsset.onplayertick =
-        register_event(env, "on_player_tick", prefix + ":.playertick");
-    funcsset.onchunkpresent =
-        register_event(env, "on_chunk_present", prefix + ":.chunkpresent");
-    funcsset.onchunkremove =
-        register_event(env, "on_chunk_remove", prefix + ":.chunkremove");
-    funcsset.oninventoryopen =
-        register_event(env, "on_inventory_open", prefix + ":.inventoryopen");
-    funcsset.oninventoryclosed =
-        register_event(env, "on_inventory_closed", prefix + ":.inventoryclosed");
+    funcsset.onblockplaced = register_event_handle(
+        env, "on_block_placed", prefix + ":.blockplaced"
+    );
+    funcsset.onblockbreaking = register_event_handle(
+        env, "on_block_breaking", prefix + ":.blockbreaking"
+    );
+    funcsset.onblockbroken = register_event_handle(
+        env, "on_block_broken", prefix + ":.blockbroken"
+    );
+    funcsset.onblockreplaced = register_event_handle(
+        env, "on_block_replaced", prefix + ":.blockreplaced"
+    );
+    funcsset.onblockinteract = register_event_handle(
+        env, "on_block_interact", prefix + ":.blockinteract"
+    );
+    funcsset.onplayertick = register_event_handle(
+        env, "on_player_tick", prefix + ":.playertick"
+    );
+    funcsset.onchunkpresent = register_event_handle(
+        env, "on_chunk_present", prefix + ":.chunkpresent"
+    );
+    funcsset.onchunkremove = register_event_handle(
+        env, "on_chunk_remove", prefix + ":.chunkremove"
+    );
+    funcsset.oninventoryopen = register_event_handle(
+        env, "on_inventory_open", prefix + ":.inventoryopen"
+    );
+    funcsset.oninventoryclosed = register_event_handle(
+        env, "on_inventory_closed", prefix + ":.inventoryclosed"
+    );
 }
 
 void scripting::load_layout_script(
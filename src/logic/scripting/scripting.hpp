@@ -77,6 +77,14 @@ namespace scripting {
     void on_blocks_tick(const Block& block, int tps);
     void update_block(const Block& block, const glm::ivec3& pos);
     void random_update_block(const Block& block, const glm::ivec3& pos);
+
+    /// @brief Call on_random_update_batch of the block with flat array
+    /// of the tick random updates coordinates {x1, y1, z1, x2, ...}.
+    /// Positions are collected before the call, so blocks there may be
+    /// already replaced by the callback itself
+    void random_update_blocks(
+        const Block& block, const std::vector<glm::ivec3>& positions
+    );
     void on_block_placed(
         Player* player, const Block& block, const glm::ivec3& pos
     );
@@ -69,6 +69,13 @@ public:
         }
     }
 
+    std::unique_ptr<GeneratorScript> clone() const override {
+        auto state = create_state(
+            Engine::getInstance().getPaths(), StateType::GENERATOR
+        );
+        return std::make_unique<LuaGeneratorScript>(state, def, file, dirPath);
+    }
+
     std::shared_ptr<Heightmap> generateHeightmap(
         const glm::ivec2& offset,
         const glm::ivec2& size,
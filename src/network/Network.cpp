@@ -6,6 +6,8 @@
 #include <curl/curl.h>
 #include <stdexcept>
 #include <limits>
+#include <atomic>
+#include <condition_variable>
 #include <queue>
 #include <thread>
 
@@ -27,6 +29,8 @@ using SOCKET = int;
 
 #include "debug/Logger.hpp"
 #include "util/stringutil.hpp"
+#include "util/RingBuffer.hpp"
+#include "Reactor.hpp"
 
 using namespace network;
 
@@ -291,6 +295,90 @@ static std::string to_string(const sockaddr_in& addr, bool port=true) {
     return "";
 }
 
+static sockaddr_in resolve_address(const std::string& address, int port) {
+    sockaddr_in serverAddress {};
+    serverAddress.sin_family = AF_INET;
+    serverAddress.sin_port = htons(port);
+    // numeric addresses don't need a lookup
+    if (inet_pton(AF_INET, address.c_str(), &serverAddress.sin_addr) == 1) {
+        return serverAddress;
+    }
+    addrinfo hints {};
+
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+
+    addrinfo* addrinfo = nullptr;
+    if (int res = getaddrinfo(
+        address.c_str(), nullptr, &hints, &addrinfo
+    )) {
+        throw std::runtime_error(gai_strerror(res));
+    }
+
+    std::memcpy(&serverAddress, addrinfo->ai_addr, sizeof(sockaddr_in));
+    serverAddress.sin_port = htons(port);
+    freeaddrinfo(addrinfo);
+    return serverAddress;
+}
+
+/// @brief Create server socket bound to the port
+/// @param port port to bind or 0 to bind any free port. Set to the bound
+/// port on success
+static SOCKET open_server_socket(int& port) {
+    SOCKET descriptor = socket(
+        AF_INET, SOCK_STREAM, 0
+    );
+    if (descriptor == -1) {
+        throw std::runtime_error("Could not create server socket");
+    }
+    int opt = 1;
+    int flags = SO_REUSEADDR;
+#   ifndef _WIN32
+        flags |= SO_REUSEPORT;
+#   endif
+    if (setsockopt(descriptor, SOL_SOCKET, flags, (const char*)&opt, sizeof(opt))) {
+        closesocket(descriptor);
+        throw std::runtime_error("setsockopt");
+    }
+    sockaddr_in address {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = INADDR_ANY;
+    address.sin_port = htons(port);
+    socklen_t addrlen = sizeof(address);
+    if (bind(descriptor, (sockaddr*)&address, addrlen) < 0 ||
+        getsockname(descriptor, (sockaddr*)&address, &addrlen) < 0) {
+        closesocket(descriptor);
+        throw std::runtime_error("could not bind port "+std::to_string(port));
+    }
+    port = htons(address.sin_port);
+    logger.info() << "opened server at port " << port;
+    return descriptor;
+}
+
+static void set_nonblocking(SOCKET descriptor) {
+#ifdef _WIN32
+    u_long mode = 1;
+    if (ioctlsocket(descriptor, FIONBIO, &mode)) {
+        throw handle_socket_error("ioctlsocket(FIONBIO)");
+    }
+#else
+    int flags = fcntl(descriptor, F_GETFL, 0);
+    if (flags == -1 || fcntl(descriptor, F_SETFL, flags | O_NONBLOCK) == -1) {
+        throw handle_socket_error("fcntl(O_NONBLOCK)");
+    }
+#endif
+}
+
+/// @brief Check if the last non-blocking socket operation failed because
+/// it would block
+static bool would_block() {
+#ifdef _WIN32
+    return WSAGetLastError() == WSAEWOULDBLOCK;
+#else
+    return errno == EAGAIN || errno == EWOULDBLOCK;
+#endif
+}
+
 class SocketConnection : public Connection {
     SOCKET descriptor;
     sockaddr_in addr;
@@ -298,9 +386,16 @@ class SocketConnection : public Connection {
     size_t totalDownload = 0;
     ConnectionState state = ConnectionState::INITIAL;
     std::unique_ptr<std::thread> thread = nullptr;
-    std::vector<char> readBatch;
+    util::RingBuffer<char> readBuffer;
     util::Buffer<char> buffer;
+    size_t highWaterMark = 0;
     std::mutex mutex;
+    /// @brief Notified when buffered data is read or socket is closed
+    std::condition_variable readCondition;
+
+    bool isReadBufferFull() const {
+        return highWaterMark && readBuffer.size() >= highWaterMark;
+    }
 
     void connectSocket() {
         state = ConnectionState::CONNECTING;
@@ -331,6 +426,13 @@ public:
 
     void startListen() {
         while (state == ConnectionState::CONNECTED) {
+            {
+                std::unique_lock lock(mutex);
+                readCondition.wait(lock, [this]() {
+                    return !isReadBufferFull() ||
+                           state != ConnectionState::CONNECTED;
+                });
+            }
             int size = recvsocket(descriptor, buffer.data(), buffer.size());
             if (size == 0) {
                 logger.info() << "closed connection with " << to_string(addr);
@@ -348,9 +450,7 @@ public:
             }
             {
                 std::lock_guard lock(mutex);
-                for (size_t i = 0; i < size; i++) {
-                    readBatch.emplace_back(buffer[i]);
-                }
+                readBuffer.put(buffer.data(), size);
                 totalDownload += size;
             }
             logger.debug() << "read " << size << " bytes from " << to_string(addr);
@@ -375,12 +475,11 @@ public:
     int recv(char* buffer, size_t length) override {
         std::lock_guard lock(mutex);
 
-        if (state != ConnectionState::CONNECTED && readBatch.empty()) {
+        if (state != ConnectionState::CONNECTED && readBuffer.empty()) {
             return -1;
         }
-        int size = std::min(readBatch.size(), length);
-        std::memcpy(buffer, readBatch.data(), size);
-        readBatch.erase(readBatch.begin(), readBatch.begin() + size);
+        int size = readBuffer.get(buffer, length);
+        readCondition.notify_one();
         return size;
     }
 
@@ -403,18 +502,25 @@ public:
 
     int available() override {
         std::lock_guard lock(mutex);
-        return readBatch.size();
+        return readBuffer.size();
+    }
+
+    void setHighWaterMark(size_t bytes) override {
+        std::lock_guard lock(mutex);
+        highWaterMark = bytes;
+        readCondition.notify_one();
     }
 
     void close(bool discardAll=false) override {
         {
             std::lock_guard lock(mutex);
-            readBatch.clear();
+            readBuffer.clear();
 
             if (state != ConnectionState::CLOSED) {
                 shutdown(descriptor, 2);
                 closesocket(descriptor);
             }
+            readCondition.notify_one();
         }
         if (thread) {
             thread->join();
@@ -445,23 +551,7 @@ public:
     static std::shared_ptr<SocketConnection> connect(
         const std::string& address, int port, runnable callback
     ) {
-        addrinfo hints {};
-
-        hints.ai_family = AF_INET;
-        hints.ai_socktype = SOCK_STREAM;
-
-        addrinfo* addrinfo = nullptr;
-        if (int res = getaddrinfo(
-            address.c_str(), nullptr, &hints, &addrinfo
-        )) {
-            throw std::runtime_error(gai_strerror(res));
-        }
-
-        sockaddr_in serverAddress;
-        std::memcpy(&serverAddress, addrinfo->ai_addr, sizeof(sockaddr_in));
-        serverAddress.sin_port = htons(port);
-        freeaddrinfo(addrinfo);
-
+        auto serverAddress = resolve_address(address, port);
         SOCKET descriptor = socket(AF_INET, SOCK_STREAM, 0);
         if (descriptor == -1) {
             throw std::runtime_error("Could not create socket");
@@ -560,37 +650,616 @@ public:
     static std::shared_ptr<SocketTcpSServer> openServer(
         Network* network, int port, consumer<u64id_t> handler
     ) {
-        SOCKET descriptor = socket(
-            AF_INET, SOCK_STREAM, 0
+        SOCKET descriptor = open_server_socket(port);
+        auto server =
+            std::make_shared<SocketTcpSServer>(network, descriptor, port);
+        server->startListen(std::move(handler));
+        return server;
+    }
+};
+
+/// @brief Maximum number of datagrams received per system call
+inline constexpr size_t UDP_BATCH_SIZE = 32;
+/// @brief Maximum size of received datagram. Larger ones are dropped
+inline constexpr size_t UDP_DATAGRAM_SIZE = 4096;
+
+/// @brief Non-blocking UDP socket. Datagrams are kept in the system socket
+/// buffer until polled, so no I/O thread is needed
+class DatagramSocket : public UdpSocket {
+    SOCKET descriptor;
+    int port;
+    bool open = true;
+    size_t totalUpload = 0;
+    size_t totalDownload = 0;
+    /// @brief Receive buffer split into UDP_BATCH_SIZE slots
+    util::Buffer<char> buffer;
+
+    /// @brief Copy received datagram to the destination list
+    void push(
+        std::vector<Datagram>& dst,
+        size_t index,
+        const sockaddr_in& addr,
+        const char* data,
+        size_t size
+    ) {
+        if (index == dst.size()) {
+            dst.emplace_back();
+        }
+        auto& datagram = dst[index];
+        datagram.address = to_string(addr, false);
+        datagram.port = htons(addr.sin_port);
+        datagram.data.assign(data, data + size);
+        totalDownload += size;
+    }
+
+#ifdef __linux__
+    /// @brief Receive a batch of datagrams with one recvmmsg call
+    /// @return number of received datagrams or -1 if nothing is pending
+    int receiveBatch(std::vector<Datagram>& dst, size_t offset, size_t count) {
+        mmsghdr messages[UDP_BATCH_SIZE] {};
+        iovec vectors[UDP_BATCH_SIZE];
+        sockaddr_in addresses[UDP_BATCH_SIZE];
+        for (size_t i = 0; i < count; i++) {
+            vectors[i].iov_base = buffer.data() + i * UDP_DATAGRAM_SIZE;
+            vectors[i].iov_len = UDP_DATAGRAM_SIZE;
+            auto& header = messages[i].msg_hdr;
+            header.msg_name = &addresses[i];
+            header.msg_namelen = sizeof(sockaddr_in);
+            header.msg_iov = &vectors[i];
+            header.msg_iovlen = 1;
+        }
+        int received = recvmmsg(descriptor, messages, count, 0, nullptr);
+        if (received <= 0) {
+            return -1;
+        }
+        size_t written = 0;
+        for (int i = 0; i < received; i++) {
+            if (messages[i].msg_hdr.msg_flags & MSG_TRUNC) {
+                logger.warning() << "dropped too large datagram from "
+                                 << to_string(addresses[i]);
+                continue;
+            }
+            push(
+                dst,
+                offset + written++,
+                addresses[i],
+                buffer.data() + i * UDP_DATAGRAM_SIZE,
+                messages[i].msg_len
+            );
+        }
+        return written;
+    }
+#else
+    int receiveBatch(std::vector<Datagram>& dst, size_t offset, size_t count) {
+        size_t written = 0;
+        for (size_t i = 0; i < count; i++) {
+            sockaddr_in addr;
+            socklen_t addrlen = sizeof(sockaddr_in);
+            int size = recvfrom(
+                descriptor,
+                buffer.data(),
+                UDP_DATAGRAM_SIZE,
+                0,
+                (sockaddr*)&addr,
+                &addrlen
+            );
+            if (size < 0) {
+                break;
+            }
+            push(dst, offset + written++, addr, buffer.data(), size);
+        }
+        return written ? static_cast<int>(written) : -1;
+    }
+#endif
+public:
+    DatagramSocket(SOCKET descriptor, int port)
+        : descriptor(descriptor),
+          port(port),
+          buffer(UDP_BATCH_SIZE * UDP_DATAGRAM_SIZE) {
+    }
+
+    ~DatagramSocket() {
+        close();
+    }
+
+    int sendTo(
+        const std::string& address,
+        int port,
+        const char* buffer,
+        size_t length
+    ) override {
+        if (!open) {
+            return 0;
+        }
+        auto addr = resolve_address(address, port);
+        int len = sendto(
+            descriptor, buffer, length, 0, (const sockaddr*)&addr, sizeof(addr)
         );
+        if (len < 0) {
+            if (would_block()) {
+                return 0;
+            }
+            throw handle_socket_error("sendto(...) error");
+        }
+        totalUpload += len;
+        return len;
+    }
+
+    size_t recvFrom(std::vector<Datagram>& dst, size_t maxCount) override {
+        size_t count = 0;
+        while (open && count < maxCount) {
+            size_t batch = std::min(maxCount - count, UDP_BATCH_SIZE);
+            int received = receiveBatch(dst, count, batch);
+            if (received < 0) {
+                break;
+            }
+            count += received;
+        }
+        return count;
+    }
+
+    void close() override {
+        if (!open) {
+            return;
+        }
+        open = false;
+        closesocket(descriptor);
+    }
+
+    bool isOpen() const override {
+        return open;
+    }
+
+    size_t pullUpload() override {
+        size_t size = totalUpload;
+        totalUpload = 0;
+        return size;
+    }
+
+    size_t pullDownload() override {
+        size_t size = totalDownload;
+        totalDownload = 0;
+        return size;
+    }
+
+    int getPort() const override {
+        return port;
+    }
+
+    static std::shared_ptr<DatagramSocket> bind(int port) {
+        SOCKET descriptor = socket(AF_INET, SOCK_DGRAM, 0);
         if (descriptor == -1) {
-            throw std::runtime_error("Could not create server socket");
-        }
-        int opt = 1;
-        int flags = SO_REUSEADDR;
-#       ifndef _WIN32
-            flags |= SO_REUSEPORT;
-#       endif
-        if (setsockopt(descriptor, SOL_SOCKET, flags, (const char*)&opt, sizeof(opt))) {
-            closesocket(descriptor);
-            throw std::runtime_error("setsockopt");
+            throw std::runtime_error("Could not create socket");
         }
-        sockaddr_in address;
+        sockaddr_in address {};
         address.sin_family = AF_INET;
         address.sin_addr.s_addr = INADDR_ANY;
         address.sin_port = htons(port);
-        if (bind(descriptor, (sockaddr*)&address, sizeof(address)) < 0) {
+        socklen_t addrlen = sizeof(address);
+        if (::bind(descriptor, (sockaddr*)&address, addrlen) < 0 ||
+            getsockname(descriptor, (sockaddr*)&address, &addrlen) < 0) {
             closesocket(descriptor);
             throw std::runtime_error("could not bind port "+std::to_string(port));
         }
-        logger.info() << "opened server at port " << port;
-        auto server =
-            std::make_shared<SocketTcpSServer>(network, descriptor, port);
-        server->startListen(std::move(handler));
+        try {
+            set_nonblocking(descriptor);
+        } catch (const std::exception&) {
+            closesocket(descriptor);
+            throw;
+        }
+        port = htons(address.sin_port);
+        logger.info() << "opened udp socket at port " << port;
+        return std::make_shared<DatagramSocket>(descriptor, port);
+    }
+};
+
+#ifdef __linux__
+
+/// @brief Minimal free space of the read buffer for each recv call
+/// in the I/O thread
+inline constexpr size_t REACTOR_READ_BUFFER_SIZE = 16'384;
+/// @brief Max size of data queued for sending. Connection is closed if
+/// the peer does not read fast enough to keep the queue under the limit
+inline constexpr size_t REACTOR_WRITE_QUEUE_LIMIT = 64 * 1024 * 1024;
+
+/// @brief Non-blocking connection served by the reactor I/O thread.
+/// Data that could not be sent immediately is kept in the write queue
+class ReactorConnection : public Connection,
+                          public std::enable_shared_from_this<ReactorConnection> {
+    Reactor& reactor;
+    SOCKET descriptor;
+    sockaddr_in addr;
+    std::atomic<size_t> totalUpload = 0;
+    std::atomic<size_t> totalDownload = 0;
+    std::atomic<ConnectionState> state = ConnectionState::INITIAL;
+    util::RingBuffer<char> readBuffer;
+    util::RingBuffer<char> writeQueue;
+    size_t highWaterMark = 0;
+    runnable onConnected;
+    /// @brief Guards buffers and socket state. Socket I/O is done under
+    /// the lock so descriptor can't be closed while used by I/O thread
+    std::mutex mutex;
+
+    bool isReadBufferFull() const {
+        return highWaterMark && readBuffer.size() >= highWaterMark;
+    }
+
+    /// @brief Get events to wait for. Reading is paused while the read
+    /// buffer is full
+    uint32_t getEvents() const {
+        return (isReadBufferFull() ? 0 : Reactor::READ) |
+               (writeQueue.empty() ? 0 : Reactor::WRITE);
+    }
+
+    /// @brief Close socket. Must be called with mutex locked
+    void closeSocket() {
+        if (state == ConnectionState::CLOSED) {
+            return;
+        }
+        state = ConnectionState::CLOSED;
+        reactor.remove(descriptor);
+        shutdown(descriptor, 2);
+        closesocket(descriptor);
+        writeQueue.clear();
+    }
+
+    /// @param drain read until the peer shutdown ignoring high water mark
+    void receive(bool drain) {
+        while (state == ConnectionState::CONNECTED &&
+               (drain || !isReadBufferFull())) {
+            auto buffer = readBuffer.prepare(REACTOR_READ_BUFFER_SIZE);
+            int size = recvsocket(descriptor, buffer.data(), buffer.size());
+            if (size == 0) {
+                logger.info() << "closed connection with " << to_string(addr);
+                closeSocket();
+                return;
+            } else if (size < 0) {
+                if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                    return;
+                } else if (errno == EINTR) {
+                    continue;
+                }
+                auto error = handle_socket_error("recv(...) error");
+                logger.error() << "an error ocurred while receiving from "
+                               << to_string(addr) << ": " << error.what();
+                closeSocket();
+                return;
+            }
+            readBuffer.commit(size);
+            totalDownload += size;
+        }
+    }
+
+    /// @brief Send as much of the write queue as the socket accepts
+    void flush() {
+        while (!writeQueue.empty()) {
+            auto data = writeQueue.front();
+            int len = sendsocket(
+                descriptor, data.data(), data.size(), MSG_NOSIGNAL
+            );
+            if (len < 0) {
+                if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                    break;
+                } else if (errno == EINTR) {
+                    continue;
+                }
+                auto error = handle_socket_error("send(...) error");
+                logger.error() << "an error ocurred while sending to "
+                               << to_string(addr) << ": " << error.what();
+                closeSocket();
+                return;
+            }
+            writeQueue.skip(len);
+            totalUpload += len;
+        }
+    }
+
+    /// @brief Check result of non-blocking connect
+    bool finishConnect() {
+        int error = 0;
+        socklen_t len = sizeof(error);
+        if (getsockopt(descriptor, SOL_SOCKET, SO_ERROR, &error, &len) ||
+            error) {
+            logger.error() << "connect to " << to_string(addr)
+                           << " failed: " << strerror(error);
+            closeSocket();
+            return false;
+        }
+        logger.info() << "connected to " << to_string(addr);
+        state = ConnectionState::CONNECTED;
+        return true;
+    }
+
+    void handle(uint32_t events) {
+        runnable callback;
+        {
+            std::lock_guard lock(mutex);
+            if (state == ConnectionState::CLOSED) {
+                return;
+            }
+            if (state == ConnectionState::CONNECTING) {
+                if (!(events & (Reactor::WRITE | Reactor::CLOSED)) ||
+                    !finishConnect()) {
+                    return;
+                }
+                callback = std::move(onConnected);
+                events &= ~Reactor::CLOSED;
+            }
+            if (events & (Reactor::READ | Reactor::CLOSED)) {
+                receive(events & Reactor::CLOSED);
+            }
+            if (state == ConnectionState::CONNECTED) {
+                flush();
+            }
+            if (state == ConnectionState::CONNECTED) {
+                reactor.modify(descriptor, getEvents());
+            }
+        }
+        if (callback) {
+            callback();
+        }
+    }
+
+    void listen(uint32_t events) {
+        std::weak_ptr<ReactorConnection> weak = weak_from_this();
+        reactor.add(descriptor, events, [weak](uint32_t events) {
+            if (auto connection = weak.lock()) {
+                connection->handle(events);
+            }
+        });
+    }
+public:
+    ReactorConnection(Reactor& reactor, SOCKET descriptor, sockaddr_in addr)
+        : reactor(reactor), descriptor(descriptor), addr(std::move(addr)) {
+    }
+
+    ~ReactorConnection() {
+        std::lock_guard lock(mutex);
+        closeSocket();
+    }
+
+    /// @brief Start serving accepted client socket
+    void startClient() {
+        set_nonblocking(descriptor);
+        state = ConnectionState::CONNECTED;
+        listen(Reactor::READ);
+    }
+
+    void connect(runnable callback) override {
+        std::lock_guard lock(mutex);
+        set_nonblocking(descriptor);
+        state = ConnectionState::CONNECTING;
+        logger.info() << "connecting to " << to_string(addr);
+        int res = connectsocket(
+            descriptor, (const sockaddr*)&addr, sizeof(sockaddr_in)
+        );
+        if (res < 0 && errno != EINPROGRESS) {
+            auto error = handle_socket_error("Connect failed");
+            closesocket(descriptor);
+            state = ConnectionState::CLOSED;
+            logger.error() << error.what();
+            return;
+        }
+        onConnected = std::move(callback);
+        listen(Reactor::WRITE);
+    }
+
+    int recv(char* buffer, size_t length) override {
+        std::lock_guard lock(mutex);
+
+        if (state != ConnectionState::CONNECTED && readBuffer.empty()) {
+            return -1;
+        }
+        bool paused = isReadBufferFull();
+        int size = readBuffer.get(buffer, length);
+        if (paused && !isReadBufferFull() &&
+            state == ConnectionState::CONNECTED) {
+            reactor.modify(descriptor, getEvents());
+        }
+        return size;
+    }
+
+    int send(const char* buffer, size_t length) override {
+        std::lock_guard lock(mutex);
+        if (state == ConnectionState::CLOSED) {
+            return 0;
+        }
+        if (writeQueue.size() + length > REACTOR_WRITE_QUEUE_LIMIT) {
+            logger.error() << "write queue limit exceeded, closing "
+                           << to_string(addr);
+            closeSocket();
+            return 0;
+        }
+        bool queued = !writeQueue.empty();
+        writeQueue.put(buffer, length);
+        if (state != ConnectionState::CONNECTED || queued) {
+            return length;
+        }
+        flush();
+        if (state == ConnectionState::CONNECTED && !writeQueue.empty()) {
+            reactor.modify(descriptor, getEvents());
+        }
+        return length;
+    }
+
+    int available() override {
+        std::lock_guard lock(mutex);
+        return readBuffer.size();
+    }
+
+    void setHighWaterMark(size_t bytes) override {
+        std::lock_guard lock(mutex);
+        highWaterMark = bytes;
+        if (state == ConnectionState::CONNECTED) {
+            reactor.modify(descriptor, getEvents());
+        }
+    }
+
+    void close(bool discardAll=false) override {
+        std::lock_guard lock(mutex);
+        readBuffer.clear();
+        closeSocket();
+    }
+
+    size_t pullUpload() override {
+        return totalUpload.exchange(0);
+    }
+
+    size_t pullDownload() override {
+        return totalDownload.exchange(0);
+    }
+
+    int getPort() const override {
+        return htons(addr.sin_port);
+    }
+
+    std::string getAddress() const override {
+        return to_string(addr, false);
+    }
+
+    ConnectionState getState() const override {
+        return state;
+    }
+
+    static std::shared_ptr<ReactorConnection> connect(
+        Reactor& reactor,
+        const std::string& address,
+        int port,
+        runnable callback
+    ) {
+        auto serverAddress = resolve_address(address, port);
+        SOCKET descriptor = socket(AF_INET, SOCK_STREAM, 0);
+        if (descriptor == -1) {
+            throw std::runtime_error("Could not create socket");
+        }
+        auto socket = std::make_shared<ReactorConnection>(
+            reactor, descriptor, std::move(serverAddress)
+        );
+        socket->connect(std::move(callback));
+        return socket;
+    }
+};
+
+/// @brief Non-blocking server accepting clients in the reactor I/O thread
+class ReactorTcpServer : public TcpServer,
+                         public std::enable_shared_from_this<ReactorTcpServer> {
+    Network* network;
+    Reactor& reactor;
+    SOCKET descriptor;
+    std::vector<u64id_t> clients;
+    consumer<u64id_t> handler;
+    std::atomic<bool> open = true;
+    /// @brief Guards clients list and socket state
+    std::mutex mutex;
+    int port;
+
+    void accept() {
+        while (open) {
+            sockaddr_in address;
+            socklen_t addrlen = sizeof(sockaddr_in);
+            SOCKET clientDescriptor =
+                ::accept(descriptor, (sockaddr*)&address, &addrlen);
+            if (clientDescriptor == -1) {
+                if (errno == EINTR || errno == ECONNABORTED) {
+                    continue;
+                } else if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                    logger.error() << handle_socket_error("accept").what();
+                }
+                return;
+            }
+            logger.info() << "client connected: " << to_string(address);
+            auto socket = std::make_shared<ReactorConnection>(
+                reactor, clientDescriptor, address
+            );
+            socket->startClient();
+            u64id_t id = network->addConnection(socket);
+            clients.push_back(id);
+            handler(id);
+        }
+    }
+public:
+    ReactorTcpServer(
+        Network* network, Reactor& reactor, SOCKET descriptor, int port
+    )
+        : network(network),
+          reactor(reactor),
+          descriptor(descriptor),
+          port(port) {
+    }
+
+    ~ReactorTcpServer() {
+        closeSocket();
+    }
+
+    void startListen(consumer<u64id_t> handler) override {
+        set_nonblocking(descriptor);
+        if (listen(descriptor, SOMAXCONN) < 0) {
+            throw handle_socket_error("listen");
+        }
+        this->handler = std::move(handler);
+        logger.info() << "listening for connections";
+
+        std::weak_ptr<ReactorTcpServer> weak = weak_from_this();
+        reactor.add(descriptor, Reactor::READ, [weak](uint32_t) {
+            if (auto server = weak.lock()) {
+                std::lock_guard lock(server->mutex);
+                server->accept();
+            }
+        });
+    }
+
+    void closeSocket() {
+        std::vector<u64id_t> clients;
+        {
+            std::lock_guard lock(mutex);
+            if (!open) {
+                return;
+            }
+            logger.info() << "closing server";
+            open = false;
+            reactor.remove(descriptor);
+            shutdown(descriptor, 2);
+            closesocket(descriptor);
+            clients = std::move(this->clients);
+        }
+        for (u64id_t clientid : clients) {
+            if (auto client = network->getConnection(clientid)) {
+                client->close();
+            }
+        }
+    }
+
+    void close() override {
+        closeSocket();
+    }
+
+    bool isOpen() override {
+        return open;
+    }
+
+    int getPort() const override {
+        return port;
+    }
+
+    static std::shared_ptr<ReactorTcpServer> openServer(
+        Network* network, Reactor& reactor, int port, consumer<u64id_t> handler
+    ) {
+        SOCKET descriptor = open_server_socket(port);
+        auto server = std::make_shared<ReactorTcpServer>(
+            network, reactor, descriptor, port
+        );
+        try {
+            server->startListen(std::move(handler));
+        } catch (const std::exception&) {
+            server->close();
+            throw;
+        }
         return server;
     }
 };
 
+#endif // __linux__
+
 Network::Network(std::unique_ptr<Requests> requests)
 : requests(std::move(requests)) {
 }
@@ -634,24 +1303,61 @@ TcpServer* Network::getServer(u64id_t id) const {
     return found->second.get();
 }
 
+UdpSocket* Network::getUdpSocket(u64id_t id) const {
+    const auto& found = udpSockets.find(id);
+    if (found == udpSockets.end()) {
+        return nullptr;
+    }
+    return found->second.get();
+}
+
+Reactor* Network::getReactor() {
+    if (reactor == nullptr && Reactor::isSupported()) {
+        reactor = std::make_unique<Reactor>();
+    }
+    return reactor.get();
+}
+
 u64id_t Network::connect(const std::string& address, int port, consumer<u64id_t> callback) {
+    auto reactor = getReactor();
     std::lock_guard lock(connectionsMutex);
     
     u64id_t id = nextConnection++;
-    auto socket = SocketConnection::connect(address, port, [id, callback]() {
+    runnable onConnected = [id, callback]() {
         callback(id);
-    });
+    };
+#ifdef __linux__
+    if (reactor) {
+        connections[id] = ReactorConnection::connect(
+            *reactor, address, port, std::move(onConnected)
+        );
+        return id;
+    }
+#endif
+    auto socket = SocketConnection::connect(address, port, std::move(onConnected));
     connections[id] = std::move(socket);
     return id;
 }
 
 u64id_t Network::openServer(int port, consumer<u64id_t> handler) {
     u64id_t id = nextServer++;
+#ifdef __linux__
+    if (auto reactor = getReactor()) {
+        servers[id] = ReactorTcpServer::openServer(this, *reactor, port, handler);
+        return id;
+    }
+#endif
     auto server = SocketTcpSServer::openServer(this, port, handler);
     servers[id] = std::move(server);
     return id;
 }
 
+u64id_t Network::bind(int port) {
+    u64id_t id = nextUdpSocket++;
+    udpSockets[id] = DatagramSocket::bind(port);
+    return id;
+}
+
 u64id_t Network::addConnection(const std::shared_ptr<Connection>& socket) {
     std::lock_guard lock(connectionsMutex);
 
@@ -685,6 +1391,17 @@ void Network::update() {
             }
             ++socketiter;
         }
+        auto udpiter = udpSockets.begin();
+        while (udpiter != udpSockets.end()) {
+            auto socket = udpiter->second.get();
+            totalDownload += socket->pullDownload();
+            totalUpload += socket->pullUpload();
+            if (!socket->isOpen()) {
+                udpiter = udpSockets.erase(udpiter);
+                continue;
+            }
+            ++udpiter;
+        }
         auto serveriter = servers.begin();
         while (serveriter != servers.end()) {
             auto server = serveriter->second.get();
@@ -52,6 +52,12 @@ namespace network {
         virtual void close(bool discardAll=false) = 0;
         virtual int available() = 0;
 
+        /// @brief Set limit of received bytes buffered until read.
+        /// Reading from socket is paused while the limit is reached,
+        /// so the peer gets slowed down by TCP flow control
+        /// @param bytes limit or 0 to disable
+        virtual void setHighWaterMark(size_t bytes) = 0;
+
         virtual size_t pullUpload() = 0;
         virtual size_t pullDownload() = 0;
 
@@ -70,8 +76,50 @@ namespace network {
         virtual int getPort() const = 0;
     };
 
+    /// @brief Received UDP datagram
+    struct Datagram {
+        std::string address;
+        int port;
+        std::vector<char> data;
+    };
+
+    /// @brief Non-blocking UDP socket polled by the owner thread
+    class UdpSocket {
+    public:
+        virtual ~UdpSocket() {}
+
+        /// @brief Send datagram to the address
+        /// @return number of bytes sent or 0 if the socket buffer is full
+        virtual int sendTo(
+            const std::string& address,
+            int port,
+            const char* buffer,
+            size_t length
+        ) = 0;
+
+        /// @brief Receive pending datagrams without blocking
+        /// @param dst datagrams destination, existing elements are reused
+        /// @param maxCount maximum number of datagrams to receive
+        /// @return number of datagrams written to dst
+        virtual size_t recvFrom(std::vector<Datagram>& dst, size_t maxCount) = 0;
+
+        virtual void close() = 0;
+        virtual bool isOpen() const = 0;
+
+        virtual size_t pullUpload() = 0;
+        virtual size_t pullDownload() = 0;
+
+        /// @brief Get port the socket is bound to
+        virtual int getPort() const = 0;
+    };
+
+    class Reactor;
+
     class Network {
         std::unique_ptr<Requests> requests;
+        /// @brief Sockets I/O multiplexer (nullptr if not supported or
+        /// not used yet). Must outlive connections and servers
+        std::unique_ptr<Reactor> reactor;
 
         std::unordered_map<u64id_t, std::shared_ptr<Connection>> connections;
         std::mutex connectionsMutex {};
@@ -80,8 +128,13 @@ namespace network {
         std::unordered_map<u64id_t, std::shared_ptr<TcpServer>> servers;
         u64id_t nextServer = 1;
 
+        std::unordered_map<u64id_t, std::shared_ptr<UdpSocket>> udpSockets;
+        u64id_t nextUdpSocket = 1;
+
         size_t totalDownload = 0;
         size_t totalUpload = 0;
+
+        Reactor* getReactor();
     public:
         Network(std::unique_ptr<Requests> requests);
         ~Network();
@@ -103,11 +156,16 @@ namespace network {
 
         [[nodiscard]] Connection* getConnection(u64id_t id);
         [[nodiscard]] TcpServer* getServer(u64id_t id) const;
+        [[nodiscard]] UdpSocket* getUdpSocket(u64id_t id) const;
 
         u64id_t connect(const std::string& address, int port, consumer<u64id_t> callback);
 
         u64id_t openServer(int port, consumer<u64id_t> handler);
 
+        /// @brief Open UDP socket
+        /// @param port port to bind or 0 to use any free one
+        u64id_t bind(int port);
+
         u64id_t addConnection(const std::shared_ptr<Connection>& connection);
 
         size_t getTotalUpload() const;
@@ -0,0 +1,192 @@
+#include "Reactor.hpp"
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#endif
+
+#include "debug/Logger.hpp"
+
+using namespace network;
+
+static debug::Logger logger("network-reactor");
+
+#ifdef __linux__
+
+/// @brief Maximum number of events processed per epoll_wait call
+inline constexpr int MAX_EVENTS = 64;
+
+static uint32_t to_epoll_events(uint32_t events) {
+    uint32_t result = 0;
+    if (events & Reactor::READ) {
+        result |= EPOLLIN | EPOLLRDHUP;
+    }
+    if (events & Reactor::WRITE) {
+        result |= EPOLLOUT;
+    }
+    return result;
+}
+
+static std::runtime_error epoll_error(const std::string& message) {
+    int err = errno;
+    return std::runtime_error(
+        message + " [errno=" + std::to_string(err) + "]: " +
+        std::string(strerror(err))
+    );
+}
+
+Reactor::Reactor() {
+    epollDescriptor = epoll_create1(EPOLL_CLOEXEC);
+    if (epollDescriptor == -1) {
+        throw epoll_error("epoll_create1");
+    }
+    wakeDescriptor = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wakeDescriptor == -1) {
+        auto error = epoll_error("eventfd");
+        ::close(epollDescriptor);
+        throw error;
+    }
+    epoll_event event {};
+    event.events = EPOLLIN;
+    event.data.u64 = 0;
+    if (epoll_ctl(epollDescriptor, EPOLL_CTL_ADD, wakeDescriptor, &event)) {
+        auto error = epoll_error("epoll_ctl");
+        ::close(wakeDescriptor);
+        ::close(epollDescriptor);
+        throw error;
+    }
+    thread = std::thread([this]() { loop(); });
+    logger.info() << "started";
+}
+
+Reactor::~Reactor() {
+    running = false;
+    uint64_t value = 1;
+    if (write(wakeDescriptor, &value, sizeof(value)) != sizeof(value)) {
+        logger.error() << "could not wake up I/O thread";
+    }
+    thread.join();
+    ::close(wakeDescriptor);
+    ::close(epollDescriptor);
+    logger.info() << "stopped";
+}
+
+void Reactor::add(int descriptor, uint32_t events, Handler handler) {
+    std::lock_guard lock(mutex);
+    uint64_t id = nextId++;
+    epoll_event event {};
+    event.events = to_epoll_events(events);
+    event.data.u64 = id;
+    if (epoll_ctl(epollDescriptor, EPOLL_CTL_ADD, descriptor, &event)) {
+        throw epoll_error("epoll_ctl(EPOLL_CTL_ADD)");
+    }
+    descriptors[descriptor] = id;
+    handlers[id] = std::make_shared<Handler>(std::move(handler));
+}
+
+void Reactor::modify(int descriptor, uint32_t events) {
+    std::lock_guard lock(mutex);
+    const auto& found = descriptors.find(descriptor);
+    if (found == descriptors.end()) {
+        return;
+    }
+    epoll_event event {};
+    event.events = to_epoll_events(events);
+    event.data.u64 = found->second;
+    if (epoll_ctl(epollDescriptor, EPOLL_CTL_MOD, descriptor, &event)) {
+        logger.error() << epoll_error("epoll_ctl(EPOLL_CTL_MOD)").what();
+    }
+}
+
+void Reactor::remove(int descriptor) {
+    std::lock_guard lock(mutex);
+    const auto& found = descriptors.find(descriptor);
+    if (found == descriptors.end()) {
+        return;
+    }
+    epoll_ctl(epollDescriptor, EPOLL_CTL_DEL, descriptor, nullptr);
+    handlers.erase(found->second);
+    descriptors.erase(found);
+}
+
+void Reactor::loop() {
+    epoll_event events[MAX_EVENTS];
+    std::vector<std::pair<std::shared_ptr<Handler>, uint32_t>> ready;
+    while (running) {
+        int count = epoll_wait(epollDescriptor, events, MAX_EVENTS, -1);
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            logger.error() << epoll_error("epoll_wait").what();
+            break;
+        }
+        ready.clear();
+        {
+            std::lock_guard lock(mutex);
+            for (int i = 0; i < count; i++) {
+                const auto& event = events[i];
+                const auto& found = handlers.find(event.data.u64);
+                if (found == handlers.end()) {
+                    continue;
+                }
+                uint32_t flags = 0;
+                if (event.events & EPOLLIN) {
+                    flags |= READ;
+                }
+                if (event.events & EPOLLOUT) {
+                    flags |= WRITE;
+                }
+                if (event.events & (EPOLLERR | EPOLLHUP | EPOLLRDHUP)) {
+                    flags |= CLOSED;
+                }
+                ready.emplace_back(found->second, flags);
+            }
+        }
+        // handlers are called without lock to let them modify the reactor
+        for (const auto& [handler, flags] : ready) {
+            try {
+                (*handler)(flags);
+            } catch (const std::exception& err) {
+                logger.error() << err.what();
+            }
+        }
+    }
+}
+
+bool Reactor::isSupported() {
+    return true;
+}
+
+#else
+
+Reactor::Reactor() {
+    throw std::runtime_error("network reactor is not supported");
+}
+
+Reactor::~Reactor() = default;
+
+void Reactor::add(int, uint32_t, Handler) {
+}
+
+void Reactor::modify(int, uint32_t) {
+}
+
+void Reactor::remove(int) {
+}
+
+void Reactor::loop() {
+}
+
+bool Reactor::isSupported() {
+    return false;
+}
+
+#endif // __linux__
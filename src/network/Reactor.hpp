@@ -0,0 +1,60 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+namespace network {
+    /// @brief Multiplexes non-blocking sockets on a single I/O thread.
+    /// Implemented with epoll, so available on Linux only
+    class Reactor {
+    public:
+        /// @brief Socket events handler called in the I/O thread
+        using Handler = std::function<void(uint32_t events)>;
+
+        /// @brief Socket has data to read or a connection to accept
+        static constexpr uint32_t READ = 1;
+        /// @brief Socket is ready to send data or connected
+        static constexpr uint32_t WRITE = 2;
+        /// @brief Socket hung up or got an error. Peer shutdown is only
+        /// reported while waiting for READ
+        static constexpr uint32_t CLOSED = 4;
+
+        Reactor();
+        ~Reactor();
+
+        /// @brief Register socket. Handler must ignore events if the socket
+        /// is already closed as events of the current iteration may still
+        /// be delivered after remove call
+        /// @param events READ and WRITE flags
+        void add(int descriptor, uint32_t events, Handler handler);
+
+        /// @brief Change events the socket is waiting for
+        void modify(int descriptor, uint32_t events);
+
+        /// @brief Unregister socket. Must be called before closing it
+        void remove(int descriptor);
+
+        static bool isSupported();
+    private:
+        struct Entry {
+            uint64_t id;
+            std::shared_ptr<Handler> handler;
+        };
+        int epollDescriptor = -1;
+        /// @brief eventfd used to wake up the I/O thread on stop
+        int wakeDescriptor = -1;
+        std::atomic<bool> running = true;
+        std::mutex mutex;
+        std::unordered_map<int, uint64_t> descriptors;
+        std::unordered_map<uint64_t, std::shared_ptr<Handler>> handlers;
+        uint64_t nextId = 1;
+        std::thread thread;
+
+        void loop();
+    };
+}
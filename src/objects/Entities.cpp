@@ -18,9 +18,14 @@
 #include "maths/rays.hpp"
 #include "EntityDef.hpp"
 #include "rigging.hpp"
+#include "physics/BodiesStepper.hpp"
 #include "physics/Hitbox.hpp"
 #include "physics/PhysicsSolver.hpp"
+#include "voxels/GlobalChunks.hpp"
 #include "world/Level.hpp"
+#include "objects/Player.hpp"
+#include "objects/Players.hpp"
+#include "settings.hpp"
 
 static debug::Logger logger("entities");
 
@@ -39,6 +44,19 @@ void Transform::refresh() {
     dirty = false;
 }
 
+void Entity::setPosition(const glm::vec3& position) {
+    getTransform().setPos(position);
+    getRigidbody().hitbox.position = position;
+    getRigidbody().hitbox.wakeUp();
+    entities.updateIndex(entity);
+}
+
+void Entity::setHitboxSize(const glm::vec3& size) {
+    getRigidbody().hitbox.halfsize = size * 0.5f;
+    getRigidbody().hitbox.wakeUp();
+    entities.updateIndex(entity);
+}
+
 void Entity::setInterpolatedPosition(const glm::vec3& position) {
     getSkeleton().interpolation.refresh(position);
 }
@@ -72,8 +90,57 @@ void Entity::setRig(const rigging::SkeletonConfig* rigConfig) {
     );
 }
 
-Entities::Entities(Level& level)
-    : level(level), sensorsTickClock(20, 3), updateTickClock(20, 3) {
+/// @brief Entities grid cell size
+inline constexpr float GRID_CELL_SIZE = 8.0f;
+
+Entities::Entities(Level& level, const PhysicsSettings& settings)
+    : level(level),
+      settings(settings),
+      sensorsTickClock(20, 3),
+      updateTickClock(20, 3),
+      grid(GRID_CELL_SIZE),
+      stepper(std::make_unique<BodiesStepper>(
+          *level.physics, *level.chunks, settings.threads.get()
+      )) {
+}
+
+Entities::~Entities() = default;
+
+void Entities::updateIndex(entt::entity entity) {
+    const auto& transform = registry.get<Transform>(entity);
+    const auto& hitbox = registry.get<Rigidbody>(entity).hitbox;
+    maxHalfsize = glm::max(maxHalfsize, hitbox.halfsize);
+
+    auto cell = grid.cellOf(transform.pos);
+    auto found = gridCells.find(entity);
+    if (found == gridCells.end()) {
+        gridCells[entity] = cell;
+        grid.insert(cell, entity);
+    } else if (found->second != cell) {
+        grid.remove(found->second, entity);
+        grid.insert(cell, entity);
+        found->second = cell;
+    }
+}
+
+template <typename Func>
+void Entities::queryGrid(AABB aabb, bool hitboxes, const Func& func) {
+    if (hitboxes) {
+        aabb = AABB(aabb.min() - maxHalfsize, aabb.max() + maxHalfsize);
+    }
+    grid.query(aabb, func);
+}
+
+std::vector<Entity> Entities::collect(
+    std::vector<std::pair<entityid_t, entt::entity>>& found
+) {
+    std::sort(found.begin(), found.end());
+    std::vector<Entity> collected;
+    collected.reserve(found.size());
+    for (const auto& [uid, entity] : found) {
+        collected.emplace_back(*this, uid, registry, entity);
+    }
+    return collected;
 }
 
 template <void (*callback)(const Entity&, size_t, entityid_t)>
@@ -185,6 +252,7 @@ entityid_t Entities::spawn(
         loadEntity(saved, get(id).value());
     }
     body.hitbox.position = tsf.pos;
+    updateIndex(entity);
     scripting::on_entity_spawn(
         def, id, scripting.components, args, componentsMap);
     return id;
@@ -255,14 +323,16 @@ std::optional<Entities::RaycastResult> Entities::rayCast(
     glm::vec3 start, glm::vec3 dir, float maxDistance, entityid_t ignore
 ) {
     Ray ray(start, dir);
-    auto view = registry.view<EntityId, Transform, Rigidbody>();
 
     entityid_t foundUID = 0;
     glm::ivec3 foundNormal;
 
-    for (auto [entity, eid, transform, body] : view.each()) {
+    AABB rayAABB(start, start + dir * maxDistance);
+    queryGrid(rayAABB, true, [&](entt::entity entity) {
+        const auto& eid = registry.get<EntityId>(entity);
+        const auto& body = registry.get<Rigidbody>(entity);
         if (eid.uid == ignore || !body.enabled) {
-            continue;
+            return;
         }
         auto& hitbox = body.hitbox;
         glm::ivec3 normal;
@@ -274,7 +344,7 @@ std::optional<Entities::RaycastResult> Entities::rayCast(
             foundNormal = normal;
             maxDistance = static_cast<float>(distance);
         }
-    }
+    });
     if (foundUID) {
         return Entities::RaycastResult {foundUID, foundNormal, maxDistance};
     } else {
@@ -398,6 +468,11 @@ void Entities::clean() {
             for (auto& sensor : rigidbody.sensors) {
                 physics->removeSensor(&sensor);
             }
+            if (auto found = gridCells.find(it->second);
+                found != gridCells.end()) {
+                grid.remove(found->second, it->second);
+                gridCells.erase(found);
+            }
             uids.erase(it->second);
             registry.destroy(it->second);
             it = entities.erase(it);
@@ -460,28 +535,46 @@ void Entities::preparePhysics(float delta) {
 void Entities::updatePhysics(float delta) {
     preparePhysics(delta);
 
+    viewers.clear();
+    for (const auto& [_, player] : *level.players) {
+        viewers.push_back(player->getPosition());
+    }
+    stepper->begin(delta, viewers, settings.lodDistance.get());
+    steppedEntities.clear();
+
     auto view = registry.view<EntityId, Transform, Rigidbody>();
     auto physics = level.physics.get();
     for (auto [entity, eid, transform, rigidbody] : view.each()) {
         if (!rigidbody.enabled || rigidbody.hitbox.type == BodyType::STATIC) {
             continue;
         }
-        auto& hitbox = rigidbody.hitbox;
-        auto prevVel = hitbox.velocity;
-        bool grounded = hitbox.grounded;
-
-        float vel = glm::length(prevVel);
-        int substeps = static_cast<int>(delta * vel * 20);
-        substeps = std::min(100, std::max(2, substeps));
-        physics->step(*level.chunks, hitbox, delta, substeps, eid.uid);
-        hitbox.linearDamping = hitbox.grounded * 24;
+        stepper->add(rigidbody.hitbox, eid.uid, eid.player != -1);
+        steppedEntities.push_back(entity);
+    }
+    stepper->step();
+
+    // sensors and scripting events in the view order
+    const auto& bodies = stepper->getBodies();
+    for (size_t i = 0; i < bodies.size(); i++) {
+        const auto& body = bodies[i];
+        const auto& eid = registry.get<EntityId>(steppedEntities[i]);
+        auto& transform = registry.get<Transform>(steppedEntities[i]);
+        auto& hitbox = *body.hitbox;
+
+        if (physics->testSensors(hitbox, eid.uid) && hitbox.sleeping) {
+            hitbox.wakeUp();
+        }
+        if (body.delta <= 0.0f) {
+            continue;
+        }
         transform.setPos(hitbox.position);
-        if (hitbox.grounded && !grounded) {
+        updateIndex(steppedEntities[i]);
+        if (hitbox.grounded && !body.grounded) {
             scripting::on_entity_grounded(
-                *get(eid.uid), glm::length(prevVel - hitbox.velocity)
+                *get(eid.uid), glm::length(body.prevVelocity - hitbox.velocity)
             );
         }
-        if (!hitbox.grounded && grounded) {
+        if (!hitbox.grounded && body.grounded) {
             scripting::on_entity_fall(*get(eid.uid));
         }
     }
@@ -588,45 +681,38 @@ void Entities::render(
 }
 
 bool Entities::hasBlockingInside(AABB aabb) {
-    auto view = registry.view<EntityId, Rigidbody>();
-    for (auto [entity, eid, body] : view.each()) {
+    bool found = false;
+    queryGrid(aabb, true, [&](entt::entity entity) {
+        const auto& eid = registry.get<EntityId>(entity);
+        const auto& body = registry.get<Rigidbody>(entity);
         if (eid.def.blocking && aabb.intersect(body.hitbox.getAABB(), -0.05f)) {
-            return true;
+            found = true;
         }
-    }
-    return false;
+    });
+    return found;
 }
 
 std::vector<Entity> Entities::getAllInside(AABB aabb) {
-    std::vector<Entity> collected;
-    auto view = registry.view<EntityId, Transform>();
-    for (auto [entity, eid, transform] : view.each()) {
+    std::vector<std::pair<entityid_t, entt::entity>> found;
+    queryGrid(aabb, false, [&](entt::entity entity) {
+        const auto& eid = registry.get<EntityId>(entity);
+        const auto& transform = registry.get<Transform>(entity);
         if (!eid.destroyFlag && aabb.contains(transform.pos)) {
-            const auto& found = uids.find(entity);
-            if (found == uids.end()) {
-                continue;
-            }
-            if (auto wrapper = get(found->second)) {
-                collected.push_back(*wrapper);
-            }
+            found.emplace_back(eid.uid, entity);
         }
-    }
-    return collected;
+    });
+    return collect(found);
 }
 
 std::vector<Entity> Entities::getAllInRadius(glm::vec3 center, float radius) {
-    std::vector<Entity> collected;
-    auto view = registry.view<Transform>();
-    for (auto [entity, transform] : view.each()) {
+    std::vector<std::pair<entityid_t, entt::entity>> found;
+    AABB aabb(center - glm::vec3(radius), center + glm::vec3(radius));
+    queryGrid(aabb, false, [&](entt::entity entity) {
+        const auto& eid = registry.get<EntityId>(entity);
+        const auto& transform = registry.get<Transform>(entity);
         if (glm::distance2(transform.pos, center) <= radius * radius) {
-            const auto& found = uids.find(entity);
-            if (found == uids.end()) {
-                continue;
-            }
-            if (auto wrapper = get(found->second)) {
-                collected.push_back(*wrapper);
-            }
+            found.emplace_back(eid.uid, entity);
         }
-    }
-    return collected;
+    });
+    return collect(found);
 }
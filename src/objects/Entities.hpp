@@ -7,6 +7,7 @@
 
 #include "data/dv.hpp"
 #include "physics/Hitbox.hpp"
+#include "physics/SpatialHash.hpp"
 #include "typedefs.hpp"
 #include "util/Clock.hpp"
 #define GLM_ENABLE_EXPERIMENTAL
@@ -111,6 +112,9 @@ namespace rigging {
     class SkeletonConfig;
 }
 
+class BodiesStepper;
+struct PhysicsSettings;
+
 class Entity {
     Entities& entities;
     entityid_t id;
@@ -170,6 +174,12 @@ public:
         registry.get<EntityId>(entity).player = id;
     }
 
+    /// @brief Move transform and rigidbody to the position
+    void setPosition(const glm::vec3& position);
+
+    /// @brief Set rigidbody hitbox size
+    void setHitboxSize(const glm::vec3& size);
+
     void setInterpolatedPosition(const glm::vec3& position);
 
     glm::vec3 getInterpolatedPosition() const;
@@ -180,11 +190,35 @@ public:
 class Entities {
     entt::registry registry;
     Level& level;
+    const PhysicsSettings& settings;
     std::unordered_map<entityid_t, entt::entity> entities;
     std::unordered_map<entt::entity, entityid_t> uids;
     entityid_t nextID = 1;
     util::Clock sensorsTickClock;
     util::Clock updateTickClock;
+    /// @brief Broadphase grid of entities by transform position
+    SpatialHash<entt::entity> grid;
+    /// @brief Grid cells entities are currently stored in
+    std::unordered_map<entt::entity, glm::ivec2> gridCells;
+    /// @brief Maximum indexed hitbox half-size. Hitbox queries are expanded
+    /// by it as entities are indexed by position
+    glm::vec3 maxHalfsize {};
+
+    std::unique_ptr<BodiesStepper> stepper;
+    /// @brief Entities of bodies added to the stepper in the view order
+    std::vector<entt::entity> steppedEntities;
+    /// @brief Positions of players used to select bodies step interval
+    std::vector<glm::vec3> viewers;
+
+    /// @brief Visit entities having transform position inside the box
+    /// or hitbox intersecting it (if hitboxes is true)
+    template <typename Func>
+    void queryGrid(AABB aabb, bool hitboxes, const Func& func);
+    /// @brief Create wrappers of found entities sorted by UID to make
+    /// query results independent of the grid layout
+    std::vector<Entity> collect(
+        std::vector<std::pair<entityid_t, entt::entity>>& found
+    );
 
     void updateSensors(
         Rigidbody& body, const Transform& tsf, std::vector<Sensor*>& sensors
@@ -197,9 +231,13 @@ public:
         float distance;
     };
 
-    Entities(Level& level);
+    Entities(Level& level, const PhysicsSettings& settings);
+    ~Entities();
 
     void clean();
+    /// @brief Update entity in the spatial index. Must be called after
+    /// its position or hitbox size is changed
+    void updateIndex(entt::entity entity);
     void updatePhysics(float delta);
     void update(float delta);
 
@@ -182,8 +182,7 @@ void Player::teleport(glm::vec3 position) {
     this->position = position;
 
     if (auto entity = level.entities->get(eid)) {
-        entity->getRigidbody().hitbox.position = position;
-        entity->getTransform().setPos(position);
+        entity->setPosition(position);
         entity->setInterpolatedPosition(position);
     }
 }
@@ -199,7 +198,7 @@ void Player::attemptToFindSpawnpoint() {
         newpos.y--;
     }
 
-    voxel* headvox = chunks->get(newpos.x, newpos.y + 1, newpos.z);
+    const voxel* headvox = chunks->get(newpos.x, newpos.y + 1, newpos.z);
     if (chunks->isObstacleBlock(newpos.x, newpos.y, newpos.z) ||
         headvox == nullptr || headvox->id != 0) {
         return;
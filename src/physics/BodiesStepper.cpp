@@ -0,0 +1,193 @@
+#include "BodiesStepper.hpp"
+#include "Hitbox.hpp"
+#include "PhysicsSolver.hpp"
+
+#include "debug/Logger.hpp"
+#include "maths/voxmaths.hpp"
+#include "util/ThreadPool.hpp"
+#include "voxels/Chunk.hpp"
+#include "voxels/GlobalChunks.hpp"
+
+#include <algorithm>
+#include <cmath>
+#define GLM_ENABLE_EXPERIMENTAL
+#include <glm/gtx/norm.hpp>
+
+static debug::Logger logger("bodies-stepper");
+
+/// @brief Number of bodies stepped by a worker task
+inline constexpr size_t BATCH_SIZE = 16;
+/// @brief Max physics step interval of distant bodies (in ticks)
+inline constexpr int MAX_STEP_INTERVAL = 8;
+/// @brief Speed below which grounded body is considered resting
+inline constexpr float SLEEP_VELOCITY = 0.05f;
+/// @brief Resting time after which body falls asleep
+inline constexpr float SLEEP_DELAY = 1.0f;
+
+class BodiesStepper::Worker : public util::Worker<size_t, size_t> {
+    BodiesStepper& stepper;
+public:
+    Worker(BodiesStepper& stepper) : stepper(stepper) {
+    }
+
+    size_t operator()(const size_t& batch) override {
+        stepper.stepBatch(batch);
+        return batch;
+    }
+};
+
+BodiesStepper::BodiesStepper(
+    const PhysicsSolver& solver, const GlobalChunks& chunks, uint threads
+)
+    : solver(solver), chunks(chunks) {
+    if (threads > 1) {
+        workers = std::make_unique<util::ThreadPool<size_t, size_t>>(
+            "physics-workers",
+            [this]() { return std::make_shared<Worker>(*this); },
+            [](size_t&) {},
+            threads
+        );
+        logger.info() << "created " << workers->getWorkersCount()
+                      << " physics workers";
+    }
+}
+
+BodiesStepper::~BodiesStepper() = default;
+
+static inline uint64_t hash_combine(uint64_t seed, uint64_t value) {
+    return seed ^ (value + 0x9E3779B97F4A7C15ULL + (seed << 6) + (seed >> 2));
+}
+
+/// @brief Hash of blocks versions of chunks around the box. Unlike a sum
+/// of versions, it changes if versions of two chunks change by opposite
+/// amounts or a chunk gets unloaded
+static uint64_t get_blocks_version(
+    const GlobalChunks& chunks, const AABB& aabb
+) {
+    // include blocks the body is standing on or touching
+    glm::ivec3 min(glm::floor(aabb.min()));
+    glm::ivec3 max(glm::floor(aabb.max()));
+    int minx = floordiv<CHUNK_W>(min.x - 1);
+    int minz = floordiv<CHUNK_D>(min.z - 1);
+    int maxx = floordiv<CHUNK_W>(max.x + 1);
+    int maxz = floordiv<CHUNK_D>(max.z + 1);
+    uint64_t version = 0;
+    for (int cz = minz; cz <= maxz; cz++) {
+        for (int cx = minx; cx <= maxx; cx++) {
+            auto chunk = chunks.getChunk(cx, cz);
+            // missing chunk differs from any blocks version
+            version = hash_combine(
+                version, chunk ? chunk->blocksVersion + 1ULL : 0ULL
+            );
+        }
+    }
+    return version;
+}
+
+/// @brief Select body physics step interval by distance to the nearest viewer
+static int get_step_interval(
+    const glm::vec3& position,
+    const std::vector<glm::vec3>& viewers,
+    int lodDistance
+) {
+    if (lodDistance <= 0) {
+        return 1;
+    }
+    float minDistance2 = INFINITY;
+    for (const auto& viewer : viewers) {
+        minDistance2 = std::min(minDistance2, glm::distance2(viewer, position));
+    }
+    float tier = std::sqrt(minDistance2) / lodDistance;
+    if (tier >= 3.0f) {
+        return MAX_STEP_INTERVAL;
+    }
+    return 1 << static_cast<int>(tier);
+}
+
+/// @brief Put the body to sleep if it is resting long enough
+static void update_rest(Hitbox& hitbox, float delta) {
+    if (!hitbox.grounded ||
+        glm::length2(hitbox.velocity) >= SLEEP_VELOCITY * SLEEP_VELOCITY) {
+        hitbox.restTime = 0.0f;
+        return;
+    }
+    hitbox.restTime += delta;
+    if (hitbox.restTime >= SLEEP_DELAY) {
+        hitbox.sleeping = true;
+        hitbox.velocity = glm::vec3(0.0f);
+    }
+}
+
+void BodiesStepper::begin(
+    float delta, const std::vector<glm::vec3>& viewers, int lodDistance
+) {
+    this->delta = delta;
+    this->viewers.assign(viewers.begin(), viewers.end());
+    this->lodDistance = lodDistance;
+    bodies.clear();
+    tick++;
+}
+
+void BodiesStepper::add(Hitbox& hitbox, entityid_t uid, bool player) {
+    if (hitbox.sleeping &&
+        (player || get_blocks_version(chunks, hitbox.getAABB()) !=
+                       hitbox.sleepBlocksVersion)) {
+        hitbox.wakeUp();
+    }
+    float bodyDelta = 0.0f;
+    if (!hitbox.sleeping) {
+        hitbox.skippedTime += delta;
+        int interval = player ? 1
+                              : get_step_interval(
+                                    hitbox.position, viewers, lodDistance
+                                );
+        if ((tick + uid) % interval == 0) {
+            bodyDelta = hitbox.skippedTime;
+            hitbox.skippedTime = 0.0f;
+        }
+    }
+    bodies.push_back(
+        Body {&hitbox, hitbox.velocity, hitbox.grounded, bodyDelta, !player}
+    );
+}
+
+void BodiesStepper::step() {
+    // voxel collisions depend on the body itself only, so bodies
+    // are stepped in parallel
+    size_t batches = (bodies.size() + BATCH_SIZE - 1) / BATCH_SIZE;
+    if (workers && batches > 1) {
+        for (size_t batch = 0; batch < batches; batch++) {
+            workers->enqueueJob(batch);
+        }
+        workers->waitForJobs();
+    } else {
+        for (size_t batch = 0; batch < batches; batch++) {
+            stepBatch(batch);
+        }
+    }
+    for (const auto& body : bodies) {
+        if (body.delta > 0.0f && body.hitbox->sleeping) {
+            body.hitbox->sleepBlocksVersion =
+                get_blocks_version(chunks, body.hitbox->getAABB());
+        }
+    }
+}
+
+void BodiesStepper::stepBatch(size_t batch) {
+    size_t end = std::min(bodies.size(), (batch + 1) * BATCH_SIZE);
+    for (size_t i = batch * BATCH_SIZE; i < end; i++) {
+        const auto& body = bodies[i];
+        if (body.delta <= 0.0f) {
+            continue;
+        }
+        auto& hitbox = *body.hitbox;
+        float vel = glm::length(body.prevVelocity);
+        int substeps = static_cast<int>(body.delta * vel * 20);
+        substeps = std::min(100, std::max(2, substeps));
+        solver.step(chunks, hitbox, body.delta, substeps);
+        hitbox.linearDamping = hitbox.grounded * 24;
+        if (body.canSleep) {
+            update_rest(hitbox, body.delta);
+        }
+    }
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include "typedefs.hpp"
+
+#include <memory>
+#include <vector>
+#include <glm/glm.hpp>
+
+class GlobalChunks;
+class PhysicsSolver;
+struct Hitbox;
+
+namespace util {
+    template <class T, class R>
+    class ThreadPool;
+}
+
+/// @brief Steps voxel collisions of dynamic bodies, in parallel if
+/// multiple threads are used. Bodies far from viewers are stepped less
+/// frequently, resting bodies fall asleep until blocks around change
+class BodiesStepper {
+public:
+    /// @brief Body state captured before the step
+    struct Body {
+        Hitbox* hitbox;
+        glm::vec3 prevVelocity;
+        bool grounded;
+        /// @brief Time to step the body for (0 if skipped this tick)
+        float delta;
+        /// @brief Player bodies are never put to sleep
+        bool canSleep;
+    };
+
+    /// @param threads number of threads used to step bodies
+    BodiesStepper(
+        const PhysicsSolver& solver, const GlobalChunks& chunks, uint threads
+    );
+    ~BodiesStepper();
+
+    /// @brief Start a new tick removing previously added bodies
+    /// @param delta tick duration
+    /// @param viewers positions bodies step interval depends on
+    /// @param lodDistance see PhysicsSettings::lodDistance
+    void begin(
+        float delta, const std::vector<glm::vec3>& viewers, int lodDistance
+    );
+
+    /// @brief Add body to the tick, waking it up if blocks around changed
+    /// @param uid entity id used to spread steps of distant bodies
+    /// @param player player bodies are stepped every tick and never sleep
+    void add(Hitbox& hitbox, entityid_t uid, bool player);
+
+    /// @brief Step added bodies. Results do not depend on the threads count
+    void step();
+
+    /// @brief Added bodies in order of adding
+    const std::vector<Body>& getBodies() const {
+        return bodies;
+    }
+private:
+    class Worker;
+
+    const PhysicsSolver& solver;
+    const GlobalChunks& chunks;
+    /// @brief Bodies batches stepping workers (nullptr if single-threaded)
+    std::unique_ptr<util::ThreadPool<size_t, size_t>> workers;
+    std::vector<Body> bodies;
+    std::vector<glm::vec3> viewers;
+    float delta = 0.0f;
+    int lodDistance = 0;
+    uint64_t tick = 0;
+
+    /// @brief Step batch of bodies. Batches may be stepped in parallel
+    void stepBatch(size_t batch);
+};
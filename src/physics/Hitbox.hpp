@@ -57,9 +57,23 @@ struct Hitbox {
     bool grounded = false;
     float gravityScale = 1.0f;
     bool crouching = false;
+    /// @brief Resting body is not stepped until woken up
+    bool sleeping = false;
+    /// @brief Time the body is resting for
+    float restTime = 0.0f;
+    /// @brief Hash of blocks versions of chunks around the body when it
+    /// fell asleep
+    uint64_t sleepBlocksVersion = 0;
+    /// @brief Time passed since the last physics step
+    float skippedTime = 0.0f;
 
     Hitbox(BodyType type, glm::vec3 position, glm::vec3 halfsize);
 
+    void wakeUp() {
+        sleeping = false;
+        restTime = 0.0f;
+    }
+
     AABB getAABB() const {
         return AABB(position-halfsize, position+halfsize);
     }
@@ -16,16 +16,48 @@
 const float E = 0.03f;
 const float MAX_FIX = 0.1f;
 
-PhysicsSolver::PhysicsSolver(glm::vec3 gravity) : gravity(gravity) {
+/// @brief Sensors grid cell size
+inline constexpr float SENSORS_CELL_SIZE = 8.0f;
+/// @brief Maximum number of grid cells a sensor may be put to
+inline constexpr size_t MAX_SENSOR_CELLS = 256;
+
+PhysicsSolver::PhysicsSolver(glm::vec3 gravity)
+    : gravity(gravity), sensorsGrid(SENSORS_CELL_SIZE) {
+}
+
+static AABB get_sensor_bounds(const Sensor& sensor) {
+    switch (sensor.type) {
+        case SensorType::AABB:
+            return sensor.calculated.aabb;
+        case SensorType::RADIUS: {
+            glm::vec3 center(sensor.calculated.radial);
+            float radius = std::sqrt(sensor.calculated.radial.w);
+            return AABB(center - radius, center + radius);
+        }
+    }
+    return AABB();
+}
+
+void PhysicsSolver::setSensors(std::vector<Sensor*> sensors) {
+    this->sensors = std::move(sensors);
+    sensorsGrid.clear();
+    largeSensors.clear();
+    for (size_t i = 0; i < this->sensors.size(); i++) {
+        auto bounds = get_sensor_bounds(*this->sensors[i]);
+        if (sensorsGrid.countCells(bounds) > MAX_SENSOR_CELLS) {
+            largeSensors.push_back(i);
+        } else {
+            sensorsGrid.insert(bounds, i);
+        }
+    }
 }
 
 void PhysicsSolver::step(
     const GlobalChunks& chunks, 
     Hitbox& hitbox, 
     float delta, 
-    uint substeps, 
-    entityid_t entity
-) {
+    uint substeps
+) const {
     float dt = delta / static_cast<float>(substeps);
     float linearDamping = hitbox.linearDamping;
 
@@ -71,9 +103,25 @@ void PhysicsSolver::step(
             }
         }
     }
+}
+
+bool PhysicsSolver::testSensors(const Hitbox& hitbox, entityid_t entity) {
     AABB aabb = hitbox.getAABB();
-    for (size_t i = 0; i < sensors.size(); i++) {
-        auto& sensor = *sensors[i];
+    bool entered = false;
+    nearSensors = largeSensors;
+    sensorsGrid.query(aabb, [this](size_t index) {
+        nearSensors.push_back(index);
+    });
+    // keep sensors order independent of the grid
+    std::sort(nearSensors.begin(), nearSensors.end());
+    nearSensors.erase(
+        std::unique(nearSensors.begin(), nearSensors.end()), nearSensors.end()
+    );
+    for (size_t index : nearSensors) {
+        if (sensors[index] == nullptr) {
+            continue;
+        }
+        auto& sensor = *sensors[index];
         if (sensor.entity == entity) {
             continue;
         }
@@ -92,10 +140,12 @@ void PhysicsSolver::step(
         if (triggered) {
             if (sensor.prevEntered.find(entity) == sensor.prevEntered.end()) {
                 sensor.enterCallback(sensor.entity, sensor.index, entity);
+                entered = true;
             }
             sensor.nextEntered.insert(entity);
         }
     }
+    return entered;
 }
 
 /// @brief calculate max stepHeight if something above
@@ -179,10 +229,10 @@ void PhysicsSolver::colisionCalc(
     glm::vec3& pos,
     const glm::vec3 half,
     float stepHeight
-) {
+) const {
     stepHeight = calc_step_height(chunks, hitbox, stepHeight);
 
-    const AABB* aabb;
+    std::optional<AABB> aabb;
     
     calc_collision_neg<0, 1, 2>(chunks, pos, vel, half);
     calc_collision_pos<0, 1, 2>(chunks, pos, vel, half);
@@ -241,5 +291,8 @@ bool PhysicsSolver::isBlockInside(int x, int y, int z, Block* def, blockstate st
 }
 
 void PhysicsSolver::removeSensor(Sensor* sensor) {
-    sensors.erase(std::remove(sensors.begin(), sensors.end(), sensor), sensors.end());
+    // indices must stay valid for the grid
+    std::replace(
+        sensors.begin(), sensors.end(), sensor, static_cast<Sensor*>(nullptr)
+    );
 }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Hitbox.hpp"
+#include "SpatialHash.hpp"
 
 #include "typedefs.hpp"
 #include "voxels/voxel.hpp"
@@ -14,16 +15,28 @@ struct Sensor;
 
 class PhysicsSolver {
     glm::vec3 gravity;
+    /// @brief Active sensors (removed ones are replaced with nullptr)
     std::vector<Sensor*> sensors;
+    /// @brief Broadphase grid of sensors indices
+    SpatialHash<size_t> sensorsGrid;
+    /// @brief Indices of sensors too large to be put to the grid
+    std::vector<size_t> largeSensors;
+    /// @brief Indices of sensors near the body being stepped
+    std::vector<size_t> nearSensors;
 public:
     PhysicsSolver(glm::vec3 gravity);
+    /// @brief Move the body checking voxel collisions only.
+    /// May be called from multiple threads for different bodies
     void step(
         const GlobalChunks& chunks,
         Hitbox& hitbox,
         float delta,
-        uint substeps,
-        entityid_t entity
-    );
+        uint substeps
+    ) const;
+    /// @brief Test the body against active sensors calling enter callbacks.
+    /// Must be called from the main thread after the step
+    /// @return true if the body entered any sensor
+    bool testSensors(const Hitbox& hitbox, entityid_t entity);
     void colisionCalc(
         const GlobalChunks& chunks,
         Hitbox& hitbox,
@@ -31,13 +44,11 @@ public:
         glm::vec3& pos,
         const glm::vec3 half,
         float stepHeight
-    );
+    ) const;
     bool isBlockInside(int x, int y, int z, Hitbox* hitbox);
     bool isBlockInside(int x, int y, int z, Block* def, blockstate state, Hitbox* hitbox);
 
-    void setSensors(std::vector<Sensor*> sensors) {
-        this->sensors = std::move(sensors);
-    }
+    void setSensors(std::vector<Sensor*> sensors);
 
     void removeSensor(Sensor* sensor);
 };
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
+#include <vector>
+
+#define GLM_ENABLE_EXPERIMENTAL
+#include <glm/glm.hpp>
+#include <glm/gtx/hash.hpp>
+
+#include "maths/aabb.hpp"
+
+/// @brief Uniform grid of values split by XZ cells. Used as a broadphase
+/// for spatial queries: only values from cells overlapping the query box
+/// are visited
+/// @tparam T value type (equality comparable)
+template <typename T>
+class SpatialHash {
+    float cellSize;
+    std::unordered_map<glm::ivec2, std::vector<T>> cells;
+
+    inline int toCell(float coord) const {
+        constexpr float limit = 1 << 30;
+        return static_cast<int>(
+            std::floor(std::clamp(coord / cellSize, -limit, limit))
+        );
+    }
+public:
+    SpatialHash(float cellSize) : cellSize(cellSize) {
+    }
+
+    glm::ivec2 cellOf(const glm::vec3& pos) const {
+        return {toCell(pos.x), toCell(pos.z)};
+    }
+
+    /// @brief Get cells range overlapping the box (inclusive)
+    void getRange(const AABB& aabb, glm::ivec2& min, glm::ivec2& max) const {
+        min = cellOf(aabb.min());
+        max = cellOf(aabb.max());
+    }
+
+    /// @brief Get number of cells overlapping the box
+    size_t countCells(const AABB& aabb) const {
+        glm::ivec2 min, max;
+        getRange(aabb, min, max);
+        return static_cast<size_t>(static_cast<int64_t>(max.x) - min.x + 1) *
+               static_cast<size_t>(static_cast<int64_t>(max.y) - min.y + 1);
+    }
+
+    void insert(const glm::ivec2& cell, T value) {
+        cells[cell].push_back(std::move(value));
+    }
+
+    /// @brief Insert value to all cells overlapping the box
+    void insert(const AABB& aabb, const T& value) {
+        glm::ivec2 min, max;
+        getRange(aabb, min, max);
+        for (int z = min.y; z <= max.y; z++) {
+            for (int x = min.x; x <= max.x; x++) {
+                insert({x, z}, value);
+            }
+        }
+    }
+
+    /// @brief Remove value from the cell. Order of the cell values
+    /// is not preserved
+    /// @return false if value not found
+    bool remove(const glm::ivec2& cell, const T& value) {
+        auto found = cells.find(cell);
+        if (found == cells.end()) {
+            return false;
+        }
+        auto& values = found->second;
+        auto it = std::find(values.begin(), values.end(), value);
+        if (it == values.end()) {
+            return false;
+        }
+        *it = std::move(values.back());
+        values.pop_back();
+        if (values.empty()) {
+            cells.erase(found);
+        }
+        return true;
+    }
+
+    void clear() {
+        cells.clear();
+    }
+
+    /// @brief Call func for each value in cells overlapping the box.
+    /// Values inserted to multiple cells may be visited multiple times
+    template <typename Func>
+    void query(const AABB& aabb, const Func& func) const {
+        glm::ivec2 min, max;
+        getRange(aabb, min, max);
+        if (countCells(aabb) > cells.size()) {
+            // the box is larger than occupied area
+            for (const auto& [cell, values] : cells) {
+                if (cell.x >= min.x && cell.x <= max.x && cell.y >= min.y &&
+                    cell.y <= max.y) {
+                    for (const auto& value : values) {
+                        func(value);
+                    }
+                }
+            }
+            return;
+        }
+        for (int z = min.y; z <= max.y; z++) {
+            for (int x = min.x; x <= max.x; x++) {
+                auto found = cells.find({x, z});
+                if (found == cells.end()) {
+                    continue;
+                }
+                for (const auto& value : found->second) {
+                    func(value);
+                }
+            }
+        }
+    }
+};
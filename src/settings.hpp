@@ -40,6 +40,28 @@ struct ChunksSettings {
     IntegerSetting loadDistance {22, 3, 80};
     /// @brief Buffer zone where chunks are not unloading (chunk is unit)
     IntegerSetting padding {2, 1, 8};
+    /// @brief Number of chunks loading threads (0 - load on the main thread)
+    IntegerSetting loadThreads {4, -4, 32};
+    /// @brief Number of threads used for world generation
+    IntegerSetting generatorThreads {1, 1, 16};
+    /// @brief Number of threads used to build chunks lights
+    IntegerSetting lightThreads {2, 1, 16};
+    /// @brief Build chunks lights on a dedicated thread
+    FlagSetting lightingThread {false};
+    /// @brief Build and save chunks lights when running headless server
+    FlagSetting serverLighting {true};
+    /// @brief Max megabytes of in-memory region data per regions layer
+    /// (0 - unlimited)
+    IntegerSetting regionsCacheSize {64, 0, 4096};
+};
+
+struct PhysicsSettings {
+    /// @brief Number of threads used to step entities physics
+    IntegerSetting threads {2, 1, 16};
+    /// @brief Distance to the nearest player from which entities physics
+    /// is stepped less frequently. The step interval is doubled every next
+    /// such distance, up to 8 ticks (0 - disabled)
+    IntegerSetting lodDistance {64, 0, 1024};
 };
 
 struct CameraSettings {
@@ -65,6 +87,8 @@ struct GraphicsSettings {
     FlagSetting backlight {true};
     /// @brief Disable culling with 'optional' mode
     FlagSetting denseRender {true};
+    /// @brief Merge adjacent faces of full-cube blocks into larger ones
+    FlagSetting greedyMeshing {false};
     /// @brief Enable chunks frustum culling
     FlagSetting frustumCulling {true};
     /// @brief Skybox texture face resolution
@@ -96,6 +120,7 @@ struct EngineSettings {
     AudioSettings audio;
     DisplaySettings display;
     ChunksSettings chunks;
+    PhysicsSettings physics;
     CameraSettings camera;
     GraphicsSettings graphics;
     DebugSettings debug;
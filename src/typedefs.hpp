@@ -4,6 +4,8 @@
 #include <cstdint>
 
 using scriptenv = std::shared_ptr<int>;
+/// @brief script event handle (0 - no event)
+using eventhandle_t = int;
 
 class ObserverHandler;
 
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+
+#include "span.hpp"
+
+namespace util {
+    /// @brief Growable FIFO ring buffer with bulk copy in and out.
+    /// Reading from the front does not move remaining elements
+    /// @tparam T trivially copyable elements type
+    template <typename T>
+    class RingBuffer {
+        static_assert(std::is_trivially_copyable_v<T>);
+
+        std::unique_ptr<T[]> ptr;
+        size_t length = 0;
+        /// @brief Index of the first element
+        size_t head = 0;
+        /// @brief Number of stored elements
+        size_t count = 0;
+
+        /// @brief Reallocate storage keeping elements, head becomes 0
+        void reallocate(size_t newCapacity) {
+            auto newPtr = std::make_unique<T[]>(newCapacity);
+            peek(newPtr.get(), count);
+            ptr = std::move(newPtr);
+            length = newCapacity;
+            head = 0;
+        }
+    public:
+        RingBuffer() = default;
+
+        RingBuffer(size_t capacity)
+            : ptr(capacity ? std::make_unique<T[]>(capacity) : nullptr),
+              length(capacity) {
+        }
+
+        RingBuffer(RingBuffer&&) = default;
+        RingBuffer& operator=(RingBuffer&&) = default;
+
+        /// @brief Make capacity at least of the given number of elements
+        void reserve(size_t capacity) {
+            if (capacity > length) {
+                reallocate(std::max(capacity, length * 2));
+            }
+        }
+
+        /// @brief Append elements to the back growing the buffer if needed
+        void put(const T* src, size_t n) {
+            if (n == 0) {
+                return;
+            }
+            reserve(count + n);
+            size_t tail = (head + count) % length;
+            size_t first = std::min(n, length - tail);
+            std::memcpy(ptr.get() + tail, src, first * sizeof(T));
+            std::memcpy(ptr.get(), src + first, (n - first) * sizeof(T));
+            count += n;
+        }
+
+        /// @brief Copy up to n elements from the front without removing them
+        /// @return number of copied elements
+        size_t peek(T* dst, size_t n) const {
+            n = std::min(n, count);
+            if (n == 0) {
+                return 0;
+            }
+            size_t first = std::min(n, length - head);
+            std::memcpy(dst, ptr.get() + head, first * sizeof(T));
+            std::memcpy(dst + first, ptr.get(), (n - first) * sizeof(T));
+            return n;
+        }
+
+        /// @brief Get contiguous elements from the front. Remaining ones
+        /// are stored at the buffer start if elements are wrapped around
+        span<const T> front() const {
+            return span<const T>(
+                ptr.get() + head, std::min(count, length - head)
+            );
+        }
+
+        /// @brief Remove up to n elements from the front
+        /// @return number of removed elements
+        size_t skip(size_t n) {
+            n = std::min(n, count);
+            count -= n;
+            head = count ? (head + n) % length : 0;
+            return n;
+        }
+
+        /// @brief Move up to n elements from the front to dst
+        /// @return number of moved elements
+        size_t get(T* dst, size_t n) {
+            return skip(peek(dst, n));
+        }
+
+        /// @brief Get contiguous free space after the last element, growing
+        /// the buffer if less than minFree elements are available there.
+        /// Written elements must be committed with commit(...)
+        span<T> prepare(size_t minFree) {
+            reserve(count + std::max<size_t>(minFree, 1));
+            size_t tail = (head + count) % length;
+            size_t end = tail < head ? head : length;
+            if (end - tail < minFree) {
+                // free space is split by the buffer end
+                reallocate(length);
+                tail = count;
+                end = length;
+            }
+            return span<T>(ptr.get() + tail, end - tail);
+        }
+
+        /// @brief Append n elements written to the prepare(...) result
+        void commit(size_t n) {
+            count += n;
+        }
+
+        void clear() {
+            head = 0;
+            count = 0;
+        }
+
+        size_t size() const {
+            return count;
+        }
+
+        size_t capacity() const {
+            return length;
+        }
+
+        bool empty() const {
+            return count == 0;
+        }
+    };
+}
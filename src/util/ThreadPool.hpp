@@ -38,6 +38,8 @@ namespace util {
         std::queue<T> jobs;
         std::queue<ThreadPoolResult<T, R>> results;
         std::mutex resultsMutex;
+        /// @brief Notified when a worker finishes a job
+        std::condition_variable resultsCondition;
         std::vector<std::thread> threads;
         std::condition_variable jobsMutexCondition;
         std::mutex jobsMutex;
@@ -82,6 +84,7 @@ namespace util {
                         }
                         busyWorkers--;
                     }
+                    resultsCondition.notify_all();
                     if (!standaloneResults) {
                         std::unique_lock<std::mutex> lock(mutex);
                         variable.wait(lock, [&] {
@@ -89,7 +92,6 @@ namespace util {
                         });
                     }
                 } catch (std::exception& err) {
-                    busyWorkers--;
                     if (onJobFailed) {
                         onJobFailed(job);
                     }
@@ -98,6 +100,11 @@ namespace util {
                         failed = true;
                     }
                     logger.error() << "uncaught exception: " << err.what();
+                    {
+                        std::lock_guard<std::mutex> lock(resultsMutex);
+                        busyWorkers--;
+                    }
+                    resultsCondition.notify_all();
                 }
                 jobsDone++;
             }
@@ -271,6 +278,26 @@ namespace util {
             return jobsDone;
         }
 
+        /// @brief Block until all enqueued jobs are done, passing results
+        /// to the consumer on the calling thread. Used to run jobs
+        /// referencing the caller stack data
+        /// @throws std::runtime_error if a job failed and stopOnFail is set
+        void waitForJobs() {
+            bool done = false;
+            while (working && !done) {
+                {
+                    std::unique_lock<std::mutex> lock(resultsMutex);
+                    resultsCondition.wait(lock, [this, &done] {
+                        std::lock_guard<std::mutex> jobsLock(jobsMutex);
+                        // jobs left in queue are never taken after failure
+                        done = busyWorkers == 0 && (jobs.empty() || failed);
+                        return done || !results.empty();
+                    });
+                }
+                update();
+            }
+        }
+
         virtual void waitForEnd() override {
             using namespace std::chrono_literals;
             while (working) {
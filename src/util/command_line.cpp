@@ -28,6 +28,8 @@ static bool perform_keyword(
         std::cout << " --headless - run in headless mode\n";
         std::cout << " --test <path> - test script file\n";
         std::cout << " --script <path> - main script file\n";
+        std::cout << " --trace <path> - write headless ticks trace file\n";
+        std::cout << " --report <path> - write headless ticks report file\n";
         std::cout << std::endl;
         return false;
     } else if (keyword == "--version") {
@@ -43,6 +45,10 @@ static bool perform_keyword(
         auto token = reader.next();
         params.testMode = false;
         params.scriptFile = token;
+    } else if (keyword == "--trace") {
+        params.traceFile = reader.next();
+    } else if (keyword == "--report") {
+        params.reportFile = reader.next();
     } else {
         throw std::runtime_error("unknown argument " + keyword);
     }
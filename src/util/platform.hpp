@@ -13,4 +13,6 @@ namespace platform {
     /// Makes the current thread sleep for the specified amount of milliseconds.
     void sleep(size_t millis);
     int get_process_id();
+    /// @return peak resident set size of the process in bytes
+    size_t get_peak_memory_usage();
 }
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+
+namespace util {
+    /// @brief Non-owning view of a contiguous sequence (std::span replacement
+    /// until C++20)
+    template <typename T>
+    class span {
+        T* ptr;
+        size_t length;
+    public:
+        span() : ptr(nullptr), length(0) {}
+        span(T* ptr, size_t length) : ptr(ptr), length(length) {}
+
+        T* data() const {
+            return ptr;
+        }
+
+        size_t size() const {
+            return length;
+        }
+
+        bool empty() const {
+            return length == 0;
+        }
+
+        T& operator[](size_t index) const {
+            return ptr[index];
+        }
+
+        T* begin() const {
+            return ptr;
+        }
+
+        T* end() const {
+            return ptr + length;
+        }
+    };
+}
@@ -35,16 +35,18 @@ inline constexpr size_t MAX_USER_BLOCK_FIELDS_SIZE = 240;
 
 inline std::string DEFAULT_MATERIAL = "base:stone";
 
+/// @brief Block script events handles (0 if the function is not defined)
 struct BlockFuncsSet {
-    bool init : 1;
-    bool update : 1;
-    bool onplaced : 1;
-    bool onbreaking : 1;
-    bool onbroken : 1;
-    bool onreplaced : 1;
-    bool oninteract : 1;
-    bool randupdate : 1;
-    bool onblockstick : 1;
+    eventhandle_t init;
+    eventhandle_t update;
+    eventhandle_t onplaced;
+    eventhandle_t onbreaking;
+    eventhandle_t onbroken;
+    eventhandle_t onreplaced;
+    eventhandle_t oninteract;
+    eventhandle_t randupdate;
+    eventhandle_t randupdatebatch;
+    eventhandle_t onblockstick;
 };
 
 struct CoordSystem {
@@ -260,7 +262,7 @@ public:
         /// @brief set of hitboxes sets with all coord-systems precalculated
         std::vector<AABB> hitboxes[BlockRotProfile::MAX_COUNT];
 
-        /// @brief set of block callbacks flags
+        /// @brief set of block callbacks handles
         BlockFuncsSet funcsset {};
 
         /// @brief picking item integer id
@@ -14,20 +14,53 @@ Chunk::Chunk(int xpos, int zpos) : x(xpos), z(zpos) {
 }
 
 void Chunk::updateHeights() {
-    for (uint i = 0; i < CHUNK_VOL; i++) {
-        if (voxels[i].id != 0) {
+    occupancy = 0;
+    for (uint y = 0; y < CHUNK_SECTIONS; y++) {
+        if (!voxels.isEmpty(y)) {
+            occupancy |= 1 << y;
+        }
+    }
+    if (occupancy == 0) {
+        return;
+    }
+    // only the lowest and the highest non-empty sections are scanned
+    uint bottomSection = 0;
+    while (!isSectionOccupied(bottomSection)) {
+        bottomSection++;
+    }
+    uint topSection = CHUNK_SECTIONS - 1;
+    while (!isSectionOccupied(topSection)) {
+        topSection--;
+    }
+    uint begin = bottomSection * CHUNK_SECTION_VOL;
+    for (uint i = begin; i < begin + CHUNK_SECTION_VOL; i++) {
+        if (voxels.get(i).id != 0) {
             bottom = i / (CHUNK_D * CHUNK_W);
             break;
         }
     }
-    for (int i = CHUNK_VOL - 1; i >= 0; i--) {
-        if (voxels[i].id != 0) {
+    int end = topSection * CHUNK_SECTION_VOL;
+    for (int i = end + CHUNK_SECTION_VOL - 1; i >= end; i--) {
+        if (voxels.get(i).id != 0) {
             top = i / (CHUNK_D * CHUNK_W) + 1;
             break;
         }
     }
 }
 
+bool Chunk::compactIdle(uint64_t tick, uint idleTicks) {
+    if (idleVersion != blocksVersion) {
+        idleVersion = blocksVersion;
+        idleSince = tick;
+        return false;
+    }
+    if (tick - idleSince < idleTicks || voxels.isCompact()) {
+        return false;
+    }
+    voxels.compact();
+    return true;
+}
+
 void Chunk::addBlockInventory(
     std::shared_ptr<Inventory> inventory, uint x, uint y, uint z
 ) {
@@ -57,8 +90,10 @@ std::shared_ptr<Inventory> Chunk::getBlockInventory(uint x, uint y, uint z)
 
 std::unique_ptr<Chunk> Chunk::clone() const {
     auto other = std::make_unique<Chunk>(x, z);
-    for (uint i = 0; i < CHUNK_VOL; i++) {
-        other->voxels[i] = voxels[i];
+    voxel buffer[CHUNK_SECTION_VOL];
+    for (uint y = 0; y < CHUNK_SECTIONS; y++) {
+        voxels.getSection(y, buffer);
+        other->voxels.setSection(y, buffer);
     }
     other->lightmap.set(&lightmap);
     return other;
@@ -77,22 +112,12 @@ std::unique_ptr<Chunk> Chunk::clone() const {
 */
 std::unique_ptr<ubyte[]> Chunk::encode() const {
     auto buffer = std::make_unique<ubyte[]>(CHUNK_DATA_LEN);
-    auto dst = reinterpret_cast<uint16_t*>(buffer.get());
-    for (uint i = 0; i < CHUNK_VOL; i++) {
-        dst[i] = dataio::h2le(voxels[i].id);
-        dst[CHUNK_VOL + i] = dataio::h2le(blockstate2int(voxels[i].state));
-    }
+    voxels.encode(buffer.get());
     return buffer;
 }
 
 bool Chunk::decode(const ubyte* data) {
-    auto src = reinterpret_cast<const uint16_t*>(data);
-    for (uint i = 0; i < CHUNK_VOL; i++) {
-        voxel& vox = voxels[i];
-
-        vox.id = dataio::le2h(src[i]);
-        vox.state = int2blockstate(dataio::le2h(src[CHUNK_VOL + i]));
-    }
+    voxels.decode(data);
     return true;
 }
 
@@ -6,6 +6,8 @@
 #include <unordered_map>
 
 #include "constants.hpp"
+#include "ChunkDeltas.hpp"
+#include "ChunkVoxels.hpp"
 #include "lighting/Lightmap.hpp"
 #include "util/SmallHeap.hpp"
 #include "maths/aabb.hpp"
@@ -14,6 +16,8 @@
 /// @brief Total bytes number of chunk voxel data
 inline constexpr int CHUNK_DATA_LEN = CHUNK_VOL * 4;
 
+static_assert(CHUNK_SECTIONS <= sizeof(uint16_t) * 8);
+
 class ContentReport;
 class Inventory;
 
@@ -26,7 +30,11 @@ class Chunk {
 public:
     int x, z;
     int bottom, top;
-    voxel voxels[CHUNK_VOL] {};
+    /// @brief Bit per voxels section set if the section may contain
+    /// non-air blocks. Refreshed by updateHeights, bits are set on blocks
+    /// placement
+    uint16_t occupancy = 0xFFFF;
+    ChunkVoxels voxels;
     Lightmap lightmap;
     struct {
         bool modified : 1;
@@ -43,12 +51,37 @@ public:
     ChunkInventoriesMap inventories;
     /// @brief Blocks metadata heap
     BlocksMetadata blocksMetadata;
+    /// @brief Block changes recorded for remote peers (nullptr if not tracked)
+    std::unique_ptr<ChunkDeltas> deltas;
+    /// @brief Incremented on every blocks modification
+    uint32_t blocksVersion = 0;
+    /// @brief blocksVersion observed by the last compactIdle call
+    uint32_t idleVersion = 0;
+    /// @brief Tick since blocks were not modified
+    uint64_t idleSince = 0;
+    /// @brief Number of the last random tick the chunk was updated in
+    /// (see BlocksController::randomTick)
+    uint64_t randomTickStamp = 0;
 
     Chunk(int x, int z);
 
-    /// @brief Refresh `bottom` and `top` values
+    /// @brief Refresh `bottom`, `top` and `occupancy` values
     void updateHeights();
 
+    /// @param y section index
+    /// @return false if all section blocks are air
+    inline bool isSectionOccupied(uint y) const {
+        return occupancy & (1 << y);
+    }
+
+    /// @brief Pack voxel sections expanded by modifications if blocks were
+    /// not modified for the given number of ticks. Must not be called while
+    /// voxel references are held
+    /// @param tick current tick number
+    /// @param idleTicks number of ticks without blocks modifications
+    /// @return true if voxels were packed
+    bool compactIdle(uint64_t tick, uint idleTicks);
+
     // unused
     std::unique_ptr<Chunk> clone() const;
 
@@ -66,6 +99,15 @@ public:
     inline void setModifiedAndUnsaved() {
         flags.modified = true;
         flags.unsaved = true;
+        blocksVersion++;
+    }
+
+    /// @brief Record voxel change if deltas are tracked
+    /// @param index voxel index
+    inline void recordDelta(uint index) {
+        if (deltas) {
+            deltas->record(index, voxels.get(index));
+        }
     }
 
     /// @brief Encode chunk to bytes array of size CHUNK_DATA_LEN
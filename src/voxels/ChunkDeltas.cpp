@@ -0,0 +1,66 @@
+#include "ChunkDeltas.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "constants.hpp"
+#include "coders/byte_utils.hpp"
+
+bool ChunkDeltas::pull(ByteBuilder& builder) {
+    if (!complete) {
+        complete = true;
+        return false;
+    }
+    std::stable_sort(
+        changes.begin(),
+        changes.end(),
+        [](const auto& a, const auto& b) { return a.index < b.index; }
+    );
+    // keep the last change of each voxel
+    size_t count = 0;
+    for (size_t i = 0; i < changes.size(); i++) {
+        if (i + 1 < changes.size() &&
+            changes[i].index == changes[i + 1].index) {
+            continue;
+        }
+        changes[count++] = changes[i];
+    }
+    builder.putVarUInt32(count);
+    uint prevIndex = 0;
+    for (size_t i = 0; i < count; i++) {
+        const auto& change = changes[i];
+        builder.putVarUInt32(change.index - prevIndex);
+        builder.putVarUInt32(change.vox.id);
+        builder.putVarUInt32(blockstate2int(change.vox.state));
+        prevIndex = change.index;
+    }
+    changes.clear();
+    return true;
+}
+
+std::vector<ChunkDeltas::Change> ChunkDeltas::decode(
+    const ubyte* src, size_t size
+) {
+    ByteReader reader(src, size);
+    uint count = reader.getVarUInt32();
+    // every change takes at least 3 bytes
+    if (count > reader.remaining() / 3) {
+        throw std::runtime_error("corrupted chunk deltas");
+    }
+    std::vector<Change> changes;
+    changes.reserve(count);
+    uint index = 0;
+    for (uint i = 0; i < count; i++) {
+        uint offset = reader.getVarUInt32();
+        uint id = reader.getVarUInt32();
+        uint state = reader.getVarUInt32();
+        if (offset >= CHUNK_VOL - index || id > 0xFFFF || state > 0xFFFF) {
+            throw std::runtime_error("corrupted chunk deltas");
+        }
+        index += offset;
+        changes.push_back(
+            {index, {static_cast<blockid_t>(id), int2blockstate(state)}}
+        );
+    }
+    return changes;
+}
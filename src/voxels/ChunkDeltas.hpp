@@ -0,0 +1,61 @@
+#pragma once
+
+#include <vector>
+
+#include "typedefs.hpp"
+#include "voxel.hpp"
+
+class ByteBuilder;
+
+/// @brief Block changes of a chunk recorded to be sent to remote peers
+/// instead of the whole chunk data
+/// @see /doc/specs/chunk_deltas_spec.md
+class ChunkDeltas {
+public:
+    struct Change {
+        uint index;
+        voxel vox;
+    };
+private:
+    std::vector<Change> changes;
+    /// @brief Changes are recorded since the last pull
+    bool complete = false;
+public:
+    /// @brief Maximum number of changes recorded between pulls.
+    /// History gets incomplete when exceeded
+    static constexpr size_t MAX_CHANGES = 16'384;
+
+    /// @param index voxel index in the chunk
+    /// @param vox new voxel value
+    void record(uint index, voxel vox) {
+        if (!complete) {
+            return;
+        }
+        if (changes.size() == MAX_CHANGES) {
+            invalidate();
+            return;
+        }
+        changes.push_back({index, vox});
+    }
+
+    /// @brief Drop recorded changes. Next pull will fail so peers must be
+    /// sent the whole chunk data
+    void invalidate() {
+        changes.clear();
+        complete = false;
+    }
+
+    /// @brief Encode changes recorded since the last pull and start
+    /// a new history. Only the last change of a voxel is encoded
+    /// @return false if history is incomplete (nothing is written)
+    bool pull(ByteBuilder& builder);
+
+    size_t size() const {
+        return changes.size();
+    }
+
+    /// @brief Decode changes encoded with pull
+    /// @return changes ordered by voxel index
+    /// @throws std::runtime_error if data is corrupted or truncated
+    static std::vector<Change> decode(const ubyte* src, size_t size);
+};
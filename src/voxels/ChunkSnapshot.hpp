@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstdint>
+
+#include "VoxelsVolume.hpp"
+
+/// @brief Immutable copy of chunk voxels and lights including border slabs
+/// of the neighbour chunks. Safe to be read by other threads while the
+/// chunk is being modified
+struct ChunkSnapshot {
+    int x;
+    int z;
+    int bottom;
+    int top;
+    /// @brief Chunk sections occupancy mask at the moment of snapshot
+    /// @see Chunk::occupancy
+    uint16_t occupancy = 0xFFFF;
+    /// @brief Snapshot version assigned by the consumer to drop outdated
+    /// results
+    uint64_t version = 0;
+    /// @brief Chunk area with neighbour slabs in global blocks coordinates.
+    /// Covers layers in range [bottom - padding, top + padding) only
+    VoxelsVolume volume;
+
+    ChunkSnapshot(
+        int x, int z, int bottom, int top, int padding, int minY, int maxY
+    )
+        : x(x),
+          z(z),
+          bottom(bottom),
+          top(top),
+          volume(
+              x * CHUNK_W - padding,
+              minY,
+              z * CHUNK_D - padding,
+              CHUNK_W + padding * 2,
+              maxY - minY,
+              CHUNK_D + padding * 2
+          ) {
+    }
+
+    /// @param y section index
+    /// @return false if all section blocks are air
+    inline bool isSectionOccupied(int y) const {
+        return occupancy & (1 << y);
+    }
+
+    /// @param lx,ly,lz chunk-local block position
+    inline const voxel& getVoxel(int lx, int ly, int lz) const {
+        int padding = (volume.getW() - CHUNK_W) / 2;
+        return volume.getVoxels()[vox_index(
+            lx + padding,
+            ly - volume.getY(),
+            lz + padding,
+            volume.getW(),
+            volume.getD()
+        )];
+    }
+};
@@ -0,0 +1,226 @@
+#include "ChunkVoxels.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#include "util/data_io.hpp"
+
+/// @brief Max number of distinct voxels in a paletted section
+inline constexpr size_t MAX_PALETTE_SIZE = 256;
+/// @brief Size of open addressing table used to build a section palette
+inline constexpr uint PALETTE_TABLE_SIZE = MAX_PALETTE_SIZE * 2;
+
+static inline uint32_t voxel2int(voxel vox) {
+    return vox.id | static_cast<uint32_t>(blockstate2int(vox.state)) << 16;
+}
+
+static inline uint table_slot(uint32_t key) {
+    return (key * 2654435761U) % PALETTE_TABLE_SIZE;
+}
+
+static inline uint bits_for(size_t paletteSize) {
+    if (paletteSize <= 2) return 1;
+    if (paletteSize <= 4) return 2;
+    if (paletteSize <= 16) return 4;
+    return 8;
+}
+
+void ChunkVoxels::pack(VoxelSection& section, const voxel* src) {
+    uint32_t keys[PALETTE_TABLE_SIZE];
+    int16_t values[PALETTE_TABLE_SIZE];
+    std::fill(std::begin(values), std::end(values), -1);
+
+    std::vector<voxel> palette;
+    ubyte indices[CHUNK_SECTION_VOL];
+    uint32_t prevKey = voxel2int(src[0]);
+    ubyte prevIndex = 0;
+    palette.push_back(src[0]);
+    keys[table_slot(prevKey)] = prevKey;
+    values[table_slot(prevKey)] = 0;
+
+    for (uint i = 0; i < CHUNK_SECTION_VOL; i++) {
+        uint32_t key = voxel2int(src[i]);
+        if (key != prevKey) {
+            uint slot = table_slot(key);
+            while (values[slot] != -1 && keys[slot] != key) {
+                slot = (slot + 1) % PALETTE_TABLE_SIZE;
+            }
+            if (values[slot] == -1) {
+                if (palette.size() == MAX_PALETTE_SIZE) {
+                    // too many distinct voxels, storing plain array
+                    if (section.voxels.get() != src) {
+                        section.voxels.reset(new voxel[CHUNK_SECTION_VOL]);
+                        std::memcpy(
+                            section.voxels.get(),
+                            src,
+                            sizeof(voxel) * CHUNK_SECTION_VOL
+                        );
+                    }
+                    section.bits = 0;
+                    section.indices.reset();
+                    std::vector<voxel>().swap(section.palette);
+                    return;
+                }
+                keys[slot] = key;
+                values[slot] = palette.size();
+                palette.push_back(src[i]);
+            }
+            prevKey = key;
+            prevIndex = values[slot];
+        }
+        indices[i] = prevIndex;
+    }
+    if (palette.size() == 1) {
+        section.bits = 0;
+        section.uniform = palette[0];
+        section.indices.reset();
+        std::vector<voxel>().swap(section.palette);
+        section.voxels.reset();
+        return;
+    }
+    uint bits = bits_for(palette.size());
+    auto packed = std::make_unique<ubyte[]>(CHUNK_SECTION_VOL * bits / 8);
+    for (uint i = 0; i < CHUNK_SECTION_VOL; i++) {
+        uint bit = i * bits;
+        packed[bit >> 3] |= indices[i] << (bit & 7);
+    }
+    section.bits = bits;
+    section.palette = std::move(palette);
+    section.palette.shrink_to_fit();
+    section.indices = std::move(packed);
+    section.voxels.reset();
+}
+
+void ChunkVoxels::unpack(const VoxelSection& section, voxel* dst) {
+    if (section.voxels) {
+        std::memcpy(
+            dst, section.voxels.get(), sizeof(voxel) * CHUNK_SECTION_VOL
+        );
+    } else if (section.bits == 0) {
+        std::fill(dst, dst + CHUNK_SECTION_VOL, section.uniform);
+    } else if (section.bits == 8) {
+        for (uint i = 0; i < CHUNK_SECTION_VOL; i++) {
+            dst[i] = section.palette[section.indices[i]];
+        }
+    } else {
+        uint bits = section.bits;
+        uint mask = (1U << bits) - 1;
+        for (uint i = 0; i < CHUNK_SECTION_VOL; i++) {
+            uint bit = i * bits;
+            uint index = (section.indices[bit >> 3] >> (bit & 7)) & mask;
+            dst[i] = section.palette[index];
+        }
+    }
+}
+
+voxel* ChunkVoxels::expand(VoxelSection& section) {
+    std::unique_ptr<voxel[]> voxels(new voxel[CHUNK_SECTION_VOL]);
+    unpack(section, voxels.get());
+    section.voxels = std::move(voxels);
+    section.indices.reset();
+    return section.voxels.get();
+}
+
+void ChunkVoxels::getSection(uint y, voxel* dst) const {
+    unpack(sections[y], dst);
+}
+
+void ChunkVoxels::setSection(uint y, const voxel* src) {
+    pack(sections[y], src);
+    expanded &= ~(1 << y);
+}
+
+void ChunkVoxels::getAll(voxel* dst) const {
+    for (uint y = 0; y < CHUNK_SECTIONS; y++) {
+        unpack(sections[y], dst + y * CHUNK_SECTION_VOL);
+    }
+}
+
+void ChunkVoxels::setAll(const voxel* src) {
+    for (uint y = 0; y < CHUNK_SECTIONS; y++) {
+        pack(sections[y], src + y * CHUNK_SECTION_VOL);
+    }
+    expanded = 0;
+}
+
+void ChunkVoxels::encode(ubyte* dst) const {
+    auto ids = reinterpret_cast<uint16_t*>(dst);
+    auto states = ids + CHUNK_VOL;
+    voxel buffer[CHUNK_SECTION_VOL];
+    for (uint y = 0; y < CHUNK_SECTIONS; y++) {
+        uint offset = y * CHUNK_SECTION_VOL;
+        const auto& section = sections[y];
+        if (section.voxels == nullptr && section.bits == 0) {
+            std::fill_n(
+                ids + offset,
+                CHUNK_SECTION_VOL,
+                dataio::h2le(section.uniform.id)
+            );
+            std::fill_n(
+                states + offset,
+                CHUNK_SECTION_VOL,
+                dataio::h2le(blockstate2int(section.uniform.state))
+            );
+            continue;
+        }
+        unpack(section, buffer);
+        for (uint i = 0; i < CHUNK_SECTION_VOL; i++) {
+            ids[offset + i] = dataio::h2le(buffer[i].id);
+            states[offset + i] = dataio::h2le(blockstate2int(buffer[i].state));
+        }
+    }
+}
+
+void ChunkVoxels::decode(const ubyte* src) {
+    auto ids = reinterpret_cast<const uint16_t*>(src);
+    auto states = ids + CHUNK_VOL;
+    voxel buffer[CHUNK_SECTION_VOL];
+    for (uint y = 0; y < CHUNK_SECTIONS; y++) {
+        uint offset = y * CHUNK_SECTION_VOL;
+        for (uint i = 0; i < CHUNK_SECTION_VOL; i++) {
+            buffer[i].id = dataio::le2h(ids[offset + i]);
+            buffer[i].state = int2blockstate(dataio::le2h(states[offset + i]));
+        }
+        pack(sections[y], buffer);
+    }
+    expanded = 0;
+}
+
+blockid_t ChunkVoxels::getMaxId(uint y) const {
+    const auto& section = sections[y];
+    blockid_t maxId = 0;
+    if (section.voxels) {
+        const voxel* voxels = section.voxels.get();
+        for (uint i = 0; i < CHUNK_SECTION_VOL; i++) {
+            maxId = std::max(maxId, voxels[i].id);
+        }
+        return maxId;
+    }
+    for (const auto& vox : getPalette(y)) {
+        maxId = std::max(maxId, vox.id);
+    }
+    return maxId;
+}
+
+void ChunkVoxels::compact() {
+    for (uint y = 0; y < CHUNK_SECTIONS; y++) {
+        if (expanded & (1 << y)) {
+            pack(sections[y], sections[y].voxels.get());
+        }
+    }
+    expanded = 0;
+}
+
+size_t ChunkVoxels::getMemoryUsage() const {
+    size_t size = sizeof(ChunkVoxels);
+    for (const auto& section : sections) {
+        size += section.palette.capacity() * sizeof(voxel);
+        if (section.indices) {
+            size += CHUNK_SECTION_VOL * section.bits / 8;
+        }
+        if (section.voxels) {
+            size += CHUNK_SECTION_VOL * sizeof(voxel);
+        }
+    }
+    return size;
+}
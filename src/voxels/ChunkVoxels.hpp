@@ -0,0 +1,147 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "constants.hpp"
+#include "typedefs.hpp"
+#include "util/span.hpp"
+#include "voxel.hpp"
+
+/// @brief Height of a chunk section
+inline constexpr int CHUNK_SECTION_H = 16;
+/// @brief Count of voxels per chunk section
+inline constexpr int CHUNK_SECTION_VOL = CHUNK_W * CHUNK_D * CHUNK_SECTION_H;
+/// @brief Count of sections per chunk
+inline constexpr int CHUNK_SECTIONS = CHUNK_H / CHUNK_SECTION_H;
+
+/// @brief Chunk voxels stored as 16x16x16 sections. Section is stored as
+/// a single voxel if uniform, as bit-packed indices into the section palette
+/// if it has up to 256 distinct voxels or as a plain voxels array.
+/// Modified sections stay expanded to plain arrays until compact() call.
+///
+/// References returned by get() are valid until compact(), setSection() or
+/// setAll() call, but may refer to an outdated value after the section is
+/// modified
+class ChunkVoxels {
+    struct VoxelSection {
+        /// @brief Bits per palette index: 0 if uniform, 1, 2, 4 or 8
+        ubyte bits = 0;
+        voxel uniform {};
+        /// @brief Kept when the section is expanded as get() references
+        /// may point to it
+        std::vector<voxel> palette;
+        std::unique_ptr<ubyte[]> indices;
+        /// @brief Plain voxels array or nullptr if not expanded
+        std::unique_ptr<voxel[]> voxels;
+    };
+    VoxelSection sections[CHUNK_SECTIONS];
+    /// @brief Bit per section expanded by modifications since packing
+    uint16_t expanded = 0;
+
+    static void pack(VoxelSection& section, const voxel* src);
+    static void unpack(const VoxelSection& section, voxel* dst);
+    static voxel* expand(VoxelSection& section);
+public:
+    /// @param index voxel index in the chunk
+    inline const voxel& get(uint index) const {
+        const auto& section = sections[index / CHUNK_SECTION_VOL];
+        index %= CHUNK_SECTION_VOL;
+        if (section.voxels) {
+            return section.voxels[index];
+        }
+        if (section.bits == 0) {
+            return section.uniform;
+        }
+        uint bit = index * section.bits;
+        uint mask = (1U << section.bits) - 1;
+        uint paletteIndex = (section.indices[bit >> 3] >> (bit & 7)) & mask;
+        return section.palette[paletteIndex];
+    }
+
+    /// @brief Get mutable voxel reference. Expands the voxel section
+    /// @param index voxel index in the chunk
+    inline voxel& ref(uint index) {
+        auto& section = sections[index / CHUNK_SECTION_VOL];
+        voxel* voxels = section.voxels.get();
+        if (voxels == nullptr) {
+            voxels = expand(section);
+            expanded |= 1 << (index / CHUNK_SECTION_VOL);
+        }
+        return voxels[index % CHUNK_SECTION_VOL];
+    }
+
+    /// @param index voxel index in the chunk
+    inline void set(uint index, voxel vox) {
+        ref(index) = vox;
+    }
+
+    /// @brief Copy section voxels
+    /// @param y section index
+    /// @param dst array of CHUNK_SECTION_VOL voxels
+    void getSection(uint y, voxel* dst) const;
+
+    /// @brief Replace section voxels with packed ones
+    /// @param y section index
+    /// @param src array of CHUNK_SECTION_VOL voxels
+    void setSection(uint y, const voxel* src);
+
+    /// @brief Copy all voxels
+    /// @param dst array of CHUNK_VOL voxels
+    void getAll(voxel* dst) const;
+
+    /// @brief Replace all voxels with packed ones
+    /// @param src array of CHUNK_VOL voxels
+    void setAll(const voxel* src);
+
+    /// @brief Encode voxels to bytes array of size CHUNK_VOL * 4
+    /// @see /doc/specs/region_voxels_chunk_spec.md
+    void encode(ubyte* dst) const;
+
+    /// @brief Decode voxels from bytes array of size CHUNK_VOL * 4
+    void decode(const ubyte* src);
+
+    /// @brief Pack expanded sections. Invalidates references returned by
+    /// get() and ref()
+    void compact();
+
+    /// @return true if no sections were expanded since packing
+    bool isCompact() const {
+        return expanded == 0;
+    }
+
+    /// @param y section index
+    /// @return true if all section voxels are the same
+    bool isUniform(uint y) const {
+        return sections[y].voxels == nullptr && sections[y].bits == 0;
+    }
+
+    /// @param y section index
+    /// @return max block id of the section. Packed section palette may
+    /// contain voxels no longer present in the section
+    blockid_t getMaxId(uint y) const;
+
+    /// @param y section index
+    /// @return true if all section voxels are air
+    bool isEmpty(uint y) const {
+        return getMaxId(y) == BLOCK_AIR;
+    }
+
+    /// @brief Get distinct voxels of the section. Packed section palette
+    /// may contain voxels no longer present in the section
+    /// @param y section index
+    /// @return section palette or empty span if the section is expanded
+    util::span<const voxel> getPalette(uint y) const {
+        const auto& section = sections[y];
+        if (section.voxels) {
+            return {};
+        }
+        if (section.bits == 0) {
+            return {&section.uniform, 1};
+        }
+        return {section.palette.data(), section.palette.size()};
+    }
+
+    /// @brief Count of bytes used to store voxels
+    size_t getMemoryUsage() const;
+};
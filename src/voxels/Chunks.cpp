@@ -18,6 +18,7 @@
 #include "world/Level.hpp"
 #include "world/LevelEvents.hpp"
 #include "VoxelsVolume.hpp"
+#include "ChunkSnapshot.hpp"
 #include "blocks_agent.hpp"
 
 Chunks::Chunks(
@@ -45,11 +46,11 @@ void Chunks::configure(int32_t x, int32_t z, uint32_t radius) {
     setCenter(x, z);
 }
 
-voxel* Chunks::get(int32_t x, int32_t y, int32_t z) const {
+const voxel* Chunks::get(int32_t x, int32_t y, int32_t z) const {
     return blocks_agent::get(*this, x, y, z);
 }
 
-voxel& Chunks::require(int32_t x, int32_t y, int32_t z) const {
+const voxel& Chunks::require(int32_t x, int32_t y, int32_t z) const {
     return blocks_agent::require(*this, x, y, z);
 }
 
@@ -57,7 +58,7 @@ const AABB* Chunks::isObstacleAt(float x, float y, float z) const {
     int ix = std::floor(x);
     int iy = std::floor(y);
     int iz = std::floor(z);
-    voxel* v = get(ix, iy, iz);
+    const voxel* v = get(ix, iy, iz);
     if (v == nullptr) {
         if (iy >= CHUNK_H) {
             return nullptr;
@@ -95,7 +96,7 @@ bool Chunks::isReplaceableBlock(int32_t x, int32_t y, int32_t z) {
 }
 
 bool Chunks::isObstacleBlock(int32_t x, int32_t y, int32_t z) {
-    voxel* v = get(x, y, z);
+    const voxel* v = get(x, y, z);
     if (v == nullptr) return false;
     return indices.blocks.require(v->id).obstacle;
 }
@@ -202,7 +203,7 @@ void Chunks::set(
     blocks_agent::set(*this, x, y, z, id, state);
 }
 
-voxel* Chunks::rayCast(
+const voxel* Chunks::rayCast(
     const glm::vec3& start,
     const glm::vec3& dir,
     float maxDist,
@@ -251,7 +252,7 @@ glm::vec3 Chunks::rayCastToObstacle(
     float tzMax = (tzDelta < infinity) ? tzDelta * zdist : infinity;
 
     while (t <= maxDist) {
-        voxel* voxel = get(ix, iy, iz);
+        const voxel* voxel = get(ix, iy, iz);
         if (voxel) {
             const auto& def = indices.blocks.require(voxel->id);
             if (def.obstacle) {
@@ -372,9 +373,14 @@ void Chunks::getVoxels(VoxelsVolume& volume, bool backlight) const {
                     }
                 }
             } else {
-                const voxel* cvoxels = chunk->voxels;
+                const auto& cvoxels = chunk->voxels;
                 const light_t* clights = chunk->lightmap.getLights();
                 for (int ly = y; ly < y + h; ly++) {
+                    // uniform section rows are filled without decoding
+                    const voxel* uniform = nullptr;
+                    if (cvoxels.isUniform(ly / CHUNK_SECTION_H)) {
+                        uniform = &cvoxels.get(vox_index(0, ly, 0));
+                    }
                     for (int lz = std::max(z, cz * CHUNK_D);
                              lz < std::min(z + d, (cz + 1) * CHUNK_D);
                              lz++) {
@@ -389,7 +395,8 @@ void Chunks::getVoxels(VoxelsVolume& volume, bool backlight) const {
                                 CHUNK_W,
                                 CHUNK_D
                             );
-                            voxels[vidx] = cvoxels[cidx];
+                            voxels[vidx] =
+                                uniform ? *uniform : cvoxels.get(cidx);
                             light_t light = clights[cidx];
                             if (backlight) {
                                 const auto block =
@@ -416,6 +423,20 @@ void Chunks::getVoxels(VoxelsVolume& volume, bool backlight) const {
     }
 }
 
+std::shared_ptr<ChunkSnapshot> Chunks::createSnapshot(
+    const Chunk& chunk, int padding, bool backlight
+) const {
+    int minY = std::max(0, std::min(chunk.bottom, chunk.top) - padding);
+    int maxY = std::min(CHUNK_H, chunk.top + padding);
+    auto snapshot = std::make_shared<ChunkSnapshot>(
+        chunk.x, chunk.z, chunk.bottom, chunk.top, padding, minY,
+        std::max(minY + 1, maxY)
+    );
+    snapshot->occupancy = chunk.occupancy;
+    getVoxels(snapshot->volume, backlight);
+    return snapshot;
+}
+
 void Chunks::saveAndClear() {
     areaMap.clear();
 }
@@ -21,6 +21,7 @@ class WorldFiles;
 class LevelEvents;
 class Block;
 class VoxelsVolume;
+struct ChunkSnapshot;
 
 /// Player-centred chunks matrix
 class Chunks {
@@ -64,12 +65,8 @@ public:
         );
     }
 
-    voxel* get(int32_t x, int32_t y, int32_t z) const;
-    voxel& require(int32_t x, int32_t y, int32_t z) const;
-
-    inline voxel* get(const glm::ivec3& pos) {
-        return get(pos.x, pos.y, pos.z);
-    }
+    const voxel* get(int32_t x, int32_t y, int32_t z) const;
+    const voxel& require(int32_t x, int32_t y, int32_t z) const;
 
     inline const voxel* get(const glm::ivec3& pos) const {
         return get(pos.x, pos.y, pos.z);
@@ -102,7 +99,7 @@ public:
 
     void setRotation(int32_t x, int32_t y, int32_t z, uint8_t rotation);
 
-    voxel* rayCast(
+    const voxel* rayCast(
         const glm::vec3& start,
         const glm::vec3& dir,
         float maxLength,
@@ -128,6 +125,13 @@ public:
 
     void getVoxels(VoxelsVolume& volume, bool backlight = false) const;
 
+    /// @brief Copy chunk voxels and lights with neighbours border slabs
+    /// of the given width. Only layers near to the chunk blocks are copied
+    /// @param padding border slabs width
+    std::shared_ptr<ChunkSnapshot> createSnapshot(
+        const Chunk& chunk, int padding, bool backlight = false
+    ) const;
+
     void setCenter(int32_t x, int32_t z);
     void resize(uint32_t newW, uint32_t newD);
 
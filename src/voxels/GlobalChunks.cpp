@@ -8,6 +8,7 @@
 #include "debug/Logger.hpp"
 #include "world/files/WorldFiles.hpp"
 #include "items/Inventories.hpp"
+#include "lighting/Lighting.hpp"
 #include "lighting/Lightmap.hpp"
 #include "maths/voxmaths.hpp"
 #include "objects/Entities.hpp"
@@ -41,9 +42,17 @@ std::shared_ptr<Chunk> GlobalChunks::fetch(int x, int z) {
 static void check_voxels(const ContentIndices& indices, Chunk& chunk) {
     bool corrupted = false;
     blockid_t defsCount = indices.blocks.count();
-    for (size_t i = 0; i < CHUNK_VOL; i++) {
-        blockid_t id = chunk.voxels[i].id;
-        if (id >= defsCount) {
+    for (uint y = 0; y < CHUNK_SECTIONS; y++) {
+        // uniform and paletted sections are checked by palette
+        if (chunk.voxels.getMaxId(y) < defsCount) {
+            continue;
+        }
+        uint begin = y * CHUNK_SECTION_VOL;
+        for (uint i = begin; i < begin + CHUNK_SECTION_VOL; i++) {
+            blockid_t id = chunk.voxels.get(i).id;
+            if (id < defsCount) {
+                continue;
+            }
             if (!corrupted) {
 #ifdef NDEBUG
                 // release
@@ -57,7 +66,7 @@ static void check_voxels(const ContentIndices& indices, Chunk& chunk) {
                 abort();
 #endif
             }
-            chunk.voxels[i].id = BLOCK_AIR;
+            chunk.voxels.ref(i).id = BLOCK_AIR;
         }
     }
 }
@@ -75,7 +84,7 @@ static inline auto load_inventories(
     auto iterator = invs.begin();
     while (iterator != invs.end()) {
         uint index = iterator->first;
-        const auto& def = defs.require(chunk.voxels[index].id);
+        const auto& def = defs.require(chunk.voxels.get(index).id);
         if (def.inventorySize == 0) {
             iterator = invs.erase(iterator);
             continue;
@@ -89,38 +98,24 @@ static inline auto load_inventories(
     return invs;
 }
 
-std::shared_ptr<Chunk> GlobalChunks::create(int x, int z) {
-    const auto& found = chunksMap.find(keyfrom(x, z));
-    if (found != chunksMap.end()) {
-        return found->second;
-    }
-
+LoadedChunk GlobalChunks::load(
+    WorldRegions& regions, const ContentIndices& indices, int x, int z
+) {
     auto chunk = std::make_shared<Chunk>(x, z);
-    chunksMap[keyfrom(x, z)] = chunk;
-
-    World& world = *level.getWorld();
-    auto& regions = world.wfile.get()->getRegions();
+    dv::value entities = nullptr;
 
     if (auto data = regions.getVoxels(chunk->x, chunk->z)) {
-        const auto& indices = *level.content.getIndices();
-
         chunk->decode(data.get());
         check_voxels(indices, *chunk);
 
         chunk->setBlockInventories(
             load_inventories(regions, *chunk, indices.blocks)
         );
-
         auto entitiesData = regions.fetchEntities(chunk->x, chunk->z);
         if (entitiesData.getType() == dv::value_type::object) {
-            level.entities->loadEntities(std::move(entitiesData));
-            chunk->flags.entities = true;
+            entities = std::move(entitiesData);
         }
-
         chunk->flags.loaded = true;
-        for (auto& entry : chunk->inventories) {
-            level.inventories->store(entry.second);
-        }
     }
     if (auto lights = regions.getLights(chunk->x, chunk->z)) {
         chunk->lightmap.set(lights.get());
@@ -128,10 +123,43 @@ std::shared_ptr<Chunk> GlobalChunks::create(int x, int z) {
     }
     chunk->blocksMetadata = regions.getBlocksData(chunk->x, chunk->z);
 
+    if (chunk->flags.loaded) {
+        chunk->updateHeights();
+        if (!chunk->flags.loadedLights) {
+            Lighting::prebuildSkyLight(*chunk, indices);
+        }
+    }
+    return LoadedChunk {std::move(chunk), std::move(entities)};
+}
+
+std::shared_ptr<Chunk> GlobalChunks::integrate(LoadedChunk loaded) {
+    auto& chunk = loaded.chunk;
+    const auto& found = chunksMap.find(keyfrom(chunk->x, chunk->z));
+    if (found != chunksMap.end()) {
+        return found->second;
+    }
+    chunksMap[keyfrom(chunk->x, chunk->z)] = chunk;
+
+    if (loaded.entities != nullptr) {
+        level.entities->loadEntities(std::move(loaded.entities));
+        chunk->flags.entities = true;
+    }
+    for (auto& entry : chunk->inventories) {
+        level.inventories->store(entry.second);
+    }
     level.events->trigger(LevelEventType::CHUNK_PRESENT, chunk.get());
     return chunk;
 }
 
+std::shared_ptr<Chunk> GlobalChunks::create(int x, int z) {
+    const auto& found = chunksMap.find(keyfrom(x, z));
+    if (found != chunksMap.end()) {
+        return found->second;
+    }
+    auto& regions = level.getWorld()->wfile->getRegions();
+    return integrate(load(regions, indices, x, z));
+}
+
 void GlobalChunks::pinChunk(std::shared_ptr<Chunk> chunk) {
     pinnedChunks[{chunk->x, chunk->z}] = std::move(chunk);
 }
@@ -201,6 +229,20 @@ void GlobalChunks::saveAll() {
     }
 }
 
+void GlobalChunks::compactIdle(uint idleTicks, size_t budget) {
+    size_t packed = 0;
+    // chunks not visited due to the budget are only packed later
+    for (const auto& [_, chunk] : chunksMap) {
+        if (packed == budget) {
+            break;
+        }
+        if (chunk->compactIdle(ticks, idleTicks)) {
+            packed++;
+        }
+    }
+    ticks++;
+}
+
 void GlobalChunks::putChunk(std::shared_ptr<Chunk> chunk) {
     chunksMap[keyfrom(chunk->x, chunk->z)] = std::move(chunk);
 }
@@ -208,10 +250,12 @@ void GlobalChunks::putChunk(std::shared_ptr<Chunk> chunk) {
 const AABB* GlobalChunks::isObstacleAt(float x, float y, float z) const {
     return blocks_agent::is_obstacle_at(*this, x, y, z);
 }
-const AABB* GlobalChunks::isObstacleWith(AABB box) const {
+std::optional<AABB> GlobalChunks::isObstacleWith(AABB box) const {
     return blocks_agent::is_obstacle_with(*this, box);
 }
-const AABB* GlobalChunks::isObstacleWith(float x, float y, float z, const glm::vec3& halfbox) const {
+std::optional<AABB> GlobalChunks::isObstacleWith(
+    float x, float y, float z, const glm::vec3& halfbox
+) const {
     return isObstacleWith(AABB(glm::vec3(x, y, z)-halfbox, glm::vec3(x, y, z)+halfbox));
 }
 
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <memory>
+#include <optional>
 #include <unordered_map>
 
 #define GLM_ENABLE_EXPERIMENTAL
@@ -9,11 +10,20 @@
 
 #include "voxel.hpp"
 #include "delegates.hpp"
+#include "data/dv.hpp"
+#include "maths/aabb.hpp"
 
 class Chunk;
 class Level;
-struct AABB;
 class ContentIndices;
+class WorldRegions;
+
+/// @brief Chunk read from world regions but not added to the level yet
+struct LoadedChunk {
+    std::shared_ptr<Chunk> chunk;
+    /// @brief Saved entities data (loaded on integration)
+    dv::value entities = nullptr;
+};
 
 class GlobalChunks {
     static inline uint64_t keyfrom(int32_t x, int32_t z) {
@@ -33,6 +43,8 @@ class GlobalChunks {
     std::unordered_map<ptrdiff_t, int> refCounters;
 
     consumer<Chunk&> onUnload;
+    /// @brief Number of compactIdle calls
+    uint64_t ticks = 0;
 public:
     GlobalChunks(Level& level);
     ~GlobalChunks() = default;
@@ -42,6 +54,18 @@ public:
     std::shared_ptr<Chunk> fetch(int x, int z);
     std::shared_ptr<Chunk> create(int x, int z);
 
+    /// @brief Read and decode chunk data without touching the level state.
+    /// May be called from a worker thread.
+    /// @return chunk with flags.loaded set if saved voxels were found
+    static LoadedChunk load(
+        WorldRegions& regions, const ContentIndices& indices, int x, int z
+    );
+
+    /// @brief Add chunk produced by GlobalChunks::load to the level.
+    /// Must be called from the main thread.
+    /// @return already present chunk or the integrated one
+    std::shared_ptr<Chunk> integrate(LoadedChunk loaded);
+
     void pinChunk(std::shared_ptr<Chunk> chunk);
     void unpinChunk(int x, int z);
 
@@ -55,11 +79,19 @@ public:
     void save(Chunk* chunk);
     void saveAll();
 
+    /// @brief Pack voxels of chunks not modified for the given number of
+    /// ticks. Called once per tick when no voxel references are held
+    /// @param idleTicks number of ticks without blocks modifications
+    /// @param budget max number of chunks packed per call
+    void compactIdle(uint idleTicks, size_t budget);
+
     void putChunk(std::shared_ptr<Chunk> chunk);
 
     const AABB* isObstacleAt(float x, float y, float z) const;
-    const AABB* isObstacleWith(float x, float y, float z, const glm::vec3& halfbox) const;
-    const AABB* isObstacleWith(AABB box) const;
+    std::optional<AABB> isObstacleWith(
+        float x, float y, float z, const glm::vec3& halfbox
+    ) const;
+    std::optional<AABB> isObstacleWith(AABB box) const;
 
     inline Chunk* getChunk(int cx, int cz) const {
         const auto& found = chunksMap.find(keyfrom(cx, cz));
@@ -30,7 +30,7 @@ static inline void set_block(
     size_t index = vox_index(lx, y, lz);
 
     // block finalization
-    voxel& vox = chunk->voxels[(y * CHUNK_D + lz) * CHUNK_W + lx];
+    voxel& vox = chunk->voxels.ref(index);
     const auto& prevdef = indices.blocks.require(vox.id);
     if (prevdef.inventorySize != 0) {
         chunk->removeBlockInventory(lx, y, lz);
@@ -51,10 +51,14 @@ static inline void set_block(
     vox.id = id;
     vox.state = state;
     chunk->setModifiedAndUnsaved();
+    chunk->recordDelta(index);
     if (!state.segment && newdef.rt.extended) {
         repair_segments(chunks, newdef, state, x, y, z);
     }
 
+    if (id != BLOCK_AIR) {
+        chunk->occupancy |= 1 << (y / CHUNK_SECTION_H);
+    }
     if (y < chunk->bottom)
         chunk->bottom = y;
     else if (y + 1 > chunk->top)
@@ -99,7 +103,7 @@ void blocks_agent::set(
 }
 
 template <class Storage>
-static inline voxel* raycast_blocks(
+static inline const voxel* raycast_blocks(
     const Storage& chunks,
     const glm::vec3& start,
     const glm::vec3& dir,
@@ -144,7 +148,7 @@ static inline voxel* raycast_blocks(
     int steppedIndex = -1;
 
     while (t <= maxDist) {
-        voxel* voxel = get(chunks, ix, iy, iz);
+        const voxel* voxel = get(chunks, ix, iy, iz);
         if (voxel == nullptr) {
             return nullptr;
         }
@@ -240,7 +244,7 @@ static inline voxel* raycast_blocks(
     return nullptr;
 }
 
-voxel* blocks_agent::raycast(
+const voxel* blocks_agent::raycast(
     const Chunks& chunks,
     const glm::vec3& start,
     const glm::vec3& dir,
@@ -253,7 +257,7 @@ voxel* blocks_agent::raycast(
     return raycast_blocks(chunks, start, dir, maxDist, end, norm, iend, filter);
 }
 
-voxel* blocks_agent::raycast(
+const voxel* blocks_agent::raycast(
     const GlobalChunks& chunks,
     const glm::vec3& start,
     const glm::vec3& dir,
@@ -313,9 +317,14 @@ inline void get_voxels_impl(
                     }
                 }
             } else {
-                const voxel* cvoxels = chunk->voxels;
+                const auto& cvoxels = chunk->voxels;
                 const light_t* clights = chunk->lightmap.getLights();
                 for (int ly = y; ly < y + h; ly++) {
+                    // uniform section rows are filled without decoding
+                    const voxel* uniform = nullptr;
+                    if (cvoxels.isUniform(ly / CHUNK_SECTION_H)) {
+                        uniform = &cvoxels.get(vox_index(0, ly, 0));
+                    }
                     for (int lz = std::max(z, cz * CHUNK_D);
                              lz < std::min(z + d, (cz + 1) * CHUNK_D);
                              lz++) {
@@ -330,7 +339,8 @@ inline void get_voxels_impl(
                                 CHUNK_W,
                                 CHUNK_D
                             );
-                            voxels[vidx] = cvoxels[cidx];
+                            voxels[vidx] =
+                                uniform ? *uniform : cvoxels.get(cidx);
                             light_t light = clights[cidx];
                             if (backlight) {
                                 const auto block = blocks.get(voxels[vidx].id);
@@ -14,6 +14,7 @@
 #include "maths/voxmaths.hpp"
 
 #include <algorithm>
+#include <optional>
 #include <set>
 #include <algorithm>
 #include <stdint.h>
@@ -42,9 +43,12 @@ inline Chunk* get_chunk(const Storage& chunks, int cx, int cz) {
 /// @param x position X
 /// @param y position Y
 /// @param z position Z
-/// @return voxel pointer or nullptr
+/// @return voxel pointer or nullptr. Valid until the chunk voxels are
+/// compacted, may point to an outdated value after the block is modified
 template<class Storage>
-inline voxel* get(const Storage& chunks, int32_t x, int32_t y, int32_t z) {
+inline const voxel* get(
+    const Storage& chunks, int32_t x, int32_t y, int32_t z
+) {
     if (y < 0 || y >= CHUNK_H) {
         return nullptr;
     }
@@ -56,7 +60,7 @@ inline voxel* get(const Storage& chunks, int32_t x, int32_t y, int32_t z) {
     }
     int lx = x - cx * CHUNK_W;
     int lz = z - cz * CHUNK_D;
-    return &chunk->voxels[(y * CHUNK_D + lz) * CHUNK_W + lx];
+    return &chunk->voxels.get((y * CHUNK_D + lz) * CHUNK_W + lx);
 }
 
 /// @brief Get voxel at specified position.
@@ -68,7 +72,9 @@ inline voxel* get(const Storage& chunks, int32_t x, int32_t y, int32_t z) {
 /// @param z position Z
 /// @return voxel reference
 template<class Storage>
-inline voxel& require(const Storage& chunks, int32_t x, int32_t y, int32_t z) {
+inline const voxel& require(
+    const Storage& chunks, int32_t x, int32_t y, int32_t z
+) {
     auto vox = get(chunks, x, y, z);
     if (vox == nullptr) {
         throw std::runtime_error("voxel does not exist");
@@ -144,6 +150,33 @@ void set(
     blockstate state
 );
 
+/// @brief Set block state at specified position keeping the block id.
+/// Extended block segments are not updated
+/// @tparam Storage chunks storage class
+/// @param chunks chunks storage
+/// @param x block position X
+/// @param y block position Y
+/// @param z block position Z
+/// @param state new block state
+template<class Storage>
+inline void set_state(
+    const Storage& chunks, int32_t x, int32_t y, int32_t z, blockstate state
+) {
+    if (y < 0 || y >= CHUNK_H) {
+        return;
+    }
+    int cx = floordiv<CHUNK_W>(x);
+    int cz = floordiv<CHUNK_D>(z);
+    Chunk* chunk = get_chunk(chunks, cx, cz);
+    if (chunk == nullptr) {
+        return;
+    }
+    uint index = vox_index(x - cx * CHUNK_W, y, z - cz * CHUNK_D);
+    chunk->voxels.ref(index).state = state;
+    chunk->setModifiedAndUnsaved();
+    chunk->recordDelta(index);
+}
+
 /// @brief Erase extended block segments
 /// @tparam Storage chunks storage class
 /// @param chunks chunks storage
@@ -330,12 +363,7 @@ inline void set_rotation_extended(
                 if (vox->id != def.rt.id) {
                     set(chunks, pos.x, pos.y, pos.z, def.rt.id, segState);
                 } else {
-                    vox->state = segState;
-                    int cx = floordiv<CHUNK_W>(pos.x);
-                    int cz = floordiv<CHUNK_D>(pos.z);
-                    auto chunk = get_chunk(chunks, cx, cz);
-                    assert(chunk != nullptr);
-                    chunk->setModifiedAndUnsaved();
+                    set_state(chunks, pos.x, pos.y, pos.z, segState);
                     segmentBlocks.emplace_back(pos);
                 }
             }
@@ -386,12 +414,9 @@ inline void set_rotation(
         vox = get(chunks, origin.x, origin.y, origin.z);
         set_rotation_extended(chunks, def, vox->state, origin, index);
     } else {
-        vox->state.rotation = index;
-        int cx = floordiv<CHUNK_W>(x);
-        int cz = floordiv<CHUNK_D>(z);
-        auto chunk = get_chunk(chunks, cx, cz);
-        assert(chunk != nullptr);
-        chunk->setModifiedAndUnsaved();
+        auto state = vox->state;
+        state.rotation = index;
+        set_state(chunks, x, y, z, state);
     }
 }
 
@@ -405,7 +430,7 @@ inline void set_rotation(
 /// @param iend [out] ray end integer position (voxel position + normal)
 /// @param filter filtered ids
 /// @return voxel pointer or nullptr
-voxel* raycast(
+const voxel* raycast(
     const Chunks& chunks,
     const glm::vec3& start,
     const glm::vec3& dir,
@@ -426,7 +451,7 @@ voxel* raycast(
 /// @param iend [out] ray end integer position (voxel position + normal)
 /// @param filter filtered ids
 /// @return voxel pointer or nullptr
-voxel* raycast(
+const voxel* raycast(
     const GlobalChunks& chunks,
     const glm::vec3& start,
     const glm::vec3& dir,
@@ -446,7 +471,7 @@ inline const AABB* is_obstacle_at(const Storage& chunks, float x, float y, float
     int ix = std::floor(x);
     int iy = std::floor(y);
     int iz = std::floor(z);
-    voxel* v = get(chunks, ix, iy, iz);
+    const voxel* v = get(chunks, ix, iy, iz);
     if (v == nullptr) {
         if (iy >= CHUNK_H) {
             return nullptr;
@@ -474,18 +499,31 @@ inline const AABB* is_obstacle_at(const Storage& chunks, float x, float y, float
     }
     return nullptr;
 }
+
+/// @brief Check if the box intersects any obstacle.
+/// Thread-safe if chunks are not modified concurrently.
+/// @return union of intersected block hitboxes in block-local coordinates
+/// or std::nullopt
 template <class Storage>
-inline const AABB* is_obstacle_with(const Storage& chunks, AABB box) {
-    static AABB combined_box;
-    bool is_null = true;
+inline std::optional<AABB> is_obstacle_with(const Storage& chunks, AABB box) {
+    std::optional<AABB> combined_box;
+    auto add_box = [&combined_box](const AABB& local) {
+        if (!combined_box) {
+            combined_box = local;
+        } else {
+            combined_box->addPoint(local.min());
+            combined_box->addPoint(local.max());
+        }
+    };
     for (int ix = floor(box.min().x); ix <= ceil(box.max().x); ++ix) {
         for (int iy = floor(box.min().y); iy <= ceil(box.max().y); ++iy) {
             for (int iz = floor(box.min().z); iz <= ceil(box.max().z); ++iz) {
                 glm::vec3 vec{ix, iy, iz};
-                voxel* v = get(chunks, ix, iy, iz);
+                const voxel* v = get(chunks, ix, iy, iz);
                 if (v == nullptr) {
                     if (iy < CHUNK_H) {
-                        is_null = false;
+                        // missing chunks are solid
+                        add_box(AABB());
                     }
                     continue;
                 }
@@ -504,21 +542,14 @@ inline const AABB* is_obstacle_with(const Storage& chunks, AABB box) {
                         if (union_box.contains(
                             box.center() - vec - offset
                         )) {
-                            is_null = false;
-                            combined_box.addPoint(hitbox.min() + vec);
-                            combined_box.addPoint(hitbox.max() + vec);
-                            continue;
+                            add_box(hitbox.translated(offset));
                         }
                     }
                 }
             }
         }
     }
-    if (is_null) {
-        return nullptr;
-    } else {
-        return &combined_box;
-    }
+    return combined_box;
 }
 
 } // blocks_agent
@@ -49,6 +49,29 @@ static void read_voxel_data(ByteReader& reader, util::Buffer<ubyte>& dst) {
     extrle::decode16(rleData.data(), rleData.size(), dst.data());
 }
 
+/// @throws std::runtime_error if unknown block id found
+static void check_voxels(
+    const Chunk& chunk, const ChunkVoxels& voxels, blockid_t defsCount
+) {
+    for (uint y = 0; y < CHUNK_SECTIONS; y++) {
+        // uniform and paletted sections are checked by palette
+        if (voxels.getMaxId(y) < defsCount) {
+            continue;
+        }
+        uint begin = y * CHUNK_SECTION_VOL;
+        for (uint i = begin; i < begin + CHUNK_SECTION_VOL; i++) {
+            blockid_t id = voxels.get(i).id;
+            if (id >= defsCount) {
+                throw std::runtime_error(
+                    "block data corruption (chunk: " + std::to_string(chunk.x) +
+                    ", " + std::to_string(chunk.z) + ") at " +
+                    std::to_string(i) + " id: " + std::to_string(id)
+                );
+            }
+        }
+    }
+}
+
 void compressed_chunks::decode(
     Chunk& chunk, const ubyte* src, size_t size, const ContentIndices& indices
 ) {
@@ -61,19 +84,10 @@ void compressed_chunks::decode(
         /// world.get_chunk_data is only available in the main Lua state
         static util::Buffer<ubyte> voxelData (CHUNK_DATA_LEN);
         read_voxel_data(reader, voxelData);
-        // TODO: move somewhere in Chunk
-        auto src = reinterpret_cast<const uint16_t*>(voxelData.data());
-        for (size_t i = 0; i < CHUNK_VOL; i++) {
-            blockid_t id = dataio::le2h(src[i]);;
-            if (indices.blocks.get(id) == nullptr) {
-                throw std::runtime_error(
-                    "block data corruption (chunk: " + std::to_string(chunk.x) +
-                    ", " + std::to_string(chunk.z) + ") at " +
-                    std::to_string(i) + " id: " + std::to_string(id)
-                );
-            }
-        }
-        chunk.decode(voxelData.data());
+        ChunkVoxels voxels;
+        voxels.decode(voxelData.data());
+        check_voxels(chunk, voxels, indices.blocks.count());
+        chunk.voxels = std::move(voxels);
         chunk.updateHeights();
     }
     if (flags & HAS_METADATA) {
@@ -82,6 +96,9 @@ void compressed_chunks::decode(
         reader.skip(metadataSize);
     }
     chunk.setModifiedAndUnsaved();
+    if (chunk.deltas) {
+        chunk.deltas->invalidate();
+    }
 }
 
 void compressed_chunks::save(
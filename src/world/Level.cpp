@@ -26,7 +26,7 @@ Level::Level(
       chunks(std::make_unique<GlobalChunks>(*this)),
       physics(std::make_unique<PhysicsSolver>(glm::vec3(0, -22.6f, 0))),
       events(std::make_unique<LevelEvents>()),
-      entities(std::make_unique<Entities>(*this)),
+      entities(std::make_unique<Entities>(*this, settings.physics)),
       players(std::make_unique<Players>(*this)) {
     const auto& worldInfo = world->getInfo();
     auto& cameraIndices = content.getIndices(ResourceType::CAMERA);
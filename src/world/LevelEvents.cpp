@@ -1,17 +1,37 @@
 #include "LevelEvents.hpp"
 
+#include <algorithm>
+
 #include "voxels/Chunk.hpp"
 
 using std::vector;
 
 void LevelEvents::listen(LevelEventType type, const ChunkEventFunc& func) {
     auto& callbacks = chunk_callbacks[type];
-    callbacks.push_back(func);
+    callbacks.emplace_back(nextid++, func);
+}
+
+ObserverHandler LevelEvents::observe(
+    LevelEventType type, const ChunkEventFunc& func
+) {
+    int id = nextid++;
+    chunk_callbacks[type].emplace_back(id, func);
+    return ObserverHandler([this, type, id]() {
+        auto& callbacks = chunk_callbacks[type];
+        callbacks.erase(
+            std::remove_if(
+                callbacks.begin(),
+                callbacks.end(),
+                [id](const auto& entry) { return entry.first == id; }
+            ),
+            callbacks.end()
+        );
+    });
 }
 
 void LevelEvents::trigger(LevelEventType type, Chunk* chunk) {
     const auto& callbacks = chunk_callbacks[type];
-    for (const ChunkEventFunc& func : callbacks) {
+    for (const auto& [_, func] : callbacks) {
         func(type, chunk);
     }
 }
@@ -4,6 +4,8 @@
 #include <unordered_map>
 #include <vector>
 
+#include "util/observer_handler.hpp"
+
 class Chunk;
 
 enum class LevelEventType {
@@ -16,9 +18,15 @@ enum class LevelEventType {
 using ChunkEventFunc = std::function<void(LevelEventType, Chunk*)>;
 
 class LevelEvents {
-    std::unordered_map<LevelEventType, std::vector<ChunkEventFunc>>
-        chunk_callbacks;
+    using Callbacks = std::vector<std::pair<int, ChunkEventFunc>>;
+
+    std::unordered_map<LevelEventType, Callbacks> chunk_callbacks;
+    int nextid = 1;
 public:
     void listen(LevelEventType type, const ChunkEventFunc& func);
+    /// @brief Listen until the returned handler is destroyed
+    [[nodiscard]] ObserverHandler observe(
+        LevelEventType type, const ChunkEventFunc& func
+    );
     void trigger(LevelEventType type, Chunk* chunk);
 };
@@ -1,35 +1,71 @@
 #include "WorldRegions.hpp"
 
 #include <cstring>
+#include <zlib.h>
 
+#include "debug/Logger.hpp"
+#include "coders/lz.hpp"
 #include "util/data_io.hpp"
 
 #define REGION_FORMAT_MAGIC ".VOXREG"
 
+static debug::Logger logger("regions-layer");
+
+/// @brief Min unused bytes in region file to start compaction
+static inline constexpr uint32_t COMPACTION_MIN_DEAD_SIZE = 256 * 1024;
+
 static io::path get_region_filename(int x, int z) {
     return std::to_string(x) + "_" + std::to_string(z) + ".bin";
 }
 
 /// @brief Read missing chunks data (null pointers) from region file
-static void fetch_chunks(WorldRegion* region, int x, int z, regfile* file) {
+static void fetch_chunks(
+    const RegionsLayer& layer,
+    WorldRegion* region,
+    int x,
+    int z,
+    regfile* file
+) {
     auto* chunks = region->getChunks();
-    auto sizes = region->getSizes();
+    bool transcode = file->compression != static_cast<ubyte>(layer.compression);
 
     for (size_t i = 0; i < REGION_CHUNKS_COUNT; i++) {
         int chunk_x = (i % REGION_SIZE) + x * REGION_SIZE;
         int chunk_z = (i / REGION_SIZE) + z * REGION_SIZE;
         if (chunks[i] == nullptr) {
-            chunks[i] = RegionsLayer::readChunkData(
-                    chunk_x, chunk_z, sizes[i][0], sizes[i][1], file);
+            uint32_t size, srcSize;
+            auto data = RegionsLayer::readChunkData(
+                chunk_x, chunk_z, size, srcSize, file
+            );
+            if (data && transcode) {
+                data = layer.transcode(*file, data.get(), size, srcSize);
+            }
+            if (data) {
+                region->put(
+                    i % REGION_SIZE, i / REGION_SIZE, std::move(data),
+                    size, srcSize
+                );
+            }
         }
     }
 }
 
-regfile::regfile(io::path filename) : file(std::move(filename)) {
-    if (file.length() < REGION_HEADER_SIZE)
+static std::unique_ptr<ubyte[]> copy_data(const ubyte* data, uint32_t size) {
+    auto copy = std::make_unique<ubyte[]>(size);
+    std::memcpy(copy.get(), data, size);
+    return copy;
+}
+
+static inline uint32_t read_uint32(const ubyte* src) {
+    uint32_t value;
+    std::memcpy(&value, src, sizeof(uint32_t));
+    return dataio::le2h(value);
+}
+
+regfile::regfile(io::path filename) : file(io::resolve(filename)) {
+    if (file.size() < REGION_HEADER_SIZE)
         throw std::runtime_error("incomplete region file header");
-    char header[REGION_HEADER_SIZE];
-    file.read(header, REGION_HEADER_SIZE);
+    auto header = reinterpret_cast<const char*>(file.data());
 
     // avoid of use strcmp_s
     if (std::string(header, std::strlen(REGION_FORMAT_MAGIC)) !=
@@ -37,198 +73,575 @@ regfile::regfile(io::path filename) : file(std::move(filename)) {
         throw std::runtime_error("invalid region file magic number");
     }
     version = header[8];
+    compression = header[9];
     if (static_cast<uint>(version) > REGION_FORMAT_VERSION) {
         throw illegal_region_format(
             "region format " + std::to_string(version) + " is not supported"
         );
     }
+    if (version >= 4) {
+        if (file.size() < REGION_DATA_OFFSET) {
+            throw std::runtime_error("incomplete region file offsets table");
+        }
+        deadSize = read_uint32(file.data() + REGION_DEAD_SIZE_OFFSET);
+        dictionaryId = read_uint32(file.data() + REGION_DICTIONARY_ID_OFFSET);
+    } else if (file.size() < REGION_HEADER_SIZE + REGION_CHUNKS_COUNT * 4) {
+        throw std::runtime_error("incomplete region file offsets table");
+    }
 }
 
-std::unique_ptr<ubyte[]> regfile::read(int index, uint32_t& size, uint32_t& srcSize) {
-    size_t file_size = file.length();
-    size_t table_offset = file_size - REGION_CHUNKS_COUNT * 4;
-
-    uint32_t buff32;
-    file.seekg(table_offset + index * 4);
-    file.read(reinterpret_cast<char*>(&buff32), 4);
-    uint32_t offset = dataio::le2h(buff32);
+util::span<const ubyte> regfile::getChunkData(
+    int index, uint32_t& srcSize
+) const {
+    size_t length = file.size();
+    size_t tableOffset;
+    if (version >= 4) {
+        tableOffset = REGION_TABLE_OFFSET;
+    } else {
+        tableOffset = length - REGION_CHUNKS_COUNT * 4;
+    }
+    const ubyte* bytes = file.data();
+    uint32_t offset = read_uint32(bytes + tableOffset + index * 4);
     if (offset == 0) {
-        return nullptr;
+        return {};
     }
+    if (offset < REGION_HEADER_SIZE || offset > length ||
+        length - offset < 8) {
+        throw std::runtime_error("invalid chunk offset in region file");
+    }
+    uint32_t size = read_uint32(bytes + offset);
+    srcSize = read_uint32(bytes + offset + 4);
+    if (size > length - offset - 8) {
+        throw std::runtime_error("invalid chunk size in region file");
+    }
+    return {bytes + offset + 8, size};
+}
 
-    file.seekg(offset);
-    file.read(reinterpret_cast<char*>(&buff32), 4);
-    size = dataio::le2h(buff32);
-    file.read(reinterpret_cast<char*>(&buff32), 4);
-    srcSize = dataio::le2h(buff32);
-
+std::unique_ptr<ubyte[]> regfile::read(
+    int index, uint32_t& size, uint32_t& srcSize
+) const {
+    auto chunkData = getChunkData(index, srcSize);
+    if (chunkData.data() == nullptr) {
+        return nullptr;
+    }
+    size = chunkData.size();
     auto data = std::make_unique<ubyte[]>(size);
-    file.read(reinterpret_cast<char*>(data.get()), size);
+    std::memcpy(data.get(), chunkData.data(), size);
     return data;
 }
 
+void RegionsLayer::beginRegFileWrite(glm::ivec2 coord) {
+    {
+        std::unique_lock lock(regFilesMutex);
+        regFilesCv.wait(lock, [this, coord]() {
+            if (writingRegFiles.find(coord) != writingRegFiles.end()) {
+                return false;
+            }
+            const auto& found = openRegFiles.find(coord);
+            return found == openRegFiles.end() || found->second->users == 0;
+        });
+        openRegFiles.erase(coord);
+        writingRegFiles.insert(coord);
+    }
+    regFilesCv.notify_all();
+}
+
+void RegionsLayer::endRegFileWrite(glm::ivec2 coord) {
+    {
+        std::lock_guard lock(regFilesMutex);
+        writingRegFiles.erase(coord);
+    }
+    regFilesCv.notify_all();
+}
 
-void RegionsLayer::closeRegFile(glm::ivec2 coord) {
-    openRegFiles.erase(coord);
-    regFilesCv.notify_one();
+void RegionsLayer::waitRegFileWritten(
+    glm::ivec2 coord, std::unique_lock<std::mutex>& lock
+) {
+    regFilesCv.wait(lock, [this, coord]() {
+        return writingRegFiles.find(coord) == writingRegFiles.end();
+    });
 }
 
 regfile_ptr RegionsLayer::useRegFile(glm::ivec2 coord) {
     auto* file = openRegFiles[coord].get();
-    file->inUse = true;
-    return regfile_ptr(file, &regFilesCv);
+    file->users++;
+    file->lastUse = ++regFilesUsage;
+    return regfile_ptr(file, &regFilesMutex, &regFilesCv);
 }
 
-// Marks regfile as used and unmarks when shared_ptr dies
 regfile_ptr RegionsLayer::getRegFile(glm::ivec2 coord, bool create) {
-    {
-        std::lock_guard lock(regFilesMutex);
-        const auto found = openRegFiles.find(coord);
-        if (found != openRegFiles.end()) {
-            if (found->second->inUse) {
-                throw std::runtime_error("regfile is currently in use");
-            }
-            return useRegFile(found->first);
-        }
+    std::unique_lock lock(regFilesMutex);
+    waitRegFileWritten(coord, lock);
+    const auto found = openRegFiles.find(coord);
+    if (found != openRegFiles.end()) {
+        return useRegFile(found->first);
     }
     if (create) {
-        return createRegFile(coord);
+        return createRegFile(coord, lock);
     }
     return nullptr;
 }
 
-regfile_ptr RegionsLayer::createRegFile(glm::ivec2 coord) {
+regfile_ptr RegionsLayer::createRegFile(
+    glm::ivec2 coord, std::unique_lock<std::mutex>& lock
+) {
     auto file = folder / get_region_filename(coord[0], coord[1]);
-    if (!io::exists(file)) {
-        return nullptr;
-    }
-    if (openRegFiles.size() == MAX_OPEN_REGION_FILES) {
-        std::unique_lock lock(regFilesMutex);
-        while (true) {
-            bool closed = false;
-            // FIXME: bad choosing algorithm
-            for (auto& entry : openRegFiles) {
-                if (!entry.second->inUse) {
-                    closeRegFile(entry.first);
-                    closed = true;
-                    break;
-                }
+    while (true) {
+        // file may be opened or written by another thread while waiting
+        waitRegFileWritten(coord, lock);
+        if (openRegFiles.find(coord) != openRegFiles.end()) {
+            return useRegFile(coord);
+        }
+        if (openRegFiles.size() < MAX_OPEN_REGION_FILES) {
+            break;
+        }
+        // close least recently used file
+        auto victim = openRegFiles.end();
+        for (auto it = openRegFiles.begin(); it != openRegFiles.end(); ++it) {
+            if (it->second->users) {
+                continue;
             }
-            if (closed) {
-                break;
+            if (victim == openRegFiles.end() ||
+                it->second->lastUse < victim->second->lastUse) {
+                victim = it;
             }
-            // notified when any regfile gets out of use or closed
-            regFilesCv.wait(lock);
         }
-        openRegFiles[coord] = std::make_unique<regfile>(file);
-        return useRegFile(coord);
-    } else {
-        std::lock_guard lock(regFilesMutex);
-        openRegFiles[coord] = std::make_unique<regfile>(file);
-        return useRegFile(coord);
+        if (victim != openRegFiles.end()) {
+            openRegFiles.erase(victim);
+            continue;
+        }
+        regFilesCv.wait(lock);
+    }
+    if (!io::exists(file)) {
+        return nullptr;
+    }
+    auto opened = std::make_unique<regfile>(file);
+    auto method = static_cast<compression::Method>(opened->compression);
+    if (compression::is_using_dictionary(method) &&
+        opened->dictionaryId != dictionaryId) {
+        throw std::runtime_error(
+            "region file " + file.string() +
+            " is compressed with another dictionary"
+        );
     }
+    openRegFiles[coord] = std::move(opened);
+    return useRegFile(coord);
+}
+
+RegionsLayer::~RegionsLayer() {
+    if (!writer.joinable()) {
+        return;
+    }
+    {
+        std::lock_guard lock(mapMutex);
+        stopWriter = true;
+    }
+    writerCv.notify_all();
+    // pending writes are finished before the thread stops
+    writer.join();
 }
 
 WorldRegion* RegionsLayer::getRegion(int x, int z) {
-    std::lock_guard lock(mapMutex);
-    auto found = regions.find({x, z});
-    if (found == regions.end()) {
+    std::unique_lock lock(mapMutex);
+    waitRegionWritten({x, z}, lock);
+    return findRegion({x, z});
+}
+
+WorldRegion* RegionsLayer::findRegion(glm::ivec2 coord) {
+    auto found = regions.find(coord);
+    if (found != regions.end()) {
+        return found->second.get();
+    }
+    auto pending = pendingWrites.find(coord);
+    if (pending == pendingWrites.end()) {
         return nullptr;
     }
-    return found->second.get();
+    auto& region = regions[coord];
+    region = std::move(pending->second);
+    pendingWrites.erase(pending);
+    return region.get();
+}
+
+void RegionsLayer::waitRegionWritten(
+    glm::ivec2 coord, std::unique_lock<std::mutex>& lock
+) {
+    writerCv.wait(lock, [this, coord]() { return writingRegion != coord; });
 }
 
 io::path RegionsLayer::getRegionFilePath(int x, int z) const {
     return folder / get_region_filename(x, z);
 }
 
-WorldRegion* RegionsLayer::getOrCreateRegion(int x, int z) {
-    if (auto region = getRegion(x, z)) {
-        return region;
+WorldRegion& RegionsLayer::useRegion(int x, int z) {
+    WorldRegion* region = findRegion({x, z});
+    if (region == nullptr) {
+        auto& created = regions[{x, z}];
+        created = std::make_unique<WorldRegion>();
+        region = created.get();
+    }
+    region->setLastUse(++usageCounter);
+    return *region;
+}
+
+size_t RegionsLayer::calcMemoryUsage() const {
+    size_t usage = 0;
+    for (const auto& [_, region] : regions) {
+        usage += region->getMemoryUsage();
+    }
+    return usage;
+}
+
+void RegionsLayer::evictRegion(RegionsMap::iterator it) {
+    if (it->second->isUnsaved()) {
+        // written outside of the lock to not block chunks loading
+        pendingWrites[it->first] = std::move(it->second);
+        if (!writer.joinable()) {
+            writer = std::thread([this]() { runWriter(); });
+        }
+        writerCv.notify_all();
+    }
+    regions.erase(it);
+    cacheStats.evictions++;
+}
+
+/// @brief Move chunks missing in the destination region
+static void merge_region(WorldRegion& dst, WorldRegion& src) {
+    auto* dstChunks = dst.getChunks();
+    auto* srcChunks = src.getChunks();
+    auto* srcSizes = src.getSizes();
+    for (uint i = 0; i < REGION_CHUNKS_COUNT; i++) {
+        if (dstChunks[i] || srcChunks[i] == nullptr) {
+            continue;
+        }
+        uint x = i % REGION_SIZE;
+        uint z = i / REGION_SIZE;
+        dst.put(x, z, std::move(srcChunks[i]), srcSizes[i][0], srcSizes[i][1]);
+        if (src.isChunkUnsaved(i)) {
+            dst.setChunkUnsaved(x, z);
+        }
+    }
+}
+
+void RegionsLayer::runWriter() {
+    std::unique_lock lock(mapMutex);
+    while (true) {
+        writerCv.wait(lock, [this]() {
+            return stopWriter || !pendingWrites.empty();
+        });
+        if (pendingWrites.empty()) {
+            break;
+        }
+        auto pending = pendingWrites.begin();
+        glm::ivec2 coord = pending->first;
+        auto region = std::move(pending->second);
+        pendingWrites.erase(pending);
+        writingRegion = coord;
+        lock.unlock();
+
+        bool written = false;
+        try {
+            io::create_directories(folder);
+            writeRegion(coord.x, coord.y, region.get());
+            written = true;
+        } catch (const std::exception& err) {
+            logger.error() << "could not write region " << coord.x << "_"
+                           << coord.y << ": " << err.what();
+        }
+
+        lock.lock();
+        writingRegion = std::nullopt;
+        if (!written) {
+            // keep unsaved data in memory until the next write
+            if (auto current = findRegion(coord)) {
+                merge_region(*current, *region);
+            } else {
+                regions[coord] = std::move(region);
+            }
+        }
+        writerCv.notify_all();
+    }
+}
+
+void RegionsLayer::evictRegions(std::optional<glm::ivec2> keep) {
+    if (cacheBudget == 0) {
+        return;
+    }
+    size_t usage = calcMemoryUsage();
+    while (usage > cacheBudget) {
+        auto victim = regions.end();
+        for (auto it = regions.begin(); it != regions.end(); ++it) {
+            if (it->first == keep) {
+                continue;
+            }
+            if (victim == regions.end() ||
+                it->second->getLastUse() < victim->second->getLastUse()) {
+                victim = it;
+            }
+        }
+        if (victim == regions.end()) {
+            break;
+        }
+        usage -= victim->second->getMemoryUsage();
+        evictRegion(victim);
     }
+}
+
+RegionsCacheStats RegionsLayer::getCacheStats() {
+    std::lock_guard lock(mapMutex);
+    RegionsCacheStats stats = cacheStats;
+    stats.memoryUsage = calcMemoryUsage();
+    stats.regions = regions.size();
+    return stats;
+}
+
+void RegionsLayer::put(
+    int x, int z, std::unique_ptr<ubyte[]> data, uint32_t size, uint32_t srcSize
+) {
+    int regionX, regionZ, localX, localZ;
+    calc_reg_coords(x, z, regionX, regionZ, localX, localZ);
+
     std::lock_guard lock(mapMutex);
-    auto region_ptr = std::make_unique<WorldRegion>();
-    auto region = region_ptr.get();
-    regions[{x, z}] = std::move(region_ptr);
-    return region;
+    auto& region = useRegion(regionX, regionZ);
+    region.put(localX, localZ, std::move(data), size, srcSize);
+    region.setChunkUnsaved(localX, localZ);
+    evictRegions(glm::ivec2(regionX, regionZ));
 }
 
-ubyte* RegionsLayer::getData(int x, int z, uint32_t& size, uint32_t& srcSize) {
+std::unique_ptr<ubyte[]> RegionsLayer::getData(
+    int x, int z, uint32_t& size, uint32_t& srcSize
+) {
     int regionX, regionZ, localX, localZ;
     calc_reg_coords(x, z, regionX, regionZ, localX, localZ);
 
-    WorldRegion* region = getOrCreateRegion(regionX, regionZ);
-    ubyte* data = region->getChunkData(localX, localZ);
-    if (data == nullptr) {
-        auto regfile = getRegFile({regionX, regionZ});
-        if (regfile != nullptr) {
-            auto dataptr = readChunkData(x, z, size, srcSize, regfile.get());
-            if (dataptr) {
-                data = dataptr.get();
-                region->put(localX, localZ, std::move(dataptr), size, srcSize);
+    size_t evictions;
+    {
+        std::unique_lock lock(mapMutex);
+        // region file may not contain the evicted chunks data yet
+        waitRegionWritten({regionX, regionZ}, lock);
+        if (auto found = findRegion({regionX, regionZ})) {
+            auto& region = *found;
+            region.setLastUse(++usageCounter);
+            if (ubyte* data = region.getChunkData(localX, localZ)) {
+                auto sizevec = region.getChunkDataSize(localX, localZ);
+                size = sizevec[0];
+                srcSize = sizevec[1];
+                cacheStats.hits++;
+                return copy_data(data, size);
             }
         }
+        cacheStats.misses++;
+        evictions = cacheStats.evictions;
     }
-    if (data != nullptr) {
-        auto sizevec = region->getChunkDataSize(localX, localZ);
-        size = sizevec[0];
-        srcSize = sizevec[1];
-        return data;
+    std::unique_ptr<ubyte[]> dataptr;
+    bool outdated = false;
+    // regfile must be released before locking the map (see writeAll)
+    if (auto regfile = getRegFile({regionX, regionZ})) {
+        outdated =
+            regfile.get()->compression != static_cast<ubyte>(compression);
+        auto chunkData = regfile.get()->getChunkData(
+            localZ * REGION_SIZE + localX, srcSize
+        );
+        if (chunkData.data()) {
+            size = chunkData.size();
+            dataptr =
+                transcode(*regfile.get(), chunkData.data(), size, srcSize);
+        }
     }
-    return nullptr;
+    if (dataptr == nullptr) {
+        return nullptr;
+    }
+    std::lock_guard lock(mapMutex);
+    // region may be rewritten while reading if evicted meanwhile
+    if (evictions != cacheStats.evictions) {
+        return dataptr;
+    }
+    auto& region = useRegion(regionX, regionZ);
+    // chunk may be fetched by another thread meanwhile
+    if (region.getChunkData(localX, localZ) == nullptr) {
+        region.put(localX, localZ, copy_data(dataptr.get(), size), size, srcSize);
+        if (outdated) {
+            // region file will be rewritten with the layer compression
+            region.setChunkUnsaved(localX, localZ);
+        }
+        evictRegions(glm::ivec2(regionX, regionZ));
+    }
+    return dataptr;
 }
 
-void RegionsLayer::writeRegion(int x, int z, WorldRegion* entry) {
-    io::path filename = folder / get_region_filename(x, z);
+static void write_chunk(
+    std::ostream& file, const ubyte* data, uint32_t size, uint32_t srcSize
+) {
+    uint32_t intbuf = dataio::h2le(size);
+    file.write(reinterpret_cast<const char*>(&intbuf), 4);
 
-    glm::ivec2 regcoord(x, z);
-    if (auto regfile = getRegFile(regcoord, false)) {
-        fetch_chunks(entry, x, z, regfile.get());
+    intbuf = dataio::h2le(srcSize);
+    file.write(reinterpret_cast<const char*>(&intbuf), 4);
 
-        std::lock_guard lock(regFilesMutex);
-        regfile.reset();
-        closeRegFile(regcoord);
+    file.write(reinterpret_cast<const char*>(data), size);
+}
+
+/// @brief Append dictionary training samples from region file chunks
+/// @param method target LZ-based compression method
+static void collect_samples(
+    const regfile& file,
+    compression::Method method,
+    std::vector<std::vector<ubyte>>& samples
+) {
+    auto fileMethod = static_cast<compression::Method>(file.compression);
+    for (size_t i = 0; i < REGION_CHUNKS_COUNT &&
+                       samples.size() < REGION_DICTIONARY_MAX_SAMPLES;
+         i++) {
+        uint32_t srcSize;
+        auto data = file.getChunkData(i, srcSize);
+        if (data.data() == nullptr) {
+            continue;
+        }
+        if (fileMethod == compression::Method::NONE) {
+            samples.push_back(compression::to_dictionary_sample(
+                data.data(), data.size(), method
+            ));
+        } else {
+            auto source = compression::decompress(
+                data.data(), data.size(), srcSize, fileMethod
+            );
+            samples.push_back(compression::to_dictionary_sample(
+                source.get(), srcSize, method
+            ));
+        }
     }
+}
 
+/// @brief Write complete region file
+/// @param dictionaryId checksum of the dictionary used by method
+static void write_region_file(
+    const io::path& filename,
+    WorldRegion* entry,
+    compression::Method method,
+    uint32_t dictionaryId
+) {
     char header[REGION_HEADER_SIZE] = REGION_FORMAT_MAGIC;
     header[8] = REGION_FORMAT_VERSION;
-    header[9] = static_cast<ubyte>(compression); // FIXME
+    header[9] = static_cast<ubyte>(method);
     std::ofstream file(io::resolve(filename), std::ios::out | std::ios::binary);
     file.write(header, REGION_HEADER_SIZE);
 
-    size_t offset = REGION_HEADER_SIZE;
-    uint32_t intbuf;
-    uint offsets[REGION_CHUNKS_COUNT] {};
-
     auto region = entry->getChunks();
     auto sizes = entry->getSizes();
 
+    uint32_t offsets[REGION_CHUNKS_COUNT] {};
+    uint32_t offset = REGION_DATA_OFFSET;
+    for (size_t i = 0; i < REGION_CHUNKS_COUNT; i++) {
+        if (region[i] != nullptr) {
+            offsets[i] = dataio::h2le(offset);
+            offset += 8 + sizes[i][0];
+        }
+    }
+    uint32_t deadSize = 0;
+    if (!compression::is_using_dictionary(method)) {
+        dictionaryId = 0;
+    }
+    dictionaryId = dataio::h2le(dictionaryId);
+    file.write(reinterpret_cast<const char*>(&deadSize), 4);
+    file.write(reinterpret_cast<const char*>(&dictionaryId), 4);
+    file.write(reinterpret_cast<const char*>(offsets), sizeof(offsets));
+
+    for (size_t i = 0; i < REGION_CHUNKS_COUNT; i++) {
+        if (ubyte* chunk = region[i].get()) {
+            write_chunk(file, chunk, sizes[i][0], sizes[i][1]);
+        }
+    }
+}
+
+/// @brief Append unsaved chunks data to the end of region file and update
+/// offsets table. Previous chunks data becomes unused
+static void append_region_chunks(const io::path& filename, WorldRegion* entry) {
+    std::fstream file(
+        io::resolve(filename), std::ios::in | std::ios::out | std::ios::binary
+    );
+    if (!file.is_open()) {
+        throw std::runtime_error(
+            "could not to open region file " + filename.string()
+        );
+    }
+    uint32_t deadSize;
+    uint32_t offsets[REGION_CHUNKS_COUNT];
+    file.seekg(REGION_DEAD_SIZE_OFFSET);
+    file.read(reinterpret_cast<char*>(&deadSize), 4);
+    file.seekg(REGION_TABLE_OFFSET);
+    file.read(reinterpret_cast<char*>(offsets), sizeof(offsets));
+    deadSize = dataio::le2h(deadSize);
+
+    file.seekp(0, std::ios::end);
+    uint32_t end = file.tellp();
+
+    auto region = entry->getChunks();
+    auto sizes = entry->getSizes();
     for (size_t i = 0; i < REGION_CHUNKS_COUNT; i++) {
+        if (!entry->isChunkUnsaved(i)) {
+            continue;
+        }
+        if (uint32_t prevOffset = dataio::le2h(offsets[i])) {
+            uint32_t prevSize;
+            file.seekg(prevOffset);
+            file.read(reinterpret_cast<char*>(&prevSize), 4);
+            deadSize += 8 + dataio::le2h(prevSize);
+        }
         ubyte* chunk = region[i].get();
         if (chunk == nullptr) {
+            offsets[i] = 0;
             continue;
         }
-        offsets[i] = offset;
-
-        auto sizevec = sizes[i];
-        uint32_t compressedSize = sizevec[0];
-        uint32_t srcSize = sizevec[1];
-        
-        intbuf = dataio::h2le(compressedSize);
-        file.write(reinterpret_cast<const char*>(&intbuf), 4);
-        offset += 4;
+        file.seekp(end);
+        write_chunk(file, chunk, sizes[i][0], sizes[i][1]);
+        offsets[i] = dataio::h2le(end);
+        end += 8 + sizes[i][0];
+    }
+    // chunks data must be written before the offsets pointing to it
+    file.flush();
+
+    deadSize = dataio::h2le(deadSize);
+    file.seekp(REGION_DEAD_SIZE_OFFSET);
+    file.write(reinterpret_cast<const char*>(&deadSize), 4);
+    file.seekp(REGION_TABLE_OFFSET);
+    file.write(reinterpret_cast<const char*>(offsets), sizeof(offsets));
+    if (!file.good()) {
+        throw std::runtime_error(
+            "could not to write region file " + filename.string()
+        );
+    }
+}
 
-        intbuf = dataio::h2le(srcSize);
-        file.write(reinterpret_cast<const char*>(&intbuf), 4);
-        offset += 4;
+void RegionsLayer::writeRegion(int x, int z, WorldRegion* entry) {
+    io::path filename = folder / get_region_filename(x, z);
 
-        file.write(reinterpret_cast<const char*>(chunk), compressedSize);
-        offset += compressedSize;
+    glm::ivec2 regcoord(x, z);
+    auto regfile = getRegFile(regcoord);
+    bool rewrite = true;
+    if (regfile) {
+        auto file = regfile.get();
+        rewrite = file->version < REGION_FORMAT_VERSION ||
+                  file->compression != static_cast<ubyte>(compression) ||
+                  (file->deadSize >= COMPACTION_MIN_DEAD_SIZE &&
+                   file->deadSize * 2 >= file->file.size());
+        if (rewrite) {
+            fetch_chunks(*this, entry, x, z, file);
+        }
+        regfile.reset();
     }
-    for (size_t i = 0; i < REGION_CHUNKS_COUNT; i++) {
-        intbuf = dataio::h2le(offsets[i]);
-        file.write(reinterpret_cast<const char*>(&intbuf), 4);
+    // prevent the file from being reopened by other threads while writing,
+    // other region files are available meanwhile
+    beginRegFileWrite(regcoord);
+    try {
+        if (rewrite) {
+            write_region_file(filename, entry, compression, dictionaryId);
+        } else {
+            append_region_chunks(filename, entry);
+        }
+    } catch (...) {
+        endRegFileWrite(regcoord);
+        throw;
     }
+    endRegFileWrite(regcoord);
 }
 
 std::unique_ptr<ubyte[]> RegionsLayer::readChunkData(
@@ -239,3 +652,96 @@ std::unique_ptr<ubyte[]> RegionsLayer::readChunkData(
     int chunkIndex = localZ * REGION_SIZE + localX;
     return rfile->read(chunkIndex, size, srcSize);
 }
+
+std::unique_ptr<ubyte[]> RegionsLayer::transcode(
+    const regfile& file, const ubyte* data, uint32_t& size, uint32_t srcSize
+) const {
+    auto method = static_cast<compression::Method>(file.compression);
+    if (method == compression) {
+        return copy_data(data, size);
+    }
+    std::unique_ptr<ubyte[]> source;
+    if (method == compression::Method::NONE) {
+        source = copy_data(data, size);
+    } else {
+        source = compression::decompress(
+            data, size, srcSize, method, getDictionary()
+        );
+    }
+    if (compression == compression::Method::NONE) {
+        size = srcSize;
+        return source;
+    }
+    size_t length;
+    auto compressed = compression::compress(
+        source.get(), srcSize, length, compression, getDictionary()
+    );
+    size = length;
+    return compressed;
+}
+
+void RegionsLayer::initDictionary() {
+    auto method = compression::get_dictionary_method(compression);
+    if (method == compression) {
+        return;
+    }
+    std::vector<ubyte> bytes;
+    if (io::exists(dictionaryFile)) {
+        bytes = io::read_bytes(dictionaryFile);
+    } else {
+        bytes = trainDictionary();
+        if (!bytes.empty()) {
+            io::write_bytes(dictionaryFile, bytes.data(), bytes.size());
+            logger.info() << "trained dictionary " << dictionaryFile.string()
+                          << " (" << bytes.size() << " bytes)";
+        }
+    }
+    if (bytes.empty()) {
+        return;
+    }
+    dictionaryId = crc32(0L, bytes.data(), bytes.size());
+    dictionary = lz::Dictionary(std::move(bytes));
+    compression = method;
+}
+
+std::vector<ubyte> RegionsLayer::trainDictionary() const {
+    if (!io::is_directory(folder)) {
+        return {};
+    }
+    std::vector<std::vector<ubyte>> buffers;
+    for (const auto& path : io::directory_iterator(folder)) {
+        std::unique_ptr<regfile> file;
+        try {
+            file = std::make_unique<regfile>(path);
+        } catch (const std::runtime_error& err) {
+            logger.warning() << "skip " << path.string() << ": " << err.what();
+            continue;
+        }
+        // chunks of the file can not be read without the dictionary
+        auto method = static_cast<compression::Method>(file->compression);
+        if (compression::is_using_dictionary(method)) {
+            throw std::runtime_error(
+                "dictionary " + dictionaryFile.string() + " required by " +
+                path.string() + " is missing"
+            );
+        }
+        // outdated files are upgraded by WorldConverter later
+        if (file->version == REGION_FORMAT_VERSION &&
+            buffers.size() < REGION_DICTIONARY_MAX_SAMPLES) {
+            try {
+                collect_samples(*file, compression, buffers);
+            } catch (const std::runtime_error& err) {
+                logger.warning() << "skip " << path.string() << ": "
+                                 << err.what();
+            }
+        }
+    }
+    if (buffers.size() < REGION_DICTIONARY_MIN_SAMPLES) {
+        return {};
+    }
+    std::vector<util::span<const ubyte>> samples;
+    for (const auto& buffer : buffers) {
+        samples.emplace_back(buffer.data(), buffer.size());
+    }
+    return lz::train_dictionary(samples, REGION_DICTIONARY_CAPACITY);
+}
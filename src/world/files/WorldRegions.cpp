@@ -28,11 +28,23 @@ WorldRegion::~WorldRegion() = default;
 
 void WorldRegion::setUnsaved(bool unsaved) {
     this->unsaved = unsaved;
+    if (!unsaved) {
+        unsavedChunks.reset();
+    }
 }
 bool WorldRegion::isUnsaved() const {
     return unsaved;
 }
 
+void WorldRegion::setChunkUnsaved(uint x, uint z) {
+    unsavedChunks.set(z * REGION_SIZE + x);
+    unsaved = true;
+}
+
+bool WorldRegion::isChunkUnsaved(size_t index) const {
+    return unsavedChunks.test(index);
+}
+
 std::unique_ptr<ubyte[]>* WorldRegion::getChunks() const {
     return chunksData.get();
 }
@@ -41,10 +53,30 @@ glm::u32vec2* WorldRegion::getSizes() const {
     return sizes.get();
 }
 
+void WorldRegion::setLastUse(uint64_t lastUse) {
+    this->lastUse = lastUse;
+}
+
+uint64_t WorldRegion::getLastUse() const {
+    return lastUse;
+}
+
+size_t WorldRegion::getMemoryUsage() const {
+    return dataSize + REGION_CHUNKS_COUNT *
+                          (sizeof(std::unique_ptr<ubyte[]>) + sizeof(glm::u32vec2));
+}
+
 void WorldRegion::put(
     uint x, uint z, std::unique_ptr<ubyte[]> data, uint32_t size, uint32_t srcSize
 ) {
     size_t chunk_index = z * REGION_SIZE + x;
+    if (chunksData[chunk_index]) {
+        dataSize -= sizes[chunk_index][0];
+    }
+    if (data == nullptr) {
+        size = 0;
+    }
+    dataSize += size;
     chunksData[chunk_index] = std::move(data);
     sizes[chunk_index] = glm::u32vec2(size, srcSize);
 }
@@ -63,7 +95,9 @@ WorldRegions::WorldRegions(const io::path& directory) : directory(directory) {
     }
     auto& voxels = layers[REGION_LAYER_VOXELS];
     voxels.folder = directory / "regions";
-    voxels.compression = compression::Method::EXTRLE16;
+    voxels.compression = compression::Method::EXTRLE16_LZ;
+    voxels.dictionaryFile = directory / "regions.dict";
+    voxels.initDictionary();
 
     auto& lights = layers[REGION_LAYER_LIGHTS];
     lights.folder = directory / "lights";
@@ -80,6 +114,11 @@ WorldRegions::WorldRegions(const io::path& directory) : directory(directory) {
 WorldRegions::~WorldRegions() = default;
 
 void RegionsLayer::writeAll() {
+    std::unique_lock lock(mapMutex);
+    // evicted regions are written by the writer thread
+    writerCv.wait(lock, [this]() {
+        return pendingWrites.empty() && !writingRegion.has_value();
+    });
     for (auto& it : regions) {
         WorldRegion* region = it.second.get();
         if (region->getChunks() == nullptr || !region->isUnsaved()) {
@@ -87,6 +126,7 @@ void RegionsLayer::writeAll() {
         }
         const auto& key = it.first;
         writeRegion(key[0], key[1], region);
+        region->setUnsaved(false);
     }
 }
 
@@ -99,22 +139,17 @@ void WorldRegions::put(
 ) {
     size_t size = srcSize;
     auto& layer = layers[layerid];
-    int regionX, regionZ, localX, localZ;
-    calc_reg_coords(x, z, regionX, regionZ, localX, localZ);
-
-    WorldRegion* region = layer.getOrCreateRegion(regionX, regionZ);
-    region->setUnsaved(true);
-    
     if (data == nullptr) {
-        region->put(localX, localZ, nullptr, 0, 0);
+        layer.put(x, z, nullptr, 0, 0);
         return;
     }
 
     if (layer.compression != compression::Method::NONE) {
         data = compression::compress(
-            data.get(), size, size, layer.compression);
+            data.get(), size, size, layer.compression, layer.getDictionary()
+        );
     }
-    region->put(localX, localZ, std::move(data), size, srcSize);
+    layer.put(x, z, std::move(data), size, srcSize);
 }
 
 static std::unique_ptr<ubyte[]> write_inventories(
@@ -219,24 +254,26 @@ std::unique_ptr<ubyte[]> WorldRegions::getVoxels(int x, int z) {
     uint32_t size;
     uint32_t srcSize;
     auto& layer = layers[REGION_LAYER_VOXELS];
-    auto* data = layer.getData(x, z, size, srcSize);
+    auto data = layer.getData(x, z, size, srcSize);
     if (data == nullptr) {
         return nullptr;
     }
     assert(srcSize == CHUNK_DATA_LEN);
-    return compression::decompress(data, size, srcSize, layer.compression);
+    return compression::decompress(
+        data.get(), size, srcSize, layer.compression, layer.getDictionary()
+    );
 }
 
 std::unique_ptr<light_t[]> WorldRegions::getLights(int x, int z) {
     uint32_t size;
     uint32_t srcSize;
     auto& layer = layers[REGION_LAYER_LIGHTS];
-    auto* bytes = layer.getData(x, z, size, srcSize);
+    auto bytes = layer.getData(x, z, size, srcSize);
     if (bytes == nullptr) {
         return nullptr;
     }
     auto data = compression::decompress(
-        bytes, size, srcSize, layer.compression
+        bytes.get(), size, srcSize, layer.compression
     );
     assert(srcSize == LIGHTMAP_DATA_LEN);
     return Lightmap::decode(data.get());
@@ -249,7 +286,7 @@ ChunkInventoriesMap WorldRegions::fetchInventories(int x, int z) {
     if (bytes == nullptr) {
         return {};
     }
-    return load_inventories(bytes, bytesSize);
+    return load_inventories(bytes.get(), bytesSize);
 }
 
 BlocksMetadata WorldRegions::getBlocksData(int x, int z) {
@@ -260,7 +297,7 @@ BlocksMetadata WorldRegions::getBlocksData(int x, int z) {
         return {};
     }
     BlocksMetadata heap;
-    heap.deserialize(bytes, bytesSize);
+    heap.deserialize(bytes.get(), bytesSize);
     return heap;
 }
 
@@ -317,7 +354,11 @@ void WorldRegions::processBlocksData(int x, int z, const BlockDataProc& func) {
                 continue;
             }
             voxData = compression::decompress(
-                voxData.get(), voxLength, voxSrcSize, voxLayer.compression
+                voxData.get(),
+                voxLength,
+                voxSrcSize,
+                static_cast<compression::Method>(voxRegfile.get()->compression),
+                voxLayer.getDictionary()
             );
 
             BlocksMetadata blocksData;
@@ -341,11 +382,11 @@ dv::value WorldRegions::fetchEntities(int x, int z) {
     }
     uint32_t bytesSize;
     uint32_t srcSize;
-    const ubyte* data = layers[REGION_LAYER_ENTITIES].getData(x, z, bytesSize, srcSize);
+    auto data = layers[REGION_LAYER_ENTITIES].getData(x, z, bytesSize, srcSize);
     if (data == nullptr) {
         return nullptr;
     }
-    auto map = json::from_binary(data, bytesSize);
+    auto map = json::from_binary(data.get(), bytesSize);
     if (map.empty()) {
         return nullptr;
     }
@@ -374,9 +415,11 @@ void WorldRegions::processRegion(
             if (data == nullptr) {
                 continue;
             }
-            if (layer.compression != compression::Method::NONE) {
+            auto method =
+                static_cast<compression::Method>(regfile.get()->compression);
+            if (method != compression::Method::NONE) {
                 data = compression::decompress(
-                    data.get(), length, srcSize, layer.compression
+                    data.get(), length, srcSize, method, layer.getDictionary()
                 );
             } else {
                 srcSize = length;
@@ -403,6 +446,18 @@ void WorldRegions::writeAll() {
     }
 }
 
+void WorldRegions::setCacheBudget(size_t bytes) {
+    for (auto& layer : layers) {
+        std::lock_guard lock(layer.mapMutex);
+        layer.cacheBudget = bytes;
+        layer.evictRegions();
+    }
+}
+
+RegionsCacheStats WorldRegions::getCacheStats(RegionLayerIndex layerid) {
+    return layers[layerid].getCacheStats();
+}
+
 void WorldRegions::deleteRegion(RegionLayerIndex layerid, int x, int z) {
     auto& layer = layers[layerid];
     if (layer.getRegFile({x, z}, false)) {
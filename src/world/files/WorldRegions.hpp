@@ -1,18 +1,26 @@
 #pragma once
 
+#include <bitset>
 #include <condition_variable>
 #include <functional>
 #include <glm/glm.hpp>
 #include <memory>
 #include <mutex>
+#include <optional>
+#include <thread>
 #include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 #include "typedefs.hpp"
 #include "util/BufferPool.hpp"
 #include "voxels/Chunk.hpp"
 #include "maths/voxmaths.hpp"
 #include "coders/compression.hpp"
+#include "coders/lz.hpp"
 #include "io/io.hpp"
+#include "io/mapped_file.hpp"
+#include "util/span.hpp"
 #include "world_regions_fwd.hpp"
 
 #define GLM_ENABLE_EXPERIMENTAL
@@ -24,6 +32,25 @@ inline constexpr uint REGION_SIZE_BIT = 5;
 inline constexpr uint REGION_SIZE = (1 << (REGION_SIZE_BIT));
 inline constexpr uint REGION_CHUNKS_COUNT = ((REGION_SIZE) * (REGION_SIZE));
 
+/// @brief Position of unused bytes counter (since version 4)
+inline constexpr uint REGION_DEAD_SIZE_OFFSET = REGION_HEADER_SIZE;
+/// @brief Position of the dictionary checksum of *_LZ_DICT compressed
+/// files (since version 4)
+inline constexpr uint REGION_DICTIONARY_ID_OFFSET =
+    REGION_DEAD_SIZE_OFFSET + 4;
+/// @brief Position of chunks offsets table (since version 4)
+inline constexpr uint REGION_TABLE_OFFSET = REGION_DICTIONARY_ID_OFFSET + 4;
+/// @brief Position of the first chunk data (since version 4)
+inline constexpr uint REGION_DATA_OFFSET =
+    REGION_TABLE_OFFSET + REGION_CHUNKS_COUNT * 4;
+
+/// @brief Max length of a region layer LZ dictionary
+inline constexpr size_t REGION_DICTIONARY_CAPACITY = 32 * 1024;
+/// @brief Max number of chunks used to train a region layer dictionary
+inline constexpr size_t REGION_DICTIONARY_MAX_SAMPLES = 64;
+/// @brief Min number of saved chunks required to train a dictionary
+inline constexpr size_t REGION_DICTIONARY_MIN_SAMPLES = 16;
+
 class illegal_region_format : public std::runtime_error {
 public:
     illegal_region_format(const std::string& message)
@@ -34,7 +61,13 @@ public:
 class WorldRegion {
     std::unique_ptr<std::unique_ptr<ubyte[]>[]> chunksData;
     std::unique_ptr<glm::u32vec2[]> sizes;
+    /// @brief Chunks changed since the region was written
+    std::bitset<REGION_CHUNKS_COUNT> unsavedChunks;
     bool unsaved = false;
+    /// @brief Total size of stored chunks data
+    size_t dataSize = 0;
+    /// @brief Value of layer usage counter on last access
+    uint64_t lastUse = 0;
 public:
     WorldRegion();
     ~WorldRegion();
@@ -46,19 +79,49 @@ public:
     void setUnsaved(bool unsaved);
     bool isUnsaved() const;
 
+    void setChunkUnsaved(uint x, uint z);
+    bool isChunkUnsaved(size_t index) const;
+
+    void setLastUse(uint64_t lastUse);
+    uint64_t getLastUse() const;
+
+    /// @brief Get approximate memory used by the region in bytes
+    size_t getMemoryUsage() const;
+
     std::unique_ptr<ubyte[]>* getChunks() const;
     glm::u32vec2* getSizes() const;
 };
 
+/// @brief Memory-mapped region file. May be read by multiple threads
+/// simultaneously
 struct regfile {
-    io::rafile file;
+    io::mapped_file file;
     int version;
-    bool inUse = false;
+    /// @brief compression::Method used to compress chunks data in the file
+    ubyte compression;
+    /// @brief Number of bytes not used by actual chunks data
+    uint32_t deadSize = 0;
+    /// @brief Checksum of the dictionary chunks data is compressed with
+    uint32_t dictionaryId = 0;
+    /// @brief Number of regfile_ptr using the file.
+    /// Modified with RegionsLayer::regFilesMutex locked
+    int users = 0;
+    /// @brief Value of RegionsLayer::regFilesUsage on last use
+    uint64_t lastUse = 0;
 
     regfile(io::path filename);
     regfile(const regfile&) = delete;
 
-    std::unique_ptr<ubyte[]> read(int index, uint32_t& size, uint32_t& srcSize);
+    /// @brief Get compressed chunk data without copying.
+    /// Valid until the file is closed
+    /// @param index chunk index in region
+    /// @param srcSize [out] source chunk data length
+    /// @return empty span if chunk is not present in the file
+    util::span<const ubyte> getChunkData(int index, uint32_t& srcSize) const;
+
+    std::unique_ptr<ubyte[]> read(
+        int index, uint32_t& size, uint32_t& srcSize
+    ) const;
 };
 
 using RegionsMap = std::unordered_map<glm::ivec2, std::unique_ptr<WorldRegion>>;
@@ -66,18 +129,20 @@ using RegionProc = std::function<std::unique_ptr<ubyte[]>(std::unique_ptr<ubyte[
 using InventoryProc = std::function<void(Inventory*)>;
 using BlockDataProc = std::function<void(BlocksMetadata*, std::unique_ptr<ubyte[]>)>;
 
-/// @brief Region file pointer keeping inUse flag on until destroyed
+/// @brief Region file pointer preventing the file from closing until
+/// destroyed
 class regfile_ptr {
     regfile* file;
+    std::mutex* mutex;
     std::condition_variable* cv;
 public:
-    regfile_ptr(regfile* file, std::condition_variable* cv)
-        : file(file), cv(cv) {
+    regfile_ptr(regfile* file, std::mutex* mutex, std::condition_variable* cv)
+        : file(file), mutex(mutex), cv(cv) {
     }
 
     regfile_ptr(const regfile_ptr&) = delete;
 
-    regfile_ptr(std::nullptr_t) : file(nullptr), cv(nullptr) {
+    regfile_ptr(std::nullptr_t) : file(nullptr), mutex(nullptr), cv(nullptr) {
     }
 
     bool operator==(std::nullptr_t) const {
@@ -97,8 +162,11 @@ public:
     }
     void reset() {
         if (file) {
-            file->inUse = false;
-            cv->notify_one();
+            {
+                std::lock_guard lock(*mutex);
+                file->users--;
+            }
+            cv->notify_all();
             file = nullptr;
         }
     }
@@ -113,6 +181,19 @@ inline void calc_reg_coords(
     localZ = z - (regionZ * REGION_SIZE);
 }
 
+struct RegionsCacheStats {
+    /// @brief Chunk data requests served from memory
+    size_t hits = 0;
+    /// @brief Chunk data requests not served from memory
+    size_t misses = 0;
+    /// @brief Number of regions removed from memory to fit the budget
+    size_t evictions = 0;
+    /// @brief Memory used by in-memory regions in bytes
+    size_t memoryUsage = 0;
+    /// @brief Number of in-memory regions
+    size_t regions = 0;
+};
+
 struct RegionsLayer {
     /// @brief Layer index
     RegionLayerIndex layer;
@@ -120,47 +201,187 @@ struct RegionsLayer {
     /// @brief Regions layer folder
     io::path folder;
 
+    /// @brief Compression method of in-memory and newly written chunks data.
+    /// Region files written with another method are converted on rewrite
     compression::Method compression = compression::Method::NONE;
 
+    /// @brief Dictionary file (empty path - dictionary is not used)
+    io::path dictionaryFile;
+
+    /// @brief LZ compression dictionary. Must not be changed after
+    /// any chunk is compressed with it
+    lz::Dictionary dictionary;
+
+    /// @brief Checksum of the dictionary stored in region files headers
+    uint32_t dictionaryId = 0;
+
     /// @brief In-memory regions data
     RegionsMap regions;
 
     /// @brief In-memory regions map mutex
     std::mutex mapMutex;
 
+    /// @brief Max memory used by in-memory regions in bytes (0 - unlimited).
+    /// Least recently used regions are written if unsaved and removed 
+    /// from memory when exceeded
+    size_t cacheBudget = 0;
+
+    /// @brief Evicted unsaved regions waiting for the writer thread.
+    /// Taken back to memory on access. Guarded by mapMutex
+    RegionsMap pendingWrites;
+
+    /// @brief Coords of the region being written by the writer thread.
+    /// Guarded by mapMutex
+    std::optional<glm::ivec2> writingRegion;
+
+    /// @brief Notified when pending writes are added or a region is written.
+    /// Used with mapMutex
+    std::condition_variable writerCv;
+
+    bool stopWriter = false;
+
+    /// @brief Writes evicted regions. Started on the first eviction
+    std::thread writer;
+
+    /// @brief Incremented on every region access
+    uint64_t usageCounter = 0;
+
+    RegionsCacheStats cacheStats {};
+
     /// @brief Open region files map
     std::unordered_map<glm::ivec2, std::unique_ptr<regfile>> openRegFiles;
 
     /// @brief Open region files map mutex
     std::mutex regFilesMutex;
+    /// @brief Notified when any region file gets out of use, closed
+    /// or written
     std::condition_variable regFilesCv;
 
+    /// @brief Coords of region files being written. These files are not
+    /// opened until written. Guarded by regFilesMutex
+    std::unordered_set<glm::ivec2> writingRegFiles;
+
+    /// @brief Incremented on every region file use
+    uint64_t regFilesUsage = 0;
+
+    /// @brief Get open region file or open it if exists
+    /// @param create open file if not open yet
     [[nodiscard]] regfile_ptr getRegFile(glm::ivec2 coord, bool create = true);
+    /// @brief regFilesMutex must be locked
     [[nodiscard]] regfile_ptr useRegFile(glm::ivec2 coord);
-    regfile_ptr createRegFile(glm::ivec2 coord);
-    void closeRegFile(glm::ivec2 coord);
+    regfile_ptr createRegFile(
+        glm::ivec2 coord, std::unique_lock<std::mutex>& lock
+    );
+    /// @brief Wait until region file gets out of use, close it and mark
+    /// as being written
+    void beginRegFileWrite(glm::ivec2 coord);
+    /// @brief Allow the written region file to be opened
+    void endRegFileWrite(glm::ivec2 coord);
+    /// @brief Wait until region file is not being written.
+    /// @param lock regFilesMutex lock
+    void waitRegFileWritten(
+        glm::ivec2 coord, std::unique_lock<std::mutex>& lock
+    );
+
+    ~RegionsLayer();
 
     WorldRegion* getRegion(int x, int z);
-    WorldRegion* getOrCreateRegion(int x, int z);
+
+    /// @brief Find in-memory region taking it back from pending writes.
+    /// mapMutex must be locked
+    /// @return nullptr if the region is not in memory
+    WorldRegion* findRegion(glm::ivec2 coord);
+
+    /// @brief Wait until the region file is not being written by the writer
+    /// thread
+    /// @param lock mapMutex lock
+    void waitRegionWritten(
+        glm::ivec2 coord, std::unique_lock<std::mutex>& lock
+    );
+
+    /// @brief Get or create in-memory region and update its last use.
+    /// mapMutex must be locked
+    WorldRegion& useRegion(int x, int z);
+
+    /// @brief Remove least recently used regions from memory until 
+    /// cacheBudget is not exceeded. mapMutex must be locked
+    /// @param keep coords of the region that must stay in memory
+    void evictRegions(std::optional<glm::ivec2> keep = std::nullopt);
+
+    size_t calcMemoryUsage() const;
+
+    RegionsCacheStats getCacheStats();
 
     io::path getRegionFilePath(int x, int z) const;
 
-    /// @brief Get chunk data. Read from file if not loaded yet.
+    /// @brief Get chunk data copy. Read from file if not loaded yet.
     /// @param x chunk x coord
     /// @param z chunk z coord
     /// @param size [out] compressed chunk data length
     /// @param size [out] source chunk data length
     /// @return nullptr if no saved chunk data found
-    [[nodiscard]] ubyte* getData(int x, int z, uint32_t& size, uint32_t& srcSize);
+    [[nodiscard]] std::unique_ptr<ubyte[]> getData(
+        int x, int z, uint32_t& size, uint32_t& srcSize
+    );
 
-    /// @brief Write or rewrite region file
+    /// @brief Store chunk data in memory and mark region as unsaved
+    /// @param x chunk x coord
+    /// @param z chunk z coord
+    /// @param data compressed chunk data (nullptr to remove)
+    /// @param size compressed chunk data length
+    /// @param srcSize source chunk data length
+    void put(
+        int x,
+        int z,
+        std::unique_ptr<ubyte[]> data,
+        uint32_t size,
+        uint32_t srcSize
+    );
+
+    /// @brief Append unsaved chunks to the region file or rewrite it
+    /// if has an outdated format or too much unused space
     /// @param x region X
     /// @param z region Z
     void writeRegion(int x, int y, WorldRegion* entry);
 
-    /// @brief Write all unsaved regions to files
+    /// @brief Write all unsaved regions to files including pending writes.
+    /// In-memory regions map stays locked until finished
     void writeAll();
 
+    /// @brief Remove region from memory. Unsaved region is handed to the
+    /// writer thread. mapMutex must be locked
+    void evictRegion(RegionsMap::iterator it);
+
+    /// @brief Writer thread loop. Writes pending regions until stopped
+    void runWriter();
+
+    const lz::Dictionary* getDictionary() const {
+        return &dictionary;
+    }
+
+    /// @brief Load the dictionary file or train a new dictionary on chunks
+    /// of existing region files, then switch compression to the method
+    /// variant using dictionary.
+    /// Must be called before any layer data access
+    void initDictionary();
+
+    /// @brief Train dictionary on chunks data of existing region files
+    /// @return empty dictionary if not enough chunks saved yet
+    /// @throws std::runtime_error if some region file is already compressed
+    /// with a dictionary, so the dictionary file is lost
+    std::vector<ubyte> trainDictionary() const;
+
+    /// @brief Convert chunk data read from the region file to the layer
+    /// compression method
+    /// @param file source region file
+    /// @param data chunk data compressed with file compression method
+    /// @param size [in,out] compressed chunk data length
+    /// @param srcSize source chunk data length
+    /// @return chunk data copy compressed with the layer method
+    std::unique_ptr<ubyte[]> transcode(
+        const regfile& file, const ubyte* data, uint32_t& size, uint32_t srcSize
+    ) const;
+
     /// @brief Read chunk data from region file
     /// @param x chunk x coord
     /// @param z chunk z coord
@@ -245,6 +466,12 @@ public:
     /// @brief Write all region layers
     void writeAll();
 
+    /// @brief Set max memory used by in-memory regions of each layer
+    /// @param bytes budget in bytes (0 - unlimited)
+    void setCacheBudget(size_t bytes);
+
+    RegionsCacheStats getCacheStats(RegionLayerIndex layerid);
+
     void deleteRegion(RegionLayerIndex layerid, int x, int z);
 
     /// @brief Extract X and Z from 'X_Z.bin' region file name.
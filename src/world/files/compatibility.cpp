@@ -1,5 +1,6 @@
 #include "compatibility.hpp"
 
+#include <cstring>
 #include <stdexcept>
 
 #include "constants.hpp"
@@ -107,3 +108,53 @@ util::Buffer<ubyte> compatibility::convert_region_2to3(
     }
     return util::Buffer<ubyte>(builder.build().data(), builder.size());
 }
+
+util::Buffer<ubyte> compatibility::convert_region_3to4(
+    const util::Buffer<ubyte>& src
+) {
+    const size_t REGION_CHUNKS = 1024;
+    const size_t HEADER_SIZE = 10;
+    const size_t OFFSET_TABLE_SIZE = REGION_CHUNKS * sizeof(uint32_t);
+    const size_t DATA_OFFSET = HEADER_SIZE + 8 + OFFSET_TABLE_SIZE;
+
+    if (src.size() < HEADER_SIZE + OFFSET_TABLE_SIZE) {
+        throw std::runtime_error("incomplete region file");
+    }
+    const ubyte* const ptr = src.data();
+
+    ByteBuilder builder;
+    builder.putCStr(".VOXREG");
+    builder.put(4);
+    builder.put(ptr[9]);
+    // unused bytes count
+    builder.putInt32(0);
+    // dictionary id (version 3 files are compressed without dictionary)
+    builder.putInt32(0);
+
+    const ubyte* table = ptr + src.size() - OFFSET_TABLE_SIZE;
+    auto read_uint32 = [](const ubyte* src) {
+        uint32_t value;
+        std::memcpy(&value, src, sizeof(uint32_t));
+        return dataio::le2h(value);
+    };
+
+    uint32_t offset = DATA_OFFSET;
+    for (size_t i = 0; i < REGION_CHUNKS; i++) {
+        uint32_t srcOffset = read_uint32(table + i * sizeof(uint32_t));
+        if (srcOffset == 0) {
+            builder.putInt32(0);
+            continue;
+        }
+        builder.putInt32(offset);
+        offset += 8 + read_uint32(ptr + srcOffset);
+    }
+    for (size_t i = 0; i < REGION_CHUNKS; i++) {
+        uint32_t srcOffset = read_uint32(table + i * sizeof(uint32_t));
+        if (srcOffset == 0) {
+            continue;
+        }
+        uint32_t size = read_uint32(ptr + srcOffset);
+        builder.put(ptr + srcOffset, 8 + size);
+    }
+    return util::Buffer<ubyte>(builder.build().data(), builder.size());
+}
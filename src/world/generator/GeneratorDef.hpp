@@ -128,6 +128,10 @@ public:
 
     virtual void initialize(uint64_t seed) = 0;
 
+    /// @brief Create a separate not initialized instance of the script
+    /// to be used in another thread
+    virtual std::unique_ptr<GeneratorScript> clone() const = 0;
+
     /// @brief Generate a heightmap with values in range 0..1
     /// @param offset position of the heightmap in the world
     /// @param size size of the heightmap
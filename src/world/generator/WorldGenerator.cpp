@@ -13,6 +13,7 @@
 #include "util/listutil.hpp"
 #include "maths/voxmaths.hpp"
 #include "maths/util.hpp"
+#include "util/ThreadPool.hpp"
 #include "debug/Logger.hpp"
 
 static debug::Logger logger("world-generator");
@@ -23,8 +24,25 @@ static inline constexpr uint MAX_PARAMETERS = 4;
 /// @brief Initial + wide_structs + biomes + heightmaps + complete
 static inline constexpr uint BASIC_PROTOTYPE_LAYERS = 5;
 
+class WorldGenerator::UpgradeWorker
+    : public util::Worker<PrototypeUpgrade*, PrototypeUpgrade*> {
+    WorldGenerator& generator;
+    std::unique_ptr<GeneratorScript> script;
+public:
+    UpgradeWorker(
+        WorldGenerator& generator, std::unique_ptr<GeneratorScript> script
+    )
+        : generator(generator), script(std::move(script)) {
+    }
+
+    PrototypeUpgrade* operator()(PrototypeUpgrade* const& upgrade) override {
+        generator.upgradePrototype(*script, *upgrade);
+        return upgrade;
+    }
+};
+
 WorldGenerator::WorldGenerator(
-    const GeneratorDef& def, const Content& content, uint64_t seed
+    const GeneratorDef& def, const Content& content, uint64_t seed, uint threads
 )
     : def(def), 
       content(content), 
@@ -33,6 +51,25 @@ WorldGenerator::WorldGenerator(
 {
     def.script->initialize(seed);
 
+    if (threads > 1) {
+        workers = std::make_unique<UpgradeWorkers>(
+            "generator-workers",
+            [this, seed]() {
+                // Lua states must be created and initialized in the main
+                // thread, workers are created by the pool constructor
+                auto script = this->def.script->clone();
+                script->initialize(seed);
+                return std::make_shared<UpgradeWorker>(
+                    *this, std::move(script)
+                );
+            },
+            [](PrototypeUpgrade*&) {},
+            threads
+        );
+        logger.info() << "using " << workers->getWorkersCount()
+                      << " generator threads";
+    }
+
     uint levels = BASIC_PROTOTYPE_LAYERS + def.wideStructsChunksRadius * 2;
 
     surroundMap = SurroundMap(0, levels);
@@ -45,25 +82,19 @@ WorldGenerator::WorldGenerator(
         }
         prototypes.erase({x, z});
     });
-    surroundMap.setLevelCallback(1, [this](int const x, int const z) {
-        if (prototypes.find({x, z}) != prototypes.end()) {
-            return;
-        }
-        prototypes[{x, z}] = generatePrototype(x, z);
-    });
-    surroundMap.setLevelCallback(def.wideStructsChunksRadius + 1, 
-    [this](int const x, int const z) {
-        generateStructuresWide(requirePrototype(x, z), x, z);
-    });
-    surroundMap.setLevelCallback(levels-3, [this](int const x, int const z) {
-        generateBiomes(requirePrototype(x, z), x, z);
-    });
-    surroundMap.setLevelCallback(levels-2, [this](int const x, int const z) {
-        generateHeightmap(requirePrototype(x, z), x, z);
-    });
-    surroundMap.setLevelCallback(levels-1, [this](int const x, int const z) {
-        generateStructures(requirePrototype(x, z), x, z);
-    });
+    int wideStructsLevel = def.wideStructsChunksRadius + 1;
+    for (int level : {
+        1,
+        wideStructsLevel,
+        static_cast<int>(levels) - 3,
+        static_cast<int>(levels) - 2,
+        static_cast<int>(levels) - 1
+    }) {
+        surroundMap.setLevelCallback(level, 
+        [this, level](int const x, int const z) {
+            pending.push_back(PrototypeUpgrade {level, {x, z}});
+        });
+    }
     for (int i = 0; i < def.structures.size(); i++) {
         // pre-calculate rotated structure variants
         def.structures[i]->fragments[0]->prepare(content);
@@ -224,33 +255,15 @@ void WorldGenerator::placeStructures(
     }
 }
 
-void WorldGenerator::generateStructuresWide(
-    ChunkPrototype& prototype, int chunkX, int chunkZ
-) {
-    if (prototype.level >= ChunkPrototypeLevel::WIDE_STRUCTS) {
-        return;
-    }
-    auto placements = def.script->placeStructuresWide(
-        {chunkX * CHUNK_W, chunkZ * CHUNK_D}, {CHUNK_W, CHUNK_D}, CHUNK_H
-    );
-    placeStructures(placements, prototype, chunkX, chunkZ);
-
-    prototype.level = ChunkPrototypeLevel::WIDE_STRUCTS;
-}
-
 void WorldGenerator::generateStructures(
-    ChunkPrototype& prototype, int chunkX, int chunkZ
+    ChunkPrototype& prototype,
+    const std::vector<Placement>& placements,
+    int chunkX,
+    int chunkZ
 ) {
-    if (prototype.level >= ChunkPrototypeLevel::STRUCTURES) {
-        return;
-    }
     const auto& biomes = prototype.biomes;
     const auto& heightmap = prototype.heightmap;
 
-    auto placements = def.script->placeStructures(
-        {chunkX * CHUNK_W, chunkZ * CHUNK_D}, {CHUNK_W, CHUNK_D},
-        heightmap, CHUNK_H
-    );
     placeStructures(placements, prototype, chunkX, chunkZ);
 
     util::PseudoRandom structsRand;
@@ -288,17 +301,16 @@ void WorldGenerator::generateStructures(
             );
         }
     }
-    prototype.level = ChunkPrototypeLevel::STRUCTURES;
 }
 
 void WorldGenerator::generateBiomes(
-    ChunkPrototype& prototype, int chunkX, int chunkZ
+    GeneratorScript& script, ChunkPrototype& prototype, int chunkX, int chunkZ
 ) {
     if (prototype.level >= ChunkPrototypeLevel::BIOMES) {
         return;
     }
     uint bpd = def.biomesBPD;
-    auto biomeParams = def.script->generateParameterMaps(
+    auto biomeParams = script.generateParameterMaps(
         {floordiv(chunkX * CHUNK_W, bpd), floordiv(chunkZ * CHUNK_D, bpd)},
         {floordiv(CHUNK_W, bpd)+1, floordiv(CHUNK_D, bpd)+1},
         bpd
@@ -333,13 +345,13 @@ void WorldGenerator::generateBiomes(
 }
 
 void WorldGenerator::generateHeightmap(
-    ChunkPrototype& prototype, int chunkX, int chunkZ
+    GeneratorScript& script, ChunkPrototype& prototype, int chunkX, int chunkZ
 ) {
     if (prototype.level >= ChunkPrototypeLevel::HEIGHTMAP) {
         return;
     }
     uint bpd = def.heightsBPD;
-    prototype.heightmap = def.script->generateHeightmap(
+    prototype.heightmap = script.generateHeightmap(
         {floordiv(chunkX * CHUNK_W, bpd), floordiv(chunkZ * CHUNK_D, bpd)},
         {floordiv(CHUNK_W, bpd)+1, floordiv(CHUNK_D, bpd)+1},
         bpd,
@@ -359,6 +371,99 @@ void WorldGenerator::update(int centerX, int centerY, int loadDistance) {
     surroundMap.setCenter(centerX, centerY);
 }
 
+void WorldGenerator::processPending() {
+    auto upgrades = std::move(pending);
+    pending.clear();
+    // Level N of a chunk depends only on level N-1 of surrounding chunks and
+    // placed structures are not used until chunks generation, so
+    // consecutive upgrades of the same level are independent. Placing their
+    // structures after all of them in order gives the same prototypes as
+    // upgrading one by one
+    for (size_t begin = 0; begin < upgrades.size();) {
+        size_t end = begin + 1;
+        while (end < upgrades.size() &&
+               upgrades[end].level == upgrades[begin].level) {
+            end++;
+        }
+        processLevel(upgrades.data() + begin, end - begin);
+        begin = end;
+    }
+}
+
+void WorldGenerator::processLevel(PrototypeUpgrade* upgrades, size_t count) {
+    if (upgrades[0].level == 1) {
+        for (size_t i = 0; i < count; i++) {
+            const auto& pos = upgrades[i].pos;
+            if (prototypes.find(pos) == prototypes.end()) {
+                prototypes[pos] = generatePrototype(pos.x, pos.y);
+            }
+        }
+        return;
+    }
+    for (size_t i = 0; i < count; i++) {
+        const auto& pos = upgrades[i].pos;
+        upgrades[i].prototype = &requirePrototype(pos.x, pos.y);
+    }
+    if (workers && count > 1) {
+        for (size_t i = 0; i < count; i++) {
+            workers->enqueueJob(&upgrades[i]);
+        }
+        workers->waitForJobs();
+    } else {
+        for (size_t i = 0; i < count; i++) {
+            upgradePrototype(*def.script, upgrades[i]);
+        }
+    }
+    for (size_t i = 0; i < count; i++) {
+        applyPlacements(upgrades[i]);
+    }
+}
+
+void WorldGenerator::upgradePrototype(
+    GeneratorScript& script, PrototypeUpgrade& upgrade
+) {
+    auto& prototype = *upgrade.prototype;
+    const auto& pos = upgrade.pos;
+    int levels = BASIC_PROTOTYPE_LAYERS + def.wideStructsChunksRadius * 2;
+    if (upgrade.level == static_cast<int>(def.wideStructsChunksRadius) + 1) {
+        if (prototype.level >= ChunkPrototypeLevel::WIDE_STRUCTS) {
+            return;
+        }
+        upgrade.placements = script.placeStructuresWide(
+            {pos.x * CHUNK_W, pos.y * CHUNK_D}, {CHUNK_W, CHUNK_D}, CHUNK_H
+        );
+        upgrade.placing = true;
+        prototype.level = ChunkPrototypeLevel::WIDE_STRUCTS;
+    } else if (upgrade.level == levels - 3) {
+        generateBiomes(script, prototype, pos.x, pos.y);
+    } else if (upgrade.level == levels - 2) {
+        generateHeightmap(script, prototype, pos.x, pos.y);
+    } else if (upgrade.level == levels - 1) {
+        if (prototype.level >= ChunkPrototypeLevel::STRUCTURES) {
+            return;
+        }
+        upgrade.placements = script.placeStructures(
+            {pos.x * CHUNK_W, pos.y * CHUNK_D}, {CHUNK_W, CHUNK_D},
+            prototype.heightmap, CHUNK_H
+        );
+        upgrade.placing = true;
+        prototype.level = ChunkPrototypeLevel::STRUCTURES;
+    }
+}
+
+void WorldGenerator::applyPlacements(PrototypeUpgrade& upgrade) {
+    if (!upgrade.placing) {
+        return;
+    }
+    const auto& pos = upgrade.pos;
+    auto& prototype = *upgrade.prototype;
+    if (upgrade.level == static_cast<int>(def.wideStructsChunksRadius) + 1) {
+        placeStructures(upgrade.placements, prototype, pos.x, pos.y);
+    } else {
+        generateStructures(prototype, upgrade.placements, pos.x, pos.y);
+    }
+}
+
 void WorldGenerator::generatePlants(
     const ChunkPrototype& prototype,
     float* heights,
@@ -428,6 +533,7 @@ void WorldGenerator::generateLand(
 
 void WorldGenerator::generate(voxel* voxels, int chunkX, int chunkZ) {
     surroundMap.completeAt(chunkX, chunkZ);
+    processPending();
 
     const auto& prototype = requirePrototype(chunkX, chunkZ);
     const auto values = prototype.heightmap->getValues();
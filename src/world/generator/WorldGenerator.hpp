@@ -14,6 +14,7 @@
 
 class Content;
 struct GeneratorDef;
+class GeneratorScript;
 class Heightmap;
 struct Biome;
 class VoxelFragment;
@@ -37,6 +38,11 @@ struct ChunkPrototype {
     std::vector<std::shared_ptr<Heightmap>> heightmapInputs {};
 };
 
+namespace util {
+    template <class T, class R>
+    class ThreadPool;
+}
+
 struct WorldGenDebugInfo {
     int areaOffsetX;
     int areaOffsetY;
@@ -57,6 +63,42 @@ class WorldGenerator {
     std::unordered_map<glm::ivec2, std::unique_ptr<ChunkPrototype>> prototypes;
     /// @brief Chunk prototypes loading surround map
     SurroundMap surroundMap;
+    /// @brief Prototype upgrade requested by surroundMap
+    struct PrototypeUpgrade {
+        int level;
+        glm::ivec2 pos;
+        /// @brief Upgraded prototype (set before upgrade)
+        ChunkPrototype* prototype = nullptr;
+        /// @brief Structures placed to neighbour prototypes by the upgrade
+        std::vector<Placement> placements {};
+        /// @brief Set if the upgrade places structures
+        bool placing = false;
+    };
+    class UpgradeWorker;
+    using UpgradeWorkers = util::ThreadPool<PrototypeUpgrade*, PrototypeUpgrade*>;
+
+    /// @brief Prototype upgrades in surroundMap callbacks order, processed
+    /// in processPending
+    std::vector<PrototypeUpgrade> pending;
+    /// @brief Upgrade workers having own generator scripts
+    /// (nullptr if upgrades are performed on the calling thread)
+    std::unique_ptr<UpgradeWorkers> workers;
+
+    /// @brief Process pending prototype upgrades in the callbacks order.
+    /// Consecutive upgrades of the same level are performed by workers
+    void processPending();
+
+    /// @brief Perform consecutive upgrades of the same level, then place
+    /// their structures in order
+    void processLevel(PrototypeUpgrade* upgrades, size_t count);
+
+    /// @brief Perform upgrade script calls. Structure placements are stored
+    /// in the upgrade to be applied with applyPlacements.
+    /// Prototypes of different upgrades may be upgraded in parallel
+    void upgradePrototype(GeneratorScript& script, PrototypeUpgrade& upgrade);
+
+    /// @brief Place upgrade structures to neighbour prototypes
+    void applyPlacements(PrototypeUpgrade& upgrade);
 
     /// @brief Generate chunk prototype (see ChunkPrototype)
     /// @param x chunk position X divided by CHUNK_W
@@ -65,13 +107,20 @@ class WorldGenerator {
 
     ChunkPrototype& requirePrototype(int x, int z);
 
-    void generateStructuresWide(ChunkPrototype& prototype, int x, int z);
-
-    void generateStructures(ChunkPrototype& prototype, int x, int z);
+    /// @brief Place structures and biome structures of the prototype
+    void generateStructures(
+        ChunkPrototype& prototype,
+        const std::vector<Placement>& placements,
+        int x, int z
+    );
 
-    void generateBiomes(ChunkPrototype& prototype, int x, int z);
+    void generateBiomes(
+        GeneratorScript& script, ChunkPrototype& prototype, int x, int z
+    );
 
-    void generateHeightmap(ChunkPrototype& prototype, int x, int z);
+    void generateHeightmap(
+        GeneratorScript& script, ChunkPrototype& prototype, int x, int z
+    );
 
     void placeStructure(
         const StructurePlacement& placement, int priority, 
@@ -118,10 +167,12 @@ class WorldGenerator {
         int x, int z
     );
 public:
+    /// @param threads number of threads used for prototypes generation
     WorldGenerator(
         const GeneratorDef& def,
         const Content& content,
-        uint64_t seed
+        uint64_t seed,
+        uint threads = 1
     );
     ~WorldGenerator();
 
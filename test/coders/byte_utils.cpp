@@ -18,3 +18,19 @@ TEST(byte_utils, BytesBuildAndRead) {
     EXPECT_EQ(reader.getInt32(), 123456789);
     EXPECT_EQ(reader.getInt64(), 98765432123456789LL);
 }
+
+TEST(byte_utils, VarUInt32) {
+    const uint32_t values[] {0, 1, 127, 128, 300, 16384, 0xFFFFFFFF};
+    ByteBuilder builder;
+    for (auto value : values) {
+        builder.putVarUInt32(value);
+    }
+    auto data = builder.build();
+    EXPECT_EQ(data.size(), 1 + 1 + 1 + 2 + 2 + 3 + 5);
+
+    ByteReader reader(data);
+    for (auto value : values) {
+        EXPECT_EQ(reader.getVarUInt32(), value);
+    }
+    EXPECT_FALSE(reader.hasNext());
+}
@@ -0,0 +1,147 @@
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+
+#include "typedefs.hpp"
+#include "coders/lz.hpp"
+#include "coders/compression.hpp"
+
+static std::vector<ubyte> create_data(size_t size, int dencity, uint seed) {
+    srand(seed);
+    std::vector<ubyte> data(size);
+    ubyte next = rand();
+    for (size_t i = 0; i < size; i++) {
+        data[i] = next;
+        if (rand() % dencity == 0) {
+            next = rand();
+        }
+    }
+    return data;
+}
+
+static void test_encode_decode(
+    const std::vector<ubyte>& data, const lz::Dictionary& dictionary
+) {
+    std::vector<ubyte> encoded(lz::compress_bound(data.size()));
+    size_t encodedSize =
+        lz::encode(data.data(), data.size(), encoded.data(), &dictionary);
+    EXPECT_LE(encodedSize, encoded.size());
+
+    std::vector<ubyte> decoded(data.size());
+    size_t decodedSize = lz::decode(
+        encoded.data(),
+        encodedSize,
+        decoded.data(),
+        decoded.size(),
+        dictionary.getData()
+    );
+    EXPECT_EQ(decodedSize, data.size());
+    EXPECT_EQ(decoded, data);
+}
+
+TEST(LZ, EncodeDecode) {
+    test_encode_decode({}, lz::Dictionary());
+    test_encode_decode(create_data(3, 2, 1), lz::Dictionary());
+    test_encode_decode(create_data(50'000, 13, 2), lz::Dictionary());
+    test_encode_decode(create_data(50'000, 1, 3), lz::Dictionary());
+    test_encode_decode(std::vector<ubyte>(100'000, 7), lz::Dictionary());
+}
+
+TEST(LZ, Dictionary) {
+    std::vector<std::vector<ubyte>> sources;
+    std::vector<util::span<const ubyte>> samples;
+    for (uint i = 0; i < 8; i++) {
+        sources.push_back(create_data(4'000, 40, 100));
+        // samples share the most of data
+        sources.back()[i * 500] ^= 0xFF;
+    }
+    for (const auto& source : sources) {
+        samples.emplace_back(source.data(), source.size());
+    }
+    auto dictionary = lz::train_dictionary(samples, 4096);
+    EXPECT_FALSE(dictionary.empty());
+    EXPECT_LE(dictionary.size(), 4096);
+    lz::Dictionary dict(std::move(dictionary));
+
+    auto data = create_data(4'000, 40, 100);
+    test_encode_decode(data, dict);
+
+    std::vector<ubyte> encoded(lz::compress_bound(data.size()));
+    size_t plainSize = lz::encode(data.data(), data.size(), encoded.data());
+    size_t dictSize =
+        lz::encode(data.data(), data.size(), encoded.data(), &dict);
+    EXPECT_LT(dictSize, plainSize);
+}
+
+TEST(LZ, Malformed) {
+    auto data = create_data(10'000, 13, 4);
+    std::vector<ubyte> encoded(lz::compress_bound(data.size()));
+    size_t encodedSize = lz::encode(data.data(), data.size(), encoded.data());
+
+    EXPECT_THROW(
+        compression::decompress(
+            encoded.data(),
+            encodedSize / 2,
+            data.size(),
+            compression::Method::LZ
+        ),
+        std::runtime_error
+    );
+    std::vector<ubyte> decoded(data.size());
+    EXPECT_THROW(
+        lz::decode(
+            encoded.data(), encodedSize, decoded.data(), decoded.size() / 2
+        ),
+        std::runtime_error
+    );
+}
+
+TEST(LZ, CompressionMethod) {
+    auto data = create_data(30'000, 20, 5);
+    lz::Dictionary dict({data.begin(), data.begin() + 1000});
+
+    for (auto method : {
+             compression::Method::LZ,
+             compression::Method::LZ_DICT,
+             compression::Method::EXTRLE16_LZ,
+             compression::Method::EXTRLE16_LZ_DICT,
+         }) {
+        size_t length;
+        auto compressed = compression::compress(
+            data.data(), data.size(), length, method, &dict
+        );
+        auto decompressed = compression::decompress(
+            compressed.get(), length, data.size(), method, &dict
+        );
+        std::vector<ubyte> result(
+            decompressed.get(), decompressed.get() + data.size()
+        );
+        EXPECT_EQ(result, data);
+    }
+    size_t length;
+    EXPECT_THROW(
+        compression::compress(
+            data.data(), data.size(), length, compression::Method::LZ_DICT
+        ),
+        std::invalid_argument
+    );
+}
+
+TEST(LZ, DistantShortMatches) {
+    // incompressible literals runs with short matches far in the dictionary
+    auto dictionary = create_data(32'768, 1, 6);
+    lz::Dictionary dict(dictionary);
+    auto literals = create_data(150'000, 1, 7);
+    std::vector<ubyte> data;
+    for (size_t i = 0; i < 10'000; i++) {
+        auto literal = literals.begin() + i * 15;
+        data.insert(data.end(), literal, literal + 15);
+        size_t offset = (i * 7919) % (dictionary.size() - lz::MIN_MATCH);
+        data.insert(
+            data.end(),
+            dictionary.begin() + offset,
+            dictionary.begin() + offset + lz::MIN_MATCH
+        );
+    }
+    test_encode_decode(data, dict);
+}
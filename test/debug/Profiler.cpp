@@ -0,0 +1,59 @@
+#include <gtest/gtest.h>
+
+#include "coders/json.hpp"
+#include "debug/Profiler.hpp"
+
+using namespace debug::profiler;
+
+static void add_time(Section section, int64_t micros) {
+    auto start = clock::now();
+    add(section, start, start + std::chrono::microseconds(micros));
+}
+
+TEST(Profiler, History) {
+    for (size_t i = 0; i < HISTORY_SIZE + 10; i++) {
+        add_time(Section::PHYSICS, i);
+        add_time(Section::PHYSICS, 1);
+        next_frame();
+    }
+    auto history = get_history(Section::PHYSICS);
+    ASSERT_EQ(history.size(), HISTORY_SIZE);
+    for (size_t i = 0; i < HISTORY_SIZE; i++) {
+        EXPECT_EQ(history[i], static_cast<int64_t>(i + 11));
+    }
+    int64_t last = HISTORY_SIZE + 10;
+    auto stats = get_stats(Section::PHYSICS);
+    EXPECT_EQ(stats.last, last);
+    EXPECT_EQ(stats.max, last);
+    EXPECT_EQ(stats.average, (11 + last) / 2);
+    EXPECT_EQ(get_stats(Section::SAVING).max, 0);
+}
+
+TEST(Profiler, SectionNames) {
+    for (size_t i = 0; i < SECTIONS_COUNT; i++) {
+        Section section;
+        ASSERT_TRUE(get_section(get_name(static_cast<Section>(i)), section));
+        EXPECT_EQ(static_cast<size_t>(section), i);
+    }
+    Section section;
+    EXPECT_FALSE(get_section("unknown", section));
+}
+
+TEST(Profiler, Trace) {
+    start_trace(2);
+    EXPECT_TRUE(is_tracing());
+    add_time(Section::TICK, 100);
+    add_time(Section::CHUNKS, 50);
+    add_time(Section::LIGHTING, 10);
+    next_frame();
+
+    auto root = json::parse(stop_trace());
+    EXPECT_FALSE(is_tracing());
+    const auto& events = root["traceEvents"];
+    ASSERT_EQ(events.size(), 2);
+    EXPECT_EQ(events[0]["name"].asString(), "tick");
+    EXPECT_EQ(events[0]["ph"].asString(), "X");
+    EXPECT_EQ(events[0]["dur"].asInteger(), 100);
+    EXPECT_EQ(events[1]["name"].asString(), "chunks");
+    EXPECT_EQ(root["otherData"]["dropped"].asInteger(), 1);
+}
@@ -0,0 +1,23 @@
+#include <gtest/gtest.h>
+
+#include "engine/TickStats.hpp"
+
+TEST(TickStats, Percentiles) {
+    TickStats stats;
+    EXPECT_EQ(stats.getPercentile(50), 0);
+    for (int i = 100; i >= 1; i--) {
+        stats.addTick(i * 1000, i);
+    }
+    EXPECT_EQ(stats.getTicksCount(), 100);
+    EXPECT_EQ(stats.getPercentile(50), 50'000);
+    EXPECT_EQ(stats.getPercentile(99), 99'000);
+    EXPECT_EQ(stats.getPercentile(100), 100'000);
+    EXPECT_EQ(stats.getPercentile(0), 1000);
+
+    auto report = stats.createReport();
+    EXPECT_EQ(report["ticks"].asInteger(), 100);
+    EXPECT_DOUBLE_EQ(report["tick_p99_ms"].asNumber(), 99.0);
+    EXPECT_DOUBLE_EQ(report["tick_max_ms"].asNumber(), 100.0);
+    EXPECT_DOUBLE_EQ(report["tick_mean_ms"].asNumber(), 50.5);
+    EXPECT_EQ(report["entities_max"].asInteger(), 100);
+}
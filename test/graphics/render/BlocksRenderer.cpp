@@ -0,0 +1,133 @@
+#include <gtest/gtest.h>
+
+#include "assets/Assets.hpp"
+#include "content/Content.hpp"
+#include "content/ContentPack.hpp"
+#include "core_defs.hpp"
+#include "frontend/ContentGfxCache.hpp"
+#include "graphics/core/Atlas.hpp"
+#include "graphics/core/ImageData.hpp"
+#include "graphics/core/Mesh.hpp"
+#include "graphics/render/BlocksRenderer.hpp"
+#include "items/ItemDef.hpp"
+#include "lighting/Lightmap.hpp"
+#include "objects/EntityDef.hpp"
+#include "objects/rigging.hpp"
+#include "voxels/Block.hpp"
+#include "world/generator/GeneratorDef.hpp"
+#include "world/generator/VoxelFragment.hpp"
+
+inline constexpr size_t CAPACITY = 1 << 16;
+
+class BlocksRendererTest : public testing::Test {
+protected:
+    std::unique_ptr<Content> content;
+    EngineSettings settings;
+    Assets assets;
+
+    void SetUp() override {
+        UptrsMap<std::string, Block> blocks;
+        std::vector<Block*> defs;
+        for (const auto& name : {"core:air", "test:stone", "test:dirt"}) {
+            auto block = std::make_unique<Block>(name);
+            block->rt.id = defs.size();
+            block->rt.solid = !defs.empty();
+            block->replaceable = defs.empty();
+            defs.push_back(block.get());
+            blocks[name] = std::move(block);
+        }
+        ResourceIndicesSet resourceIndices {};
+        content = std::make_unique<Content>(
+            std::make_unique<ContentIndices>(
+                ContentUnitIndices<Block>(defs),
+                ContentUnitIndices<ItemDef>({}),
+                ContentUnitIndices<EntityDef>({})
+            ),
+            std::make_unique<DrawGroups>(DrawGroups {0}),
+            ContentUnitDefs<Block>(std::move(blocks)),
+            ContentUnitDefs<ItemDef>({}),
+            ContentUnitDefs<EntityDef>({}),
+            ContentUnitDefs<GeneratorDef>({}),
+            UptrsMap<std::string, ContentPackRuntime>(),
+            UptrsMap<std::string, BlockMaterial>(),
+            UptrsMap<std::string, rigging::SkeletonConfig>(),
+            resourceIndices,
+            nullptr
+        );
+        std::unordered_map<std::string, UVRegion> regions {
+            {TEXTURE_NOTFOUND, UVRegion(0.0f, 0.0f, 0.5f, 0.5f)}
+        };
+        assets.store(
+            std::make_unique<Atlas>(
+                std::make_unique<ImageData>(ImageFormat::rgba8888, 2, 2),
+                std::move(regions),
+                false
+            ),
+            "blocks"
+        );
+    }
+
+    /// @brief Create snapshot of a fully lit chunk with ground of blocks
+    /// returned by the function for every column
+    template <typename Func>
+    static std::unique_ptr<ChunkSnapshot> createGround(
+        int height, const Func& ground
+    ) {
+        int padding = 2;
+        auto snapshot = std::make_unique<ChunkSnapshot>(
+            0, 0, 0, height + 1, padding, 0, height + 3
+        );
+        const auto& volume = snapshot->volume;
+        int w = volume.getW();
+        int d = volume.getD();
+        for (int y = 0; y < volume.getH(); y++) {
+            for (int z = 0; z < d; z++) {
+                for (int x = 0; x < w; x++) {
+                    size_t index = vox_index(x, y, z, w, d);
+                    volume.getVoxels()[index] = {
+                        static_cast<blockid_t>(
+                            y < height ? ground(x - padding, z - padding) : 0
+                        ),
+                        {}
+                    };
+                    volume.getLights()[index] = Lightmap::combine(0, 0, 0, 15);
+                }
+            }
+        }
+        return snapshot;
+    }
+
+    /// @return number of opaque mesh vertices
+    size_t build(const ChunkSnapshot& snapshot, bool greedy) {
+        settings.graphics.greedyMeshing.set(greedy);
+        ContentGfxCache cache(*content, assets, settings.graphics);
+        BlocksRenderer renderer(CAPACITY, *content, cache, settings);
+        renderer.build(snapshot);
+        auto data = renderer.createMesh();
+        const auto& mesh = data.mesh;
+        EXPECT_EQ(mesh.indices.size(), mesh.vertices.size() / 4 * 6);
+        return mesh.vertices.size();
+    }
+};
+
+TEST_F(BlocksRendererTest, GreedyMergesFlatGround) {
+    auto snapshot = createGround(8, [](int, int) { return 1; });
+    auto plain = build(*snapshot, false);
+    auto greedy = build(*snapshot, true);
+
+    // only top faces are visible
+    EXPECT_EQ(plain, CHUNK_W * CHUNK_D * 4);
+    EXPECT_EQ(greedy, 4);
+}
+
+TEST_F(BlocksRendererTest, GreedyKeepsDifferentBlocks) {
+    // stripes of different blocks along x
+    auto snapshot = createGround(8, [](int x, int) {
+        return 1 + ((x + CHUNK_W) / 4 & 1);
+    });
+    auto plain = build(*snapshot, false);
+    auto greedy = build(*snapshot, true);
+
+    EXPECT_EQ(plain, CHUNK_W * CHUNK_D * 4);
+    EXPECT_EQ(greedy, CHUNK_W / 4 * 4);
+}
@@ -0,0 +1,232 @@
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <random>
+#include <thread>
+
+#include "content/Content.hpp"
+#include "lighting/LightEngine.hpp"
+#include "lighting/LightSolver.hpp"
+#include "lighting/Lighting.hpp"
+#include "voxels/Block.hpp"
+#include "voxels/Chunk.hpp"
+#include "voxels/Chunks.hpp"
+
+class LightEngineTest : public testing::Test {
+protected:
+    std::vector<std::unique_ptr<Block>> blocks;
+    std::unique_ptr<ContentIndices> indices;
+    std::unique_ptr<Chunks> chunks;
+
+    ChunkGetter getter() const {
+        return [this](int x, int z) { return chunks->getChunk(x, z); };
+    }
+
+    /// @param x,z chunk position relative to the chunks matrix
+    Chunk* getChunk(int x, int z) const {
+        return chunks->getChunk(
+            chunks->getOffsetX() + x, chunks->getOffsetY() + z
+        );
+    }
+
+    void SetUp() override {
+        auto& air = blocks.emplace_back(std::make_unique<Block>("core:air"));
+        air->lightPassing = true;
+        air->skyLightPassing = true;
+        blocks.emplace_back(std::make_unique<Block>("test:stone"));
+        auto& lamp = blocks.emplace_back(std::make_unique<Block>("test:lamp"));
+        lamp->emission[0] = 15;
+        lamp->emission[1] = 9;
+        lamp->emission[2] = 3;
+        lamp->rt.emissive = true;
+
+        std::vector<Block*> defs;
+        for (auto& block : blocks) {
+            defs.push_back(block.get());
+        }
+        indices = std::make_unique<ContentIndices>(
+            ContentUnitIndices<Block>(defs),
+            ContentUnitIndices<ItemDef>({}),
+            ContentUnitIndices<EntityDef>({})
+        );
+        chunks = std::make_unique<Chunks>(7, 7, 0, 0, nullptr, *indices);
+
+        std::mt19937 random(42);
+        for (int cz = 0; cz < 7; cz++) {
+            for (int cx = 0; cx < 7; cx++) {
+                auto chunk = std::make_shared<Chunk>(
+                    chunks->getOffsetX() + cx, chunks->getOffsetY() + cz
+                );
+                for (uint i = 0; i < CHUNK_VOL; i++) {
+                    uint value = random() % 100;
+                    chunk->voxels.ref(i).id = value < 60 ? 0 : (value < 99 ? 1 : 2);
+                }
+                chunks->putChunk(chunk);
+            }
+        }
+    }
+
+    /// @brief Build lights of emissive blocks with LightSolver
+    void solveReference(int cx, int cz) {
+        LightSolver solverR(*indices, getter(), 0);
+        LightSolver solverG(*indices, getter(), 1);
+        LightSolver solverB(*indices, getter(), 2);
+        auto chunk = getChunk(cx, cz);
+        for (uint y = 0; y < CHUNK_H; y++) {
+            for (uint z = 0; z < CHUNK_D; z++) {
+                for (uint x = 0; x < CHUNK_W; x++) {
+                    const auto& vox = chunk->voxels.get(vox_index(x, y, z));
+                    const auto& def = *blocks[vox.id];
+                    int gx = x + chunk->x * CHUNK_W;
+                    int gz = z + chunk->z * CHUNK_D;
+                    if (def.rt.emissive) {
+                        solverR.add(gx, y, gz, def.emission[0]);
+                        solverG.add(gx, y, gz, def.emission[1]);
+                        solverB.add(gx, y, gz, def.emission[2]);
+                    }
+                }
+            }
+        }
+        solverR.solve();
+        solverG.solve();
+        solverB.solve();
+    }
+
+    std::vector<light_t> copyLights() const {
+        std::vector<light_t> lights;
+        for (const auto& chunk : chunks->getChunks()) {
+            const auto* map = chunk->lightmap.getLights();
+            lights.insert(lights.end(), map, map + CHUNK_VOL);
+        }
+        return lights;
+    }
+
+    void clearLights() {
+        for (const auto& chunk : chunks->getChunks()) {
+            chunk->lightmap.clear();
+        }
+    }
+};
+
+TEST_F(LightEngineTest, MatchesLightSolver) {
+    solveReference(2, 2);
+    solveReference(3, 3);
+    auto expected = copyLights();
+    clearLights();
+
+    LightEngine engine(*indices, getter(), 1);
+    engine.build({LightTask {getChunk(2, 2), false}});
+    engine.build({LightTask {getChunk(3, 3), false}});
+    EXPECT_TRUE(expected == copyLights());
+}
+
+TEST_F(LightEngineTest, ParallelMatchesSerial) {
+    std::vector<LightTask> tasks {
+        LightTask {getChunk(1, 1), true},
+        LightTask {getChunk(4, 1), true},
+        LightTask {getChunk(1, 4), true},
+        LightTask {getChunk(4, 4), true},
+    };
+    LightEngine serial(*indices, getter(), 1);
+    for (const auto& task : tasks) {
+        serial.build({task});
+    }
+    auto expected = copyLights();
+    clearLights();
+
+    LightEngine parallel(*indices, getter(), 4);
+    parallel.build(tasks);
+    EXPECT_TRUE(expected == copyLights());
+}
+
+TEST_F(LightEngineTest, SkyLight) {
+    auto chunk = getChunk(3, 3);
+    for (int z = 0; z < CHUNK_D; z++) {
+        for (int x = 0; x < CHUNK_W; x++) {
+            for (int y = 0; y < CHUNK_H; y++) {
+                chunk->voxels.ref(vox_index(x, y, z)).id = y < 10 ? 1 : 0;
+            }
+        }
+    }
+    // dig a shaft and a tunnel under the ground
+    for (int y = 5; y < 10; y++) {
+        chunk->voxels.ref(vox_index(8, y, 8)).id = 0;
+    }
+    for (int x = 9; x < 13; x++) {
+        chunk->voxels.ref(vox_index(x, 5, 8)).id = 0;
+    }
+    clearLights();
+    Lighting::prebuildSkyLight(*chunk, *indices);
+
+    LightEngine engine(*indices, getter(), 1);
+    engine.build({LightTask {chunk, true}});
+
+    EXPECT_EQ(chunk->lightmap.getS(8, 5, 8), 15);
+    for (int x = 9; x < 13; x++) {
+        EXPECT_EQ(chunk->lightmap.getS(x, 5, 8), 15 - (x - 8));
+    }
+    EXPECT_EQ(chunk->lightmap.getS(13, 5, 8), 0);
+}
+
+TEST_F(LightEngineTest, SkyLightSections) {
+    auto chunk = getChunk(3, 3);
+    std::vector<voxel> voxels(CHUNK_VOL);
+    for (int y = 0; y < CHUNK_H; y++) {
+        for (int z = 0; z < CHUNK_D; z++) {
+            for (int x = 0; x < CHUNK_W; x++) {
+                bool solid = y < 32 || (y < 40 && (x + z) % 3 == 0);
+                voxels[vox_index(x, y, z)].id = solid ? 1 : 0;
+            }
+        }
+    }
+    // reference: expanded sections without occupancy info
+    for (uint i = 0; i < CHUNK_VOL; i++) {
+        chunk->voxels.set(i, voxels[i]);
+    }
+    chunk->occupancy = 0xFFFF;
+    clearLights();
+    Lighting::prebuildSkyLight(*chunk, *indices);
+    auto expected = copyLights();
+    int highestPoint = chunk->lightmap.highestPoint;
+
+    chunk->voxels.setAll(voxels.data());
+    chunk->updateHeights();
+    EXPECT_TRUE(chunk->voxels.isUniform(0));
+    EXPECT_FALSE(chunk->isSectionOccupied(3));
+    clearLights();
+    Lighting::prebuildSkyLight(*chunk, *indices);
+    EXPECT_TRUE(expected == copyLights());
+    EXPECT_EQ(chunk->lightmap.highestPoint, highestPoint);
+}
+
+TEST_F(LightEngineTest, DedicatedThread) {
+    LightTask task {getChunk(3, 3), true};
+    LightEngine engine(*indices, getter(), 1, true);
+    engine.build({task});
+    auto expected = copyLights();
+    clearLights();
+
+    ASSERT_TRUE(engine.enqueue(task));
+    // neighbourhood overlaps with the enqueued one
+    EXPECT_FALSE(engine.enqueue(LightTask {getChunk(4, 2), true}));
+    while (!task.chunk->flags.lighted) {
+        engine.update();
+        std::this_thread::yield();
+    }
+    EXPECT_TRUE(expected == copyLights());
+}
+
+TEST_F(LightEngineTest, DedicatedThreadDropsOutdated) {
+    LightTask task {getChunk(3, 3), true};
+    LightEngine engine(*indices, getter(), 1, true);
+    ASSERT_TRUE(engine.enqueue(task));
+    // modify neighbour chunk while lights are being built
+    getChunk(2, 3)->lightmap.setR(0, 0, 0, 7);
+    auto expected = copyLights();
+    while (engine.isQueueFull() || !engine.enqueue(LightTask {getChunk(0, 0), false})) {
+        engine.update();
+        std::this_thread::yield();
+    }
+    EXPECT_FALSE(task.chunk->flags.lighted);
+    EXPECT_TRUE(expected == copyLights());
+}
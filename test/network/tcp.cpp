@@ -0,0 +1,133 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include "network/Network.hpp"
+
+class NoRequests : public network::Requests {
+public:
+    void get(
+        const std::string&, network::OnResponse, network::OnReject, long
+    ) override {}
+
+    void post(
+        const std::string&,
+        const std::string&,
+        network::OnResponse,
+        network::OnReject,
+        long
+    ) override {}
+
+    size_t getTotalUpload() const override {
+        return 0;
+    }
+
+    size_t getTotalDownload() const override {
+        return 0;
+    }
+
+    void update() override {}
+};
+
+template <typename Predicate>
+static bool wait_for(Predicate predicate) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (!predicate()) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+TEST(tcp, Loopback) {
+    network::Network network(std::make_unique<NoRequests>());
+    std::atomic<u64id_t> serverSide = 0;
+    std::atomic<bool> connected = false;
+    // bind any free port
+    auto serverId = network.openServer(0, [&](u64id_t id) { serverSide = id; });
+    int port = network.getServer(serverId)->getPort();
+    ASSERT_NE(port, 0);
+    u64id_t clientSide = network.connect("127.0.0.1", port, [&](u64id_t) {
+        connected = true;
+    });
+    ASSERT_TRUE(wait_for([&]() { return connected && serverSide; }));
+
+    auto client = network.getConnection(clientSide);
+    auto server = network.getConnection(serverSide);
+    ASSERT_NE(client, nullptr);
+    ASSERT_NE(server, nullptr);
+
+    // large enough to not fit socket buffers at once
+    std::vector<char> data(4 * 1024 * 1024);
+    for (size_t i = 0; i < data.size(); i++) {
+        data[i] = static_cast<char>(i * 31);
+    }
+    EXPECT_EQ(client->send(data.data(), data.size()), data.size());
+
+    std::vector<char> received;
+    std::vector<char> buffer(65'536);
+    ASSERT_TRUE(wait_for([&]() {
+        int size = server->recv(buffer.data(), buffer.size());
+        if (size > 0) {
+            received.insert(received.end(), buffer.data(), buffer.data() + size);
+        }
+        return received.size() >= data.size();
+    }));
+    EXPECT_TRUE(received == data);
+
+    server->send("pong", 4);
+    ASSERT_TRUE(wait_for([&]() { return client->available() == 4; }));
+    EXPECT_EQ(client->recv(buffer.data(), buffer.size()), 4);
+    EXPECT_EQ(std::string(buffer.data(), 4), "pong");
+
+    client->close();
+    ASSERT_TRUE(wait_for([&]() {
+        return server->getState() == network::ConnectionState::CLOSED;
+    }));
+}
+
+TEST(tcp, HighWaterMark) {
+    network::Network network(std::make_unique<NoRequests>());
+    std::atomic<u64id_t> serverSide = 0;
+    std::atomic<bool> connected = false;
+    // bind any free port
+    auto serverId = network.openServer(0, [&](u64id_t id) { serverSide = id; });
+    int port = network.getServer(serverId)->getPort();
+    ASSERT_NE(port, 0);
+    u64id_t clientSide = network.connect("127.0.0.1", port, [&](u64id_t) {
+        connected = true;
+    });
+    ASSERT_TRUE(wait_for([&]() { return connected && serverSide; }));
+
+    auto client = network.getConnection(clientSide);
+    auto server = network.getConnection(serverSide);
+    const size_t highWaterMark = 64 * 1024;
+    server->setHighWaterMark(highWaterMark);
+
+    std::vector<char> data(4 * 1024 * 1024);
+    for (size_t i = 0; i < data.size(); i++) {
+        data[i] = static_cast<char>(i * 7);
+    }
+    client->send(data.data(), data.size());
+    ASSERT_TRUE(wait_for([&]() {
+        return server->available() >= highWaterMark;
+    }));
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    // rest of data is kept in socket buffers
+    EXPECT_LT(server->available(), highWaterMark + 64 * 1024);
+
+    std::vector<char> received;
+    std::vector<char> buffer(16'384);
+    ASSERT_TRUE(wait_for([&]() {
+        int size = server->recv(buffer.data(), buffer.size());
+        if (size > 0) {
+            received.insert(received.end(), buffer.data(), buffer.data() + size);
+        }
+        return received.size() >= data.size();
+    }));
+    EXPECT_TRUE(received == data);
+}
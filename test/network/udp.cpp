@@ -0,0 +1,59 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <thread>
+
+#include "network/Network.hpp"
+
+TEST(udp, Loopback) {
+    network::Network network(nullptr);
+    auto server = network.getUdpSocket(network.bind(0));
+    auto client = network.getUdpSocket(network.bind(0));
+    ASSERT_NE(server, nullptr);
+    ASSERT_NE(client, nullptr);
+    ASSERT_NE(server->getPort(), 0);
+
+    const int count = 100;
+    for (int i = 0; i < count; i++) {
+        std::string message = "datagram " + std::to_string(i);
+        EXPECT_EQ(
+            client->sendTo(
+                "127.0.0.1", server->getPort(), message.data(), message.size()
+            ),
+            message.size()
+        );
+    }
+    std::vector<network::Datagram> datagrams;
+    std::vector<std::string> received;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (received.size() < count &&
+           std::chrono::steady_clock::now() < deadline) {
+        // small batches to check datagrams list reuse
+        size_t size = server->recvFrom(datagrams, 7);
+        ASSERT_LE(size, 7);
+        for (size_t i = 0; i < size; i++) {
+            const auto& datagram = datagrams[i];
+            EXPECT_EQ(datagram.address, "127.0.0.1");
+            EXPECT_EQ(datagram.port, client->getPort());
+            received.emplace_back(datagram.data.begin(), datagram.data.end());
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    ASSERT_EQ(received.size(), count);
+    for (int i = 0; i < count; i++) {
+        EXPECT_EQ(received[i], "datagram " + std::to_string(i));
+    }
+    EXPECT_EQ(server->recvFrom(datagrams, count), 0);
+
+    size_t expected = 0;
+    for (const auto& message : received) {
+        expected += message.size();
+    }
+    EXPECT_EQ(client->pullUpload(), expected);
+    EXPECT_EQ(server->pullDownload(), expected);
+    EXPECT_EQ(server->pullDownload(), 0);
+
+    server->close();
+    EXPECT_FALSE(server->isOpen());
+    EXPECT_EQ(server->recvFrom(datagrams, count), 0);
+}
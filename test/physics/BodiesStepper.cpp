@@ -0,0 +1,229 @@
+#include <gtest/gtest.h>
+
+#include <random>
+
+#include "content/Content.hpp"
+#include "content/ContentPack.hpp"
+#include "items/ItemDef.hpp"
+#include "objects/EntityDef.hpp"
+#include "objects/rigging.hpp"
+#include "physics/BodiesStepper.hpp"
+#include "physics/Hitbox.hpp"
+#include "physics/PhysicsSolver.hpp"
+#include "settings.hpp"
+#include "voxels/Block.hpp"
+#include "voxels/Chunk.hpp"
+#include "voxels/GlobalChunks.hpp"
+#include "world/Level.hpp"
+#include "world/World.hpp"
+#include "world/generator/GeneratorDef.hpp"
+#include "world/generator/VoxelFragment.hpp"
+
+inline constexpr float TICK = 1.0f / 20.0f;
+
+class BodiesStepperTest : public testing::Test {
+protected:
+    std::unique_ptr<Content> content;
+    EngineSettings settings;
+    std::unique_ptr<Level> level;
+
+    void SetUp() override {
+        UptrsMap<std::string, Block> blocks;
+        std::vector<Block*> defs;
+        for (const auto& name : {"core:air", "test:stone"}) {
+            auto block = std::make_unique<Block>(name);
+            block->rt.id = defs.size();
+            block->obstacle = !defs.empty();
+            block->replaceable = defs.empty();
+            defs.push_back(block.get());
+            blocks[name] = std::move(block);
+        }
+        ResourceIndicesSet resourceIndices {};
+        content = std::make_unique<Content>(
+            std::make_unique<ContentIndices>(
+                ContentUnitIndices<Block>(defs),
+                ContentUnitIndices<ItemDef>({}),
+                ContentUnitIndices<EntityDef>({})
+            ),
+            std::make_unique<DrawGroups>(),
+            ContentUnitDefs<Block>(std::move(blocks)),
+            ContentUnitDefs<ItemDef>({}),
+            ContentUnitDefs<EntityDef>({}),
+            ContentUnitDefs<GeneratorDef>({}),
+            UptrsMap<std::string, ContentPackRuntime>(),
+            UptrsMap<std::string, BlockMaterial>(),
+            UptrsMap<std::string, rigging::SkeletonConfig>(),
+            resourceIndices,
+            nullptr
+        );
+        level = std::make_unique<Level>(
+            std::make_unique<World>(
+                WorldInfo {}, nullptr, *content, std::vector<ContentPack> {}
+            ),
+            *content,
+            settings
+        );
+        // uneven ground with pillars in chunks -2..1
+        std::mt19937 random(42);
+        for (int cz = -2; cz < 2; cz++) {
+            for (int cx = -2; cx < 2; cx++) {
+                auto chunk = std::make_shared<Chunk>(cx, cz);
+                for (uint z = 0; z < CHUNK_D; z++) {
+                    for (uint x = 0; x < CHUNK_W; x++) {
+                        uint height = 8 + random() % 3;
+                        if (random() % 40 == 0) {
+                            height += 4;
+                        }
+                        for (uint y = 0; y < height; y++) {
+                            chunk->voxels.ref(vox_index(x, y, z)).id = 1;
+                        }
+                    }
+                }
+                chunk->updateHeights();
+                level->chunks->putChunk(std::move(chunk));
+            }
+        }
+    }
+
+    /// @brief Create falling bodies scattered over the ground
+    static std::vector<Hitbox> createBodies(size_t count) {
+        std::mt19937 random(7);
+        std::uniform_real_distribution<float> coord(-24.0f, 24.0f);
+        std::uniform_real_distribution<float> height(12.0f, 30.0f);
+        std::uniform_real_distribution<float> speed(-6.0f, 6.0f);
+        std::uniform_real_distribution<float> size(0.2f, 0.9f);
+        std::vector<Hitbox> bodies;
+        for (size_t i = 0; i < count; i++) {
+            auto& hitbox = bodies.emplace_back(
+                BodyType::DYNAMIC,
+                glm::vec3(coord(random), height(random), coord(random)),
+                glm::vec3(size(random), size(random), size(random))
+            );
+            hitbox.velocity = glm::vec3(speed(random), 0.0f, speed(random));
+        }
+        return bodies;
+    }
+
+    /// @param ticks number of ticks to step bodies for
+    void step(
+        BodiesStepper& stepper,
+        std::vector<Hitbox>& bodies,
+        const std::vector<glm::vec3>& viewers,
+        int lodDistance,
+        int ticks
+    ) {
+        for (int tick = 0; tick < ticks; tick++) {
+            stepper.begin(TICK, viewers, lodDistance);
+            for (size_t i = 0; i < bodies.size(); i++) {
+                stepper.add(bodies[i], i + 1, false);
+            }
+            stepper.step();
+        }
+    }
+};
+
+TEST_F(BodiesStepperTest, ParallelMatchesSerial) {
+    const std::vector<glm::vec3> viewers {{0.0f, 10.0f, 0.0f}};
+    auto serial = createBodies(500);
+    auto parallel = serial;
+
+    BodiesStepper serialStepper(*level->physics, *level->chunks, 1);
+    BodiesStepper parallelStepper(*level->physics, *level->chunks, 4);
+    step(serialStepper, serial, viewers, 16, 100);
+    step(parallelStepper, parallel, viewers, 16, 100);
+
+    size_t grounded = 0;
+    for (size_t i = 0; i < serial.size(); i++) {
+        grounded += serial[i].grounded;
+        EXPECT_EQ(serial[i].position, parallel[i].position) << "body " << i;
+        EXPECT_EQ(serial[i].velocity, parallel[i].velocity) << "body " << i;
+        EXPECT_EQ(serial[i].grounded, parallel[i].grounded) << "body " << i;
+        EXPECT_EQ(serial[i].sleeping, parallel[i].sleeping) << "body " << i;
+    }
+    // the scene must actually collide
+    EXPECT_GT(grounded, 0);
+}
+
+TEST_F(BodiesStepperTest, SleepAndWakeUp) {
+    const std::vector<glm::vec3> viewers {{0.0f, 10.0f, 0.0f}};
+    std::vector<Hitbox> bodies;
+    bodies.emplace_back(
+        BodyType::DYNAMIC, glm::vec3(0.5f, 20.0f, 0.5f), glm::vec3(0.25f)
+    );
+    auto& hitbox = bodies[0];
+
+    BodiesStepper stepper(*level->physics, *level->chunks, 1);
+    step(stepper, bodies, viewers, 16, 100);
+    ASSERT_TRUE(hitbox.grounded);
+    ASSERT_TRUE(hitbox.sleeping);
+
+    // sleeping body is not stepped
+    auto position = hitbox.position;
+    step(stepper, bodies, viewers, 16, 1);
+    EXPECT_EQ(stepper.getBodies()[0].delta, 0.0f);
+    EXPECT_EQ(hitbox.position, position);
+
+    // blocks modified far from the body do not wake it up
+    level->chunks->getChunk(1, 1)->setModifiedAndUnsaved();
+    step(stepper, bodies, viewers, 16, 1);
+    EXPECT_TRUE(hitbox.sleeping);
+
+    // remove the block the body is resting on
+    auto chunk = level->chunks->getChunk(0, 0);
+    int y = static_cast<int>(std::floor(hitbox.getAABB().min().y)) - 1;
+    ASSERT_EQ(chunk->voxels.get(vox_index(0, y, 0)).id, 1);
+    chunk->voxels.ref(vox_index(0, y, 0)).id = 0;
+    chunk->setModifiedAndUnsaved();
+    step(stepper, bodies, viewers, 16, 1);
+    EXPECT_FALSE(hitbox.sleeping);
+    EXPECT_GT(stepper.getBodies()[0].delta, 0.0f);
+
+    step(stepper, bodies, viewers, 16, 20);
+    EXPECT_LT(hitbox.position.y, position.y);
+}
+
+TEST_F(BodiesStepperTest, DistantBodiesStaggered) {
+    const int lodDistance = 4;
+    // the viewer is far enough for the max step interval
+    const std::vector<glm::vec3> viewers {{1000.0f, 10.0f, 0.0f}};
+    std::vector<Hitbox> bodies;
+    for (int i = 0; i < 16; i++) {
+        bodies.emplace_back(
+            BodyType::DYNAMIC,
+            glm::vec3(i - 8.0f, 100.0f, 0.5f),
+            glm::vec3(0.25f)
+        );
+    }
+    BodiesStepper stepper(*level->physics, *level->chunks, 1);
+    // first steps happen before the full interval passes
+    step(stepper, bodies, viewers, lodDistance, 8);
+
+    std::vector<int> steps(bodies.size());
+    for (int tick = 0; tick < 16; tick++) {
+        step(stepper, bodies, viewers, lodDistance, 1);
+        size_t stepped = 0;
+        const auto& added = stepper.getBodies();
+        for (size_t i = 0; i < added.size(); i++) {
+            if (added[i].delta > 0.0f) {
+                // skipped time is stepped at once
+                EXPECT_FLOAT_EQ(added[i].delta, TICK * 8);
+                steps[i]++;
+                stepped++;
+            }
+        }
+        // steps of distant bodies are spread over ticks
+        EXPECT_EQ(stepped, bodies.size() / 8) << "tick " << tick;
+    }
+    for (size_t i = 0; i < bodies.size(); i++) {
+        EXPECT_EQ(steps[i], 2) << "body " << i;
+    }
+
+    // bodies near the viewer are stepped every tick
+    const std::vector<glm::vec3> near {bodies[8].position};
+    for (int tick = 0; tick < 2; tick++) {
+        step(stepper, bodies, near, 64, 1);
+        for (const auto& body : stepper.getBodies()) {
+            EXPECT_GT(body.delta, 0.0f);
+        }
+    }
+}
@@ -0,0 +1,53 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <random>
+
+#include "physics/SpatialHash.hpp"
+
+static std::vector<int> query(const SpatialHash<int>& grid, const AABB& aabb) {
+    std::vector<int> found;
+    grid.query(aabb, [&](int value) { found.push_back(value); });
+    std::sort(found.begin(), found.end());
+    found.erase(std::unique(found.begin(), found.end()), found.end());
+    return found;
+}
+
+TEST(SpatialHash, MatchesBruteForce) {
+    SpatialHash<int> grid(8.0f);
+    std::vector<glm::vec3> points;
+    std::mt19937 random(42);
+    std::uniform_real_distribution<float> coord(-100.0f, 100.0f);
+    for (int i = 0; i < 1000; i++) {
+        points.emplace_back(coord(random), coord(random), coord(random));
+        grid.insert(grid.cellOf(points.back()), i);
+    }
+    // move some points to other cells
+    for (int i = 0; i < 1000; i += 3) {
+        EXPECT_TRUE(grid.remove(grid.cellOf(points[i]), i));
+        points[i] = glm::vec3(coord(random), coord(random), coord(random));
+        grid.insert(grid.cellOf(points[i]), i);
+    }
+    const AABB boxes[] {
+        AABB({-10, -10, -10}, {10, 10, 10}),
+        AABB({-95, 0, 30}, {-40, 5, 31}),
+        // larger than occupied area
+        AABB({-1e6f, -1e6f, -1e6f}, {1e6f, 1e6f, 1e6f}),
+    };
+    for (const auto& box : boxes) {
+        auto found = query(grid, box);
+        for (int i = 0; i < points.size(); i++) {
+            if (box.contains(points[i])) {
+                EXPECT_TRUE(std::binary_search(found.begin(), found.end(), i));
+            }
+        }
+    }
+}
+
+TEST(SpatialHash, InsertBox) {
+    SpatialHash<int> grid(8.0f);
+    grid.insert(AABB({0, 0, 0}, {20, 1, 4}), 1);
+    EXPECT_EQ(query(grid, AABB({17, 0, 1}, {18, 1, 2})), std::vector<int> {1});
+    EXPECT_TRUE(query(grid, AABB({-5, 0, 0}, {-1, 1, 4})).empty());
+    EXPECT_FALSE(grid.remove({5, 5}, 1));
+}
@@ -0,0 +1,74 @@
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <numeric>
+#include <string>
+#include <vector>
+
+#include "util/RingBuffer.hpp"
+
+using namespace util;
+
+TEST(RingBuffer, PutGet) {
+    RingBuffer<char> buffer(8);
+    buffer.put("abcdef", 6);
+    char dst[8] {};
+    EXPECT_EQ(buffer.get(dst, 4), 4);
+    EXPECT_EQ(std::string(dst, 4), "abcd");
+
+    // wraps around the buffer end
+    buffer.put("ghijk", 5);
+    EXPECT_EQ(buffer.capacity(), 8);
+    EXPECT_EQ(buffer.size(), 7);
+    EXPECT_EQ(buffer.get(dst, 8), 7);
+    EXPECT_EQ(std::string(dst, 7), "efghijk");
+    EXPECT_TRUE(buffer.empty());
+    EXPECT_EQ(buffer.get(dst, 8), 0);
+}
+
+TEST(RingBuffer, Grow) {
+    RingBuffer<int> buffer(4);
+    std::vector<int> source(100);
+    std::iota(source.begin(), source.end(), 0);
+
+    buffer.put(source.data(), 3);
+    buffer.skip(2);
+    buffer.put(source.data() + 3, 97);
+    EXPECT_GE(buffer.capacity(), 98);
+
+    std::vector<int> result(98);
+    EXPECT_EQ(buffer.peek(result.data(), result.size()), 98);
+    EXPECT_EQ(buffer.size(), 98);
+    EXPECT_TRUE(std::equal(result.begin(), result.end(), source.begin() + 2));
+}
+
+TEST(RingBuffer, PrepareCommit) {
+    RingBuffer<char> buffer(8);
+    buffer.put("abcdef", 6);
+    buffer.skip(4);
+
+    // free space is split by the buffer end, so elements get moved
+    auto free = buffer.prepare(5);
+    ASSERT_GE(free.size(), 5);
+    std::memcpy(free.data(), "ghijk", 5);
+    buffer.commit(5);
+
+    char dst[8];
+    EXPECT_EQ(buffer.get(dst, 8), 7);
+    EXPECT_EQ(std::string(dst, 7), "efghijk");
+}
+
+TEST(RingBuffer, Front) {
+    RingBuffer<char> buffer(8);
+    EXPECT_TRUE(buffer.front().empty());
+    buffer.put("abcdef", 6);
+    buffer.skip(4);
+    buffer.put("ghij", 4);
+
+    // elements are wrapped around the buffer end
+    auto front = buffer.front();
+    EXPECT_EQ(std::string(front.data(), front.size()), "efgh");
+    buffer.skip(front.size());
+    front = buffer.front();
+    EXPECT_EQ(std::string(front.data(), front.size()), "ij");
+}
@@ -0,0 +1,54 @@
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+
+#include "util/ThreadPool.hpp"
+
+using namespace util;
+
+class IncrementWorker : public Worker<int*, int> {
+public:
+    int operator()(int* const& value) override {
+        (*value)++;
+        if (*value < 0) {
+            throw std::runtime_error("job failed");
+        }
+        return *value;
+    }
+};
+
+TEST(ThreadPool, WaitForJobs) {
+    int sum = 0;
+    ThreadPool<int*, int> pool(
+        "test-pool",
+        []() { return std::make_shared<IncrementWorker>(); },
+        [&sum](int& value) { sum += value; },
+        4
+    );
+    std::vector<int> values(1000);
+    for (int pass = 0; pass < 3; pass++) {
+        for (auto& value : values) {
+            pool.enqueueJob(&value);
+        }
+        pool.waitForJobs();
+    }
+    for (int value : values) {
+        EXPECT_EQ(value, 3);
+    }
+    EXPECT_EQ(sum, 6 * values.size());
+}
+
+TEST(ThreadPool, WaitForFailedJobs) {
+    ThreadPool<int*, int> pool(
+        "test-pool",
+        []() { return std::make_shared<IncrementWorker>(); },
+        [](int&) {},
+        3
+    );
+    std::vector<int> values(100);
+    values[50] = -10;
+    for (auto& value : values) {
+        pool.enqueueJob(&value);
+    }
+    EXPECT_THROW(pool.waitForJobs(), std::runtime_error);
+}
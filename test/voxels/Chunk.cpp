@@ -5,10 +5,11 @@
 TEST(Chunk, EncodeDecode) {
     Chunk chunk1(0, 0);
     for (uint i = 0; i < CHUNK_VOL; i++) {
-        chunk1.voxels[i].id = rand();
-        chunk1.voxels[i].state.rotation = rand();
-        chunk1.voxels[i].state.segment = rand();
-        chunk1.voxels[i].state.userbits = rand();
+        voxel& vox = chunk1.voxels.ref(i);
+        vox.id = rand();
+        vox.state.rotation = rand();
+        vox.state.segment = rand();
+        vox.state.userbits = rand();
     }
     auto bytes = chunk1.encode();
 
@@ -16,10 +17,55 @@ TEST(Chunk, EncodeDecode) {
     chunk2.decode(bytes.get());
 
     for (uint i = 0; i < CHUNK_VOL; i++) {
-        EXPECT_EQ(chunk1.voxels[i].id, chunk2.voxels[i].id);
+        EXPECT_EQ(chunk1.voxels.get(i).id, chunk2.voxels.get(i).id);
         EXPECT_EQ(
-            blockstate2int(chunk1.voxels[i].state), 
-            blockstate2int(chunk2.voxels[i].state)
+            blockstate2int(chunk1.voxels.get(i).state), 
+            blockstate2int(chunk2.voxels.get(i).state)
         );
     }
 }
+
+TEST(Chunk, UpdateHeights) {
+    Chunk chunk(0, 0);
+    chunk.voxels.ref(vox_index(3, 20, 4)).id = 1;
+    chunk.voxels.ref(vox_index(5, 70, 6)).id = 2;
+    chunk.updateHeights();
+    EXPECT_EQ(chunk.bottom, 20);
+    EXPECT_EQ(chunk.top, 71);
+    EXPECT_EQ(chunk.occupancy, (1 << 1) | (1 << 4));
+    EXPECT_TRUE(chunk.isSectionOccupied(4));
+    EXPECT_FALSE(chunk.isSectionOccupied(2));
+
+    chunk.voxels.ref(vox_index(5, 70, 6)).id = BLOCK_AIR;
+    chunk.updateHeights();
+    EXPECT_EQ(chunk.top, 21);
+    EXPECT_EQ(chunk.occupancy, 1 << 1);
+}
+
+TEST(Chunk, CompactIdle) {
+    Chunk chunk(0, 0);
+    chunk.voxels.set(vox_index(1, 2, 3), {1, {}});
+    chunk.setModifiedAndUnsaved();
+    ChunkVoxels packed;
+    packed.set(vox_index(1, 2, 3), {1, {}});
+    packed.compact();
+    EXPECT_GT(chunk.voxels.getMemoryUsage(), packed.getMemoryUsage());
+
+    uint64_t tick = 0;
+    for (; tick < 10; tick++) {
+        EXPECT_FALSE(chunk.compactIdle(tick, 10));
+    }
+    // modification restarts idle ticks count
+    chunk.voxels.set(vox_index(1, 3, 3), {1, {}});
+    chunk.setModifiedAndUnsaved();
+    packed.set(vox_index(1, 3, 3), {1, {}});
+    packed.compact();
+    uint64_t modified = tick;
+    for (; tick < modified + 10; tick++) {
+        EXPECT_FALSE(chunk.compactIdle(tick, 10));
+    }
+    EXPECT_TRUE(chunk.compactIdle(tick++, 10));
+    EXPECT_TRUE(chunk.voxels.isCompact());
+    EXPECT_EQ(chunk.voxels.getMemoryUsage(), packed.getMemoryUsage());
+    EXPECT_FALSE(chunk.compactIdle(tick++, 10));
+}
@@ -0,0 +1,87 @@
+#include <gtest/gtest.h>
+
+#include "coders/byte_utils.hpp"
+#include "voxels/Chunk.hpp"
+
+static void set_voxel(Chunk& chunk, uint index, blockid_t id, uint8_t bits) {
+    voxel& vox = chunk.voxels.ref(index);
+    vox.id = id;
+    vox.state.userbits = bits;
+    chunk.recordDelta(index);
+}
+
+TEST(ChunkDeltas, PullApply) {
+    Chunk source(0, 0);
+    Chunk target(0, 0);
+    source.deltas = std::make_unique<ChunkDeltas>();
+
+    ByteBuilder builder;
+    // the history is incomplete until the first pull
+    set_voxel(source, 10, 1, 0);
+    EXPECT_FALSE(source.deltas->pull(builder));
+    EXPECT_EQ(builder.size(), 0);
+    target.voxels.set(10, source.voxels.get(10));
+
+    set_voxel(source, vox_index(15, 255, 15), 3, 7);
+    set_voxel(source, vox_index(1, 2, 3), 2, 0);
+    set_voxel(source, 10, 5, 1);
+    set_voxel(source, 10, 6, 2);
+    EXPECT_EQ(source.deltas->size(), 4);
+    ASSERT_TRUE(source.deltas->pull(builder));
+    EXPECT_EQ(source.deltas->size(), 0);
+
+    auto changes = ChunkDeltas::decode(builder.data(), builder.size());
+    EXPECT_EQ(changes.size(), 3);
+    for (const auto& [index, vox] : changes) {
+        target.voxels.set(index, vox);
+    }
+    for (uint i = 0; i < CHUNK_VOL; i++) {
+        ASSERT_EQ(source.voxels.get(i).id, target.voxels.get(i).id);
+        ASSERT_EQ(
+            blockstate2int(source.voxels.get(i).state),
+            blockstate2int(target.voxels.get(i).state)
+        );
+    }
+}
+
+TEST(ChunkDeltas, Overflow) {
+    Chunk chunk(0, 0);
+    chunk.deltas = std::make_unique<ChunkDeltas>();
+    ByteBuilder builder;
+    chunk.deltas->pull(builder);
+
+    for (uint i = 0; i <= ChunkDeltas::MAX_CHANGES; i++) {
+        set_voxel(chunk, i, 1, 0);
+    }
+    EXPECT_FALSE(chunk.deltas->pull(builder));
+    // new history is started by the failed pull
+    set_voxel(chunk, 0, 2, 0);
+    EXPECT_TRUE(chunk.deltas->pull(builder));
+}
+
+TEST(ChunkDeltas, Corrupted) {
+    ByteBuilder builder;
+    builder.putVarUInt32(1);
+    builder.putVarUInt32(CHUNK_VOL);
+    builder.putVarUInt32(0);
+    builder.putVarUInt32(0);
+    EXPECT_THROW(
+        ChunkDeltas::decode(builder.data(), builder.size()),
+        std::runtime_error
+    );
+
+    Chunk chunk(0, 0);
+    chunk.deltas = std::make_unique<ChunkDeltas>();
+    ByteBuilder deltas;
+    chunk.deltas->pull(deltas);
+    for (uint i = 0; i < 10; i++) {
+        set_voxel(chunk, i * 100, 1, 0);
+    }
+    ASSERT_TRUE(chunk.deltas->pull(deltas));
+    // truncated data
+    EXPECT_THROW(
+        ChunkDeltas::decode(deltas.data(), deltas.size() - 1),
+        std::runtime_error
+    );
+    EXPECT_EQ(ChunkDeltas::decode(deltas.data(), deltas.size()).size(), 10);
+}
@@ -0,0 +1,52 @@
+#include <gtest/gtest.h>
+
+#include "content/Content.hpp"
+#include "voxels/Block.hpp"
+#include "voxels/Chunk.hpp"
+#include "voxels/Chunks.hpp"
+#include "voxels/ChunkSnapshot.hpp"
+
+TEST(ChunkSnapshot, CopiesChunkAndBorders) {
+    std::vector<std::unique_ptr<Block>> blocks;
+    blocks.emplace_back(std::make_unique<Block>("core:air"));
+    blocks.emplace_back(std::make_unique<Block>("test:stone"));
+    std::vector<Block*> defs {blocks[0].get(), blocks[1].get()};
+    ContentIndices indices(
+        ContentUnitIndices<Block>(defs),
+        ContentUnitIndices<ItemDef>({}),
+        ContentUnitIndices<EntityDef>({})
+    );
+    Chunks chunks(3, 3, 0, 0, nullptr, indices);
+    int ox = chunks.getOffsetX();
+    int oz = chunks.getOffsetY();
+    for (int cz = 0; cz < 3; cz++) {
+        for (int cx = 0; cx < 3; cx++) {
+            auto chunk = std::make_shared<Chunk>(ox + cx, oz + cz);
+            for (int x = 0; x < CHUNK_W; x++) {
+                for (int z = 0; z < CHUNK_D; z++) {
+                    chunk->voxels.ref(vox_index(x, 10 + cx, z)).id = 1;
+                }
+            }
+            chunk->updateHeights();
+            chunks.putChunk(chunk);
+        }
+    }
+    auto& chunk = *chunks.getChunk(ox + 1, oz + 1);
+    auto snapshot = chunks.createSnapshot(chunk, 2);
+    const auto& volume = snapshot->volume;
+    EXPECT_EQ(snapshot->bottom, 11);
+    EXPECT_EQ(snapshot->top, 12);
+    EXPECT_EQ(volume.getY(), 9);
+    EXPECT_EQ(volume.getH(), 5);
+
+    chunk.voxels.ref(vox_index(0, 11, 0)).id = 0;
+    EXPECT_EQ(snapshot->getVoxel(0, 11, 0).id, 1);
+
+    int gx = chunk.x * CHUNK_W;
+    int gz = chunk.z * CHUNK_D;
+    // border slabs of the neighbours
+    EXPECT_EQ(volume.pickBlockId(gx - 1, 10, gz), 1);
+    EXPECT_EQ(volume.pickBlockId(gx - 1, 11, gz), 0);
+    EXPECT_EQ(volume.pickBlockId(gx + CHUNK_W + 1, 12, gz), 1);
+    EXPECT_EQ(volume.pickBlockId(gx + CHUNK_W + 2, 12, gz), BLOCK_VOID);
+}
@@ -0,0 +1,108 @@
+#include <gtest/gtest.h>
+
+#include "voxels/ChunkVoxels.hpp"
+
+static voxel make_voxel(uint value) {
+    return {static_cast<blockid_t>(value), int2blockstate(value >> 3)};
+}
+
+static void expect_equal(const voxel& a, const voxel& b) {
+    EXPECT_EQ(a.id, b.id);
+    EXPECT_EQ(blockstate2int(a.state), blockstate2int(b.state));
+}
+
+TEST(ChunkVoxels, Uniform) {
+    ChunkVoxels voxels;
+    for (uint y = 0; y < CHUNK_SECTIONS; y++) {
+        EXPECT_TRUE(voxels.isUniform(y));
+    }
+    EXPECT_EQ(voxels.get(CHUNK_VOL - 1).id, BLOCK_AIR);
+    EXPECT_LT(voxels.getMemoryUsage(), 2048);
+
+    voxels.set(vox_index(1, 20, 3), {5, {}});
+    EXPECT_FALSE(voxels.isUniform(1));
+    EXPECT_EQ(voxels.get(vox_index(1, 20, 3)).id, 5);
+
+    voxels.set(vox_index(1, 20, 3), {BLOCK_AIR, {}});
+    voxels.compact();
+    EXPECT_TRUE(voxels.isUniform(1));
+    EXPECT_EQ(voxels.get(vox_index(1, 20, 3)).id, BLOCK_AIR);
+}
+
+TEST(ChunkVoxels, Palette) {
+    // distinct voxels count per section covering all index widths and
+    // the plain array fallback
+    const uint counts[] {1, 2, 3, 4, 5, 16, 17, 200, 256, 257, 4096};
+    std::vector<voxel> source(CHUNK_VOL);
+    for (uint y = 0; y < CHUNK_SECTIONS; y++) {
+        uint count = counts[y % std::size(counts)];
+        for (uint i = 0; i < CHUNK_SECTION_VOL; i++) {
+            source[y * CHUNK_SECTION_VOL + i] =
+                make_voxel((i * 7 + y) % count + y);
+        }
+    }
+    ChunkVoxels voxels;
+    voxels.setAll(source.data());
+    EXPECT_TRUE(voxels.isUniform(0));
+    EXPECT_FALSE(voxels.isUniform(1));
+    for (uint i = 0; i < CHUNK_VOL; i++) {
+        expect_equal(voxels.get(i), source[i]);
+    }
+    std::vector<voxel> copy(CHUNK_VOL);
+    voxels.getAll(copy.data());
+    for (uint i = 0; i < CHUNK_VOL; i++) {
+        expect_equal(copy[i], source[i]);
+    }
+
+    for (uint i = 0; i < CHUNK_VOL; i += 97) {
+        source[i] = make_voxel(i);
+        voxels.set(i, source[i]);
+    }
+    voxels.compact();
+    for (uint i = 0; i < CHUNK_VOL; i++) {
+        expect_equal(voxels.get(i), source[i]);
+    }
+}
+
+TEST(ChunkVoxels, MemoryUsage) {
+    ChunkVoxels voxels;
+    for (uint i = 0; i < CHUNK_VOL / 4; i++) {
+        voxels.set(i, make_voxel(1 + i % 3));
+    }
+    EXPECT_GE(voxels.getMemoryUsage(), CHUNK_VOL / 4 * sizeof(voxel));
+    voxels.compact();
+    // 2 bits per voxel of 4 sections
+    EXPECT_LT(voxels.getMemoryUsage(), CHUNK_SECTION_VOL * 2);
+}
+
+TEST(ChunkVoxels, StableReferences) {
+    ChunkVoxels voxels;
+    voxels.set(0, {1, {}});
+    voxels.set(1, {2, {}});
+    voxels.compact();
+
+    const voxel& paletted = voxels.get(0);
+    const voxel& uniform = voxels.get(CHUNK_VOL - 1);
+    voxels.set(0, {3, {}});
+    voxels.set(CHUNK_VOL - 1, {4, {}});
+    // references are not invalidated by modifications
+    EXPECT_EQ(paletted.id, 1);
+    EXPECT_EQ(uniform.id, BLOCK_AIR);
+    EXPECT_EQ(voxels.get(0).id, 3);
+    EXPECT_EQ(voxels.get(CHUNK_VOL - 1).id, 4);
+}
+
+TEST(ChunkVoxels, SectionQueries) {
+    ChunkVoxels voxels;
+    voxels.set(vox_index(0, 40, 0), {7, {}});
+    voxels.set(vox_index(0, 41, 0), {3, {}});
+    EXPECT_FALSE(voxels.isEmpty(2));
+    EXPECT_EQ(voxels.getMaxId(2), 7);
+    EXPECT_TRUE(voxels.getPalette(2).empty());
+
+    voxels.compact();
+    EXPECT_EQ(voxels.getPalette(2).size(), 3);
+    EXPECT_EQ(voxels.getMaxId(2), 7);
+    EXPECT_TRUE(voxels.isEmpty(3));
+    EXPECT_EQ(voxels.getPalette(3).size(), 1);
+}
@@ -0,0 +1,363 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstring>
+#include <filesystem>
+#include <thread>
+#include <vector>
+
+#include "io/io.hpp"
+#include "io/devices/StdfsDevice.hpp"
+#include "world/files/WorldRegions.hpp"
+
+/// @brief Provides "regtest" device in a temporary directory removed
+/// after the test
+class RegionsLayerTest : public testing::Test {
+protected:
+    std::filesystem::path root;
+
+    void SetUp() override {
+        root = std::filesystem::temp_directory_path() /
+               (std::string("vctest_regions_") +
+                testing::UnitTest::GetInstance()->current_test_info()->name());
+        std::filesystem::remove_all(root);
+        io::set_device("regtest", std::make_shared<io::StdfsDevice>(root));
+    }
+
+    void TearDown() override {
+        io::remove_device("regtest");
+        std::filesystem::remove_all(root);
+    }
+};
+
+static std::unique_ptr<ubyte[]> make_data(uint32_t size, ubyte value) {
+    auto data = std::make_unique<ubyte[]>(size);
+    std::memset(data.get(), value, size);
+    return data;
+}
+
+TEST_F(RegionsLayerTest, EvictLeastRecentlyUsed) {
+    RegionsLayer layer {};
+    layer.folder = "regtest:regions";
+
+    const uint32_t size = 64 * 1024;
+    layer.put(0, 0, make_data(size, 1), size, size);
+    size_t regionUsage = layer.getCacheStats().memoryUsage;
+    layer.cacheBudget = regionUsage * 2;
+
+    layer.put(REGION_SIZE, 0, make_data(size, 2), size, size);
+    EXPECT_EQ(layer.getCacheStats().evictions, 0);
+
+    // region 0_0 is least recently used, so must be written and evicted
+    layer.put(REGION_SIZE * 2, 0, make_data(size, 3), size, size);
+    // evicted region is written by the writer thread
+    layer.writeAll();
+    auto stats = layer.getCacheStats();
+    EXPECT_EQ(stats.evictions, 1);
+    EXPECT_EQ(stats.regions, 2);
+    EXPECT_EQ(layer.getRegion(0, 0), nullptr);
+    EXPECT_TRUE(io::exists(layer.getRegionFilePath(0, 0)));
+
+    uint32_t readSize, srcSize;
+    auto data = layer.getData(0, 0, readSize, srcSize);
+    ASSERT_NE(data, nullptr);
+    EXPECT_EQ(readSize, size);
+    EXPECT_EQ(data[size - 1], 1);
+
+    stats = layer.getCacheStats();
+    EXPECT_EQ(stats.misses, 1);
+    EXPECT_LE(stats.memoryUsage, layer.cacheBudget);
+
+    data = layer.getData(0, 0, readSize, srcSize);
+    ASSERT_NE(data, nullptr);
+    EXPECT_EQ(layer.getCacheStats().hits, 1);
+}
+
+TEST_F(RegionsLayerTest, ReadWhileEvicting) {
+    RegionsLayer layer {};
+    layer.folder = "regtest:regions";
+
+    const uint32_t size = 64 * 1024;
+    const int regionsCount = 32;
+    layer.put(0, 0, make_data(size, 0), size, size);
+    layer.cacheBudget = layer.getCacheStats().memoryUsage * 2;
+
+    // evicted regions must stay readable while pending or being written
+    std::atomic<int> written = 1;
+    std::atomic<int> failures = 0;
+    std::thread reader([&]() {
+        for (int i = 0; written < regionsCount; i++) {
+            int index = i % written;
+            uint32_t readSize, srcSize;
+            auto data = layer.getData(
+                index * REGION_SIZE, 0, readSize, srcSize
+            );
+            if (data == nullptr || data[size - 1] != index) {
+                failures++;
+            }
+        }
+    });
+    for (int i = 1; i < regionsCount; i++) {
+        layer.put(i * REGION_SIZE, 0, make_data(size, i), size, size);
+        written++;
+    }
+    reader.join();
+    EXPECT_EQ(failures, 0);
+    EXPECT_GT(layer.getCacheStats().evictions, 0);
+
+    layer.writeAll();
+    EXPECT_TRUE(layer.pendingWrites.empty());
+    for (int i = 0; i < regionsCount; i++) {
+        EXPECT_TRUE(io::exists(layer.getRegionFilePath(i, 0)));
+    }
+}
+
+TEST_F(RegionsLayerTest, AppendChangedChunks) {
+    RegionsLayer layer {};
+    layer.folder = "regtest:regions";
+    io::create_directories(layer.folder);
+
+    const uint32_t size = 1024;
+    for (int i = 0; i < 4; i++) {
+        layer.put(i, 0, make_data(size, i), size, size);
+    }
+    layer.writeAll();
+    auto file = layer.getRegionFilePath(0, 0);
+    size_t initialSize = io::file_size(file);
+    EXPECT_EQ(initialSize, REGION_DATA_OFFSET + 4 * (8 + size));
+
+    layer.put(1, 0, make_data(size, 10), size, size);
+    layer.put(3, 0, nullptr, 0, 0);
+    layer.writeAll();
+    EXPECT_EQ(io::file_size(file), initialSize + 8 + size);
+
+    layer.regions.clear();
+    uint32_t readSize, srcSize;
+    for (int i = 0; i < 3; i++) {
+        auto data = layer.getData(i, 0, readSize, srcSize);
+        ASSERT_NE(data, nullptr);
+        EXPECT_EQ(data[0], i == 1 ? 10 : i);
+    }
+    EXPECT_EQ(layer.getData(3, 0, readSize, srcSize), nullptr);
+    {
+        auto regfile = layer.getRegFile({0, 0});
+        ASSERT_NE(regfile, nullptr);
+        EXPECT_EQ(regfile.get()->deadSize, 2 * (8 + size));
+    }
+}
+
+TEST_F(RegionsLayerTest, InvalidChunkOffset) {
+    io::path file;
+    {
+        RegionsLayer layer {};
+        layer.folder = "regtest:regions";
+        io::create_directories(layer.folder);
+        layer.put(0, 0, make_data(1024, 1), 1024, 1024);
+        layer.writeAll();
+        file = layer.getRegionFilePath(0, 0);
+    }
+    // offset close to UINT32_MAX must not wrap around in bounds check
+    auto bytes = io::read_bytes(file);
+    ASSERT_GE(bytes.size(), REGION_DATA_OFFSET);
+    std::memset(bytes.data() + REGION_TABLE_OFFSET, 0xFF, 4);
+    bytes[REGION_TABLE_OFFSET] = 0xFC;
+    io::write_bytes(file, bytes.data(), bytes.size());
+
+    RegionsLayer layer {};
+    layer.folder = "regtest:regions";
+    uint32_t readSize, srcSize;
+    EXPECT_THROW(
+        layer.getData(0, 0, readSize, srcSize), std::runtime_error
+    );
+}
+
+TEST_F(RegionsLayerTest, ConcurrentReaders) {
+    RegionsLayer layer {};
+    layer.folder = "regtest:regions";
+    io::create_directories(layer.folder);
+
+    const uint32_t size = 4096;
+    for (int i = 0; i < REGION_SIZE; i++) {
+        layer.put(i, 0, make_data(size, i), size, size);
+    }
+    layer.writeAll();
+    layer.regions.clear();
+    {
+        // the same file may be used by multiple readers at once
+        auto first = layer.getRegFile({0, 0});
+        auto second = layer.getRegFile({0, 0});
+        ASSERT_NE(first, nullptr);
+        ASSERT_NE(second, nullptr);
+        EXPECT_EQ(first.get(), second.get());
+        EXPECT_EQ(first.get()->users, 2);
+    }
+    std::vector<std::thread> threads;
+    std::atomic<int> failures = 0;
+    for (int t = 0; t < 4; t++) {
+        threads.emplace_back([&layer, &failures]() {
+            for (int i = 0; i < REGION_SIZE; i++) {
+                auto regfile = layer.getRegFile({0, 0});
+                uint32_t srcSize;
+                auto data = regfile.get()->getChunkData(i, srcSize);
+                if (data.size() != size || data[size - 1] != i) {
+                    failures++;
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    EXPECT_EQ(failures, 0);
+}
+
+static ubyte pattern(uint32_t index, ubyte value) {
+    return (index / 16 * 31) % 7 + value;
+}
+
+static void put_compressed(
+    RegionsLayer& layer, int x, int z, uint32_t srcSize, ubyte value
+) {
+    auto source = std::make_unique<ubyte[]>(srcSize);
+    for (uint32_t i = 0; i < srcSize; i++) {
+        source[i] = pattern(i, value);
+    }
+    source[x % srcSize] = x;
+    size_t size;
+    auto data = compression::compress(
+        source.get(), srcSize, size, layer.compression, layer.getDictionary()
+    );
+    layer.put(x, z, std::move(data), size, srcSize);
+}
+
+TEST_F(RegionsLayerTest, ConvertCompression) {
+    const uint32_t size = 4096;
+    {
+        RegionsLayer layer {};
+        layer.folder = "regtest:regions";
+        layer.compression = compression::Method::EXTRLE16;
+        io::create_directories(layer.folder);
+        for (int i = 0; i < 4; i++) {
+            put_compressed(layer, i, 0, size, 7);
+        }
+        layer.writeAll();
+    }
+    RegionsLayer layer {};
+    layer.folder = "regtest:regions";
+    layer.compression = compression::Method::EXTRLE16_LZ;
+
+    uint32_t readSize, srcSize;
+    auto data = layer.getData(1, 0, readSize, srcSize);
+    ASSERT_NE(data, nullptr);
+    auto source = compression::decompress(
+        data.get(), readSize, srcSize, layer.compression
+    );
+    EXPECT_EQ(srcSize, size);
+    EXPECT_EQ(source[1], 1);
+    EXPECT_EQ(source[size - 1], pattern(size - 1, 7));
+
+    // file written with another method is rewritten on save
+    layer.writeAll();
+    layer.regions.clear();
+    {
+        auto regfile = layer.getRegFile({0, 0});
+        ASSERT_NE(regfile, nullptr);
+        EXPECT_EQ(
+            regfile.get()->compression,
+            static_cast<ubyte>(compression::Method::EXTRLE16_LZ)
+        );
+    }
+    for (int i = 0; i < 4; i++) {
+        data = layer.getData(i, 0, readSize, srcSize);
+        ASSERT_NE(data, nullptr);
+        source = compression::decompress(
+            data.get(), readSize, srcSize, layer.compression
+        );
+        EXPECT_EQ(source[i], i);
+    }
+}
+
+TEST_F(RegionsLayerTest, TrainDictionary) {
+    const uint32_t size = 4096;
+    RegionsLayer layer {};
+    layer.folder = "regtest:regions";
+    layer.dictionaryFile = "regtest:regions.dict";
+    layer.compression = compression::Method::EXTRLE16_LZ;
+    layer.initDictionary();
+    EXPECT_TRUE(layer.dictionary.empty());
+
+    io::create_directories(layer.folder);
+    for (int i = 0; i < REGION_DICTIONARY_MIN_SAMPLES; i++) {
+        put_compressed(layer, i, 0, size, i / 4);
+    }
+    layer.writeAll();
+    layer.regions.clear();
+    layer.openRegFiles.clear();
+
+    layer.initDictionary();
+    EXPECT_FALSE(layer.dictionary.empty());
+    EXPECT_TRUE(io::exists(layer.dictionaryFile));
+    EXPECT_EQ(layer.compression, compression::Method::EXTRLE16_LZ_DICT);
+
+    put_compressed(layer, REGION_SIZE, 0, size, 3);
+    uint32_t readSize, srcSize;
+    for (int x : {2, static_cast<int>(REGION_SIZE)}) {
+        auto data = layer.getData(x, 0, readSize, srcSize);
+        ASSERT_NE(data, nullptr);
+        auto source = compression::decompress(
+            data.get(),
+            readSize,
+            srcSize,
+            layer.compression,
+            layer.getDictionary()
+        );
+        EXPECT_EQ(source[x % size], x);
+    }
+}
+
+TEST_F(RegionsLayerTest, LostDictionary) {
+    const uint32_t size = 4096;
+    {
+        RegionsLayer layer {};
+        layer.folder = "regtest:regions";
+        layer.dictionaryFile = "regtest:regions.dict";
+        layer.compression = compression::Method::EXTRLE16_LZ;
+        io::create_directories(layer.folder);
+        for (int i = 0; i < REGION_DICTIONARY_MIN_SAMPLES; i++) {
+            put_compressed(layer, i, 0, size, i / 4);
+        }
+        layer.writeAll();
+        layer.regions.clear();
+        layer.openRegFiles.clear();
+        layer.initDictionary();
+        ASSERT_FALSE(layer.dictionary.empty());
+        put_compressed(layer, REGION_SIZE, 0, size, 1);
+        layer.writeAll();
+    }
+    // another dictionary can not decode chunks
+    io::path dictionaryFile = "regtest:regions.dict";
+    auto dictionary = io::read_bytes(dictionaryFile);
+    dictionary[0] ^= 0xFF;
+    io::write_bytes(dictionaryFile, dictionary.data(), dictionary.size());
+    {
+        RegionsLayer layer {};
+        layer.folder = "regtest:regions";
+        layer.dictionaryFile = "regtest:regions.dict";
+        layer.compression = compression::Method::EXTRLE16_LZ;
+        layer.initDictionary();
+        uint32_t readSize, srcSize;
+        EXPECT_THROW(
+            layer.getData(REGION_SIZE, 0, readSize, srcSize),
+            std::runtime_error
+        );
+    }
+    // world with lost dictionary fails to open
+    io::remove(dictionaryFile);
+    {
+        RegionsLayer layer {};
+        layer.folder = "regtest:regions";
+        layer.dictionaryFile = "regtest:regions.dict";
+        layer.compression = compression::Method::EXTRLE16_LZ;
+        EXPECT_THROW(layer.initDictionary(), std::runtime_error);
+    }
+}
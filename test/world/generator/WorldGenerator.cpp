@@ -0,0 +1,166 @@
+#include <gtest/gtest.h>
+
+#include <cstring>
+
+#include "content/Content.hpp"
+#include "content/ContentPack.hpp"
+#include "items/ItemDef.hpp"
+#include "objects/EntityDef.hpp"
+#include "objects/rigging.hpp"
+#include "voxels/Block.hpp"
+#include "world/generator/GeneratorDef.hpp"
+#include "world/generator/VoxelFragment.hpp"
+#include "world/generator/WorldGenerator.hpp"
+
+/// @brief Script placing overlapping lines of different blocks with the
+/// same priority, crossing many chunks, so the result depends on
+/// placements order
+class LinesScript : public GeneratorScript {
+    /// @param coord chunk coordinate multiplied by chunk size
+    static blockid_t choose_block(int coord) {
+        return 3 + (coord / CHUNK_W & 1);
+    }
+public:
+    void initialize(uint64_t) override {
+    }
+
+    std::unique_ptr<GeneratorScript> clone() const override {
+        return std::make_unique<LinesScript>();
+    }
+
+    std::shared_ptr<Heightmap> generateHeightmap(
+        const glm::ivec2& offset,
+        const glm::ivec2& size,
+        uint bpd,
+        const std::vector<std::shared_ptr<Heightmap>>&
+    ) override {
+        auto heightmap = std::make_shared<Heightmap>(size.x, size.y);
+        auto values = heightmap->getValues();
+        for (int y = 0; y < size.y; y++) {
+            for (int x = 0; x < size.x; x++) {
+                int gx = (offset.x + x) * bpd;
+                int gz = (offset.y + y) * bpd;
+                values[y * size.x + x] = 0.2f + ((gx + gz * 3) & 15) * 0.01f;
+            }
+        }
+        return heightmap;
+    }
+
+    std::vector<std::shared_ptr<Heightmap>> generateParameterMaps(
+        const glm::ivec2&, const glm::ivec2&, uint
+    ) override {
+        return {};
+    }
+
+    std::vector<Placement> placeStructuresWide(
+        const glm::ivec2& offset, const glm::ivec2&, uint
+    ) override {
+        // lines of chunks (x, z) and (x + 2, z + 1) overlap
+        glm::ivec3 a(offset.x, 40, offset.y);
+        glm::ivec3 b(offset.x + CHUNK_W * 6, 40, offset.y + CHUNK_D * 3);
+        return {Placement(1, LinePlacement(choose_block(offset.y), a, b, 3))};
+    }
+
+    std::vector<Placement> placeStructures(
+        const glm::ivec2& offset,
+        const glm::ivec2& size,
+        const std::shared_ptr<Heightmap>&,
+        uint
+    ) override {
+        // lines of chunks (x, z) and (x - 1, z + 1) overlap
+        glm::ivec3 a(offset.x + size.x / 2, 50, offset.y);
+        glm::ivec3 b(a.x - CHUNK_W * 2, 50, offset.y + CHUNK_D * 2);
+        return {Placement(1, LinePlacement(choose_block(offset.x), a, b, 2))};
+    }
+};
+
+class WorldGeneratorTest : public testing::Test {
+protected:
+    std::unique_ptr<Content> content;
+    std::unique_ptr<GeneratorDef> def;
+
+    void SetUp() override {
+        UptrsMap<std::string, Block> blocks;
+        std::vector<Block*> defs;
+        for (const auto& name :
+             {"core:air", "test:stone", "core:struct_air", "test:a", "test:b"}
+        ) {
+            auto block = std::make_unique<Block>(name);
+            block->rt.id = defs.size();
+            block->replaceable = defs.empty();
+            defs.push_back(block.get());
+            blocks[name] = std::move(block);
+        }
+        ResourceIndicesSet resourceIndices {};
+        content = std::make_unique<Content>(
+            std::make_unique<ContentIndices>(
+                ContentUnitIndices<Block>(defs),
+                ContentUnitIndices<ItemDef>({}),
+                ContentUnitIndices<EntityDef>({})
+            ),
+            std::make_unique<DrawGroups>(),
+            ContentUnitDefs<Block>(std::move(blocks)),
+            ContentUnitDefs<ItemDef>({}),
+            ContentUnitDefs<EntityDef>({}),
+            ContentUnitDefs<GeneratorDef>({}),
+            UptrsMap<std::string, ContentPackRuntime>(),
+            UptrsMap<std::string, BlockMaterial>(),
+            UptrsMap<std::string, rigging::SkeletonConfig>(),
+            resourceIndices,
+            nullptr
+        );
+        def = std::make_unique<GeneratorDef>("test:lines");
+        def->script = std::make_unique<LinesScript>();
+        def->wideStructsChunksRadius = 2;
+
+        Biome biome {"test:plains"};
+        biome.groundLayers.layers.push_back(
+            BlocksLayer {"test:stone", -1, true, {1}}
+        );
+        biome.groundLayers.lastLayersHeight = 0;
+        def->biomes.push_back(std::move(biome));
+    }
+
+    /// @brief Generate chunks while moving the center as a player does
+    std::vector<std::unique_ptr<voxel[]>> generate(uint threads) {
+        WorldGenerator generator(*def, *content, 42, threads);
+        std::vector<std::unique_ptr<voxel[]>> chunks;
+        for (int centerX : {0, 3, 6}) {
+            generator.update(centerX, 0, 4);
+            for (int radius = 0; radius <= 3; radius++) {
+                for (int z = -radius; z <= radius; z++) {
+                    for (int x = -radius; x <= radius; x++) {
+                        if (std::max(std::abs(x), std::abs(z)) != radius) {
+                            continue;
+                        }
+                        auto& voxels = chunks.emplace_back(
+                            std::make_unique<voxel[]>(CHUNK_VOL)
+                        );
+                        generator.generate(voxels.get(), centerX + x, z);
+                    }
+                }
+            }
+        }
+        return chunks;
+    }
+};
+
+TEST_F(WorldGeneratorTest, ParallelMatchesSerial) {
+    auto serial = generate(1);
+    auto parallel = generate(4);
+    ASSERT_EQ(serial.size(), parallel.size());
+
+    bool placed = false;
+    for (size_t i = 0; i < serial.size(); i++) {
+        for (uint j = 0; j < CHUNK_VOL; j++) {
+            placed |= serial[i][j].id > 2;
+        }
+        EXPECT_EQ(
+            std::memcmp(
+                serial[i].get(), parallel[i].get(), CHUNK_VOL * sizeof(voxel)
+            ),
+            0
+        ) << "chunk " << i;
+    }
+    EXPECT_TRUE(placed);
+}
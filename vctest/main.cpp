@@ -2,9 +2,12 @@
 #include <filesystem>
 #include <fstream>
 #include <iostream>
+#include <map>
+#include <regex>
 #include <sstream>
 #include <vector>
 
+#include "coders/json.hpp"
 #include "util/ArgsReader.hpp"
 
 namespace fs = std::filesystem;
@@ -16,10 +19,23 @@ struct Config {
     fs::path directory;
     fs::path resDir {"res"};
     fs::path workingDir {"."};
+    /// @brief Benchmark scenarios directory (benchmark mode if not empty)
+    fs::path benchDirectory;
+    /// @brief Benchmark results output file
+    fs::path reportFile;
     std::string memchecker = "valgrind";
     bool outputAlways = false;
 };
 
+/// @brief Benchmark scenario metric limit declared in the script as
+/// -- @threshold <metric> <= <value>
+/// -- @threshold <metric> >= <value>
+struct Threshold {
+    std::string metric;
+    bool isMax;
+    double value;
+};
+
 static bool perform_keyword(
     util::ArgsReader& reader, const std::string& keyword, Config& config
 ) {
@@ -32,6 +48,8 @@ static bool perform_keyword(
         std::cout << "  --user <path>, -u <path>        = user directory path\n";
         std::cout << "  --memchecker <path>             = path to valgrind\n";
         std::cout << "  --output-always                 = always show tests output\n";
+        std::cout << "  --bench <path>, -b <path>       = run benchmark scenarios from directory\n";
+        std::cout << "  --report <path>                 = benchmark results JSON file path\n";
         std::cout << std::endl;
         return false;
     } else if (keyword == "--exe" || keyword == "-e") {
@@ -46,6 +64,10 @@ static bool perform_keyword(
         config.outputAlways = true;
     } else if (keyword == "--memchecker") {
         config.memchecker = reader.next();
+    } else if (keyword == "--bench" || keyword == "-b") {
+        config.benchDirectory = fs::path(reader.next());
+    } else if (keyword == "--report") {
+        config.reportFile = fs::path(reader.next());
     } else {
         std::cerr << "unknown argument " << keyword << std::endl;
         return false;
@@ -86,7 +108,11 @@ static bool check_config(const Config& config) {
         std::cerr << "file " << config.executable << " not found" << std::endl;
         return true;
     }
-    if (!check_dir(config.directory)) {
+    if (config.benchDirectory.empty()) {
+        if (!check_dir(config.directory)) {
+            return true;
+        }
+    } else if (!check_dir(config.benchDirectory)) {
         return true;
     }
     if (!check_dir(config.resDir)) {
@@ -101,7 +127,11 @@ static bool check_config(const Config& config) {
 static void dump_config(const Config& config) {
     std::cout << "paths:\n";
     std::cout << "  VoxelCore executable = " << fs::canonical(config.executable).string() << "\n";
-    std::cout << "  Tests directory      = " << fs::canonical(config.directory).string() << "\n";
+    if (config.benchDirectory.empty()) {
+        std::cout << "  Tests directory      = " << fs::canonical(config.directory).string() << "\n";
+    } else {
+        std::cout << "  Bench directory      = " << fs::canonical(config.benchDirectory).string() << "\n";
+    }
     std::cout << "  Resources directory  = " << fs::canonical(config.resDir).string() << "\n";
     std::cout << "  Working directory    = " << fs::canonical(config.workingDir).string();
     std::cout << std::endl;
@@ -226,6 +256,163 @@ static bool run_test(const Config& config, const fs::path& path, bool memcheck =
     }
 }
 
+static std::vector<Threshold> read_thresholds(const fs::path& path) {
+    static const std::regex pattern(
+        R"(--\s*@threshold\s+(\w+)\s*(<=|>=)\s*([-+0-9.eE]+))"
+    );
+    std::vector<Threshold> thresholds;
+    std::ifstream file(path);
+    std::string line;
+    while (std::getline(file, line)) {
+        std::smatch match;
+        if (std::regex_search(line, match, pattern)) {
+            thresholds.push_back(Threshold {
+                match[1], match[2] == "<=", std::stod(match[3])});
+        }
+    }
+    return thresholds;
+}
+
+/// @brief Read numeric fields of the report
+static std::map<std::string, double> read_metrics(const dv::value& report) {
+    std::map<std::string, double> metrics;
+    for (const auto& [key, value] : report.asObject()) {
+        if (dv::is_numeric(value)) {
+            metrics[key] = value.asNumber();
+        }
+    }
+    return metrics;
+}
+
+static bool check_thresholds(
+    const std::map<std::string, double>& metrics,
+    const std::vector<Threshold>& thresholds
+) {
+    bool passed = true;
+    for (const auto& threshold : thresholds) {
+        const auto& found = metrics.find(threshold.metric);
+        if (found == metrics.end()) {
+            std::cerr << "  metric " << threshold.metric << " not found"
+                      << std::endl;
+            passed = false;
+            continue;
+        }
+        double value = found->second;
+        if (threshold.isMax ? value > threshold.value
+                            : value < threshold.value) {
+            std::cerr << "  [REGRESSED] " << threshold.metric << " = "
+                      << value << " (expected "
+                      << (threshold.isMax ? "<= " : ">= ") << threshold.value
+                      << ")" << std::endl;
+            passed = false;
+        }
+    }
+    return passed;
+}
+
+/// @param report scenario report (none if not produced)
+static void add_result(
+    dv::value& results, const std::string& name, bool passed, dv::value report
+) {
+    auto& result = results.object();
+    result["name"] = name;
+    result["passed"] = passed;
+    if (report != nullptr) {
+        result["report"] = std::move(report);
+    }
+}
+
+/// @param results list the scenario result is added to
+static bool run_scenario(
+    const Config& config, const fs::path& path, dv::value& results
+) {
+    auto outputFile = config.workingDir / "output.txt";
+    auto reportFile = config.workingDir / "report.json";
+    fs::remove(reportFile);
+
+    auto name = path.stem();
+    std::stringstream ss;
+    ss << fs::canonical(config.executable) << " --headless";
+    ss << " --test " << fix_path(path.string());
+    ss << " --res " << fix_path(config.resDir.string());
+    ss << " --dir " << fix_path(config.workingDir.string());
+    ss << " --report " << fix_path(reportFile.string());
+    ss << " >" << fix_path(outputFile.string()) << " 2>&1";
+    auto command = ss.str();
+
+    print_separator(std::cout);
+    std::cout << "executing scenario " << name << "\ncommand: " << command
+              << std::endl;
+
+    int code = system(command.c_str());
+    if (code || !fs::exists(reportFile)) {
+        display_test_output(outputFile, name, std::cerr);
+        std::cerr << "[FAILED] " << name << " (code=" << code << ")"
+                  << std::endl;
+        fs::remove(outputFile);
+        add_result(results, name.u8string(), false, nullptr);
+        return false;
+    }
+    if (config.outputAlways) {
+        display_test_output(outputFile, name, std::cout);
+    }
+    fs::remove(outputFile);
+
+    std::ifstream file(reportFile);
+    std::string text(
+        (std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>()
+    );
+    dv::value report;
+    try {
+        report = json::parse(reportFile.u8string(), text);
+    } catch (const std::runtime_error& err) {
+        std::cerr << "  " << err.what() << std::endl;
+    }
+    if (!report.isObject()) {
+        std::cerr << "[FAILED] " << name << " (invalid report)" << std::endl;
+        add_result(results, name.u8string(), false, nullptr);
+        return false;
+    }
+    auto metrics = read_metrics(report);
+    std::cout << "  ticks: " << metrics["ticks"]
+              << "\n  tick time (ms): p50 " << metrics["tick_p50_ms"]
+              << " p99 " << metrics["tick_p99_ms"] << " max "
+              << metrics["tick_max_ms"]
+              << "\n  chunks/s: loaded " << metrics["chunks_loaded_per_second"]
+              << " generated " << metrics["chunks_generated_per_second"]
+              << "\n  entities: " << metrics["entities_max"]
+              << "\n  peak RSS (MB): " << metrics["rss_peak_mb"] << std::endl;
+
+    bool passed = check_thresholds(metrics, read_thresholds(path));
+    std::cout << (passed ? "[PASSED] " : "[FAILED] ") << name << std::endl;
+    add_result(results, name.u8string(), passed, std::move(report));
+    return passed;
+}
+
+static int run_benchmarks(
+    const Config& config, const std::vector<fs::path>& scenarios
+) {
+    auto results = dv::list();
+    size_t passed = 0;
+    for (size_t i = 0; i < scenarios.size(); i++) {
+        passed += run_scenario(config, scenarios[i], results);
+        fs::remove_all(config.workingDir / fs::u8path("worlds"));
+    }
+    print_separator(std::cout);
+    cleanup(config.workingDir);
+    if (!config.reportFile.empty()) {
+        std::ofstream file(config.reportFile);
+        file << json::stringify(dv::object({{"scenarios", results}}), true)
+             << std::endl;
+        std::cout << "results written to " << config.reportFile << std::endl;
+    }
+    std::cout << std::endl;
+    std::cout << passed << " scenario(s) passed, "
+              << (scenarios.size() - passed) << " scenario(s) failed"
+              << std::endl;
+    return passed < scenarios.size() ? 1 : 0;
+}
+
 int main(int argc, char** argv) {
     Config config;
     try {
@@ -241,9 +428,13 @@ int main(int argc, char** argv) {
     }
     dump_config(config);
 
+    bool benchmark = !config.benchDirectory.empty();
     std::vector<fs::path> tests;
-    std::cout << "scanning for tests" << std::endl;
-    for (const auto& entry : fs::directory_iterator(config.directory)) {
+    std::cout << "scanning for " << (benchmark ? "scenarios" : "tests")
+              << std::endl;
+    for (const auto& entry : fs::directory_iterator(
+             benchmark ? config.benchDirectory : config.directory
+         )) {
         auto path = entry.path();
         if (path.extension().string() != ".lua") {
             std::cout << "  " << entry.path() << " skipped" << std::endl;
@@ -256,6 +447,10 @@ int main(int argc, char** argv) {
     setup_working_dir(config.workingDir);
     config.workingDir /= TESTING_DIR;
 
+    if (benchmark) {
+        return run_benchmarks(config, tests);
+    }
+
     size_t passed = 0;
     std::cout << "running " << tests.size() << " test(s)" << std::endl;
     for (const auto& path : tests) {